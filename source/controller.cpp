@@ -1,7 +1,12 @@
 #include "controller.h"
 #include "dispatcher.h"
 #include "hostedplugin.h"
+#include "instancediscovery.h"
+#include "instancepool.h"
+#include "instanceregistry.h"
 #include "messageids.h"
+#include "modulecache.h"
+#include "sessionserver.h"
 #include "mcp_param_handlers.h"
 #include "mcp_plugin_handlers.h"
 #include "stateformat.h"
@@ -12,7 +17,6 @@
 
 #include "public.sdk/source/vst/hosting/connectionproxy.h"
 #include "public.sdk/source/vst/hosting/module.h"
-#include "public.sdk/source/vst/utility/memoryibstream.h"
 
 #include "logging.h"
 #include "version.h"
@@ -20,41 +24,219 @@
 #include "mcp_server.h"
 #include "mcp_tool.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <future>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace Steinberg;
 using namespace Steinberg::Vst;
 
 namespace VST3MCPWrapper {
 
-static constexpr int kMCPServerPort = 8771;
-static constexpr auto kDispatchTimeout = std::chrono::seconds(5);
+static constexpr auto kJobPollInterval = std::chrono::milliseconds(50);
+
+static constexpr int kMaxBindAttempts = 5;
+static constexpr auto kListenTimeout = std::chrono::seconds(2);
+static constexpr auto kListenPollInterval = std::chrono::milliseconds(5);
+
+static sockaddr_in loopbackAddress(int port) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    return addr;
+}
+
+// A port on 127.0.0.1 the OS considers free, or 0. cpp-mcp binds the port
+// it is configured with and can't report an OS-assigned one, so we bind
+// port 0 ourselves to let the OS pick, then hand the port to the server.
+// Another process may take the port before the server binds it, so
+// MCPServer::listen() retries on a new one when the bind fails.
+static int reserveLoopbackPort() {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return 0;
+    sockaddr_in addr = loopbackAddress(0);
+    socklen_t length = sizeof(addr);
+    int port = 0;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0
+        && ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) == 0)
+        port = ntohs(addr.sin_port);
+    ::close(fd);
+    return port;
+}
+
+// Whether something accepts connections on 127.0.0.1:port.
+static bool loopbackPortAccepts(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+    sockaddr_in addr = loopbackAddress(port);
+    bool accepted = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    ::close(fd);
+    return accepted;
+}
+
+// Forwards messages between the hosted component and controller like
+// ConnectionProxy, and marks the hosted state changed on every one: plugins
+// often sync state through messages rather than parameters.
+class StateTrackingConnectionProxy : public ConnectionProxy {
+public:
+    StateTrackingConnectionProxy(IConnectionPoint* source, std::shared_ptr<HostedPluginInstance> hosted)
+        : ConnectionProxy(source), hosted_(std::move(hosted)) {}
+
+    tresult PLUGIN_API notify(IMessage* message) override {
+        hosted_->markStateChanged();
+        return ConnectionProxy::notify(message);
+    }
+
+private:
+    std::shared_ptr<HostedPluginInstance> hosted_;
+};
 
 // ---- MCP Server ----
 struct Controller::MCPServer {
     std::unique_ptr<mcp::server> server;
     std::thread serverThread;
     MainThreadDispatcher dispatcher;
+    PluginJobQueue jobs;
+    ParamChangeNotifier* notifier = nullptr;
+    bool scanRefreshStarted = false;
+    std::weak_ptr<HostedPluginInstance> poolInstance; // Whose warm pool refills on our dispatcher
+    bool discoveryWatching = false;
+    int port = 0;
+    bool listening = false; // Set once the server accepts connections on port
+    std::atomic<bool> serverExited{false};
+    // Registered again on the server of every bind attempt
+    std::vector<std::pair<mcp::tool, mcp::tool_handler>> registeredTools;
+    // The same tools, for the session server to route calls to
+    std::shared_ptr<InstanceToolTable> tools = std::make_shared<InstanceToolTable>();
+
+    void addTool(const mcp::tool& tool, mcp::tool_handler handler) {
+        tools->add(tool, handler);
+        registeredTools.emplace_back(tool, std::move(handler));
+    }
 
-    void start(Controller* controller) {
+    // Warm instances of hosted's pool are built on the main thread, one per
+    // task. Replaces the pool scheduled before.
+    void scheduleWarmPool(const std::shared_ptr<HostedPluginInstance>& hosted) {
+        unscheduleWarmPool();
+        std::weak_ptr<HostedPluginInstance> weak = hosted;
+        hosted->warmPool().setScheduler([this, weak](std::function<void()> task) {
+            // Dropped if the pool's instance is gone by the time it runs
+            dispatcher.dispatch([weak, task = std::move(task)]() {
+                if (auto keep = weak.lock())
+                    task();
+            });
+        });
+        poolInstance = hosted;
+    }
+
+    void unscheduleWarmPool() {
+        if (auto hosted = poolInstance.lock())
+            hosted->warmPool().setScheduler(nullptr);
+        poolInstance.reset();
+    }
+
+    // Starts a server on a fresh loopback port and returns once it accepts
+    // connections there, retrying on a new port when the server exits first
+    // (the reserved port was taken before it could bind).
+    void listen() {
+        for (int attempt = 0; attempt < kMaxBindAttempts; ++attempt) {
+            int candidate = reserveLoopbackPort();
+            if (candidate == 0)
+                break;
+            if (serveOn(candidate)) {
+                listening = true;
+                return;
+            }
+            WRAPPER_LOG_ERROR("MCP server could not listen on port %d", candidate);
+        }
+        throw std::runtime_error("no MCP server listening on 127.0.0.1");
+    }
+
+    bool serveOn(int candidate) {
         mcp::server::configuration conf;
         conf.host = "127.0.0.1";
-        conf.port = kMCPServerPort;
+        conf.port = candidate;
         conf.name = "VST3 MCP Wrapper";
         conf.version = FULL_VERSION_STR;
 
+        port = candidate;
         server = std::make_unique<mcp::server>(conf);
+        for (const auto& [tool, handler] : registeredTools)
+            server->register_tool(tool, handler);
+
+        serverExited.store(false);
+        serverThread = std::thread([this]() {
+            try {
+                server->start(true);
+            } catch (const std::exception& e) {
+                WRAPPER_LOG_ERROR("MCP server thread error: %s", e.what());
+            } catch (...) {
+                WRAPPER_LOG_ERROR("MCP server thread unknown error");
+            }
+            serverExited.store(true);
+        });
 
+        // A failed bind ends start() right away. Only count the port as ours
+        // once the server is still running a poll after the port answered,
+        // so a process that took the port first isn't mistaken for it.
+        auto deadline = std::chrono::steady_clock::now() + kListenTimeout;
+        bool answered = false;
+        while (!serverExited.load() && std::chrono::steady_clock::now() < deadline) {
+            if (answered)
+                return true;
+            answered = loopbackPortAccepts(candidate);
+            std::this_thread::sleep_for(kListenPollInterval);
+        }
+        server->stop();
+        serverThread.join();
+        server.reset();
+        port = 0;
+        return false;
+    }
+
+    void start(Controller* controller) {
         // --- list_parameters tool ---
         auto listParamsTool = mcp::tool_builder("list_parameters")
-            .with_description("List all parameters of the hosted VST3 plugin with their IDs, names, and current values")
+            .with_description("List all parameters of the hosted VST3 plugin with their IDs, names, and current values. "
+                              "With no arguments returns a JSON array of every parameter. Any of since_version, offset, "
+                              "limit, filter or fields returns {version, total, offset, nextOffset?, parameters} instead; "
+                              "since_version (0 for everything) lists only parameters changed after that version and adds "
+                              "\"full\"; poll again with the returned version.")
+            .with_number_param("since_version", "Optional: only list parameters changed after this version", false)
+            .with_number_param("offset", "Optional: index of the first matching parameter to return", false)
+            .with_number_param("limit", "Optional: maximum number of parameters to return", false)
+            .with_string_param("filter", "Optional: case-insensitive substring of the parameter title", false)
+            .with_array_param("fields", "Optional: fields to include per parameter (id, title, units, normalizedValue, "
+                              "displayValue, defaultNormalizedValue, stepCount, canAutomate)", "string", false)
             .build();
 
-        server->register_tool(listParamsTool,
+        addTool(listParamsTool,
             [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
                 auto ctrl = controller->getHostedController();
-                return handleListParameters(ctrl.get());
+                ListParametersOptions options;
+                std::string error;
+                if (!parseListParametersOptions(params, options, error)) {
+                    return {
+                        {"content", {{{"type", "text"}, {"text", error}}}},
+                        {"isError", true}
+                    };
+                }
+                return handleListParameters(ctrl.get(), controller->getParameterCache(), options);
             });
 
         // --- get_parameter tool ---
@@ -63,11 +245,11 @@ struct Controller::MCPServer {
             .with_number_param("id", "The parameter ID", true)
             .build();
 
-        server->register_tool(getParamTool,
+        addTool(getParamTool,
             [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
                 auto ctrl = controller->getHostedController();
                 ParamID paramId = params["id"].get<uint32>();
-                return handleGetParameter(ctrl.get(), paramId);
+                return handleGetParameter(ctrl.get(), controller->getParameterCache(), paramId);
             });
 
         // --- set_parameter tool ---
@@ -75,60 +257,225 @@ struct Controller::MCPServer {
             .with_description("Set the normalized value (0.0 to 1.0) of a specific parameter by its ID")
             .with_number_param("id", "The parameter ID", true)
             .with_number_param("value", "The normalized value between 0.0 and 1.0", true)
+            .with_number_param("at_sample", "Optional: apply at this project sample position (sample-accurate). Applied now if the transport is stopped or loops before reaching it", false)
+            .with_number_param("delay_ms", "Optional: apply this many milliseconds from now (sample-accurate)", false)
             .build();
 
-        server->register_tool(setParamTool,
+        addTool(setParamTool,
             [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
                 auto ctrl = controller->getHostedController();
                 ParamID paramId = params["id"].get<uint32>();
                 ParamValue value = params["value"].get<double>();
-                return handleSetParameter(ctrl.get(), paramId, value);
+                ParamChangeTiming timing;
+                int64 time;
+                std::string error;
+                if (!parseParamChangeTiming(params, timing, time, error)) {
+                    return {
+                        {"content", {{{"type", "text"}, {"text", error}}}},
+                        {"isError", true}
+                    };
+                }
+                return handleSetParameter(ctrl.get(), controller->getParameterCache(), *controller->getHostedInstance(),
+                                          paramId, value, timing, time, &controller->getParamHistory());
+            });
+
+        // --- set_parameters tool ---
+        auto setParamsTool = mcp::tool_builder("set_parameters")
+            .with_description("Set several parameters at once. Takes an array of {id, value} objects "
+                              "(normalized values 0.0 to 1.0); all entries are validated before any is applied.")
+            .with_array_param("parameters", "Array of {\"id\": number, \"value\": number} objects", "object", true)
+            .build();
+
+        addTool(setParamsTool,
+            [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                auto ctrl = controller->getHostedController();
+                return handleSetParameters(ctrl.get(), controller->getParameterCache(), *controller->getHostedInstance(),
+                                           params["parameters"], &controller->getParamHistory());
+            });
+
+        // --- ramp_parameter tool ---
+        auto rampParamTool = mcp::tool_builder("ramp_parameter")
+            .with_description("Smoothly move a parameter to a normalized target value (0.0 to 1.0) over a duration. "
+                              "The ramp runs sample-accurately inside the audio engine.")
+            .with_number_param("id", "The parameter ID", true)
+            .with_number_param("value", "The target normalized value between 0.0 and 1.0", true)
+            .with_number_param("duration_ms", "Ramp duration in milliseconds", true)
+            .with_string_param("curve", "Optional: linear (default), ease_in, ease_out or s_curve", false)
+            .build();
+
+        addTool(rampParamTool,
+            [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                auto ctrl = controller->getHostedController();
+                ParamID paramId = params["id"].get<uint32>();
+                ParamValue value = params["value"].get<double>();
+                double durationMs = params["duration_ms"].get<double>();
+                std::string curve = params.contains("curve") ? params["curve"].get<std::string>() : "linear";
+                return handleRampParameter(ctrl.get(), controller->getParameterCache(), *controller->getHostedInstance(),
+                                           paramId, value, durationMs, curve, &controller->getParamHistory());
+            });
+
+        // --- undo / redo tools ---
+        auto readSteps = [](const mcp::json& params) {
+            if (!params.contains("steps") || !params["steps"].is_number())
+                return 1;
+            double steps = params["steps"].get<double>();
+            return std::isfinite(steps) ? static_cast<int>(std::clamp(steps, 0.0, 1e6)) : 0;
+        };
+
+        auto undoTool = mcp::tool_builder("undo")
+            .with_description("Undo the last parameter edits made through set_parameter, set_parameters, "
+                              "ramp_parameter or revert_to. Each call of those tools is one step; all undone "
+                              "steps are applied in one batch.")
+            .with_number_param("steps", "Optional: number of steps to undo (default 1)", false)
+            .build();
+
+        addTool(undoTool,
+            [controller, readSteps](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                auto ctrl = controller->getHostedController();
+                return handleUndoRedo(ctrl.get(), controller->getParameterCache(), *controller->getHostedInstance(),
+                                      controller->getParamHistory(), false, readSteps(params));
+            });
+
+        auto redoTool = mcp::tool_builder("redo")
+            .with_description("Redo parameter edit steps undone with undo. A new edit discards the steps "
+                              "that could be redone.")
+            .with_number_param("steps", "Optional: number of steps to redo (default 1)", false)
+            .build();
+
+        addTool(redoTool,
+            [controller, readSteps](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                auto ctrl = controller->getHostedController();
+                return handleUndoRedo(ctrl.get(), controller->getParameterCache(), *controller->getHostedInstance(),
+                                      controller->getParamHistory(), true, readSteps(params));
+            });
+
+        // --- checkpoint / revert_to tools ---
+        auto checkpointTool = mcp::tool_builder("checkpoint")
+            .with_description("Save every parameter's current value under a name, to return to later with "
+                              "revert_to. Automatic checkpoints (auto-N) are also taken every 64 edit steps. "
+                              "Returns the names of all checkpoints.")
+            .with_string_param("name", "Optional: checkpoint name (generated if omitted; an existing one is replaced)",
+                               false)
+            .build();
+
+        addTool(checkpointTool,
+            [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                auto ctrl = controller->getHostedController();
+                std::string name = params.contains("name") && params["name"].is_string()
+                    ? params["name"].get<std::string>() : std::string();
+                return handleCheckpoint(ctrl.get(), controller->getParameterCache(), controller->getParamHistory(),
+                                        name);
+            });
+
+        auto revertTool = mcp::tool_builder("revert_to")
+            .with_description("Set all parameters back to their values at a checkpoint, in one batch. "
+                              "The revert is itself an undo step.")
+            .with_string_param("checkpoint", "Name of the checkpoint", true)
+            .build();
+
+        addTool(revertTool,
+            [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                auto ctrl = controller->getHostedController();
+                return handleRevertTo(ctrl.get(), controller->getParameterCache(), *controller->getHostedInstance(),
+                                      controller->getParamHistory(), params["checkpoint"].get<std::string>());
+            });
+
+        // --- subscribe_parameters tool ---
+        auto subscribeTool = mcp::tool_builder("subscribe_parameters")
+            .with_description("Subscribe this session to parameter changes made in the plugin GUI or by host "
+                              "automation. Changes are coalesced per parameter and pushed at most once per "
+                              "interval as \"notifications/parameters/changed\" with {parameters: [{id, normalizedValue}]}.")
+            .with_array_param("ids", "Optional: parameter IDs to watch (omit for all parameters)", "number", false)
+            .with_number_param("interval_ms", "Optional: minimum time between notifications (default 50, min 10)", false)
+            .build();
+
+        addTool(subscribeTool,
+            [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                auto ctrl = controller->getHostedController();
+                mcp::json ids = params.contains("ids") ? params["ids"] : mcp::json();
+                int intervalMs = ParamChangeNotifier::kDefaultIntervalMs;
+                if (params.contains("interval_ms") && params["interval_ms"].is_number()) {
+                    double requested = params["interval_ms"].get<double>();
+                    if (std::isfinite(requested))
+                        intervalMs = static_cast<int>(std::clamp(requested, 0.0,
+                            static_cast<double>(ParamChangeNotifier::kMaxIntervalMs)));
+                }
+                return handleSubscribeParameters(ctrl.get(), controller->getParameterCache(),
+                                                 controller->getParamNotifier(), session_id, ids, intervalMs);
+            });
+
+        // --- unsubscribe_parameters tool ---
+        auto unsubscribeTool = mcp::tool_builder("unsubscribe_parameters")
+            .with_description("Stop parameter change notifications for this session")
+            .with_array_param("ids", "Optional: parameter IDs to stop watching (omit to unsubscribe entirely)", "number", false)
+            .build();
+
+        addTool(unsubscribeTool,
+            [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                mcp::json ids = params.contains("ids") ? params["ids"] : mcp::json();
+                return handleUnsubscribeParameters(controller->getParamNotifier(), session_id, ids);
             });
 
         // --- list_available_plugins tool ---
         auto listPluginsTool = mcp::tool_builder("list_available_plugins")
-            .with_description("List all VST3 plugins installed on the system")
+            .with_description("List all VST3 plugins installed on the system with name, vendor, version and "
+                              "classes where the bundle provides a moduleinfo.json")
             .build();
 
-        server->register_tool(listPluginsTool,
+        addTool(listPluginsTool,
             [](const mcp::json& params, const std::string& session_id) -> mcp::json {
-                auto paths = VST3::Hosting::Module::getModulePaths();
-                return handleListAvailablePlugins(paths);
+                // Answered from the in-memory index; the scan runs in the background
+                return handleListAvailablePlugins(*PluginScanCache::shared().plugins());
             });
 
         // --- load_plugin tool ---
         auto loadPluginTool = mcp::tool_builder("load_plugin")
-            .with_description("Load a VST3 plugin by its file path. Use list_available_plugins to see available plugins.")
+            .with_description("Start loading a VST3 plugin by its file path. Returns a job immediately; poll "
+                              "get_job_status with its jobId until state is succeeded, failed or cancelled. "
+                              "Use list_available_plugins to see available plugins.")
             .with_string_param("path", "Full path to the .vst3 plugin bundle", true)
             .build();
 
-        server->register_tool(loadPluginTool,
-            [controller, &dispatcher = this->dispatcher](const mcp::json& params, const std::string& session_id) -> mcp::json {
+        addTool(loadPluginTool,
+            [this, controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
                 std::string path = params["path"].get<std::string>();
 
                 if (!dispatcher.isAlive()) {
                     return handleShuttingDown();
                 }
 
-                auto future = dispatcher.dispatch<std::string>(
-                    [controller, path]() { return controller->loadPlugin(path); },
-                    std::string("Plugin is shutting down"));
-
-                if (future.wait_for(kDispatchTimeout) == std::future_status::timeout) {
-                    return handleTimeout("Load plugin");
+                auto job = jobs.submit("load", path, [this, controller, path](const std::shared_ptr<PluginJob>& job) {
+                    // Open the bundle here, off the main thread; only the swap runs there.
+                    // A recently used bundle comes straight from the module cache.
+                    job->enterPhase(PluginJobPhase::ModuleOpen);
+                    std::string error;
+                    auto module = ModuleCache::shared().acquire(path, error);
+                    if (!module) {
+                        job->finish(error.empty() ? "Failed to open module" : error);
+                        return;
+                    }
+                    if (job->isCancelled())
+                        return;
+
+                    auto future = dispatcher.dispatch<std::string>(
+                        [controller, path, job, module]() { return controller->loadPlugin(path, job.get(), module); },
+                        std::string("Plugin is shutting down"));
+                    job->finish(awaitDispatched(future));
+                });
+                if (!job) {
+                    return handleShuttingDown();
                 }
-                auto error = future.get();
-
-                return buildLoadPluginResponse(path, error);
+                return buildJobSubmittedResponse(job->status());
             });
 
         // --- unload_plugin tool ---
         auto unloadPluginTool = mcp::tool_builder("unload_plugin")
-            .with_description("Unload the currently hosted VST3 plugin and return to the drop zone")
+            .with_description("Unload the currently hosted VST3 plugin and return to the drop zone. "
+                              "Returns a job; poll get_job_status with its jobId.")
             .build();
 
-        server->register_tool(unloadPluginTool,
-            [controller, &dispatcher = this->dispatcher](const mcp::json& params, const std::string& session_id) -> mcp::json {
+        addTool(unloadPluginTool,
+            [this, controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
                 if (!dispatcher.isAlive()) {
                     return handleShuttingDown();
                 }
@@ -137,15 +484,62 @@ struct Controller::MCPServer {
                     return handleUnloadPluginNotLoaded();
                 }
 
-                auto future = dispatcher.dispatch(
-                    [controller]() { controller->unloadPlugin(); });
-
-                if (future.wait_for(kDispatchTimeout) == std::future_status::timeout) {
-                    return handleTimeout("Unload plugin");
+                auto job = jobs.submit("unload", controller->getCurrentPluginPath(),
+                    [this, controller](const std::shared_ptr<PluginJob>& job) {
+                        if (!job->enterPhase(PluginJobPhase::Teardown) || !job->beginSwap())
+                            return;
+                        auto future = dispatcher.dispatch<std::string>(
+                            [controller]() {
+                                controller->unloadPlugin();
+                                return std::string();
+                            },
+                            std::string("Plugin is shutting down"));
+                        job->finish(awaitDispatched(future));
+                    });
+                if (!job) {
+                    return handleShuttingDown();
                 }
-                future.get();
+                return buildJobSubmittedResponse(job->status());
+            });
+
+        // --- get_job_status tool ---
+        auto jobStatusTool = mcp::tool_builder("get_job_status")
+            .with_description("Get the state (queued, running, succeeded, failed, cancelled) and current phase "
+                              "(module_open, component_init, controller_setup, state_sync, teardown, done) "
+                              "of a load_plugin/unload_plugin job")
+            .with_number_param("job_id", "The jobId returned by load_plugin or unload_plugin", true)
+            .build();
+
+        addTool(jobStatusTool,
+            [this](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                return handleGetJobStatus(jobs, params["job_id"].get<uint64_t>());
+            });
+
+        // --- cancel_job tool ---
+        auto cancelJobTool = mcp::tool_builder("cancel_job")
+            .with_description("Cancel a load_plugin/unload_plugin job. Only possible before the job starts "
+                              "replacing the current plugin; the result's \"cancelled\" says whether it worked.")
+            .with_number_param("job_id", "The jobId returned by load_plugin or unload_plugin", true)
+            .build();
 
-                return handleUnloadPluginSuccess();
+        addTool(cancelJobTool,
+            [this](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                return handleCancelJob(jobs, params["job_id"].get<uint64_t>());
+            });
+
+        // --- configure_warm_pool tool ---
+        auto warmPoolTool = mcp::tool_builder("configure_warm_pool")
+            .with_description("Keep pre-initialized instances of the given plugins ready so this instance's "
+                              "load_plugin switches to them in milliseconds. Each wrapper instance has its own "
+                              "pool. Replaces the list; an empty list turns the pool off. "
+                              "Omit both arguments to only report how many instances are ready.")
+            .with_array_param("paths", "Optional: .vst3 bundle paths to keep warm", "string", false)
+            .with_number_param("instances", "Optional: instances to keep per plugin (1-4, default 1)", false)
+            .build();
+
+        addTool(warmPoolTool,
+            [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                return handleConfigureWarmPool(controller->getHostedInstance()->warmPool(), params);
             });
 
         // --- get_loaded_plugin tool ---
@@ -153,25 +547,78 @@ struct Controller::MCPServer {
             .with_description("Get the currently loaded VST3 plugin path")
             .build();
 
-        server->register_tool(getLoadedTool,
+        addTool(getLoadedTool,
             [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
                 return handleGetLoadedPlugin(controller->getCurrentPluginPath());
             });
 
-        // Start server in background thread
-        serverThread = std::thread([this]() {
-            try {
-                server->start(true);
-            } catch (const std::exception& e) {
-                WRAPPER_LOG_ERROR("MCP server thread error: %s", e.what());
-            } catch (...) {
-                WRAPPER_LOG_ERROR("MCP server thread unknown error");
-            }
+        // --- list_instances tool ---
+        auto listInstancesTool = mcp::tool_builder("list_instances")
+            .with_description("List the MCP servers of all running wrapper instances (in every DAW process) with "
+                              "their instance ID, port, pid, pluginPath and pluginName. This instance has \"self\": true.")
+            .build();
+
+        addTool(listInstancesTool,
+            [controller](const mcp::json& params, const std::string& session_id) -> mcp::json {
+                return handleListInstances(InstanceDiscovery::shared().instances(), controller->getInstanceId());
+            });
+
+        tools->setDescriber([this, controller]() -> mcp::json {
+            return {{"pluginPath", controller->getCurrentPluginPath()}, {"port", port}};
         });
+
+        listen();
+
+        // Deliver subscribed parameter changes as JSON-RPC notifications
+        controller->getParamNotifier().start(
+            [this](const std::string& sessionId, const std::vector<ParamUpdate>& updates) {
+                try {
+                    server->send_request(sessionId, mcp::request::create_notification(
+                        kParamChangedNotification, paramChangedNotificationParams(updates)));
+                } catch (const std::exception& e) {
+                    WRAPPER_LOG_ERROR("Failed to send parameter notification: %s", e.what());
+                }
+            });
+        notifier = &controller->getParamNotifier();
+
+        PluginScanCache::shared().startBackgroundRefresh();
+        scanRefreshStarted = true;
+
+        InstanceDiscovery::shared().startWatching();
+        discoveryWatching = true;
+
+        scheduleWarmPool(controller->getHostedInstance());
+    }
+
+    // Wait for a job's main-thread step without a deadline, but give up once
+    // the server is stopping (the main thread may be the one stopping it).
+    std::string awaitDispatched(std::future<std::string>& future) {
+        while (future.wait_for(kJobPollInterval) == std::future_status::timeout) {
+            if (jobs.stopping())
+                return "Plugin is shutting down";
+        }
+        return future.get();
     }
 
     void stop() {
+        unscheduleWarmPool();
         dispatcher.shutdown();
+        jobs.stop();
+        // Wait out session calls; with the jobs stopped none waits on us
+        tools->close();
+        // Stop notifications before the server they are sent through goes away
+        if (notifier) {
+            notifier->stop();
+            notifier = nullptr;
+        }
+        if (scanRefreshStarted) {
+            PluginScanCache::shared().stopBackgroundRefresh();
+            scanRefreshStarted = false;
+        }
+        if (discoveryWatching) {
+            InstanceDiscovery::shared().stopWatching();
+            discoveryWatching = false;
+        }
         if (server) {
             server->stop();
         }
@@ -182,7 +629,7 @@ struct Controller::MCPServer {
     }
 };
 
-Controller::Controller() = default;
+Controller::Controller() : hostedInstance_(std::make_shared<HostedPluginInstance>()) {}
 Controller::~Controller() = default;
 
 tresult PLUGIN_API Controller::queryInterface(const TUID iid, void** obj) {
@@ -200,6 +647,80 @@ IPtr<IEditController> Controller::getHostedController() const {
     return hostedController_;
 }
 
+std::shared_ptr<HostedPluginInstance> Controller::getHostedInstance() const {
+    std::lock_guard<std::mutex> lock(hostedInstanceMutex_);
+    return hostedInstance_;
+}
+
+bool Controller::bindHostedInstance(const std::string& id) {
+    auto instance = InstanceRegistry::shared().find(id);
+    if (!instance)
+        return false;
+    std::string previousId;
+    std::shared_ptr<HostedPluginInstance> previous;
+    {
+        std::lock_guard<std::mutex> lock(hostedInstanceMutex_);
+        previous = std::exchange(hostedInstance_, instance);
+        hostedInstanceBound_ = true;
+        previousId = std::exchange(instanceId_, id);
+    }
+    if (previous != instance) {
+        // The warm pool is per instance: build controllers for the one we share now
+        previous->warmPool().removeControllerFactory(this);
+        registerWarmControllerFactory(*instance);
+        if (mcpServer_)
+            mcpServer_->scheduleWarmPool(instance);
+    }
+    if (mcpServer_) {
+        if (!previousId.empty() && previousId != id)
+            SessionServer::shared().detach(previousId, mcpServer_->tools.get());
+        SessionServer::shared().attach(id, mcpServer_->tools);
+        if (!previousId.empty() && previousId != id)
+            InstanceDiscovery::shared().withdraw(previousId);
+        publishDiscovery();
+    }
+    return true;
+}
+
+void Controller::registerWarmControllerFactory(HostedPluginInstance& hosted) {
+    // Build warm controllers for the pool with our host context
+    hosted.warmPool().setControllerFactory(this,
+        [this](const std::string& path, const TUID* controllerClassID, WarmController& out) {
+            std::string error;
+            auto module = ModuleCache::shared().acquire(path, error);
+            return module && createControllerInstance(module, controllerClassID, out);
+        });
+}
+
+std::string Controller::getInstanceId() const {
+    std::lock_guard<std::mutex> lock(hostedInstanceMutex_);
+    return instanceId_;
+}
+
+void Controller::publishDiscovery() {
+    if (!mcpServer_ || !mcpServer_->listening)
+        return; // Clients could not connect to the port yet
+    auto hosted = getHostedInstance();
+    DiscoveredInstance entry;
+    entry.id = getInstanceId();
+    if (entry.id.empty())
+        return; // Published once bound to the processor
+    entry.port = mcpServer_->port;
+    entry.pid = ::getpid();
+    entry.pluginPath = getCurrentPluginPath();
+    if (!entry.pluginPath.empty()) {
+        entry.pluginName = std::filesystem::path(entry.pluginPath).stem().string();
+        auto effectClassID = hosted->getEffectClassID();
+        for (const auto& info : ModuleCache::shared().classes(hosted->getModule())->classes) {
+            if (info.ID() == effectClassID) {
+                entry.pluginName = info.name();
+                break;
+            }
+        }
+    }
+    InstanceDiscovery::shared().publish(entry);
+}
+
 tresult PLUGIN_API Controller::initialize(FUnknown* context) {
     tresult result = EditController::initialize(context);
     if (result != kResultOk)
@@ -207,9 +728,16 @@ tresult PLUGIN_API Controller::initialize(FUnknown* context) {
 
     hostContext_ = context;
 
+    registerWarmControllerFactory(*getHostedInstance());
+
     // Start MCP server (works even without a hosted plugin)
     startMCPServer();
 
+    if (int port = SessionServer::configuredPort()) {
+        SessionServer::shared().start(port);
+        sessionServerStarted_ = true;
+    }
+
     return kResultOk;
 }
 
@@ -223,16 +751,29 @@ tresult PLUGIN_API Controller::terminate() {
         activeView_ = nullptr;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(restoreMutex_);
+        pendingRestore_.reset();
+    }
     stopMCPServer();
+    if (sessionServerStarted_) {
+        SessionServer::shared().stop();
+        sessionServerStarted_ = false;
+    }
 
+    getHostedInstance()->warmPool().removeControllerFactory(this);
     teardownHostedController();
 
+    // The module cache is shared by every instance in the process (including
+    // modules prefetched for a session restore still in progress), so it is
+    // left alone; its LRU budget bounds what stays loaded
     return EditController::terminate();
 }
 
 IPlugView* PLUGIN_API Controller::createView(FIDString name) {
     if (!name || !FIDStringsEqual(name, ViewType::kEditor))
         return nullptr;
+    completeRestore();
 
     auto* view = new WrapperPlugView(this);
     activeView_ = view;
@@ -243,32 +784,152 @@ tresult PLUGIN_API Controller::setComponentState(IBStream* state) {
     if (!state)
         return kResultOk;
 
-    // Read wrapper state header to extract plugin path
-    std::string pluginPath;
-    if (readStateHeader(state, pluginPath) != kResultOk)
+    // Read wrapper state to extract plugin path. If the processor restored
+    // this stream first, its decompressed component state is reused.
+    std::shared_ptr<HostedPluginInstance> hosted;
+    bool bound;
+    {
+        std::lock_guard<std::mutex> lock(hostedInstanceMutex_);
+        hosted = hostedInstance_;
+        bound = hostedInstanceBound_;
+    }
+    WrapperState saved;
+    if (readWrapperState(state, saved, hosted->takeRestoredComponentState()) != kResultOk)
         return kResultOk; // Non-fatal for controller side
 
-    // Load the plugin if needed
+    // Without a kInstanceId message (hosts that restore before connecting the
+    // processor and controller), the saved ID names the processor's instance
+    // once its setState() has run
+    if (!bound && !saved.instanceId.empty() && bindHostedInstance(saved.instanceId)) {
+        hosted = getHostedInstance();
+        hosted->takeRestoredComponentState(); // Decompressed again above
+    }
+
+    std::lock_guard<std::mutex> lock(restoreMutex_);
+    // A newer state replaces one still waiting for its plugin
+    pendingRestore_.reset();
+    if (!saved.pluginPath.empty() && saved.pluginPath != currentPluginPath_ && deferRestore(state, saved))
+        return kResultOk;
+    return applyComponentState(state, saved);
+}
+
+tresult Controller::applyComponentState(IBStream* state, const WrapperState& saved) {
+    // Load the plugin if needed. The state below replaces the one a fresh
+    // controller would otherwise be synced from.
+    bool hasComponentState = saved.version == kStateVersion || saved.componentState.present();
+    const std::string& pluginPath = saved.pluginPath;
     if (!pluginPath.empty() && pluginPath != currentPluginPath_) {
         teardownHostedController();
-        auto& pluginModule = HostedPluginModule::instance();
         std::string error;
-        if (pluginModule.load(pluginPath, error)) {
-            setupHostedController();
+        if (getHostedInstance()->load(pluginPath, error)) {
+            setupHostedController(nullptr, !hasComponentState);
             {
                 std::lock_guard<std::mutex> lock(hostedControllerMutex_);
                 currentPluginPath_ = pluginPath;
             }
+            publishDiscovery();
         }
     }
 
-    // Forward remaining state to hosted controller
+    // Forward the hosted component state to the hosted controller
     auto ctrl = getHostedController();
+    if (!ctrl)
+        return kResultOk;
+
+    tresult result = kResultOk;
+    if (saved.version == kStateVersion)
+        result = ctrl->setComponentState(state); // v1: the rest of the stream
+    else if (saved.componentState.present())
+        result = loadPayload(state, saved.componentState,
+                             [&ctrl](IBStream* hosted) { return ctrl->setComponentState(hosted); });
+    paramCache_.versions().markAllChanged();
+    return result;
+}
+
+tresult PLUGIN_API Controller::setState(IBStream* state) {
+    if (!state)
+        return kResultOk;
+
+    // Anything but a v2 stream is from a version that saved no controller state
+    WrapperState saved;
+    if (readWrapperState(state, saved) != kResultOk || !saved.controllerState.present())
+        return kResultOk;
+
+    std::lock_guard<std::mutex> lock(restoreMutex_);
+    if (pendingRestore_) {
+        // The plugin isn't loaded yet: apply this right after its component state
+        if (saved.pluginPath == pendingRestore_->pluginPath
+            && detachPayload(state, saved.controllerState) == kResultOk)
+            pendingRestore_->controllerState = std::move(saved.controllerState);
+        return kResultOk;
+    }
+    return applyControllerState(state, saved);
+}
+
+tresult Controller::applyControllerState(IBStream* state, const WrapperState& saved) {
+    // setComponentState() loaded the plugin; state saved for another one is stale
+    auto ctrl = getHostedController();
+    {
+        std::lock_guard<std::mutex> lock(hostedControllerMutex_);
+        if (!ctrl || saved.pluginPath != currentPluginPath_)
+            return kResultOk;
+    }
+
+    auto result = loadPayload(state, saved.controllerState, [&ctrl](IBStream* hosted) { return ctrl->setState(hosted); });
+    paramCache_.versions().markAllChanged();
+    return result;
+}
+
+bool Controller::deferRestore(IBStream* state, WrapperState& saved) {
+    // Caller must hold restoreMutex_
+    if (!mcpServer_ || !mcpServer_->dispatcher.isAlive())
+        return false;
+    saved.controllerState = StatePayload(); // Comes with setState()
+    if (detachWrapperState(state, saved) != kResultOk) {
+        WRAPPER_LOG_ERROR("setComponentState: could not copy the state of '%s', loading it now",
+                          saved.pluginPath.c_str());
+        return false;
+    }
+
+    // Usually already being opened for the processor
+    ModuleCache::shared().prefetch(saved.pluginPath);
+    pendingRestore_ = std::move(saved);
+    mcpServer_->dispatcher.dispatch([this]() { completeRestore(); });
+    return true;
+}
+
+bool Controller::completeRestore() {
+    std::lock_guard<std::mutex> lock(restoreMutex_);
+    if (!pendingRestore_)
+        return false;
+    WrapperState saved = std::move(*pendingRestore_);
+    pendingRestore_.reset();
+
+    applyComponentState(nullptr, saved);
+    if (saved.controllerState.present())
+        applyControllerState(nullptr, saved);
+    return true;
+}
+
+tresult PLUGIN_API Controller::getState(IBStream* state) {
+    if (!state)
+        return kResultFalse;
+    completeRestore();
+
+    WrapperState saved;
+    auto ctrl = getHostedController();
+    {
+        std::lock_guard<std::mutex> lock(hostedControllerMutex_);
+        saved.pluginPath = currentPluginPath_;
+    }
     if (ctrl) {
-        return ctrl->setComponentState(state);
+        tresult result = savePayload([&ctrl](IBStream* hosted) { return ctrl->getState(hosted); },
+                                     saved.controllerState);
+        if (result != kResultOk)
+            return result;
     }
 
-    return kResultOk;
+    return writeWrapperState(state, saved);
 }
 
 // --- IComponentHandler ---
@@ -283,7 +944,9 @@ tresult PLUGIN_API Controller::beginEdit(ParamID id) {
 
 tresult PLUGIN_API Controller::performEdit(ParamID id, ParamValue valueNormalized) {
     // Queue the change for the audio processor
-    HostedPluginModule::instance().pushParamChange(id, valueNormalized);
+    getHostedInstance()->pushParamChange(id, valueNormalized);
+    paramCache_.versions().markChanged(id);
+    paramNotifier_.publish(id, valueNormalized);
     return kResultOk;
 }
 
@@ -295,6 +958,14 @@ tresult PLUGIN_API Controller::endEdit(ParamID id) {
 }
 
 tresult PLUGIN_API Controller::restartComponent(int32 flags) {
+    getHostedInstance()->markStateChanged();
+
+    // Parameter list or titles may have changed — rebuild the cache on next use
+    if (flags & (kParamTitlesChanged | kReloadComponent))
+        paramCache_.invalidate();
+    else if (flags & kParamValuesChanged)
+        paramCache_.versions().markAllChanged();
+
     // The hosted plugin requests a restart. Forward to our host if available.
     if (componentHandler) {
         return componentHandler->restartComponent(flags);
@@ -309,43 +980,85 @@ tresult PLUGIN_API Controller::notify(IMessage* message) {
         return kResultFalse;
 
     if (strcmp(message->getMessageID(), MessageIds::kPluginLoaded) == 0) {
+        // A restore still waiting for the plugin connects to the component
+        // as it sets up the hosted controller
+        if (completeRestore())
+            return kResultOk;
         // Processor has finished loading — the hosted component is now available
-        // in the singleton. Connect IConnectionPoint and sync state so plugins
+        // in the shared instance. Connect IConnectionPoint and sync state so plugins
         // that rely on component↔controller messaging work correctly.
         connectHostedComponents();
         syncComponentState();
         return kResultOk;
     }
 
+    if (strcmp(message->getMessageID(), MessageIds::kPluginLoadFailed) == 0) {
+        // The hosted controller was set up for a plugin the processor couldn't
+        // load. Follow the processor: back to the plugin it kept playing, or
+        // to none.
+        WRAPPER_LOG_ERROR("Processor failed to load the plugin, reverting");
+        adoptProcessorPlugin();
+        return kResultOk;
+    }
+
+    if (strcmp(message->getMessageID(), MessageIds::kInstanceId) == 0) {
+        const void* data = nullptr;
+        uint32 size = 0;
+        if (message->getAttributes()->getBinary("id", data, size) == kResultOk && data && size > 0) {
+            std::string id(static_cast<const char*>(data), size);
+            if (!bindHostedInstance(id))
+                WRAPPER_LOG_ERROR("No registered instance %s", id.c_str());
+        }
+        return kResultOk;
+    }
+
     return EditController::notify(message);
 }
 
 // --- Dynamic plugin loading ---
 
-std::string Controller::loadPlugin(const std::string& path) {
+std::string Controller::loadPlugin(const std::string& path, PluginJob* job,
+                                   VST3::Hosting::Module::Ptr module) {
     WRAPPER_LOG("loadPlugin: %s", path.c_str());
 
+    // Swap point: past here the current plugin is gone, so a cancelled job
+    // has to stop now
+    if (job && !job->beginSwap())
+        return "Load cancelled";
+    {
+        std::lock_guard<std::mutex> lock(restoreMutex_);
+        pendingRestore_.reset(); // Superseded by this load
+    }
+
     teardownHostedController();
 
-    auto& pluginModule = HostedPluginModule::instance();
+    auto hosted = getHostedInstance();
+    auto& pluginModule = *hosted;
     std::string error;
-    if (!pluginModule.load(path, error)) {
+    bool opened = module ? pluginModule.load(path, std::move(module), error)
+                         : pluginModule.load(path, error);
+    if (!opened) {
         WRAPPER_LOG_ERROR("Failed to load module: %s", error.c_str());
         return error;
     }
 
-    if (!setupHostedController()) {
+    if (job)
+        job->enterPhase(PluginJobPhase::ComponentInit);
+    if (!setupHostedController(job)) {
         WRAPPER_LOG_ERROR("Failed to set up hosted controller");
         return "Failed to set up hosted controller";
     }
 
     // Tell the processor to load the same plugin
+    if (job)
+        job->enterPhase(PluginJobPhase::StateSync);
     sendLoadMessage(path);
 
     {
         std::lock_guard<std::mutex> lock(hostedControllerMutex_);
         currentPluginPath_ = path;
     }
+    publishDiscovery();
 
     // Switch the active view in-place (drop zone → hosted plugin GUI)
     auto ctrl = getHostedController();
@@ -364,8 +1077,42 @@ std::string Controller::loadPlugin(const std::string& path) {
     return {};
 }
 
+void Controller::adoptProcessorPlugin() {
+    teardownHostedController();
+
+    auto hosted = getHostedInstance();
+    bool loaded = hosted->isLoaded() && setupHostedController(nullptr, false);
+    if (loaded) {
+        // The component is already running, so connect even a single-component
+        // plugin now instead of waiting for kPluginLoaded
+        disconnectHostedComponents();
+        connectHostedComponents();
+        syncComponentState();
+        std::lock_guard<std::mutex> lock(hostedControllerMutex_);
+        currentPluginPath_ = hosted->getPluginPath();
+    }
+    publishDiscovery();
+
+    if (activeView_) {
+        auto ctrl = getHostedController();
+        auto* hostedPlugView = ctrl ? ctrl->createView("editor") : nullptr;
+        if (hostedPlugView)
+            activeView_->switchToHostedView(hostedPlugView);
+        else
+            activeView_->switchToDropZone();
+    }
+
+    if (componentHandler) {
+        componentHandler->restartComponent(kIoChanged);
+    }
+}
+
 void Controller::unloadPlugin() {
     WRAPPER_LOG("unloadPlugin called");
+    {
+        std::lock_guard<std::mutex> lock(restoreMutex_);
+        pendingRestore_.reset();
+    }
 
     teardownHostedController();
 
@@ -374,6 +1121,7 @@ void Controller::unloadPlugin() {
         msg->setMessageID(MessageIds::kUnloadPlugin);
         sendMessage(msg);
     }
+    publishDiscovery();
 
     // Switch the active view back to the drop zone
     if (activeView_) {
@@ -406,39 +1154,88 @@ void Controller::teardownHostedController() {
         hostedController_ = nullptr;
         currentPluginPath_.clear();
     }
+    paramCache_.invalidate();
+    paramNotifier_.clearPending();
+    paramHistory_.clear();
     if (ctrl) {
         ctrl->setComponentHandler(nullptr);
         ctrl->terminate();
     }
 }
 
-bool Controller::setupHostedController() {
-    auto& pluginModule = HostedPluginModule::instance();
+bool Controller::setupHostedController(PluginJob* job, bool syncState) {
+    auto hosted = getHostedInstance();
+    auto& pluginModule = *hosted;
     if (!pluginModule.isLoaded())
         return false;
 
-    // If the processor hasn't set the controller CID yet, find it ourselves
-    // by creating a temporary component and querying getControllerClassId.
-    // If that fails, the plugin may be a single-component plugin where the
-    // component itself implements IEditController (no separate controller class).
-    if (!pluginModule.hasControllerClassID()) {
-        auto factory = pluginModule.getFactory();
-        if (!factory)
+    // A warm controller from the pool skips initialize()
+    WarmController warm;
+    if (pluginModule.warmPool().takeController(pluginModule.getPluginPath(), warm)) {
+        if (job)
+            job->enterPhase(PluginJobPhase::ControllerSetup);
+    } else {
+        TUID cid;
+        bool hasCid = pluginModule.hasControllerClassID();
+        if (hasCid)
+            pluginModule.getControllerClassID(cid);
+        if (!createControllerInstance(pluginModule.getModule(), hasCid ? &cid : nullptr, warm, job))
             return false;
+    }
+    if (warm.hasControllerClassID)
+        pluginModule.setControllerClassID(warm.controllerClassID);
 
-        auto component = factory->createInstance<IComponent>(pluginModule.getEffectClassID());
+    warm.controller->setComponentHandler(this);
+    {
+        std::lock_guard<std::mutex> lock(hostedControllerMutex_);
+        hostedController_ = warm.controller;
+    }
+    paramCache_.invalidate();
+    paramNotifier_.clearPending();
+    paramHistory_.clear();
+
+    if (warm.singleComponent) {
+        WRAPPER_LOG("Single-component plugin detected");
+        // Don't call connectHostedComponents/syncComponentState here;
+        // the processor hasn't loaded its component yet (LoadPlugin message
+        // is sent after this returns).
+        return true;
+    }
+
+    connectHostedComponents();
+    if (syncState)
+        syncComponentState();
+
+    return true;
+}
+
+bool Controller::createControllerInstance(const VST3::Hosting::Module::Ptr& module, const TUID* controllerClassID,
+                                          WarmController& out, PluginJob* job) {
+    if (!module)
+        return false;
+    auto factory = module->getFactory();
+    out.module = module;
+
+    TUID cid;
+    if (controllerClassID) {
+        std::memcpy(cid, *controllerClassID, sizeof(TUID));
+    } else {
+        // If the processor hasn't found the controller CID yet, find it ourselves
+        // by creating a temporary component and querying getControllerClassId.
+        // If that fails, the plugin may be a single-component plugin where the
+        // component itself implements IEditController (no separate controller class).
+        auto classes = ModuleCache::shared().classes(module);
+        if (!classes->hasAudioEffect)
+            return false;
+
+        auto component = factory.createInstance<IComponent>(classes->audioEffectClassID);
         if (!component)
             return false;
 
         if (component->initialize(hostContext_) != kResultOk)
             return false;
 
-        TUID cid;
-        if (component->getControllerClassId(cid) == kResultOk) {
-            // Separate controller class — store the CID and fall through
-            pluginModule.setControllerClassID(cid);
-            component->terminate();
-        } else {
+        if (component->getControllerClassId(cid) != kResultOk) {
             // Single-component plugin: the component itself is the controller.
             // We create our own instance for the controller side; the processor
             // will independently create its own instance for audio processing.
@@ -449,48 +1246,28 @@ bool Controller::setupHostedController() {
                 component->terminate();
                 return false;
             }
-            WRAPPER_LOG("Single-component plugin detected");
-            singleCtrl->setComponentHandler(this);
-            {
-                std::lock_guard<std::mutex> lock(hostedControllerMutex_);
-                hostedController_ = IPtr<IEditController>(singleCtrl);
-            }
             // Don't terminate — component is now our controller.
-            // Don't call connectHostedComponents/syncComponentState here;
-            // the processor hasn't loaded its component yet (LoadPlugin message
-            // is sent after this returns).
+            out.controller = IPtr<IEditController>(singleCtrl);
+            out.singleComponent = true;
             return true;
         }
+        // Separate controller class — fall through
+        component->terminate();
     }
+    out.hasControllerClassID = true;
+    std::memcpy(out.controllerClassID, cid, sizeof(TUID));
 
-    if (!pluginModule.hasControllerClassID())
-        return false;
-
-    TUID cid;
-    pluginModule.getControllerClassID(cid);
-    VST3::UID controllerUID = VST3::UID::fromTUID(cid);
+    if (job)
+        job->enterPhase(PluginJobPhase::ControllerSetup);
 
-    auto factory = pluginModule.getFactory();
-    if (!factory)
-        return false;
-
-    auto ctrl = factory->createInstance<IEditController>(controllerUID);
+    auto ctrl = factory.createInstance<IEditController>(VST3::UID::fromTUID(cid));
     if (!ctrl)
         return false;
 
     if (ctrl->initialize(hostContext_) != kResultOk)
         return false;
 
-    ctrl->setComponentHandler(this);
-
-    {
-        std::lock_guard<std::mutex> lock(hostedControllerMutex_);
-        hostedController_ = ctrl;
-    }
-
-    connectHostedComponents();
-    syncComponentState();
-
+    out.controller = ctrl;
     return true;
 }
 
@@ -503,7 +1280,8 @@ void Controller::sendLoadMessage(const std::string& path) {
 }
 
 void Controller::connectHostedComponents() {
-    auto hostedComponent = HostedPluginModule::instance().getHostedComponent();
+    auto hosted = getHostedInstance();
+    auto hostedComponent = hosted->getHostedComponent();
     auto ctrl = getHostedController();
     if (!hostedComponent || !ctrl)
         return;
@@ -513,8 +1291,8 @@ void Controller::connectHostedComponents() {
     if (!compICP || !contrICP)
         return;
 
-    componentCP_ = owned(new ConnectionProxy(compICP));
-    controllerCP_ = owned(new ConnectionProxy(contrICP));
+    componentCP_ = owned<ConnectionProxy>(new StateTrackingConnectionProxy(compICP, hosted));
+    controllerCP_ = owned<ConnectionProxy>(new StateTrackingConnectionProxy(contrICP, hosted));
 
     componentCP_->connect(contrICP);
     controllerCP_->connect(compICP);
@@ -532,16 +1310,18 @@ void Controller::disconnectHostedComponents() {
 }
 
 void Controller::syncComponentState() {
-    auto hostedComponent = HostedPluginModule::instance().getHostedComponent();
+    auto hostedComponent = getHostedInstance()->getHostedComponent();
     auto ctrl = getHostedController();
     if (!hostedComponent || !ctrl)
         return;
 
-    // Get the processor's state and send it to the controller
-    ResizableMemoryIBStream stream;
-    if (hostedComponent->getState(&stream) == kResultOk) {
-        stream.rewind();
+    // Get the processor's state and send it to the controller; the captured
+    // buffer is read in place
+    CaptureStream capture;
+    if (hostedComponent->getState(&capture) == kResultOk) {
+        BufferStream stream(capture.take());
         ctrl->setComponentState(&stream);
+        paramCache_.versions().markAllChanged();
     }
 }
 
@@ -549,6 +1329,11 @@ void Controller::startMCPServer() {
     try {
         mcpServer_ = std::make_unique<MCPServer>();
         mcpServer_->start(this);
+        std::string id = getInstanceId();
+        if (!id.empty()) {
+            SessionServer::shared().attach(id, mcpServer_->tools);
+            publishDiscovery();
+        }
     } catch (const std::exception& e) {
         WRAPPER_LOG_ERROR("Failed to start MCP server: %s", e.what());
         mcpServer_.reset();
@@ -560,6 +1345,15 @@ void Controller::startMCPServer() {
 
 void Controller::stopMCPServer() {
     if (mcpServer_) {
+        std::string id;
+        {
+            std::lock_guard<std::mutex> lock(hostedInstanceMutex_);
+            id = instanceId_;
+        }
+        if (!id.empty()) {
+            SessionServer::shared().detach(id, mcpServer_->tools.get());
+            InstanceDiscovery::shared().withdraw(id);
+        }
         mcpServer_->stop();
         mcpServer_.reset();
     }
@@ -1,10 +1,19 @@
 #pragma once
 
+#include "instancepool.h"
+#include "paramcache.h"
+#include "paramhistory.h"
+#include "paramnotify.h"
+#include "pluginjobs.h"
+#include "stateformat.h"
+
+#include "public.sdk/source/vst/hosting/module.h"
 #include "public.sdk/source/vst/vsteditcontroller.h"
 #include "pluginterfaces/vst/ivstmessage.h"
 
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 
 namespace Steinberg {
@@ -15,6 +24,8 @@ class ConnectionProxy;
 
 namespace VST3MCPWrapper {
 
+class HostedPluginInstance;
+
 class Controller : public Steinberg::Vst::EditController,
                    public Steinberg::Vst::IComponentHandler {
 public:
@@ -30,6 +41,9 @@ public:
     Steinberg::tresult PLUGIN_API terminate() override;
     Steinberg::IPlugView* PLUGIN_API createView(Steinberg::FIDString name) override;
     Steinberg::tresult PLUGIN_API setComponentState(Steinberg::IBStream* state) override;
+    // Hosted controller state (e.g. GUI settings), in a v2 container
+    Steinberg::tresult PLUGIN_API setState(Steinberg::IBStream* state) override;
+    Steinberg::tresult PLUGIN_API getState(Steinberg::IBStream* state) override;
 
     // IComponentHandler — receives parameter changes from the hosted plugin's GUI
     Steinberg::tresult PLUGIN_API beginEdit(Steinberg::Vst::ParamID id) override;
@@ -48,9 +62,32 @@ public:
     // Thread-safe access to hosted controller (used by MCP handlers)
     Steinberg::IPtr<Steinberg::Vst::IEditController> getHostedController() const;
 
+    // State shared with this wrapper's processor. A private instance until
+    // the processor's kInstanceId message (or, failing that, the instance ID
+    // in the component state) binds the processor's registered one.
+    // Never null; thread-safe.
+    std::shared_ptr<HostedPluginInstance> getHostedInstance() const;
+
+    // The processor's instance ID once bound, else empty. Thread-safe.
+    std::string getInstanceId() const;
+
+    // Metadata cache for the hosted controller's parameters (used by MCP handlers)
+    ParameterInfoCache& getParameterCache() { return paramCache_; }
+
+    // Push notifications for hosted GUI/automation edits (used by MCP handlers)
+    ParamChangeNotifier& getParamNotifier() { return paramNotifier_; }
+
+    // Undo history of MCP parameter edits, cleared when the plugin changes
+    // (used by MCP handlers)
+    ParamHistory& getParamHistory() { return paramHistory_; }
+
     // Dynamic plugin loading — called from drop zone view and MCP tools
     // Returns empty string on success, error message on failure.
-    std::string loadPlugin(const std::string& path);
+    // job (MCP load jobs) receives phase updates and is checked for
+    // cancellation before the current plugin is torn down; module, if set,
+    // is the bundle already opened off the main thread.
+    std::string loadPlugin(const std::string& path, PluginJob* job = nullptr,
+                           VST3::Hosting::Module::Ptr module = nullptr);
     void unloadPlugin();
     bool isPluginLoaded() const;
     std::string getCurrentPluginPath() const;
@@ -67,8 +104,46 @@ private:
     void syncComponentState();
 
     void teardownHostedController();
-    bool setupHostedController();
+    // Set up the hosted controller for whatever the processor has in the
+    // shared instance (kPluginLoadFailed), or none
+    void adoptProcessorPlugin();
+    // syncState: push the hosted component's current state to the new
+    // controller (skipped when the caller is about to set one itself)
+    bool setupHostedController(PluginJob* job = nullptr, bool syncState = true);
+    // Create and initialize the edit controller for module's effect class.
+    // Without controllerClassID, a temporary component is created to find
+    // it; single-component plugins get that component as their controller.
+    // Also the factory for warm controllers.
+    bool createControllerInstance(const VST3::Hosting::Module::Ptr& module, const Steinberg::TUID* controllerClassID,
+                                  WarmController& out, PluginJob* job = nullptr);
     void sendLoadMessage(const std::string& path);
+    // Share the processor's instance registered under id. Returns false if
+    // there is none.
+    bool bindHostedInstance(const std::string& id);
+    // Make this controller the controller factory of hosted's warm pool
+    void registerWarmControllerFactory(HostedPluginInstance& hosted);
+    // Write this instance's entry to the discovery file (once bound and
+    // while the MCP server runs).
+    void publishDiscovery();
+
+    // Session restore, like the processor's: setComponentState() for another
+    // plugin starts opening its module in the background and keeps the state
+    // in pendingRestore_ (setState() adds the controller state) instead of
+    // creating the hosted controller during the host's call. completeRestore()
+    // runs on the dispatcher once it gets to it, or earlier on the host
+    // thread when the hosted controller is needed: createView(), getState()
+    // and the processor's kPluginLoaded.
+    //
+    // Caller must hold restoreMutex_. Returns false if the state can't be
+    // kept (no dispatcher, or its hosted state couldn't be copied).
+    bool deferRestore(Steinberg::IBStream* state, WrapperState& saved);
+    // Returns whether there was a pending restore.
+    bool completeRestore();
+    // Load saved's plugin unless it is the current one and hand it the
+    // component or controller state. state is the stream saved was read
+    // from, or null for a state kept by deferRestore().
+    Steinberg::tresult applyComponentState(Steinberg::IBStream* state, const WrapperState& saved);
+    Steinberg::tresult applyControllerState(Steinberg::IBStream* state, const WrapperState& saved);
 
     Steinberg::FUnknown* hostContext_ = nullptr;
     std::string currentPluginPath_;
@@ -81,11 +156,25 @@ private:
     friend class WrapperPlugView;
     friend class ControllerTestAccess;
 
+    mutable std::mutex hostedInstanceMutex_;
+    std::shared_ptr<HostedPluginInstance> hostedInstance_;
+    bool hostedInstanceBound_ = false; // Whether hostedInstance_ is the processor's
+    std::string instanceId_;            // The processor's ID once bound; routes session calls here
+    bool sessionServerStarted_ = false;
+
     mutable std::mutex hostedControllerMutex_;
     Steinberg::IPtr<Steinberg::Vst::IEditController> hostedController_;
+    ParameterInfoCache paramCache_;
+    ParamChangeNotifier paramNotifier_;
+    ParamHistory paramHistory_;
 
     Steinberg::IPtr<Steinberg::Vst::ConnectionProxy> componentCP_;
     Steinberg::IPtr<Steinberg::Vst::ConnectionProxy> controllerCP_;
+
+    // Guards pendingRestore_ and keeps the host thread and the dispatcher
+    // from applying restored state at the same time
+    std::mutex restoreMutex_;
+    std::optional<WrapperState> pendingRestore_;
 };
 
 } // namespace VST3MCPWrapper
@@ -0,0 +1,109 @@
+#include "crossfade.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace VST3MCPWrapper {
+
+void crossfadeGains(double t, double& outgoing, double& incoming) {
+    t = std::clamp(t, 0.0, 1.0);
+    constexpr double kHalfPi = 1.57079632679489661923;
+    outgoing = std::cos(t * kHalfPi);
+    incoming = std::sin(t * kHalfPi);
+}
+
+void Crossfade::prepare(int32 maxChannels, int32 maxSamples, int32 symbolicSampleSize, int32 lengthSamples) {
+    maxChannels_ = std::max<int32>(maxChannels, 0);
+    maxSamples_ = std::max<int32>(maxSamples, 0);
+    sampleSize_ = symbolicSampleSize;
+    length_ = std::max<int32>(lengthSamples, 1);
+    position_ = 0;
+
+    size_t samples = static_cast<size_t>(maxSamples_);
+    storage_.assign(2 * static_cast<size_t>(maxChannels_) * samples, 0.0);
+    input32_.assign(maxChannels_, nullptr);
+    output32_.assign(maxChannels_, nullptr);
+    input64_.assign(maxChannels_, nullptr);
+    output64_.assign(maxChannels_, nullptr);
+    for (int32 ch = 0; ch < maxChannels_; ++ch) {
+        double* in = storage_.data() + static_cast<size_t>(ch) * samples;
+        double* out = storage_.data() + static_cast<size_t>(maxChannels_ + ch) * samples;
+        input32_[ch] = reinterpret_cast<Sample32*>(in);
+        output32_[ch] = reinterpret_cast<Sample32*>(out);
+        input64_[ch] = in;
+        output64_[ch] = out;
+    }
+}
+
+bool Crossfade::fits(const ProcessData& data) const {
+    if (data.numOutputs < 1 || !data.outputs)
+        return false;
+    if (data.symbolicSampleSize != sampleSize_ || data.numSamples > maxSamples_ || data.numSamples < 0)
+        return false;
+    if (data.outputs[0].numChannels > maxChannels_)
+        return false;
+    return data.numInputs < 1 || !data.inputs || data.inputs[0].numChannels <= maxChannels_;
+}
+
+ProcessData Crossfade::incomingData(const ProcessData& data) {
+    ProcessData incoming = data;
+    incoming.inputParameterChanges = &noParamChanges_;
+    bool is64bit = sampleSize_ == kSample64;
+    size_t bytes = static_cast<size_t>(data.numSamples) * (is64bit ? sizeof(Sample64) : sizeof(Sample32));
+
+    if (data.numInputs > 0 && data.inputs) {
+        const auto& source = data.inputs[0];
+        inputBus_.numChannels = source.numChannels;
+        inputBus_.silenceFlags = source.silenceFlags;
+        for (int32 ch = 0; ch < source.numChannels; ++ch) {
+            if (is64bit)
+                std::memcpy(input64_[ch], source.channelBuffers64[ch], bytes);
+            else
+                std::memcpy(input32_[ch], source.channelBuffers32[ch], bytes);
+        }
+        if (is64bit)
+            inputBus_.channelBuffers64 = input64_.data();
+        else
+            inputBus_.channelBuffers32 = input32_.data();
+        incoming.inputs = &inputBus_;
+        incoming.numInputs = 1;
+    }
+
+    outputBus_.numChannels = data.outputs[0].numChannels;
+    outputBus_.silenceFlags = 0;
+    if (is64bit)
+        outputBus_.channelBuffers64 = output64_.data();
+    else
+        outputBus_.channelBuffers32 = output32_.data();
+    incoming.outputs = &outputBus_;
+    incoming.numOutputs = 1;
+    return incoming;
+}
+
+template <typename Sample>
+void Crossfade::mixBlock(Sample** outgoing, Sample** incoming, int32 channels, int32 samples) {
+    for (int32 i = 0; i < samples; ++i) {
+        double gainOut, gainIn;
+        crossfadeGains((static_cast<double>(position_ + i) + 0.5) / length_, gainOut, gainIn);
+        for (int32 ch = 0; ch < channels; ++ch) {
+            outgoing[ch][i] = static_cast<Sample>(outgoing[ch][i] * gainOut + incoming[ch][i] * gainIn);
+        }
+    }
+}
+
+bool Crossfade::mix(ProcessData& data) {
+    auto& out = data.outputs[0];
+    if (sampleSize_ == kSample64)
+        mixBlock(out.channelBuffers64, output64_.data(), out.numChannels, data.numSamples);
+    else
+        mixBlock(out.channelBuffers32, output32_.data(), out.numChannels, data.numSamples);
+    out.silenceFlags = 0;
+    position_ += data.numSamples;
+    return position_ >= length_;
+}
+
+} // namespace VST3MCPWrapper
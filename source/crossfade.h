@@ -0,0 +1,73 @@
+#pragma once
+
+#include "paramchanges.h"
+#include "pluginterfaces/vst/ivstaudioprocessor.h"
+
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// Equal-power gains at crossfade progress t in [0, 1]: outgoing = cos(t·π/2),
+// incoming = sin(t·π/2), so outgoing² + incoming² = 1 throughout.
+void crossfadeGains(double t, double& outgoing, double& incoming);
+
+// Scratch buffers and gain curve for crossfading from one hosted processor
+// to another inside process().
+//
+// Per block, the outgoing processor renders into the host's output buffers
+// as usual and the incoming one into this object's scratch output, both fed
+// the same input (copied first, since the host may process in place). mix()
+// then blends the two into the host buffers.
+//
+// Only bus 0 is faded: the wrapper exposes one audio input and one audio
+// output bus, and activates only bus 0 of every hosted plugin (see
+// Processor::createHostedInstance), so process() never gets more.
+//
+// prepare() allocates and must run off the audio thread; everything else is
+// allocation-free. Not thread-safe — prepared by the processor before it
+// publishes a swap, then used by the audio thread only.
+class Crossfade {
+public:
+    // Size for blocks of up to maxSamples with up to maxChannels per bus in
+    // the given symbolic sample size, fading over lengthSamples (at least 1).
+    void prepare(Steinberg::int32 maxChannels, Steinberg::int32 maxSamples,
+                 Steinberg::int32 symbolicSampleSize, Steinberg::int32 lengthSamples);
+
+    // Whether data's block fits the prepared buffers. If not, the caller
+    // should switch to the incoming processor without a fade.
+    bool fits(const Steinberg::Vst::ProcessData& data) const;
+
+    void start() { position_ = 0; }
+    Steinberg::int32 length() const { return length_; }
+    Steinberg::int32 position() const { return position_; }
+
+    // Copy of data's inputs as ProcessData for the incoming processor: same
+    // events and context, first audio input copied to scratch, first audio
+    // output redirected to scratch. Parameter changes are left out: their
+    // IDs are the outgoing plugin's. Requires fits(data).
+    Steinberg::Vst::ProcessData incomingData(const Steinberg::Vst::ProcessData& data);
+
+    // Blend the incoming processor's scratch output into data's first audio
+    // output and advance. Returns true once the fade is complete.
+    bool mix(Steinberg::Vst::ProcessData& data);
+
+private:
+    template <typename Sample>
+    void mixBlock(Sample** outgoing, Sample** incoming, Steinberg::int32 channels, Steinberg::int32 samples);
+
+    Steinberg::int32 maxChannels_ = 0;
+    Steinberg::int32 maxSamples_ = 0;
+    Steinberg::int32 sampleSize_ = Steinberg::Vst::kSample32;
+    Steinberg::int32 length_ = 1;
+    Steinberg::int32 position_ = 0;
+
+    // One double per sample holds either sample size
+    std::vector<double> storage_;
+    std::vector<Steinberg::Vst::Sample32*> input32_, output32_;
+    std::vector<Steinberg::Vst::Sample64*> input64_, output64_;
+    Steinberg::Vst::AudioBusBuffers inputBus_{};
+    Steinberg::Vst::AudioBusBuffers outputBus_{};
+    PreallocatedParameterChanges noParamChanges_; // Never allocated, so always empty
+};
+
+} // namespace VST3MCPWrapper
@@ -11,7 +11,7 @@ DEF_CLASS2(INLINE_UID_FROM_FUID(VST3MCPWrapper::kProcessorUID),
     PClassInfo::kManyInstances,
     kVstAudioEffectClass,
     stringPluginName,
-    0, // Not distributable — processor and controller share state via singleton
+    0, // Not distributable — processor and controller share state via InstanceRegistry
     Steinberg::Vst::PlugType::kFx,
     FULL_VERSION_STR,
     kVstVersionString,
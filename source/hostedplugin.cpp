@@ -1,5 +1,6 @@
 #include "hostedplugin.h"
 #include "logging.h"
+#include "modulecache.h"
 
 #include "pluginterfaces/vst/ivstaudioprocessor.h"
 
@@ -10,28 +11,24 @@ using namespace Steinberg::Vst;
 
 namespace VST3MCPWrapper {
 
-HostedPluginModule& HostedPluginModule::instance() {
-    static HostedPluginModule inst;
-    return inst;
-}
-
-void HostedPluginModule::resetState() {
+void HostedPluginInstance::resetState() {
     // Caller must hold mutex_
     hostedComponent_ = nullptr;
+    restoredComponentState_.reset();
     hasControllerCID_ = false;
     std::memset(controllerCID_, 0, sizeof(TUID));
     effectClassID_ = {};
     module_.reset();
     loaded_ = false;
     pluginPath_.clear();
-    {
-        std::lock_guard<std::mutex> plock(paramChangeMutex_);
-        pendingParamChanges_.clear();
-        paramQueueOverflowWarned_ = false;
-    }
+    paramQueue_.clear();
+    coalescedParams_.clear();
+    rampQueue_.clear();
+    paramQueueOverflowWarned_.store(false, std::memory_order_relaxed);
+    markStateChanged();
 }
 
-bool HostedPluginModule::load(const std::string& path, std::string& error) {
+bool HostedPluginInstance::load(const std::string& path, std::string& error) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (loaded_ && pluginPath_ == path)
@@ -40,98 +37,203 @@ bool HostedPluginModule::load(const std::string& path, std::string& error) {
     if (loaded_)
         resetState();
 
-    module_ = VST3::Hosting::Module::create(path, error);
-    if (!module_)
+    auto module = ModuleCache::shared().acquire(path, error);
+    if (!module)
         return false;
+    return adoptModule(path, std::move(module), error);
+}
 
-    auto factory = module_->getFactory();
-    for (auto& classInfo : factory.classInfos()) {
-        if (classInfo.category() == kVstAudioEffectClass) {
-            effectClassID_ = classInfo.ID();
-            pluginPath_ = path;
-            loaded_ = true;
-            return true;
-        }
+bool HostedPluginInstance::load(const std::string& path, VST3::Hosting::Module::Ptr module, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (loaded_ && pluginPath_ == path)
+        return true;
+
+    if (loaded_)
+        resetState();
+
+    if (!module) {
+        error = "Module is not open";
+        return false;
+    }
+    return adoptModule(path, std::move(module), error);
+}
+
+bool HostedPluginInstance::adoptModule(const std::string& path, VST3::Hosting::Module::Ptr module, std::string& error) {
+    // Caller must hold mutex_
+    module_ = std::move(module);
+    auto classes = ModuleCache::shared().classes(module_);
+    if (classes->hasAudioEffect) {
+        effectClassID_ = classes->audioEffectClassID;
+        pluginPath_ = path;
+        loaded_ = true;
+        return true;
     }
 
     error = "No audio effect class found in plugin";
     module_.reset();
+    ModuleCache::shared().evict(path);
     return false;
 }
 
-void HostedPluginModule::unload() {
+void HostedPluginInstance::unload() {
     std::lock_guard<std::mutex> lock(mutex_);
     resetState();
 }
 
-bool HostedPluginModule::isLoaded() const {
+bool HostedPluginInstance::isLoaded() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return loaded_;
 }
 
-std::optional<VST3::Hosting::PluginFactory> HostedPluginModule::getFactory() const {
+std::optional<VST3::Hosting::PluginFactory> HostedPluginInstance::getFactory() const {
     std::lock_guard<std::mutex> lock(mutex_);
     if (!module_)
         return std::nullopt;
     return module_->getFactory();
 }
 
-std::string HostedPluginModule::getPluginPath() const {
+std::string HostedPluginInstance::getPluginPath() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return pluginPath_;
 }
 
-VST3::UID HostedPluginModule::getEffectClassID() const {
+VST3::Hosting::Module::Ptr HostedPluginInstance::getModule() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return module_;
+}
+
+VST3::UID HostedPluginInstance::getEffectClassID() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return effectClassID_;
 }
 
-bool HostedPluginModule::hasControllerClassID() const {
+bool HostedPluginInstance::hasControllerClassID() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return hasControllerCID_;
 }
 
-void HostedPluginModule::getControllerClassID(TUID dest) const {
+void HostedPluginInstance::getControllerClassID(TUID dest) const {
     std::lock_guard<std::mutex> lock(mutex_);
     std::memcpy(dest, controllerCID_, sizeof(TUID));
 }
 
-void HostedPluginModule::setControllerClassID(const TUID& cid) {
+void HostedPluginInstance::setControllerClassID(const TUID& cid) {
     std::lock_guard<std::mutex> lock(mutex_);
     std::memcpy(controllerCID_, cid, sizeof(TUID));
     hasControllerCID_ = true;
 }
 
-void HostedPluginModule::setHostedComponent(IPtr<IComponent> component) {
+void HostedPluginInstance::setHostedComponent(IPtr<IComponent> component) {
     std::lock_guard<std::mutex> lock(mutex_);
     hostedComponent_ = component;
+    markStateChanged();
 }
 
-IPtr<IComponent> HostedPluginModule::getHostedComponent() const {
+IPtr<IComponent> HostedPluginInstance::getHostedComponent() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return hostedComponent_;
 }
 
-void HostedPluginModule::pushParamChange(ParamID id, ParamValue value) {
-    std::lock_guard<std::mutex> lock(paramChangeMutex_);
-    if (pendingParamChanges_.size() >= kMaxParamQueueSize) {
-        if (!paramQueueOverflowWarned_) {
-            WRAPPER_LOG_ERROR("parameter change queue full (%zu), dropping changes",
-                              kMaxParamQueueSize);
-            paramQueueOverflowWarned_ = true;
-        }
-        return;
+void HostedPluginInstance::setRestoredComponentState(StateBuffer state) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    restoredComponentState_ = std::move(state);
+}
+
+StateBuffer HostedPluginInstance::takeRestoredComponentState() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::move(restoredComponentState_);
+}
+
+void HostedPluginInstance::markStateChanged() {
+    stateGeneration_.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t HostedPluginInstance::getStateGeneration() const {
+    return stateGeneration_.load(std::memory_order_acquire);
+}
+
+void HostedPluginInstance::setHostedEditorOpen(bool open) {
+    hostedEditorOpen_.store(open, std::memory_order_relaxed);
+}
+
+bool HostedPluginInstance::isHostedEditorOpen() const {
+    return hostedEditorOpen_.load(std::memory_order_relaxed);
+}
+
+void HostedPluginInstance::setTransportPlaying(bool playing) {
+    transportPlaying_.store(playing, std::memory_order_relaxed);
+}
+
+bool HostedPluginInstance::isTransportPlaying() const {
+    return transportPlaying_.load(std::memory_order_relaxed);
+}
+
+size_t HostedPluginInstance::pushParamChanges(const ParamChange* changes, size_t count) {
+    size_t accepted = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (pushParamChange(changes[i]))
+            ++accepted;
     }
-    pendingParamChanges_.push_back({id, value});
+    return accepted;
+}
+
+void HostedPluginInstance::setParamQueueMode(ParamQueueMode mode) {
+    paramQueueMode_.store(mode, std::memory_order_relaxed);
+    markStateChanged();
+}
+
+HostedPluginInstance::ParamQueueMode HostedPluginInstance::getParamQueueMode() const {
+    return paramQueueMode_.load(std::memory_order_relaxed);
 }
 
-void HostedPluginModule::drainParamChanges(std::vector<ParamChange>& dest) {
-    // Use try_to_lock so the audio thread never blocks waiting for MCP/GUI producers
-    std::unique_lock<std::mutex> lock(paramChangeMutex_, std::try_to_lock);
-    if (lock.owns_lock()) {
-        dest.swap(pendingParamChanges_);
+bool HostedPluginInstance::pushParamChange(ParamID id, ParamValue value) {
+    return pushParamChange(ParamChange{id, value});
+}
+
+bool HostedPluginInstance::pushParamChange(const ParamChange& change) {
+    markStateChanged();
+    if (change.timing == ParamChangeTiming::Immediate
+        && paramQueueMode_.load(std::memory_order_relaxed) == ParamQueueMode::Coalesce
+        && coalescedParams_.store(change.id, change.value))
+        return true;
+
+    if (paramQueue_.tryPush(change))
+        return true;
+
+    droppedParamChanges_.fetch_add(1, std::memory_order_relaxed);
+    if (!paramQueueOverflowWarned_.exchange(true, std::memory_order_relaxed)) {
+        WRAPPER_LOG_ERROR("parameter change queue full (%zu), dropping changes",
+                          kParamQueueCapacity);
     }
-    // If lock not acquired, changes arrive next buffer (~1-5ms later)
+    return false;
+}
+
+void HostedPluginInstance::drainParamChanges(std::vector<ParamChange>& dest) {
+    // Lock-free: the audio thread never waits on MCP/GUI producers. Bounded by
+    // the capacity so a producer pushing continuously can't stall the drain.
+    ParamChange change;
+    for (size_t i = 0; i < kParamQueueCapacity && paramQueue_.tryPop(change); ++i)
+        dest.push_back(change);
+
+    // Coalesced changes after FIFO ones: if a parameter went through both
+    // (table saturated, or a mode switch), its latest value is the one here.
+    coalescedParams_.drain(kCoalescingSlots, [&dest](ParamID id, ParamValue value) {
+        dest.push_back({id, value});
+    });
+}
+
+bool HostedPluginInstance::pushParamRamp(const ParamRamp& ramp) {
+    markStateChanged();
+    return rampQueue_.tryPush(ramp);
+}
+
+bool HostedPluginInstance::popParamRamp(ParamRamp& ramp) {
+    return rampQueue_.tryPop(ramp);
+}
+
+uint64_t HostedPluginInstance::getDroppedParamChangeCount() const {
+    return droppedParamChanges_.load(std::memory_order_relaxed);
 }
 
 std::string utf16ToUtf8(const TChar* str, int maxLen) {
@@ -1,8 +1,15 @@
 #pragma once
 
+#include "instancepool.h"
+#include "paramqueue.h"
+#include "paramramp.h"
+#include "statestream.h"
+
 #include "public.sdk/source/vst/hosting/module.h"
 #include "pluginterfaces/vst/ivstcomponent.h"
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -10,21 +17,43 @@
 
 namespace VST3MCPWrapper {
 
+// When a queued parameter change should reach the hosted plugin.
+enum class ParamChangeTiming : uint8_t {
+    Immediate,     // Start of the next audio block
+    ProjectSample, // time = project sample position (ProcessContext::projectTimeSamples)
+    SteadyClock,   // time = std::chrono::steady_clock nanoseconds since its epoch
+};
+
 struct ParamChange {
     Steinberg::Vst::ParamID id;
     Steinberg::Vst::ParamValue value;
+    ParamChangeTiming timing = ParamChangeTiming::Immediate;
+    Steinberg::int64 time = 0;
 };
 
-// Holds the hosted plugin's module + factory, shared between processor and controller.
+// One wrapper instance's hosted plugin state: module + factory, hosted
+// component handle and parameter queues, shared between that instance's
+// processor and controller. The processor creates it and registers it in
+// the InstanceRegistry; the controller looks it up by instance ID (see
+// instanceregistry.h) and both keep a reference, so the audio and MCP paths
+// never go through a process-wide object.
 // The processor owns the IComponent/IAudioProcessor.
 // The controller creates its own IEditController from the same factory.
 //
 // All public methods are thread-safe.
-class HostedPluginModule {
+class HostedPluginInstance {
 public:
-    static HostedPluginModule& instance();
+    HostedPluginInstance() = default;
+    HostedPluginInstance(const HostedPluginInstance&) = delete;
+    HostedPluginInstance& operator=(const HostedPluginInstance&) = delete;
 
+    // Opens the module through ModuleCache::shared(), so switching back to a
+    // recently used plugin doesn't load its binary again.
     bool load(const std::string& path, std::string& error);
+
+    // Same as load() with a module the caller already opened, so the slow
+    // part (loading the binary) can happen off the thread that swaps plugins.
+    bool load(const std::string& path, VST3::Hosting::Module::Ptr module, std::string& error);
     void unload();
     bool isLoaded() const;
 
@@ -34,6 +63,10 @@ public:
 
     std::string getPluginPath() const;
 
+    // The open module. Instances created from it hold a reference so the
+    // binary stays loaded until they are gone, even after load() replaced it.
+    VST3::Hosting::Module::Ptr getModule() const;
+
     VST3::UID getEffectClassID() const;
 
     bool hasControllerClassID() const;
@@ -46,15 +79,87 @@ public:
     void setHostedComponent(Steinberg::IPtr<Steinberg::Vst::IComponent> component);
     Steinberg::IPtr<Steinberg::Vst::IComponent> getHostedComponent() const;
 
-    // Thread-safe parameter change queue.
+    // Component state the processor just restored from a DAW stream. The
+    // controller's setComponentState() receives the same stream and takes it
+    // from here instead of decompressing the section again. Held until taken,
+    // replaced or the plugin is unloaded.
+    void setRestoredComponentState(StateBuffer state);
+    StateBuffer takeRestoredComponentState();
+
+    // State generation: bumped whenever the hosted plugin's state may have
+    // changed (parameter changes queued or applied, component/controller
+    // message traffic, a plugin loaded or unloaded). The processor caches its
+    // getState() output per generation. Lock-free; safe on the audio thread.
+    void markStateChanged();
+    uint64_t getStateGeneration() const;
+
+    // Whether the hosted plugin's editor is open. Editors can change state
+    // without a parameter edit or message we would see, so the state cache
+    // is bypassed while one is open.
+    void setHostedEditorOpen(bool open);
+    bool isHostedEditorOpen() const;
+
+    // Whether the host's transport was playing in the last processed block.
+    // Changes scheduled at a project sample are applied right away while it
+    // is stopped. Lock-free; set by the audio thread.
+    void setTransportPlaying(bool playing);
+    bool isTransportPlaying() const;
+
+    // Lock-free parameter change queue (bounded MPMC ring).
     // Writers (MCP thread, GUI thread) push changes.
-    // Audio thread drains them in process().
-    void pushParamChange(Steinberg::Vst::ParamID id, Steinberg::Vst::ParamValue value);
+    // Audio thread drains them in process() without locking.
+    //
+    // Overflow policy: once kParamQueueCapacity changes are pending, new
+    // changes are dropped (pushParamChange returns false), counted, and an
+    // error is logged once per episode. Queued changes are never overwritten.
+    //
+    // In Coalesce mode (the default) changes go through a last-value-wins
+    // table keyed by ParamID instead, so a drain yields at most one change per
+    // parameter no matter how often it was set since the last block. The FIFO
+    // ring is only used if the table has no free slot for the parameter, or
+    // while a reset of the table (on load/unload) waits for a drain to finish.
+    enum class ParamQueueMode { Fifo, Coalesce };
+    void setParamQueueMode(ParamQueueMode mode);
+    ParamQueueMode getParamQueueMode() const;
+
+    bool pushParamChange(Steinberg::Vst::ParamID id, Steinberg::Vst::ParamValue value);
+
+    // Queue a batch of changes in one pass (same per-change routing as
+    // above). Returns the number accepted; the rest were dropped on overflow.
+    size_t pushParamChanges(const ParamChange* changes, size_t count);
+
+    // Queue a change that may carry a target time. Timed changes always use
+    // the FIFO ring (coalescing would lose their timestamps); the processor
+    // places them at the matching sample offset once their block comes up.
+    bool pushParamChange(const ParamChange& change);
+
+    // Appends all pending changes to dest: FIFO entries first, then coalesced
+    // ones in the order their parameters were first set. Never allocates as
+    // long as dest has kMaxParamDrainSize spare capacity.
     void drainParamChanges(std::vector<ParamChange>& dest);
 
+    // Ramp requests for the audio thread's ParamRampEngine. Lock-free; the
+    // processor pops them at the start of each block. pushParamRamp returns
+    // false if kRampQueueCapacity requests are already pending.
+    bool pushParamRamp(const ParamRamp& ramp);
+    bool popParamRamp(ParamRamp& ramp);
+
+    // Total number of changes dropped because the queue was full.
+    uint64_t getDroppedParamChangeCount() const;
+
+    // This instance's warm instance pool. The processor registers the
+    // component factory, the controller the controller factory and the
+    // scheduler, and configure_warm_pool sets the list of plugins.
+    WarmInstancePool& warmPool() { return warmPool_; }
+
+    static constexpr size_t kParamQueueCapacity = 10000;
+    static constexpr size_t kCoalescingSlots = 8192;
+    static constexpr size_t kMaxParamDrainSize = kParamQueueCapacity + kCoalescingSlots;
+    static constexpr size_t kRampQueueCapacity = 256;
+
 private:
-    HostedPluginModule() = default;
     void resetState(); // Caller must hold mutex_
+    bool adoptModule(const std::string& path, VST3::Hosting::Module::Ptr module, std::string& error); // Caller must hold mutex_
 
     mutable std::mutex mutex_;
     VST3::Hosting::Module::Ptr module_;
@@ -64,12 +169,20 @@ private:
     bool hasControllerCID_ = false;
     bool loaded_ = false;
     Steinberg::IPtr<Steinberg::Vst::IComponent> hostedComponent_;
-
-    std::mutex paramChangeMutex_;
-    std::vector<ParamChange> pendingParamChanges_;
-    bool paramQueueOverflowWarned_ = false; // guarded by paramChangeMutex_
-
-    static constexpr size_t kMaxParamQueueSize = 10000;
+    StateBuffer restoredComponentState_;
+
+    BoundedParamQueue<ParamChange> paramQueue_{kParamQueueCapacity};
+    CoalescingParamTable coalescedParams_{kCoalescingSlots};
+    BoundedParamQueue<ParamRamp> rampQueue_{kRampQueueCapacity};
+    std::atomic<ParamQueueMode> paramQueueMode_{ParamQueueMode::Coalesce};
+    std::atomic<bool> paramQueueOverflowWarned_{false};
+    std::atomic<uint64_t> droppedParamChanges_{0};
+    std::atomic<uint64_t> stateGeneration_{0};
+    std::atomic<bool> hostedEditorOpen_{false};
+    std::atomic<bool> transportPlaying_{false};
+
+    // Declared last: pooled instances are terminated before the rest goes
+    WarmInstancePool warmPool_;
 };
 
 // Convert VST3 UTF-16 (TChar/char16_t) string to UTF-8 std::string.
@@ -0,0 +1,404 @@
+#include "instancediscovery.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace VST3MCPWrapper {
+
+namespace {
+
+// Without inotify the watcher checks the file's mtime this often
+constexpr int kPollIntervalMs = 500;
+
+// Exclusive flock() on path for the lifetime of the object
+class FileLock {
+public:
+    explicit FileLock(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0)
+            return;
+        while (::flock(fd_, LOCK_EX) != 0) {
+            if (errno != EINTR) {
+                ::close(fd_);
+                fd_ = -1;
+                return;
+            }
+        }
+    }
+    ~FileLock() {
+        if (fd_ >= 0) {
+            ::flock(fd_, LOCK_UN);
+            ::close(fd_);
+        }
+    }
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    bool locked() const { return fd_ >= 0; }
+
+private:
+    int fd_ = -1;
+};
+
+bool byPidThenId(const DiscoveredInstance& a, const DiscoveredInstance& b) {
+    return a.pid != b.pid ? a.pid < b.pid : a.id < b.id;
+}
+
+} // namespace
+
+mcp::json discoveredInstanceToJson(const DiscoveredInstance& instance) {
+    return {
+        {"id", instance.id},
+        {"port", instance.port},
+        {"pid", instance.pid},
+        {"pluginPath", instance.pluginPath},
+        {"pluginName", instance.pluginName}
+    };
+}
+
+bool discoveredInstanceFromJson(const mcp::json& obj, DiscoveredInstance& instance) {
+    if (!obj.is_object() || !obj.contains("id") || !obj["id"].is_string()
+        || !obj.contains("port") || !obj["port"].is_number_integer()
+        || !obj.contains("pid") || !obj["pid"].is_number_integer())
+        return false;
+    instance.id = obj["id"].get<std::string>();
+    instance.port = obj["port"].get<int>();
+    instance.pid = obj["pid"].get<int64_t>();
+    instance.pluginPath = obj.value("pluginPath", "");
+    instance.pluginName = obj.value("pluginName", "");
+    return !instance.id.empty() && instance.port > 0 && instance.pid > 0;
+}
+
+// ---- InstanceDiscovery ----
+
+InstanceDiscovery& InstanceDiscovery::shared() {
+    static InstanceDiscovery discovery(defaultFilePath());
+    return discovery;
+}
+
+InstanceDiscovery::InstanceDiscovery(std::string filePath)
+    : filePath_(std::move(filePath)),
+      entries_(std::make_shared<const std::vector<DiscoveredInstance>>())
+{
+}
+
+InstanceDiscovery::~InstanceDiscovery() {
+    std::thread finished;
+    {
+        std::lock_guard<std::mutex> lock(watchMutex_);
+        if (watchers_ == 0)
+            return;
+        watchers_ = 0;
+        finished = std::move(watchThread_);
+    }
+    char stop = 0;
+    (void)::write(wakeFds_[1], &stop, 1);
+    if (finished.joinable())
+        finished.join();
+    closeWatchFds();
+}
+
+bool InstanceDiscovery::publish(const DiscoveredInstance& instance) {
+    return update([&instance](std::vector<DiscoveredInstance>& entries) {
+        auto it = std::find_if(entries.begin(), entries.end(),
+                               [&](const DiscoveredInstance& e) { return e.id == instance.id; });
+        if (it != entries.end())
+            *it = instance;
+        else
+            entries.push_back(instance);
+        return true;
+    });
+}
+
+bool InstanceDiscovery::withdraw(const std::string& id) {
+    const int64_t self = ::getpid();
+    return update([&](std::vector<DiscoveredInstance>& entries) {
+        auto it = std::find_if(entries.begin(), entries.end(),
+                               [&](const DiscoveredInstance& e) { return e.id == id && e.pid == self; });
+        if (it == entries.end())
+            return false;
+        entries.erase(it);
+        return true;
+    });
+}
+
+std::vector<DiscoveredInstance> InstanceDiscovery::instances() {
+    if (filePath_.empty())
+        return {};
+
+    bool watching;
+    {
+        std::lock_guard<std::mutex> lock(watchMutex_);
+        watching = watchers_ > 0;
+    }
+    if (watching) {
+        if (changed_.exchange(false))
+            reload();
+    } else {
+        // No watcher: one stat() per call instead of a parse
+        int64_t stamp = fileStamp();
+        bool stale;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stale = stamp != stamp_;
+        }
+        if (stale)
+            reload();
+    }
+
+    Snapshot entries;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries = entries_;
+    }
+    std::vector<DiscoveredInstance> live;
+    live.reserve(entries->size());
+    for (const auto& entry : *entries) {
+        if (processAlive(entry.pid))
+            live.push_back(entry);
+    }
+    return live;
+}
+
+InstanceDiscovery::Snapshot InstanceDiscovery::readFile() const {
+    auto entries = std::make_shared<std::vector<DiscoveredInstance>>();
+    std::ifstream in(filePath_);
+    if (!in)
+        return entries;
+
+    auto file = mcp::json::parse(in, nullptr, false);
+    if (file.is_discarded() || !file.is_object()
+        || file.value("formatVersion", 0) != kFormatVersion
+        || !file.contains("instances") || !file["instances"].is_array()) {
+        WRAPPER_LOG_ERROR("Ignoring unreadable discovery file %s", filePath_.c_str());
+        return entries;
+    }
+
+    for (const auto& obj : file["instances"]) {
+        DiscoveredInstance instance;
+        if (discoveredInstanceFromJson(obj, instance))
+            entries->push_back(std::move(instance));
+    }
+    std::sort(entries->begin(), entries->end(), byPidThenId);
+    return entries;
+}
+
+bool InstanceDiscovery::writeFile(const std::vector<DiscoveredInstance>& entries) const {
+    mcp::json list = mcp::json::array();
+    for (const auto& entry : entries)
+        list.push_back(discoveredInstanceToJson(entry));
+    mcp::json file = {
+        {"formatVersion", kFormatVersion},
+        {"instances", std::move(list)}
+    };
+
+    // Readers don't take the lock; the rename makes the new contents appear
+    // all at once
+    std::error_code ec;
+    fs::path target(filePath_);
+    fs::path temp = target;
+    temp += ".tmp" + std::to_string(::getpid());
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        if (!out)
+            return false;
+        out << file.dump(2);
+        if (!out)
+            return false;
+    }
+    fs::rename(temp, target, ec);
+    if (ec) {
+        WRAPPER_LOG_ERROR("Failed to write discovery file %s: %s", filePath_.c_str(), ec.message().c_str());
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+// Read-modify-write under the file lock. edit returns false to leave the
+// file as it is (entries of dead processes are then kept until the next
+// real change).
+template <typename Edit>
+bool InstanceDiscovery::update(Edit&& edit) {
+    if (filePath_.empty())
+        return false;
+
+    std::error_code ec;
+    fs::create_directories(fs::path(filePath_).parent_path(), ec);
+    FileLock lock(filePath_ + ".lock");
+    if (!lock.locked()) {
+        WRAPPER_LOG_ERROR("Failed to lock discovery file %s", filePath_.c_str());
+        return false;
+    }
+
+    auto current = readFile();
+    std::vector<DiscoveredInstance> entries;
+    entries.reserve(current->size() + 1);
+    for (const auto& entry : *current) {
+        if (processAlive(entry.pid))
+            entries.push_back(entry);
+    }
+    if (!edit(entries))
+        return false;
+    std::sort(entries.begin(), entries.end(), byPidThenId);
+    if (!writeFile(entries))
+        return false;
+
+    int64_t stamp = fileStamp();
+    std::lock_guard<std::mutex> guard(mutex_);
+    entries_ = std::make_shared<const std::vector<DiscoveredInstance>>(std::move(entries));
+    stamp_ = stamp;
+    return true;
+}
+
+int64_t InstanceDiscovery::fileStamp() const {
+    std::error_code ec;
+    auto time = fs::last_write_time(filePath_, ec);
+    return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+void InstanceDiscovery::reload() {
+    int64_t stamp = fileStamp();
+    auto entries = readFile();
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_ = std::move(entries);
+    stamp_ = stamp;
+}
+
+void InstanceDiscovery::startWatching() {
+    if (filePath_.empty())
+        return;
+    std::lock_guard<std::mutex> lock(watchMutex_);
+    if (watchers_++ > 0)
+        return;
+    if (::pipe(wakeFds_) != 0) {
+        WRAPPER_LOG_ERROR("Failed to create discovery watcher pipe");
+        watchers_ = 0;
+        return;
+    }
+
+    const fs::path target(filePath_);
+    std::error_code ec;
+    fs::create_directories(target.parent_path(), ec);
+#ifdef __linux__
+    // Watch the directory, since every write replaces the file by rename.
+    // Set up here rather than on the thread so no write is missed.
+    notifyFd_ = ::inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (notifyFd_ >= 0
+        && ::inotify_add_watch(notifyFd_, target.parent_path().c_str(),
+                               IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE) < 0) {
+        ::close(notifyFd_);
+        notifyFd_ = -1;
+    }
+    if (notifyFd_ < 0)
+        WRAPPER_LOG_ERROR("inotify unavailable for %s, polling instead", filePath_.c_str());
+#endif
+    changed_ = true; // Nothing was watched until now
+    watchThread_ = std::thread([this]() { runWatcher(); });
+}
+
+void InstanceDiscovery::stopWatching() {
+    std::thread finished;
+    {
+        std::lock_guard<std::mutex> lock(watchMutex_);
+        if (watchers_ == 0 || --watchers_ > 0)
+            return;
+        finished = std::move(watchThread_);
+    }
+    char stop = 0;
+    (void)::write(wakeFds_[1], &stop, 1);
+    if (finished.joinable())
+        finished.join();
+    closeWatchFds();
+}
+
+void InstanceDiscovery::closeWatchFds() {
+    for (int* fd : {&wakeFds_[0], &wakeFds_[1], &notifyFd_}) {
+        if (*fd >= 0)
+            ::close(*fd);
+        *fd = -1;
+    }
+}
+
+void InstanceDiscovery::runWatcher() {
+#ifdef __linux__
+    if (notifyFd_ >= 0) {
+        const std::string fileName = fs::path(filePath_).filename().string();
+        pollfd fds[2] = {{wakeFds_[0], POLLIN, 0}, {notifyFd_, POLLIN, 0}};
+        while (true) {
+            if (::poll(fds, 2, -1) < 0 && errno != EINTR)
+                break;
+            if (fds[0].revents & POLLIN)
+                break;
+            if (!(fds[1].revents & POLLIN))
+                continue;
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length;
+            while ((length = ::read(notifyFd_, buffer, sizeof(buffer))) > 0) {
+                for (ssize_t offset = 0; offset < length;) {
+                    auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                    if (event->len > 0 && fileName == event->name)
+                        changed_ = true;
+                    offset += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+        return;
+    }
+#endif
+
+    pollfd wake = {wakeFds_[0], POLLIN, 0};
+    while (true) {
+        if (::poll(&wake, 1, kPollIntervalMs) < 0 && errno != EINTR)
+            break;
+        if (wake.revents & POLLIN)
+            break;
+        int64_t stamp = fileStamp();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stamp != stamp_)
+            changed_ = true;
+    }
+}
+
+std::string InstanceDiscovery::defaultFilePath() {
+    const char* home = std::getenv("HOME");
+#ifdef __APPLE__
+    if (!home || !*home)
+        return {};
+    return (fs::path(home) / "Library" / "Application Support" / "VST3MCPWrapper" / "instances.json").string();
+#else
+    fs::path base;
+    if (const char* xdg = std::getenv("XDG_DATA_HOME"); xdg && *xdg)
+        base = xdg;
+    else if (home && *home)
+        base = fs::path(home) / ".local" / "share";
+    else
+        return {};
+    return (base / "VST3MCPWrapper" / "instances.json").string();
+#endif
+}
+
+bool InstanceDiscovery::processAlive(int64_t pid) {
+    if (pid <= 0)
+        return false;
+    // EPERM: the process exists but belongs to another user
+    return ::kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+}
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "mcp_message.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// One wrapper instance's MCP server, as listed in the discovery file.
+struct DiscoveredInstance {
+    std::string id;
+    int port = 0;
+    int64_t pid = 0;
+    std::string pluginPath; // Empty while no plugin is loaded
+    std::string pluginName;
+};
+
+// Discovery file wire format.
+mcp::json discoveredInstanceToJson(const DiscoveredInstance& instance);
+bool discoveredInstanceFromJson(const mcp::json& obj, DiscoveredInstance& instance);
+
+// The instances.json file through which agents find the MCP server of
+// every wrapper instance, across all DAW processes of the user.
+//
+// Writers read, modify and rewrite the file while holding flock() on a
+// separate lock file (the data file is replaced by rename, so its inode
+// can't carry the lock). The new contents go to a temporary file that is
+// renamed over the old one, so readers never need the lock and never see a
+// half-written file. Entries whose process is gone are dropped on every
+// write and skipped on every read.
+//
+// instances() answers from an in-memory copy. While watching (see
+// startWatching()) a thread reloads it when the file changes — via inotify
+// on Linux, by checking the file's mtime on other platforms — so a call
+// never parses the file unless it changed.
+//
+// All public methods are thread-safe.
+class InstanceDiscovery {
+public:
+    static constexpr int kFormatVersion = 1;
+
+    // Process-wide discovery file at defaultFilePath().
+    static InstanceDiscovery& shared();
+
+    // Empty filePath disables the file; publish() and withdraw() then do
+    // nothing and instances() is always empty.
+    explicit InstanceDiscovery(std::string filePath);
+    ~InstanceDiscovery();
+
+    InstanceDiscovery(const InstanceDiscovery&) = delete;
+    InstanceDiscovery& operator=(const InstanceDiscovery&) = delete;
+
+    // Add instance, replacing an entry with the same id. Returns false if
+    // the file could not be written.
+    bool publish(const DiscoveredInstance& instance);
+
+    // Remove the entry for id if this process published it.
+    bool withdraw(const std::string& id);
+
+    // Entries of live processes, sorted by pid then id.
+    std::vector<DiscoveredInstance> instances();
+
+    // Reference-counted: the first call starts the watcher thread, the
+    // matching last stopWatching() joins it.
+    void startWatching();
+    void stopWatching();
+
+    // $XDG_DATA_HOME (or ~/.local/share) /VST3MCPWrapper/instances.json on
+    // Linux, ~/Library/Application Support/VST3MCPWrapper/instances.json on
+    // macOS.
+    static std::string defaultFilePath();
+
+    // Whether a process with this pid exists.
+    static bool processAlive(int64_t pid);
+
+private:
+    using Snapshot = std::shared_ptr<const std::vector<DiscoveredInstance>>;
+
+    Snapshot readFile() const;
+    bool writeFile(const std::vector<DiscoveredInstance>& entries) const;
+    template <typename Edit> bool update(Edit&& edit);
+    int64_t fileStamp() const;
+    void reload();
+    void runWatcher();
+    void closeWatchFds(); // Caller has joined the watcher
+
+    const std::string filePath_;
+
+    std::mutex mutex_; // Guards entries_ and stamp_
+    Snapshot entries_;
+    int64_t stamp_ = -1; // mtime of the file entries_ was read from; -1 before the first read
+
+    std::atomic<bool> changed_{true}; // Set by the watcher; reload on the next instances()
+
+    std::mutex watchMutex_; // Guards the members below
+    size_t watchers_ = 0;
+    std::thread watchThread_;
+    int wakeFds_[2] = {-1, -1}; // Self-pipe that stops the watcher
+    int notifyFd_ = -1;         // inotify descriptor (Linux), -1 when polling
+};
+
+} // namespace VST3MCPWrapper
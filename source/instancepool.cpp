@@ -0,0 +1,330 @@
+#include "instancepool.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace VST3MCPWrapper {
+
+WarmInstancePool::~WarmInstancePool() {
+    clear();
+}
+
+// ---- Retired ----
+
+void WarmInstancePool::Retired::take(Slot& slot) {
+    for (auto& component : slot.components)
+        components.push_back(std::move(component));
+    for (auto& controller : slot.controllers)
+        controllers.push_back(std::move(controller));
+    slot.components.clear();
+    slot.controllers.clear();
+}
+
+WarmInstancePool::Retired::~Retired() {
+    for (auto& warm : components) {
+        if (warm.component)
+            warm.component->terminate();
+    }
+    for (auto& warm : controllers) {
+        if (warm.controller)
+            warm.controller->terminate();
+    }
+}
+
+// ---- Configuration ----
+
+void WarmInstancePool::configure(const std::vector<std::string>& paths, size_t instancesPerPlugin) {
+    Retired retired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        instancesPerPlugin_ = std::clamp<size_t>(instancesPerPlugin, 1, kMaxInstancesPerPlugin);
+
+        std::vector<Slot> next;
+        for (const auto& path : paths) {
+            if (path.empty() || next.size() == kMaxPlugins)
+                continue;
+            if (std::any_of(next.begin(), next.end(), [&path](const Slot& slot) { return slot.path == path; }))
+                continue;
+            Slot* existing = findSlot(path);
+            if (existing) {
+                next.push_back(std::move(*existing));
+                next.back().error.clear(); // Listing a plugin again retries it
+                existing->path.clear();
+            } else {
+                Slot slot;
+                slot.path = path;
+                next.push_back(std::move(slot));
+            }
+        }
+        for (auto& slot : slots_)
+            retired.take(slot);
+
+        for (auto& slot : next) {
+            while (slot.components.size() > instancesPerPlugin_) {
+                retired.components.push_back(std::move(slot.components.back()));
+                slot.components.pop_back();
+            }
+            while (slot.controllers.size() > instancesPerPlugin_) {
+                retired.controllers.push_back(std::move(slot.controllers.back()));
+                slot.controllers.pop_back();
+            }
+        }
+        slots_ = std::move(next);
+    }
+    scheduleRefill();
+}
+
+size_t WarmInstancePool::instancesPerPlugin() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return instancesPerPlugin_;
+}
+
+void WarmInstancePool::setComponentFactory(const void* owner, ComponentFactory factory) {
+    Retired retired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Instances from another owner's factory were set up for its configuration
+        if (componentOwner_ != owner) {
+            for (auto& slot : slots_) {
+                for (auto& component : slot.components)
+                    retired.components.push_back(std::move(component));
+                slot.components.clear();
+            }
+        }
+        componentOwner_ = owner;
+        componentFactory_ = std::move(factory);
+        ++componentGeneration_;
+    }
+    scheduleRefill();
+}
+
+void WarmInstancePool::removeComponentFactory(const void* owner) {
+    Retired retired;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (componentOwner_ != owner)
+        return;
+    componentOwner_ = nullptr;
+    componentFactory_ = nullptr;
+    ++componentGeneration_;
+    for (auto& slot : slots_) {
+        for (auto& component : slot.components)
+            retired.components.push_back(std::move(component));
+        slot.components.clear();
+    }
+}
+
+void WarmInstancePool::setControllerFactory(const void* owner, ControllerFactory factory) {
+    Retired retired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (controllerOwner_ != owner) {
+            for (auto& slot : slots_) {
+                for (auto& controller : slot.controllers)
+                    retired.controllers.push_back(std::move(controller));
+                slot.controllers.clear();
+            }
+        }
+        controllerOwner_ = owner;
+        controllerFactory_ = std::move(factory);
+        ++controllerGeneration_;
+    }
+    scheduleRefill();
+}
+
+void WarmInstancePool::removeControllerFactory(const void* owner) {
+    Retired retired;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (controllerOwner_ != owner)
+        return;
+    controllerOwner_ = nullptr;
+    controllerFactory_ = nullptr;
+    ++controllerGeneration_;
+    for (auto& slot : slots_) {
+        for (auto& controller : slot.controllers)
+            retired.controllers.push_back(std::move(controller));
+        slot.controllers.clear();
+    }
+}
+
+void WarmInstancePool::setScheduler(Scheduler scheduler) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        scheduler_ = std::move(scheduler);
+        // A task posted to the previous scheduler may never run
+        refillScheduled_ = false;
+    }
+    scheduleRefill();
+}
+
+// ---- Taking instances ----
+
+bool WarmInstancePool::takeComponent(const std::string& path, WarmComponent& out) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = findSlot(path);
+        if (!slot || slot->components.empty())
+            return false;
+        out = std::move(slot->components.front());
+        slot->components.pop_front();
+    }
+    scheduleRefill();
+    return true;
+}
+
+bool WarmInstancePool::takeController(const std::string& path, WarmController& out) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = findSlot(path);
+        if (!slot || slot->controllers.empty())
+            return false;
+        out = std::move(slot->controllers.front());
+        slot->controllers.pop_front();
+    }
+    scheduleRefill();
+    return true;
+}
+
+void WarmInstancePool::invalidateComponents() {
+    Retired retired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++componentGeneration_;
+        for (auto& slot : slots_) {
+            for (auto& component : slot.components)
+                retired.components.push_back(std::move(component));
+            slot.components.clear();
+        }
+    }
+    scheduleRefill();
+}
+
+void WarmInstancePool::clear() {
+    Retired retired;
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++componentGeneration_;
+    ++controllerGeneration_;
+    for (auto& slot : slots_)
+        retired.take(slot);
+}
+
+std::vector<WarmInstancePool::PluginStatus> WarmInstancePool::status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<PluginStatus> result;
+    result.reserve(slots_.size());
+    for (const auto& slot : slots_)
+        result.push_back({slot.path, slot.components.size(), slot.controllers.size(), slot.error});
+    return result;
+}
+
+// ---- Refill ----
+
+WarmInstancePool::Slot* WarmInstancePool::findSlot(const std::string& path) {
+    // Caller must hold mutex_
+    for (auto& slot : slots_) {
+        if (slot.path == path)
+            return &slot;
+    }
+    return nullptr;
+}
+
+WarmInstancePool::Slot* WarmInstancePool::nextToFill(bool& makeComponent) {
+    // Caller must hold mutex_. Components first: they tell the controller
+    // factory which controller class to create.
+    for (auto& slot : slots_) {
+        if (!slot.error.empty())
+            continue;
+        if (componentFactory_ && slot.components.size() < instancesPerPlugin_) {
+            makeComponent = true;
+            return &slot;
+        }
+        if (controllerFactory_ && slot.controllers.size() < instancesPerPlugin_) {
+            makeComponent = false;
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+void WarmInstancePool::scheduleRefill() {
+    Scheduler scheduler;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool makeComponent = false;
+        if (refillScheduled_ || !scheduler_ || !nextToFill(makeComponent))
+            return;
+        refillScheduled_ = true;
+        scheduler = scheduler_;
+    }
+    scheduler([this]() { refillStep(); });
+}
+
+void WarmInstancePool::refillStep() {
+    std::string path;
+    bool makeComponent = false;
+    ComponentFactory componentFactory;
+    ControllerFactory controllerFactory;
+    uint64_t generation = 0;
+    bool hasControllerClassID = false;
+    TUID controllerClassID = {};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = nextToFill(makeComponent);
+        if (!slot) {
+            refillScheduled_ = false;
+            return;
+        }
+        path = slot->path;
+        if (makeComponent) {
+            componentFactory = componentFactory_;
+            generation = componentGeneration_;
+        } else {
+            controllerFactory = controllerFactory_;
+            generation = controllerGeneration_;
+            hasControllerClassID = slot->hasControllerClassID;
+            std::memcpy(controllerClassID, slot->controllerClassID, sizeof(TUID));
+        }
+    }
+
+    // The slow part (initialize) runs unlocked
+    WarmComponent component;
+    WarmController controller;
+    bool created = makeComponent
+        ? componentFactory(path, component)
+        : controllerFactory(path, hasControllerClassID ? &controllerClassID : nullptr, controller);
+
+    Retired retired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refillScheduled_ = false;
+        Slot* slot = findSlot(path);
+        if (!created) {
+            WRAPPER_LOG_ERROR("Failed to create a warm %s for %s",
+                              makeComponent ? "component" : "controller", path.c_str());
+            if (slot)
+                slot->error = makeComponent ? "Failed to create component" : "Failed to create controller";
+        } else if (makeComponent) {
+            // Stale if the configuration changed or the plugin was unlisted meanwhile
+            if (slot && generation == componentGeneration_ && slot->components.size() < instancesPerPlugin_) {
+                if (component.hasControllerClassID) {
+                    slot->hasControllerClassID = true;
+                    std::memcpy(slot->controllerClassID, component.controllerClassID, sizeof(TUID));
+                }
+                slot->components.push_back(std::move(component));
+            } else {
+                retired.components.push_back(std::move(component));
+            }
+        } else {
+            if (slot && generation == controllerGeneration_ && slot->controllers.size() < instancesPerPlugin_)
+                slot->controllers.push_back(std::move(controller));
+            else
+                retired.controllers.push_back(std::move(controller));
+        }
+    }
+    scheduleRefill();
+}
+
+} // namespace VST3MCPWrapper
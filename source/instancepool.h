@@ -0,0 +1,156 @@
+#pragma once
+
+#include "public.sdk/source/vst/hosting/module.h"
+#include "pluginterfaces/vst/ivstaudioprocessor.h"
+#include "pluginterfaces/vst/ivstcomponent.h"
+#include "pluginterfaces/vst/ivsteditcontroller.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// Processor half of a warm instance: initialized, buses activated, stored
+// bus arrangements and ProcessSetup applied, not active.
+struct WarmComponent {
+    VST3::Hosting::Module::Ptr module; // Keeps the binary loaded while the instance lives
+    Steinberg::IPtr<Steinberg::Vst::IComponent> component;
+    Steinberg::IPtr<Steinberg::Vst::IAudioProcessor> processor;
+    bool hasControllerClassID = false;
+    Steinberg::TUID controllerClassID = {};
+};
+
+// Controller half: initialized, no component handler set yet. For
+// single-component plugins, controller is a component instance that
+// implements IEditController (singleComponent is true).
+struct WarmController {
+    VST3::Hosting::Module::Ptr module;
+    Steinberg::IPtr<Steinberg::Vst::IEditController> controller;
+    bool singleComponent = false;
+    bool hasControllerClassID = false;
+    Steinberg::TUID controllerClassID = {};
+};
+
+// Pool of pre-initialized hosted plugin instances for a configured list of
+// plugins, so loading one of them skips component/controller initialize().
+// Each wrapper instance has its own (HostedPluginInstance::warmPool()), so
+// instances never hand each other components prepared for another bus
+// layout or ProcessSetup, and one instance's shutdown doesn't stop the
+// others' refills.
+//
+// The processor and the controller each register a factory for their half
+// (they own the host context and, for the processor, the bus arrangements
+// and ProcessSetup to replay); takeComponent()/takeController() hand out a
+// warm half if one is ready. Taking an instance, configuring the pool or
+// registering a factory schedules a refill: one instance is created per
+// task posted to the scheduler (the main thread dispatcher), so the main
+// thread is never blocked for more than one initialize() at a time.
+//
+// Components are invalidated when the processing configuration they were
+// prepared with changes. Pooled instances are terminated when they are
+// dropped: when their plugin is removed from the list, when invalidated, or
+// when the factory that created them is removed.
+//
+// All public methods are thread-safe. Factories and the instances' own
+// initialize()/terminate() run without the pool lock held.
+class WarmInstancePool {
+public:
+    using ComponentFactory = std::function<bool(const std::string& path, WarmComponent& out)>;
+    // controllerClassID is the class learned from a component of the same
+    // plugin, or null if none is known yet.
+    using ControllerFactory = std::function<bool(const std::string& path, const Steinberg::TUID* controllerClassID,
+                                                 WarmController& out)>;
+    using Scheduler = std::function<void(std::function<void()> task)>;
+
+    struct PluginStatus {
+        std::string path;
+        size_t components = 0;
+        size_t controllers = 0;
+        std::string error; // Last failure to create an instance; the plugin is not retried
+    };
+
+    static constexpr size_t kMaxPlugins = 16;
+    static constexpr size_t kMaxInstancesPerPlugin = 4;
+
+    WarmInstancePool() = default;
+    ~WarmInstancePool();
+
+    WarmInstancePool(const WarmInstancePool&) = delete;
+    WarmInstancePool& operator=(const WarmInstancePool&) = delete;
+
+    // Keep instancesPerPlugin warm instances of each path (at most
+    // kMaxPlugins paths and kMaxInstancesPerPlugin instances). Instances of
+    // plugins no longer listed are dropped; an empty list disables the pool.
+    void configure(const std::vector<std::string>& paths, size_t instancesPerPlugin);
+    size_t instancesPerPlugin() const;
+
+    // owner identifies the registrant: removing a factory only takes effect
+    // for the owner that set it, and drops the instances it created.
+    void setComponentFactory(const void* owner, ComponentFactory factory);
+    void removeComponentFactory(const void* owner);
+    void setControllerFactory(const void* owner, ControllerFactory factory);
+    void removeControllerFactory(const void* owner);
+
+    // Where refill work runs. Without a scheduler the pool is not refilled.
+    void setScheduler(Scheduler scheduler);
+
+    // Take a warm half for path. Returns false if none is ready.
+    bool takeComponent(const std::string& path, WarmComponent& out);
+    bool takeController(const std::string& path, WarmController& out);
+
+    // The processing configuration changed: drop pooled components and
+    // build new ones.
+    void invalidateComponents();
+
+    // Drop every pooled instance (the list of plugins is kept).
+    void clear();
+
+    std::vector<PluginStatus> status() const;
+
+private:
+    struct Slot {
+        std::string path;
+        std::deque<WarmComponent> components;
+        std::deque<WarmController> controllers;
+        bool hasControllerClassID = false;
+        Steinberg::TUID controllerClassID = {};
+        std::string error;
+    };
+
+    struct Retired {
+        std::vector<WarmComponent> components;
+        std::vector<WarmController> controllers;
+        void take(Slot& slot);
+        ~Retired(); // Terminates them
+    };
+
+    // Caller must hold mutex_
+    Slot* findSlot(const std::string& path);
+    // Next slot missing an instance that a registered factory can build;
+    // makeComponent tells which half. nullptr if the pool is full.
+    Slot* nextToFill(bool& makeComponent);
+
+    void scheduleRefill();
+    void refillStep();
+
+    mutable std::mutex mutex_;
+    std::vector<Slot> slots_;
+    size_t instancesPerPlugin_ = 1;
+
+    const void* componentOwner_ = nullptr;
+    ComponentFactory componentFactory_;
+    uint64_t componentGeneration_ = 0; // Bumped when pooled components go stale
+    const void* controllerOwner_ = nullptr;
+    ControllerFactory controllerFactory_;
+    uint64_t controllerGeneration_ = 0;
+
+    Scheduler scheduler_;
+    bool refillScheduled_ = false;
+};
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,62 @@
+#include "instanceregistry.h"
+#include "hostedplugin.h"
+
+#include <functional>
+
+namespace VST3MCPWrapper {
+
+InstanceRegistry& InstanceRegistry::shared() {
+    static InstanceRegistry registry;
+    return registry;
+}
+
+InstanceRegistry::Shard& InstanceRegistry::shardFor(const std::string& id) {
+    return shards_[std::hash<std::string>{}(id) % kShardCount];
+}
+
+const InstanceRegistry::Shard& InstanceRegistry::shardFor(const std::string& id) const {
+    return shards_[std::hash<std::string>{}(id) % kShardCount];
+}
+
+bool InstanceRegistry::add(const std::string& id, const std::shared_ptr<HostedPluginInstance>& instance) {
+    auto& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& entry = shard.entries[id];
+    auto existing = entry.lock();
+    if (existing && existing != instance)
+        return false;
+    entry = instance;
+    return true;
+}
+
+void InstanceRegistry::remove(const std::string& id, const HostedPluginInstance* instance) {
+    auto& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(id);
+    if (it == shard.entries.end())
+        return;
+    auto existing = it->second.lock();
+    if (!existing || existing.get() == instance)
+        shard.entries.erase(it);
+}
+
+std::shared_ptr<HostedPluginInstance> InstanceRegistry::find(const std::string& id) const {
+    const auto& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(id);
+    return it != shard.entries.end() ? it->second.lock() : nullptr;
+}
+
+std::vector<std::string> InstanceRegistry::ids() const {
+    std::vector<std::string> result;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [id, instance] : shard.entries) {
+            if (!instance.expired())
+                result.push_back(id);
+        }
+    }
+    return result;
+}
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+class HostedPluginInstance;
+
+// Process-wide map from wrapper instance ID to that instance's
+// HostedPluginInstance, so a controller can find the state its processor
+// created (see MessageIds::kInstanceId).
+//
+// Only binding goes through the registry: processors and controllers keep
+// their own reference afterwards, and the audio and MCP paths never look
+// anything up. Entries are spread over kShardCount independently locked
+// shards by ID hash, so instances registering or looking each other up
+// during a session load don't queue behind one lock.
+//
+// The registry holds weak references: an entry is gone once the processor
+// and controller that used it have released it, even if remove() was never
+// called.
+//
+// All public methods are thread-safe.
+class InstanceRegistry {
+public:
+    static InstanceRegistry& shared();
+
+    // Register instance under id. Returns false, leaving the registry
+    // unchanged, if id already maps to another live instance (e.g. a
+    // duplicated track restoring the same saved ID).
+    bool add(const std::string& id, const std::shared_ptr<HostedPluginInstance>& instance);
+
+    // Remove id if it maps to instance.
+    void remove(const std::string& id, const HostedPluginInstance* instance);
+
+    // nullptr if id is unknown or its instance is gone.
+    std::shared_ptr<HostedPluginInstance> find(const std::string& id) const;
+
+    // IDs of live instances, in no particular order.
+    std::vector<std::string> ids() const;
+
+    static constexpr size_t kShardCount = 16;
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::weak_ptr<HostedPluginInstance>> entries;
+    };
+
+    Shard& shardFor(const std::string& id);
+    const Shard& shardFor(const std::string& id) const;
+
+    std::array<Shard, kShardCount> shards_;
+};
+
+} // namespace VST3MCPWrapper
@@ -2,30 +2,192 @@
 
 #include "hostedplugin.h"
 #include "mcp_message.h"
+#include "paramcache.h"
+#include "paramhistory.h"
+#include "paramnotify.h"
 
 #include "pluginterfaces/vst/ivsteditcontroller.h"
 
 #include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace VST3MCPWrapper {
 
 using namespace Steinberg;
 using namespace Steinberg::Vst;
 
-// Check if a parameter ID exists in the hosted controller's parameter list.
-inline bool isValidParamId(IEditController* ctrl, ParamID targetId) {
-    int32 count = ctrl->getParameterCount();
-    for (int32 i = 0; i < count; ++i) {
-        ParameterInfo info;
-        if (ctrl->getParameterInfo(i, info) == kResultOk && info.id == targetId)
+inline mcp::json paramNotFound(ParamID paramId) {
+    return {
+        {"content", {{{"type", "text"}, {"text", "Parameter ID " + std::to_string(paramId) + " not found"}}}},
+        {"isError", true}
+    };
+}
+
+// All handlers resolve parameter IDs and static metadata through the
+// controller's ParameterInfoCache instead of scanning getParameterInfo().
+
+// Set the hosted controller to batch's values and queue the batch for the
+// processor in one pass. Returns the number of changes queued.
+inline size_t applyParamBatch(IEditController* ctrl, ParameterInfoCache& cache, HostedPluginInstance& hosted,
+                              const std::vector<ParamChange>& batch) {
+    for (const auto& change : batch)
+        ctrl->setParamNormalized(change.id, change.value);
+
+    size_t queued = hosted.pushParamChanges(batch.data(), batch.size());
+    std::vector<ParamID> ids;
+    ids.reserve(batch.size());
+    for (const auto& change : batch)
+        ids.push_back(change.id);
+    cache.versions().markChanged(ids.data(), ids.size());
+    return queued;
+}
+
+// Current value of every parameter in table, for a checkpoint.
+inline ParamSnapshot snapshotParameters(IEditController* ctrl, const ParameterTable& table) {
+    ParamSnapshot values;
+    values.reserve(table.size());
+    for (const auto& param : table.parameters())
+        values.emplace_back(param.info.id, ctrl->getParamNormalized(param.info.id));
+    return values;
+}
+
+// Record one tool call's edits as an undo step and take an automatic
+// checkpoint when one is due. history may be null (no recording).
+inline void recordParamEdits(IEditController* ctrl, ParameterInfoCache& cache, ParamHistory* history,
+                             const std::vector<ParamEdit>& edits) {
+    if (!history)
+        return;
+    history->record(edits);
+    if (history->autoSnapshotDue())
+        history->addAutoSnapshot(snapshotParameters(ctrl, *cache.get(ctrl)));
+}
+
+// Columns of a list_parameters entry, selectable through "fields".
+enum ListParamField : uint32_t {
+    kListFieldId                     = 1u << 0,
+    kListFieldTitle                  = 1u << 1,
+    kListFieldUnits                  = 1u << 2,
+    kListFieldNormalizedValue        = 1u << 3,
+    kListFieldDisplayValue           = 1u << 4,
+    kListFieldDefaultNormalizedValue = 1u << 5,
+    kListFieldStepCount              = 1u << 6,
+    kListFieldCanAutomate            = 1u << 7,
+    kListFieldAll                    = (1u << 8) - 1
+};
+
+inline uint32_t listParamFieldFromName(const std::string& name) {
+    static const std::pair<const char*, uint32_t> kFields[] = {
+        {"id", kListFieldId},
+        {"title", kListFieldTitle},
+        {"units", kListFieldUnits},
+        {"normalizedValue", kListFieldNormalizedValue},
+        {"displayValue", kListFieldDisplayValue},
+        {"defaultNormalizedValue", kListFieldDefaultNormalizedValue},
+        {"stepCount", kListFieldStepCount},
+        {"canAutomate", kListFieldCanAutomate},
+    };
+    for (const auto& [fieldName, bit] : kFields) {
+        if (name == fieldName)
+            return bit;
+    }
+    return 0;
+}
+
+struct ListParametersOptions {
+    // When set, only parameters whose value changed after this version are
+    // listed and the result carries "full" (see ParamChangeTracker).
+    std::optional<uint64_t> sinceVersion;
+    // Window over the (filtered) parameter list.
+    size_t offset = 0;
+    std::optional<size_t> limit;
+    // Case-insensitive substring match on the title; empty matches all.
+    std::string nameFilter;
+    // ListParamField bits to include in each entry.
+    uint32_t fields = kListFieldAll;
+
+    // Any option set switches the result from the plain array to the
+    // {"version", "total", "offset", "parameters"} envelope.
+    bool isDefault() const {
+        return !sinceVersion && offset == 0 && !limit && nameFilter.empty() && fields == kListFieldAll;
+    }
+};
+
+inline std::string asciiLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+// Reads the optional list_parameters arguments: "since_version", "offset",
+// "limit", "filter" and "fields". Returns false with error set on invalid input.
+inline bool parseListParametersOptions(const mcp::json& params, ListParametersOptions& options,
+                                       std::string& error) {
+    options = {};
+
+    auto readCount = [&](const char* name, size_t& out) {
+        if (!params.contains(name) || params[name].is_null())
             return true;
+        const auto& arg = params[name];
+        if (!arg.is_number() || !std::isfinite(arg.get<double>()) || arg.get<double>() < 0) {
+            error = std::string(name) + " must be a non-negative number";
+            return false;
+        }
+        out = static_cast<size_t>(arg.get<double>());
+        return true;
+    };
+
+    if (params.contains("since_version") && !params["since_version"].is_null()) {
+        size_t since = 0;
+        if (!readCount("since_version", since))
+            return false;
+        options.sinceVersion = since;
+    }
+    if (!readCount("offset", options.offset))
+        return false;
+    if (params.contains("limit") && !params["limit"].is_null()) {
+        size_t limit = 0;
+        if (!readCount("limit", limit))
+            return false;
+        options.limit = limit;
+    }
+
+    if (params.contains("filter") && !params["filter"].is_null()) {
+        if (!params["filter"].is_string()) {
+            error = "filter must be a string";
+            return false;
+        }
+        options.nameFilter = params["filter"].get<std::string>();
+    }
+
+    if (params.contains("fields") && !params["fields"].is_null()) {
+        if (!params["fields"].is_array()) {
+            error = "fields must be an array of field names";
+            return false;
+        }
+        uint32_t fields = 0;
+        for (const auto& field : params["fields"]) {
+            uint32_t bit = field.is_string() ? listParamFieldFromName(field.get<std::string>()) : 0;
+            if (bit == 0) {
+                error = "Unknown field " + field.dump();
+                return false;
+            }
+            fields |= bit;
+        }
+        if (fields != 0)
+            options.fields = fields;
     }
-    return false;
+    return true;
 }
 
-inline mcp::json handleListParameters(IEditController* ctrl) {
+inline mcp::json handleListParameters(IEditController* ctrl, ParameterInfoCache& cache,
+                                      const ListParametersOptions& options = {}) {
     if (!ctrl) {
         return {
             {"content", {{{"type", "text"}, {"text", "No hosted plugin loaded"}}}},
@@ -33,41 +195,85 @@ inline mcp::json handleListParameters(IEditController* ctrl) {
         };
     }
 
-    int32 paramCount = ctrl->getParameterCount();
+    auto table = cache.get(ctrl);
     mcp::json paramList = mcp::json::array();
 
-    for (int32 i = 0; i < paramCount; ++i) {
-        ParameterInfo info;
-        if (ctrl->getParameterInfo(i, info) == kResultOk) {
-            std::string title = utf16ToUtf8(info.title);
-            std::string units = utf16ToUtf8(info.units);
-            ParamValue value = ctrl->getParamNormalized(info.id);
+    std::optional<ParamChangeTracker::Delta> delta;
+    if (options.sinceVersion)
+        delta = cache.versions().changesSince(*options.sinceVersion);
 
-            String128 displayStr;
-            std::string display;
-            if (ctrl->getParamStringByValue(info.id, value, displayStr) == kResultOk) {
-                display = utf16ToUtf8(displayStr);
-            }
+    std::string filter = asciiLower(options.nameFilter);
+    const uint32_t fields = options.fields;
+    size_t matched = 0;
 
-            paramList.push_back({
-                {"id", info.id},
-                {"title", title},
-                {"units", units},
-                {"normalizedValue", value},
-                {"displayValue", display},
-                {"defaultNormalizedValue", info.defaultNormalizedValue},
-                {"stepCount", info.stepCount},
-                {"canAutomate", (info.flags & ParameterInfo::kCanAutomate) != 0}
-            });
+    for (const auto& param : table->parameters()) {
+        const ParameterInfo& info = param.info;
+        if (delta && !delta->all && delta->changed.count(info.id) == 0)
+            continue;
+        if (!filter.empty() && asciiLower(param.title).find(filter) == std::string::npos)
+            continue;
+
+        // Count everything that matches, but only query the plugin for the page
+        size_t position = matched++;
+        if (position < options.offset || (options.limit && position - options.offset >= *options.limit))
+            continue;
+
+        mcp::json entry = mcp::json::object();
+        if (fields & kListFieldId)
+            entry["id"] = info.id;
+        if (fields & kListFieldTitle)
+            entry["title"] = param.title;
+        if (fields & kListFieldUnits)
+            entry["units"] = param.units;
+        if (fields & (kListFieldNormalizedValue | kListFieldDisplayValue)) {
+            ParamValue value = ctrl->getParamNormalized(info.id);
+            if (fields & kListFieldNormalizedValue)
+                entry["normalizedValue"] = value;
+            if (fields & kListFieldDisplayValue) {
+                String128 displayStr;
+                std::string display;
+                if (ctrl->getParamStringByValue(info.id, value, displayStr) == kResultOk) {
+                    display = utf16ToUtf8(displayStr);
+                }
+                entry["displayValue"] = display;
+            }
         }
+        if (fields & kListFieldDefaultNormalizedValue)
+            entry["defaultNormalizedValue"] = info.defaultNormalizedValue;
+        if (fields & kListFieldStepCount)
+            entry["stepCount"] = info.stepCount;
+        if (fields & kListFieldCanAutomate)
+            entry["canAutomate"] = (info.flags & ParameterInfo::kCanAutomate) != 0;
+
+        paramList.push_back(std::move(entry));
     }
 
+    // Compact output — for large plugins indentation alone is a sizeable
+    // share of the payload and serialization time.
+    if (options.isDefault()) {
+        return {
+            {"content", {{{"type", "text"}, {"text", paramList.dump()}}}}
+        };
+    }
+
+    mcp::json result = {
+        {"version", delta ? delta->version : cache.versions().currentVersion()}
+    };
+    if (delta)
+        result["full"] = delta->all;
+    result["total"] = matched;
+    result["offset"] = options.offset;
+    size_t end = options.offset + paramList.size();
+    if (end < matched)
+        result["nextOffset"] = end;
+    result["parameters"] = std::move(paramList);
+
     return {
-        {"content", {{{"type", "text"}, {"text", paramList.dump(2)}}}}
+        {"content", {{{"type", "text"}, {"text", result.dump()}}}}
     };
 }
 
-inline mcp::json handleGetParameter(IEditController* ctrl, ParamID paramId) {
+inline mcp::json handleGetParameter(IEditController* ctrl, ParameterInfoCache& cache, ParamID paramId) {
     if (!ctrl) {
         return {
             {"content", {{{"type", "text"}, {"text", "No hosted plugin loaded"}}}},
@@ -75,12 +281,8 @@ inline mcp::json handleGetParameter(IEditController* ctrl, ParamID paramId) {
         };
     }
 
-    if (!isValidParamId(ctrl, paramId)) {
-        return {
-            {"content", {{{"type", "text"}, {"text", "Parameter ID " + std::to_string(paramId) + " not found"}}}},
-            {"isError", true}
-        };
-    }
+    if (!cache.get(ctrl)->contains(paramId))
+        return paramNotFound(paramId);
 
     ParamValue value = ctrl->getParamNormalized(paramId);
 
@@ -101,7 +303,61 @@ inline mcp::json handleGetParameter(IEditController* ctrl, ParamID paramId) {
     };
 }
 
-inline mcp::json handleSetParameter(IEditController* ctrl, ParamID paramId, ParamValue value) {
+// Reads the optional scheduling arguments of set_parameter: "at_sample"
+// (project sample position) or "delay_ms" (wall clock from now). Neither
+// means immediate. Returns false with error set on invalid input.
+inline bool parseParamChangeTiming(const mcp::json& params, ParamChangeTiming& timing,
+                                   int64& time, std::string& error) {
+    timing = ParamChangeTiming::Immediate;
+    time = 0;
+
+    bool hasSample = params.contains("at_sample") && !params["at_sample"].is_null();
+    bool hasDelay = params.contains("delay_ms") && !params["delay_ms"].is_null();
+    if (hasSample && hasDelay) {
+        error = "Specify at most one of at_sample and delay_ms";
+        return false;
+    }
+
+    if (hasSample) {
+        if (!params["at_sample"].is_number()) {
+            error = "at_sample must be a number";
+            return false;
+        }
+        double sample = params["at_sample"].get<double>();
+        if (!std::isfinite(sample)) {
+            error = "at_sample must be a finite number";
+            return false;
+        }
+        timing = ParamChangeTiming::ProjectSample;
+        time = static_cast<int64>(std::llround(sample));
+    } else if (hasDelay) {
+        if (!params["delay_ms"].is_number()) {
+            error = "delay_ms must be a number";
+            return false;
+        }
+        double delayMs = params["delay_ms"].get<double>();
+        if (!std::isfinite(delayMs) || delayMs < 0.0) {
+            error = "delay_ms must be a non-negative finite number";
+            return false;
+        }
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        timing = ParamChangeTiming::SteadyClock;
+        time = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()
+            + static_cast<int64>(delayMs * 1e6);
+    }
+    return true;
+}
+
+// timing/time schedule the change on the audio thread (see ParamChange).
+// A change at a project sample is applied right away while the transport
+// is stopped; the result then says so instead of reporting the schedule.
+// The hosted controller is updated right away regardless, so the GUI and
+// get_parameter reflect the target value before it reaches the processor.
+// The change is recorded as one step in history, if given.
+inline mcp::json handleSetParameter(IEditController* ctrl, ParameterInfoCache& cache,
+                                    HostedPluginInstance& hosted, ParamID paramId, ParamValue value,
+                                    ParamChangeTiming timing = ParamChangeTiming::Immediate,
+                                    int64 time = 0, ParamHistory* history = nullptr) {
     if (!ctrl) {
         return {
             {"content", {{{"type", "text"}, {"text", "No hosted plugin loaded"}}}},
@@ -109,12 +365,8 @@ inline mcp::json handleSetParameter(IEditController* ctrl, ParamID paramId, Para
         };
     }
 
-    if (!isValidParamId(ctrl, paramId)) {
-        return {
-            {"content", {{{"type", "text"}, {"text", "Parameter ID " + std::to_string(paramId) + " not found"}}}},
-            {"isError", true}
-        };
-    }
+    if (!cache.get(ctrl)->contains(paramId))
+        return paramNotFound(paramId);
 
     if (!std::isfinite(value)) {
         return {
@@ -124,15 +376,18 @@ inline mcp::json handleSetParameter(IEditController* ctrl, ParamID paramId, Para
     }
 
     value = std::clamp(value, 0.0, 1.0);
+    ParamValue oldValue = ctrl->getParamNormalized(paramId);
 
     // Update the hosted controller's internal state (for GUI)
     ctrl->setParamNormalized(paramId, value);
 
     // Queue the change for the audio processor
-    HostedPluginModule::instance().pushParamChange(paramId, value);
+    hosted.pushParamChange(ParamChange{paramId, value, timing, time});
+    cache.versions().markChanged(paramId);
 
     // Read back to confirm
     ParamValue newValue = ctrl->getParamNormalized(paramId);
+    recordParamEdits(ctrl, cache, history, {{paramId, oldValue, newValue}});
     String128 displayStr;
     std::string display;
     if (ctrl->getParamStringByValue(paramId, newValue, displayStr) == kResultOk) {
@@ -144,10 +399,442 @@ inline mcp::json handleSetParameter(IEditController* ctrl, ParamID paramId, Para
         {"normalizedValue", newValue},
         {"displayValue", display}
     };
+    if (timing == ParamChangeTiming::ProjectSample) {
+        if (hosted.isTransportPlaying()) {
+            result["scheduledAtSample"] = time;
+        } else {
+            result["appliedImmediately"] = true;
+            result["note"] = "Transport is stopped: at_sample ignored, the change is applied now";
+        }
+    }
+    else if (timing == ParamChangeTiming::SteadyClock)
+        result["scheduled"] = true;
+
+    return {
+        {"content", {{{"type", "text"}, {"text", result.dump(2)}}}}
+    };
+}
+
+// Largest batch accepted by set_parameters — one FIFO ring's worth, so a
+// batch always fits even when coalescing is off.
+constexpr size_t kMaxSetParametersBatch = HostedPluginInstance::kParamQueueCapacity;
+
+// Set many parameters in one call. changes is an array of {"id", "value"}
+// objects. The whole batch is validated first; if any entry is invalid
+// nothing is applied. Values are clamped to [0, 1], the hosted controller is
+// updated, and all changes are queued for the processor in one pass.
+// The result is compact JSON: {"applied": n, "parameters": [{"id", "normalizedValue"}, ...]}.
+// The batch is recorded as one step in history, if given.
+inline mcp::json handleSetParameters(IEditController* ctrl, ParameterInfoCache& cache,
+                                     HostedPluginInstance& hosted, const mcp::json& changes, ParamHistory* history = nullptr) {
+    if (!ctrl) {
+        return {
+            {"content", {{{"type", "text"}, {"text", "No hosted plugin loaded"}}}},
+            {"isError", true}
+        };
+    }
+
+    if (!changes.is_array() || changes.empty()) {
+        return {
+            {"content", {{{"type", "text"}, {"text", "parameters must be a non-empty array of {id, value} objects"}}}},
+            {"isError", true}
+        };
+    }
+
+    if (changes.size() > kMaxSetParametersBatch) {
+        return {
+            {"content", {{{"type", "text"}, {"text", "Too many parameters in one batch (max "
+                + std::to_string(kMaxSetParametersBatch) + ")"}}}},
+            {"isError", true}
+        };
+    }
+
+    auto table = cache.get(ctrl);
+    std::vector<ParamChange> batch;
+    batch.reserve(changes.size());
+
+    for (size_t i = 0; i < changes.size(); ++i) {
+        const auto& entry = changes[i];
+        if (!entry.is_object() || !entry.contains("id") || !entry.contains("value")
+            || !entry["id"].is_number_integer() || entry["id"].get<int64_t>() < 0
+            || entry["id"].get<int64_t>() > static_cast<int64_t>(UINT32_MAX)
+            || !entry["value"].is_number()) {
+            return {
+                {"content", {{{"type", "text"}, {"text", "Entry " + std::to_string(i)
+                    + ": expected {\"id\": <unsigned integer>, \"value\": <number>}"}}}},
+                {"isError", true}
+            };
+        }
+
+        auto paramId = entry["id"].get<ParamID>();
+        if (!table->contains(paramId))
+            return paramNotFound(paramId);
+
+        ParamValue value = entry["value"].get<double>();
+        if (!std::isfinite(value)) {
+            return {
+                {"content", {{{"type", "text"}, {"text", "Entry " + std::to_string(i)
+                    + ": invalid value: must be a finite number (not NaN or Infinity)"}}}},
+                {"isError", true}
+            };
+        }
+
+        batch.push_back({paramId, std::clamp(value, 0.0, 1.0)});
+    }
+
+    std::vector<ParamEdit> edits;
+    edits.reserve(batch.size());
+    for (const auto& change : batch)
+        edits.push_back({change.id, ctrl->getParamNormalized(change.id), change.value});
+
+    size_t queued = applyParamBatch(ctrl, cache, hosted, batch);
+
+    mcp::json applied = mcp::json::array();
+    for (size_t i = 0; i < batch.size(); ++i) {
+        edits[i].newValue = ctrl->getParamNormalized(batch[i].id);
+        applied.push_back({{"id", batch[i].id}, {"normalizedValue", edits[i].newValue}});
+    }
+    recordParamEdits(ctrl, cache, history, edits);
+
+    mcp::json result = {
+        {"applied", batch.size()},
+        {"parameters", std::move(applied)}
+    };
+    if (queued < batch.size())
+        result["dropped"] = batch.size() - queued;
+
+    return {
+        {"content", {{{"type", "text"}, {"text", result.dump()}}}}
+    };
+}
+
+// Longest ramp accepted by ramp_parameter (10 minutes).
+constexpr double kMaxRampDurationMs = 600000.0;
+
+// Queue a ramp from the parameter's current value to target over durationMs,
+// executed on the audio thread (see ParamRampEngine). The hosted controller
+// is set to the target right away so the GUI and get_parameter show where
+// the ramp ends up; history, if given, records the jump to the target.
+inline mcp::json handleRampParameter(IEditController* ctrl, ParameterInfoCache& cache,
+                                     HostedPluginInstance& hosted, ParamID paramId, ParamValue target,
+                                     double durationMs, const std::string& curveName = "linear",
+                                     ParamHistory* history = nullptr) {
+    if (!ctrl) {
+        return {
+            {"content", {{{"type", "text"}, {"text", "No hosted plugin loaded"}}}},
+            {"isError", true}
+        };
+    }
+
+    if (!cache.get(ctrl)->contains(paramId))
+        return paramNotFound(paramId);
+
+    if (!std::isfinite(target)) {
+        return {
+            {"content", {{{"type", "text"}, {"text", "Invalid value: must be a finite number (not NaN or Infinity)"}}}},
+            {"isError", true}
+        };
+    }
+
+    if (!std::isfinite(durationMs) || durationMs < 0.0 || durationMs > kMaxRampDurationMs) {
+        return {
+            {"content", {{{"type", "text"}, {"text", "Invalid duration_ms: must be between 0 and "
+                + std::to_string(static_cast<int>(kMaxRampDurationMs))}}}},
+            {"isError", true}
+        };
+    }
+
+    RampCurve curve;
+    if (!parseRampCurve(curveName, curve)) {
+        return {
+            {"content", {{{"type", "text"}, {"text", "Unknown curve '" + curveName
+                + "' (expected linear, ease_in, ease_out or s_curve)"}}}},
+            {"isError", true}
+        };
+    }
+
+    target = std::clamp(target, 0.0, 1.0);
+    ParamValue startValue = ctrl->getParamNormalized(paramId);
+
+    ParamRamp ramp;
+    ramp.id = paramId;
+    ramp.startValue = startValue;
+    ramp.targetValue = target;
+    ramp.durationMs = durationMs;
+    ramp.curve = curve;
+    if (!hosted.pushParamRamp(ramp)) {
+        return {
+            {"content", {{{"type", "text"}, {"text", "Too many pending ramps, try again shortly"}}}},
+            {"isError", true}
+        };
+    }
+
+    ctrl->setParamNormalized(paramId, target);
+    cache.versions().markChanged(paramId);
+    recordParamEdits(ctrl, cache, history, {{paramId, startValue, target}});
+
+    mcp::json result = {
+        {"id", paramId},
+        {"startValue", startValue},
+        {"targetValue", target},
+        {"durationMs", durationMs},
+        {"curve", rampCurveName(curve)}
+    };
 
     return {
         {"content", {{{"type", "text"}, {"text", result.dump(2)}}}}
     };
 }
 
+// ---- Undo history ----
+
+// Longest checkpoint name accepted by checkpoint.
+constexpr size_t kMaxCheckpointNameLength = 64;
+
+inline mcp::json noHostedPlugin() {
+    return {
+        {"content", {{{"type", "text"}, {"text", "No hosted plugin loaded"}}}},
+        {"isError", true}
+    };
+}
+
+// Collapse changes to one per parameter (its last value), in the order the
+// parameters first appear, skipping parameters the plugin no longer has.
+inline std::vector<ParamChange> collapseParamChanges(const std::vector<ParamChange>& changes,
+                                                     const ParameterTable& table) {
+    std::vector<ParamChange> batch;
+    std::unordered_map<ParamID, size_t> indexById;
+    for (const auto& change : changes) {
+        if (!table.contains(change.id))
+            continue;
+        auto [it, inserted] = indexById.emplace(change.id, batch.size());
+        if (inserted)
+            batch.push_back({change.id, change.value});
+        else
+            batch[it->second].value = change.value;
+    }
+    return batch;
+}
+
+inline mcp::json historyResult(const char* countKey, size_t count, IEditController* ctrl,
+                               const std::vector<ParamChange>& batch, size_t queued,
+                               const ParamHistory& history, mcp::json steps) {
+    mcp::json parameters = mcp::json::array();
+    for (const auto& change : batch)
+        parameters.push_back({{"id", change.id}, {"normalizedValue", ctrl->getParamNormalized(change.id)}});
+
+    mcp::json result = {
+        {countKey, count},
+        {"steps", std::move(steps)},
+        {"parameters", std::move(parameters)},
+        {"undoSteps", history.undoSteps()},
+        {"redoSteps", history.redoSteps()}
+    };
+    if (queued < batch.size())
+        result["dropped"] = batch.size() - queued;
+    return {
+        {"content", {{{"type", "text"}, {"text", result.dump()}}}}
+    };
+}
+
+// Undo (redo) up to steps recorded steps and apply the result in one batch.
+// The result lists each step's time and size, and the affected parameters'
+// values.
+inline mcp::json handleUndoRedo(IEditController* ctrl, ParameterInfoCache& cache, HostedPluginInstance& hosted,
+                                ParamHistory& history, bool redo, int steps) {
+    if (!ctrl)
+        return noHostedPlugin();
+    if (steps < 1) {
+        return {
+            {"content", {{{"type", "text"}, {"text", "steps must be at least 1"}}}},
+            {"isError", true}
+        };
+    }
+
+    std::vector<ParamChange> changes;
+    mcp::json stepList = mcp::json::array();
+    size_t done = 0;
+    ParamHistory::Step step;
+    while (done < static_cast<size_t>(steps) && (redo ? history.redo(step) : history.undo(step))) {
+        stepList.push_back({{"timeMs", step.timeMs}, {"changes", step.changes.size()}});
+        changes.insert(changes.end(), step.changes.begin(), step.changes.end());
+        ++done;
+    }
+    if (done == 0) {
+        return {
+            {"content", {{{"type", "text"}, {"text", redo ? "Nothing to redo" : "Nothing to undo"}}}},
+            {"isError", true}
+        };
+    }
+
+    auto batch = collapseParamChanges(changes, *cache.get(ctrl));
+    size_t queued = applyParamBatch(ctrl, cache, hosted, batch);
+    return historyResult(redo ? "redone" : "undone", done, ctrl, batch, queued, history, std::move(stepList));
+}
+
+// Store every parameter's current value under name (generated if empty).
+inline mcp::json handleCheckpoint(IEditController* ctrl, ParameterInfoCache& cache, ParamHistory& history,
+                                  std::string name) {
+    if (!ctrl)
+        return noHostedPlugin();
+    if (name.size() > kMaxCheckpointNameLength) {
+        return {
+            {"content", {{{"type", "text"}, {"text", "Checkpoint name too long (max "
+                + std::to_string(kMaxCheckpointNameLength) + " characters)"}}}},
+            {"isError", true}
+        };
+    }
+    if (name.empty())
+        name = "checkpoint-" + std::to_string(history.checkpointNames().size() + 1);
+
+    auto table = cache.get(ctrl);
+    history.checkpoint(name, snapshotParameters(ctrl, *table));
+
+    mcp::json result = {
+        {"checkpoint", name},
+        {"parameters", table->size()},
+        {"checkpoints", history.checkpointNames()}
+    };
+    return {
+        {"content", {{{"type", "text"}, {"text", result.dump()}}}}
+    };
+}
+
+// Set every parameter that differs from checkpoint name back to its value
+// there, in one batch recorded as one step (so the revert can be undone).
+inline mcp::json handleRevertTo(IEditController* ctrl, ParameterInfoCache& cache, HostedPluginInstance& hosted,
+                                ParamHistory& history, const std::string& name) {
+    if (!ctrl)
+        return noHostedPlugin();
+
+    auto values = history.findCheckpoint(name);
+    if (!values) {
+        mcp::json names = history.checkpointNames();
+        return {
+            {"content", {{{"type", "text"}, {"text", "Unknown checkpoint '" + name + "' (available: "
+                + names.dump() + ")"}}}},
+            {"isError", true}
+        };
+    }
+
+    auto table = cache.get(ctrl);
+    std::vector<ParamChange> batch;
+    std::vector<ParamEdit> edits;
+    for (const auto& [id, value] : *values) {
+        if (!table->contains(id))
+            continue;
+        ParamValue current = ctrl->getParamNormalized(id);
+        if (current == value)
+            continue;
+        batch.push_back({id, value});
+        edits.push_back({id, current, value});
+    }
+
+    size_t queued = batch.empty() ? 0 : applyParamBatch(ctrl, cache, hosted, batch);
+    recordParamEdits(ctrl, cache, &history, edits);
+
+    mcp::json parameters = mcp::json::array();
+    for (const auto& change : batch)
+        parameters.push_back({{"id", change.id}, {"normalizedValue", ctrl->getParamNormalized(change.id)}});
+    mcp::json result = {
+        {"checkpoint", name},
+        {"changed", batch.size()},
+        {"parameters", std::move(parameters)}
+    };
+    if (queued < batch.size())
+        result["dropped"] = batch.size() - queued;
+    return {
+        {"content", {{{"type", "text"}, {"text", result.dump()}}}}
+    };
+}
+
+// ---- Change subscriptions ----
+
+// JSON-RPC notification sent to subscribed sessions.
+inline constexpr const char* kParamChangedNotification = "notifications/parameters/changed";
+
+inline mcp::json paramChangedNotificationParams(const std::vector<ParamUpdate>& updates) {
+    mcp::json list = mcp::json::array();
+    for (const auto& update : updates)
+        list.push_back({{"id", update.id}, {"normalizedValue", update.value}});
+    return {{"parameters", std::move(list)}};
+}
+
+// ids: null/absent for every parameter, otherwise an array of parameter IDs
+// that must exist in the loaded plugin.
+inline mcp::json handleSubscribeParameters(IEditController* ctrl, ParameterInfoCache& cache,
+                                           ParamChangeNotifier& notifier, const std::string& sessionId,
+                                           const mcp::json& ids, int intervalMs) {
+    std::vector<ParamID> paramIds;
+    if (!ids.is_null()) {
+        if (!ids.is_array()) {
+            return {
+                {"content", {{{"type", "text"}, {"text", "ids must be an array of parameter IDs"}}}},
+                {"isError", true}
+            };
+        }
+        if (!ctrl) {
+            return {
+                {"content", {{{"type", "text"}, {"text", "No hosted plugin loaded"}}}},
+                {"isError", true}
+            };
+        }
+
+        auto table = cache.get(ctrl);
+        paramIds.reserve(ids.size());
+        for (const auto& id : ids) {
+            if (!id.is_number_integer() || id.get<int64_t>() < 0
+                || id.get<int64_t>() > static_cast<int64_t>(UINT32_MAX)) {
+                return {
+                    {"content", {{{"type", "text"}, {"text", "Invalid parameter ID " + id.dump()}}}},
+                    {"isError", true}
+                };
+            }
+            auto paramId = id.get<ParamID>();
+            if (!table->contains(paramId))
+                return paramNotFound(paramId);
+            paramIds.push_back(paramId);
+        }
+    }
+
+    int interval = notifier.subscribe(sessionId, paramIds, intervalMs);
+
+    mcp::json result = {
+        {"subscribed", paramIds.empty() ? mcp::json("all") : mcp::json(paramIds)},
+        {"intervalMs", interval},
+        {"notification", kParamChangedNotification}
+    };
+    return {
+        {"content", {{{"type", "text"}, {"text", result.dump()}}}}
+    };
+}
+
+// ids: null/absent to drop the whole subscription.
+inline mcp::json handleUnsubscribeParameters(ParamChangeNotifier& notifier, const std::string& sessionId,
+                                             const mcp::json& ids) {
+    std::vector<ParamID> paramIds;
+    if (!ids.is_null()) {
+        if (!ids.is_array()) {
+            return {
+                {"content", {{{"type", "text"}, {"text", "ids must be an array of parameter IDs"}}}},
+                {"isError", true}
+            };
+        }
+        for (const auto& id : ids) {
+            if (id.is_number_integer() && id.get<int64_t>() >= 0
+                && id.get<int64_t>() <= static_cast<int64_t>(UINT32_MAX))
+                paramIds.push_back(id.get<ParamID>());
+        }
+    }
+
+    // An explicit list with nothing valid in it removes nothing
+    if (ids.is_null() || !paramIds.empty())
+        notifier.unsubscribe(sessionId, paramIds);
+
+    mcp::json result = {{"subscribed", notifier.isSubscribed(sessionId)}};
+    return {
+        {"content", {{{"type", "text"}, {"text", result.dump()}}}}
+    };
+}
+
 } // namespace VST3MCPWrapper
@@ -1,7 +1,12 @@
 #pragma once
 
+#include "instancediscovery.h"
+#include "instancepool.h"
 #include "mcp_message.h"
+#include "pluginjobs.h"
+#include "pluginscan.h"
 
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -19,6 +24,22 @@ inline mcp::json handleGetLoadedPlugin(const std::string& currentPath) {
     };
 }
 
+// Build response for list_instances tool from the discovery file's live
+// entries; the caller's own entry (selfId) is marked with "self": true.
+inline mcp::json handleListInstances(const std::vector<DiscoveredInstance>& instances, const std::string& selfId) {
+    mcp::json list = mcp::json::array();
+    for (const auto& instance : instances) {
+        auto entry = discoveredInstanceToJson(instance);
+        if (instance.id == selfId)
+            entry["self"] = true;
+        list.push_back(std::move(entry));
+    }
+    mcp::json result = {{"instances", std::move(list)}};
+    return {
+        {"content", {{{"type", "text"}, {"text", result.dump()}}}}
+    };
+}
+
 // Build response for list_available_plugins tool.
 // Takes the list of plugin paths (from Module::getModulePaths()).
 inline mcp::json handleListAvailablePlugins(const std::vector<std::string>& paths) {
@@ -31,6 +52,57 @@ inline mcp::json handleListAvailablePlugins(const std::vector<std::string>& path
     };
 }
 
+// Build response for list_available_plugins from the scan index: one object
+// per bundle with its path and, when the bundle ships a moduleinfo.json or
+// was loaded by vst3mcp-scanner, name/vendor/version and the exported
+// classes. Bus layouts and the scanner's outcome are included once known.
+inline mcp::json handleListAvailablePlugins(const std::vector<ScannedPlugin>& plugins) {
+    mcp::json pluginList = mcp::json::array();
+    for (const auto& plugin : plugins) {
+        mcp::json classes = mcp::json::array();
+        for (const auto& cls : plugin.classes) {
+            mcp::json info = {
+                {"cid", cls.cid},
+                {"name", cls.name},
+                {"category", cls.category},
+                {"subCategories", cls.subCategories}
+            };
+            if (!cls.buses.empty()) {
+                mcp::json buses = mcp::json::array();
+                for (const auto& bus : cls.buses) {
+                    buses.push_back({
+                        {"name", bus.name},
+                        {"mediaType", bus.mediaType},
+                        {"direction", bus.direction},
+                        {"busType", bus.busType},
+                        {"channelCount", bus.channelCount}
+                    });
+                }
+                info["buses"] = std::move(buses);
+            }
+            classes.push_back(std::move(info));
+        }
+        mcp::json entry = {
+            {"path", plugin.path},
+            {"name", plugin.name}
+        };
+        if (plugin.hasModuleInfo || plugin.scanStatus == "ok") {
+            entry["vendor"] = plugin.vendor;
+            entry["version"] = plugin.version;
+            entry["classes"] = std::move(classes);
+        }
+        if (!plugin.scanStatus.empty()) {
+            entry["scanStatus"] = plugin.scanStatus;
+            if (!plugin.scanError.empty())
+                entry["scanError"] = plugin.scanError;
+        }
+        pluginList.push_back(std::move(entry));
+    }
+    return {
+        {"content", {{{"type", "text"}, {"text", pluginList.dump(2)}}}}
+    };
+}
+
 // Build response for load_plugin tool after the load operation completes.
 // path: the requested plugin path. error: empty on success, error message on failure.
 inline mcp::json buildLoadPluginResponse(const std::string& path, const std::string& error) {
@@ -64,6 +136,130 @@ inline mcp::json handleUnloadPluginSuccess() {
     };
 }
 
+// JSON view of a load/unload job, as returned by load_plugin, unload_plugin,
+// get_job_status and cancel_job.
+inline mcp::json pluginJobStatusToJson(const PluginJob::Status& status) {
+    mcp::json result = {
+        {"jobId", status.id},
+        {"operation", status.operation},
+        {"state", pluginJobStateName(status.state)},
+        {"phase", pluginJobPhaseName(status.phase)},
+        {"elapsedMs", status.elapsed.count()}
+    };
+    if (!status.path.empty())
+        result["path"] = status.path;
+    if (!status.error.empty())
+        result["error"] = status.error;
+    return result;
+}
+
+// Build response for load_plugin/unload_plugin once the job is queued.
+inline mcp::json buildJobSubmittedResponse(const PluginJob::Status& status) {
+    return {
+        {"content", {{{"type", "text"}, {"text", pluginJobStatusToJson(status).dump(2)}}}}
+    };
+}
+
+inline mcp::json handleUnknownJob(uint64_t jobId) {
+    return {
+        {"content", {{{"type", "text"}, {"text", "Unknown job ID: " + std::to_string(jobId)}}}},
+        {"isError", true}
+    };
+}
+
+// Build response for get_job_status tool.
+inline mcp::json handleGetJobStatus(const PluginJobQueue& jobs, uint64_t jobId) {
+    auto job = jobs.find(jobId);
+    if (!job)
+        return handleUnknownJob(jobId);
+    return {
+        {"content", {{{"type", "text"}, {"text", pluginJobStatusToJson(job->status()).dump(2)}}}}
+    };
+}
+
+// Build response for cancel_job tool. Refusing to cancel (the job already
+// replaced the plugin or finished) is not an error: "cancelled" is false and
+// the status tells why.
+inline mcp::json handleCancelJob(PluginJobQueue& jobs, uint64_t jobId) {
+    auto job = jobs.find(jobId);
+    if (!job)
+        return handleUnknownJob(jobId);
+    bool cancelled = job->requestCancel();
+    mcp::json result = pluginJobStatusToJson(job->status());
+    result["cancelled"] = cancelled;
+    return {
+        {"content", {{{"type", "text"}, {"text", result.dump(2)}}}}
+    };
+}
+
+// JSON view of the warm instance pool: instances kept per plugin and, per
+// plugin, how many component/controller halves are ready.
+inline mcp::json warmPoolStatusToJson(size_t instancesPerPlugin,
+                                      const std::vector<WarmInstancePool::PluginStatus>& plugins) {
+    mcp::json list = mcp::json::array();
+    for (const auto& plugin : plugins) {
+        mcp::json entry = {
+            {"path", plugin.path},
+            {"readyComponents", plugin.components},
+            {"readyControllers", plugin.controllers},
+            {"ready", plugin.components > 0 && plugin.controllers > 0}
+        };
+        if (!plugin.error.empty())
+            entry["error"] = plugin.error;
+        list.push_back(entry);
+    }
+    return {{"instancesPerPlugin", instancesPerPlugin}, {"plugins", list}};
+}
+
+// Build response for configure_warm_pool tool. "paths" replaces the list of
+// plugins kept warm, "instances" the number per plugin; with neither, the
+// pool is only reported.
+inline mcp::json handleConfigureWarmPool(WarmInstancePool& pool, const mcp::json& params) {
+    auto error = [](const std::string& text) -> mcp::json {
+        return {
+            {"content", {{{"type", "text"}, {"text", text}}}},
+            {"isError", true}
+        };
+    };
+
+    bool hasPaths = params.contains("paths") && !params["paths"].is_null();
+    bool hasInstances = params.contains("instances") && !params["instances"].is_null();
+
+    std::vector<std::string> paths;
+    if (hasPaths) {
+        if (!params["paths"].is_array())
+            return error("paths must be an array of plugin paths");
+        for (const auto& path : params["paths"]) {
+            if (!path.is_string())
+                return error("paths must be an array of plugin paths");
+            paths.push_back(path.get<std::string>());
+        }
+        if (paths.size() > WarmInstancePool::kMaxPlugins)
+            return error("At most " + std::to_string(WarmInstancePool::kMaxPlugins) + " plugins can be kept warm");
+    } else {
+        for (const auto& plugin : pool.status())
+            paths.push_back(plugin.path);
+    }
+
+    size_t instances = pool.instancesPerPlugin();
+    if (hasInstances) {
+        const auto& value = params["instances"];
+        double requested = value.is_number() ? value.get<double>() : 0.0;
+        if (requested < 1 || requested > WarmInstancePool::kMaxInstancesPerPlugin || requested != std::floor(requested))
+            return error("instances must be a whole number from 1 to "
+                         + std::to_string(WarmInstancePool::kMaxInstancesPerPlugin));
+        instances = static_cast<size_t>(requested);
+    }
+
+    if (hasPaths || hasInstances)
+        pool.configure(paths, instances);
+
+    mcp::json result = warmPoolStatusToJson(pool.instancesPerPlugin(), pool.status());
+    return {
+        {"content", {{{"type", "text"}, {"text", result.dump(2)}}}}
+    };
+}
+
 // Build error response when the plugin is shutting down.
 inline mcp::json handleShuttingDown() {
     return {
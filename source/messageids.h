@@ -7,5 +7,15 @@ constexpr const char* kLoadPlugin = "LoadPlugin";
 constexpr const char* kUnloadPlugin = "UnloadPlugin";
 constexpr const char* kPluginLoaded = "PluginLoaded";
 
+// Processor -> controller when "path" (binary) couldn't be loaded. The
+// processor has pointed the shared HostedPluginInstance back at the plugin
+// it kept playing (a failed hot swap), or unloaded it.
+constexpr const char* kPluginLoadFailed = "PluginLoadFailed";
+
+// Processor -> controller, on connect and when setState() restores another
+// ID: "id" (binary) names the InstanceRegistry entry holding the processor's
+// HostedPluginInstance, which the controller then shares.
+constexpr const char* kInstanceId = "InstanceID";
+
 } // namespace MessageIds
 } // namespace VST3MCPWrapper
@@ -0,0 +1,309 @@
+#include "modulecache.h"
+#include "logging.h"
+
+#include "pluginterfaces/vst/ivstaudioprocessor.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace VST3MCPWrapper {
+
+ModuleCache& ModuleCache::shared() {
+    static ModuleCache cache;
+    return cache;
+}
+
+ModuleCache::ModuleCache() : ModuleCache(Limits()) {}
+
+ModuleCache::ModuleCache(Limits limits, Opener opener, SizeEstimator estimator, ClassReader reader)
+    : opener_(opener ? std::move(opener)
+                     : Opener([](const std::string& path, std::string& error) {
+                           return VST3::Hosting::Module::create(path, error);
+                       })),
+      estimator_(estimator ? std::move(estimator) : SizeEstimator(&ModuleCache::estimateModuleSize)),
+      reader_(reader ? std::move(reader)
+                     : ClassReader([](const VST3::Hosting::Module& module) {
+                           return module.getFactory().classInfos();
+                       })),
+      limits_(limits)
+{
+}
+
+ModuleCache::~ModuleCache() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopping_ = true;
+    prefetchersDone_.wait(lock, [this] { return prefetchers_ == 0; });
+}
+
+VST3::Hosting::Module::Ptr ModuleCache::acquire(const std::string& path, std::string& error) {
+    std::list<Entry> evicted; // Released after unlocking
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // Queued for prefetch but not started yet: open it right here
+        // instead of waiting for a prefetch thread (the miss is counted)
+        auto queued = std::find(prefetchQueue_.begin(), prefetchQueue_.end(), path);
+        if (queued != prefetchQueue_.end()) {
+            prefetchQueue_.erase(queued);
+            lock.unlock();
+            return open(path, error, false);
+        }
+        // Being opened by another caller or a prefetch: use that module
+        openDone_.wait(lock, [this, &path] { return !opening_.count(path); });
+
+        // A prefetched module is the caller's now; keep it alive until
+        // they hold it
+        VST3::Hosting::Module::Ptr held;
+        if (auto prefetched = prefetched_.find(path); prefetched != prefetched_.end()) {
+            held = std::move(prefetched->second);
+            prefetched_.erase(prefetched);
+        }
+        auto it = std::find_if(entries_.begin(), entries_.end(),
+                               [&path](const Entry& entry) { return entry.path == path; });
+        if (it != entries_.end()) {
+            entries_.splice(entries_.begin(), entries_, it);
+            ++hits_;
+            return it->module;
+        }
+        // Evicted, but other instances still use it: share theirs
+        auto live = live_.find(path);
+        if (live != live_.end()) {
+            if (auto module = live->second.module.lock()) {
+                ++hits_;
+                ++shared_;
+                insertEntry(path, module, live->second.bytes, evicted);
+                return module;
+            }
+            live_.erase(live);
+        }
+        ++misses_;
+        opening_.insert(path);
+    }
+    return open(path, error, false);
+}
+
+void ModuleCache::prefetch(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || opening_.count(path))
+        return;
+    if (std::any_of(entries_.begin(), entries_.end(), [&path](const Entry& entry) { return entry.path == path; }))
+        return;
+    auto live = live_.find(path);
+    if (live != live_.end() && !live->second.module.expired())
+        return;
+
+    ++misses_;
+    ++prefetches_;
+    opening_.insert(path);
+    prefetchQueue_.push_back(path);
+
+    size_t maxThreads = limits_.prefetchThreads;
+    if (maxThreads == 0)
+        maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (prefetchers_ < maxThreads) {
+        ++prefetchers_;
+        std::thread([this]() { runPrefetch(); }).detach();
+    }
+}
+
+void ModuleCache::runPrefetch() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_ && !prefetchQueue_.empty()) {
+        std::string path = std::move(prefetchQueue_.front());
+        prefetchQueue_.pop_front();
+        lock.unlock();
+
+        std::string error;
+        if (auto module = open(path, error, true))
+            classes(module); // Read here too rather than on the host thread
+        else
+            WRAPPER_LOG_ERROR("Prefetching %s failed: %s", path.c_str(), error.c_str());
+
+        lock.lock();
+    }
+    if (--prefetchers_ == 0)
+        prefetchersDone_.notify_all();
+}
+
+VST3::Hosting::Module::Ptr ModuleCache::open(const std::string& path, std::string& error, bool hold) {
+    // Open without the lock: loading a binary can take seconds
+    VST3::Hosting::Module::Ptr module;
+    try {
+        module = opener_(path, error);
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    uint64_t bytes = module ? estimator_(path) : 0;
+
+    std::list<Entry> evicted;
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Nobody else opens path while it is in opening_, so there is no entry
+    // to reconcile with
+    opening_.erase(path);
+    openDone_.notify_all();
+    if (!module)
+        return nullptr;
+    pruneLive();
+    live_[path] = {module, nullptr, bytes};
+    insertEntry(path, module, bytes, evicted);
+    if (hold)
+        prefetched_[path] = module;
+    return module;
+}
+
+std::shared_ptr<const ModuleClasses> ModuleCache::classes(const VST3::Hosting::Module::Ptr& module) {
+    if (!module)
+        return std::make_shared<const ModuleClasses>();
+
+    auto findLive = [this, &module]() -> Live* {
+        // Caller must hold mutex_
+        for (auto& [path, live] : live_) {
+            if (live.module.lock() == module)
+                return &live;
+        }
+        return nullptr;
+    };
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto* live = findLive(); live && live->classes)
+            return live->classes;
+    }
+
+    // Read without the lock: the factory calls into the plugin
+    auto read = std::make_shared<ModuleClasses>();
+    read->classes = reader_(*module);
+    for (const auto& info : read->classes) {
+        if (info.category() == kVstAudioEffectClass) {
+            read->hasAudioEffect = true;
+            read->audioEffectClassID = info.ID();
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto* live = findLive();
+    if (!live)
+        return read;
+    if (!live->classes)
+        live->classes = std::move(read);
+    return live->classes;
+}
+
+bool ModuleCache::contains(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::any_of(entries_.begin(), entries_.end(),
+                       [&path](const Entry& entry) { return entry.path == path; });
+}
+
+void ModuleCache::evict(const std::string& path) {
+    std::list<Entry> evicted;
+    VST3::Hosting::Module::Ptr prefetched;
+    std::lock_guard<std::mutex> lock(mutex_);
+    live_.erase(path);
+    if (auto held = prefetched_.find(path); held != prefetched_.end()) {
+        prefetched = std::move(held->second);
+        prefetched_.erase(held);
+    }
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [&path](const Entry& entry) { return entry.path == path; });
+    if (it == entries_.end())
+        return;
+    bytes_ -= it->bytes;
+    ++evictions_;
+    evicted.splice(evicted.end(), entries_, it);
+}
+
+void ModuleCache::clear() {
+    std::list<Entry> evicted;
+    std::unordered_map<std::string, VST3::Hosting::Module::Ptr> prefetched;
+    std::lock_guard<std::mutex> lock(mutex_);
+    prefetched.swap(prefetched_);
+    evictions_ += entries_.size();
+    bytes_ = 0;
+    evicted.swap(entries_);
+}
+
+void ModuleCache::setLimits(const Limits& limits) {
+    std::list<Entry> evicted;
+    std::lock_guard<std::mutex> lock(mutex_);
+    limits_ = limits;
+    enforceLimits(evicted);
+}
+
+ModuleCache::Limits ModuleCache::limits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limits_;
+}
+
+ModuleCache::Stats ModuleCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.modules = entries_.size();
+    stats.bytes = bytes_;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.live = std::count_if(live_.begin(), live_.end(),
+                               [](const auto& entry) { return !entry.second.module.expired(); });
+    stats.shared = shared_;
+    stats.prefetches = prefetches_;
+    stats.prefetched = prefetched_.size();
+    return stats;
+}
+
+void ModuleCache::pruneLive() {
+    // Caller must hold mutex_
+    for (auto it = live_.begin(); it != live_.end();) {
+        if (it->second.module.expired())
+            it = live_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void ModuleCache::insertEntry(const std::string& path, VST3::Hosting::Module::Ptr module, uint64_t bytes,
+                              std::list<Entry>& evicted) {
+    // Caller must hold mutex_
+    entries_.push_front({path, std::move(module), bytes});
+    bytes_ += bytes;
+    enforceLimits(evicted);
+}
+
+void ModuleCache::enforceLimits(std::list<Entry>& evicted) {
+    // Caller must hold mutex_
+    while (entries_.size() > 1
+           && (entries_.size() > limits_.maxModules || bytes_ > limits_.maxBytes)) {
+        auto last = std::prev(entries_.end());
+        WRAPPER_LOG("Evicting cached module: %s", last->path.c_str());
+        bytes_ -= last->bytes;
+        ++evictions_;
+        evicted.splice(evicted.end(), entries_, last);
+    }
+}
+
+uint64_t ModuleCache::estimateModuleSize(const std::string& path) {
+    std::error_code ec;
+    fs::path bundle(path);
+    if (fs::is_regular_file(bundle, ec))
+        return fs::file_size(bundle, ec);
+
+    fs::path contents = bundle / "Contents";
+    uint64_t total = 0;
+    for (fs::recursive_directory_iterator it(contents, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_directory(ec) && it->path().filename() == "Resources") {
+            it.disable_recursion_pending();
+            continue;
+        }
+        std::error_code sizeEc;
+        if (it->is_regular_file(sizeEc)) {
+            auto size = it->file_size(sizeEc);
+            if (!sizeEc)
+                total += size;
+        }
+    }
+    return total;
+}
+
+} // namespace VST3MCPWrapper
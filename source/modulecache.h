@@ -0,0 +1,182 @@
+#pragma once
+
+#include "public.sdk/source/vst/hosting/module.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// A module's class list, read from its factory once and shared by every
+// instance of the plugin.
+struct ModuleClasses {
+    VST3::Hosting::PluginFactory::ClassInfos classes;
+    bool hasAudioEffect = false;
+    VST3::UID audioEffectClassID; // First kVstAudioEffectClass, if any
+};
+
+// LRU cache of opened plugin modules, keyed by bundle path.
+//
+// Opening a module means loading the binary and running its static
+// initializers, so switching back and forth between two plugins would pay
+// that cost on every switch. acquire() hands out the cached module instead
+// when the bundle was opened recently.
+//
+// Modules are reference counted (Module::Ptr): evicting an entry only drops
+// the cache's reference, so a module still used by a hosted instance stays
+// loaded until that instance is gone. The budget counts cached modules and
+// their estimated size (the bundle's binaries on disk); the least recently
+// used entries are evicted once either limit is exceeded. The most recently
+// acquired module is never evicted, even if it alone exceeds the budget.
+//
+// Besides the LRU entries, the cache tracks every module it handed out that
+// is still in use (weak references). acquire() returns such a module even
+// after it was evicted or clear()ed, so any number of instances of one
+// plugin share one loaded binary and one factory rather than opening the
+// bundle again. classes() likewise reads a module's class list once.
+//
+// prefetch() opens bundles ahead of acquire() on a pool of background
+// threads, so restoring a session with many plugins opens their bundles in
+// parallel rather than one after another on the host thread. A bundle is
+// only ever opened once at a time: acquire() waits for an open already in
+// progress, and opens a bundle that is still queued for prefetch itself.
+// Prefetched modules are held until acquired, so the budget can't evict
+// them first.
+//
+// All public methods are thread-safe. Modules are opened without holding
+// the cache lock, so a slow open never blocks lookups of other bundles.
+class ModuleCache {
+public:
+    using Opener = std::function<VST3::Hosting::Module::Ptr(const std::string& path, std::string& error)>;
+    using SizeEstimator = std::function<uint64_t(const std::string& path)>;
+    using ClassReader = std::function<VST3::Hosting::PluginFactory::ClassInfos(const VST3::Hosting::Module& module)>;
+
+    struct Limits {
+        size_t maxModules = 8;
+        uint64_t maxBytes = uint64_t(1) << 30;
+        size_t prefetchThreads = 0; // 0: one per hardware thread
+    };
+
+    struct Stats {
+        size_t modules = 0;
+        uint64_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t live = 0;     // Modules handed out and still in use, cached or not
+        uint64_t shared = 0; // Hits on an in-use module that was no longer cached
+        uint64_t prefetches = 0; // Opens started by prefetch()
+        size_t prefetched = 0;   // Prefetched modules not acquired yet
+    };
+
+    // Process-wide cache used by HostedPluginInstance and load_plugin.
+    static ModuleCache& shared();
+
+    // Empty opener/estimator/reader use Module::create(),
+    // estimateModuleSize() and the module factory's classInfos().
+    ModuleCache();
+    explicit ModuleCache(Limits limits, Opener opener = {}, SizeEstimator estimator = {}, ClassReader reader = {});
+
+    ~ModuleCache(); // Waits for prefetches in progress
+
+    ModuleCache(const ModuleCache&) = delete;
+    ModuleCache& operator=(const ModuleCache&) = delete;
+
+    // The module for path: cached or still in use if present, else opened
+    // and cached. Returns nullptr with error set if the bundle can't be opened.
+    VST3::Hosting::Module::Ptr acquire(const std::string& path, std::string& error);
+
+    // Start opening path and reading its class list in the background,
+    // unless it is cached, in use or already being opened. Failures are only
+    // logged; acquire() tries again and reports them.
+    void prefetch(const std::string& path);
+
+    // Class list of module, read on first request for a module acquired
+    // here and shared while it is in use. Other modules are read every time.
+    // Never null.
+    std::shared_ptr<const ModuleClasses> classes(const VST3::Hosting::Module::Ptr& module);
+
+    // Whether path is cached, without opening it or touching LRU order.
+    bool contains(const std::string& path) const;
+
+    // Drop one entry (e.g. after the bundle changed on disk) or all of them.
+    // evict() also stops sharing the module in use for path; clear() keeps
+    // in-use modules shared. Both drop prefetched modules not acquired yet.
+    void evict(const std::string& path);
+    void clear();
+
+    // Applying tighter limits evicts right away.
+    void setLimits(const Limits& limits);
+    Limits limits() const;
+
+    Stats stats() const;
+
+    // Size on disk of the bundle's binaries: every file under Contents/
+    // except Resources/, or the file itself for a single-file module.
+    static uint64_t estimateModuleSize(const std::string& path);
+
+private:
+    struct Entry {
+        std::string path;
+        VST3::Hosting::Module::Ptr module;
+        uint64_t bytes = 0;
+    };
+
+    // A module handed out by acquire(), for as long as anyone holds it
+    struct Live {
+        std::weak_ptr<VST3::Hosting::Module> module;
+        std::shared_ptr<const ModuleClasses> classes; // Read on first classes()
+        uint64_t bytes = 0;
+    };
+
+    // Caller must hold mutex_. Evicted entries are moved to evicted so their
+    // modules are released (possibly unloading the binary) after unlocking.
+    void enforceLimits(std::list<Entry>& evicted);
+    // Caller must hold mutex_. Drops live entries whose module is gone.
+    void pruneLive();
+    // Caller must hold mutex_. Puts module at the front of the LRU list.
+    void insertEntry(const std::string& path, VST3::Hosting::Module::Ptr module, uint64_t bytes,
+                     std::list<Entry>& evicted);
+    // Open path, which the caller added to opening_, and cache the result.
+    // hold keeps the module in prefetched_. Called without mutex_ held.
+    VST3::Hosting::Module::Ptr open(const std::string& path, std::string& error, bool hold);
+    // Prefetch thread: opens queued bundles until the queue is empty
+    void runPrefetch();
+
+    const Opener opener_;
+    const SizeEstimator estimator_;
+    const ClassReader reader_;
+
+    mutable std::mutex mutex_;
+    Limits limits_;
+    std::list<Entry> entries_; // Most recently used first
+    std::unordered_map<std::string, Live> live_;
+    uint64_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+    uint64_t shared_ = 0;
+
+    // Bundles being opened by acquire() or a prefetch thread; openDone_ is
+    // signalled when one finishes
+    std::unordered_set<std::string> opening_;
+    std::condition_variable openDone_;
+
+    std::deque<std::string> prefetchQueue_; // Also in opening_
+    std::unordered_map<std::string, VST3::Hosting::Module::Ptr> prefetched_;
+    size_t prefetchers_ = 0; // Running prefetch threads (detached)
+    std::condition_variable prefetchersDone_;
+    uint64_t prefetches_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace VST3MCPWrapper
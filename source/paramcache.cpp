@@ -0,0 +1,103 @@
+#include "paramcache.h"
+#include "hostedplugin.h"
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace VST3MCPWrapper {
+
+// ---- ParameterTable ----
+
+std::shared_ptr<const ParameterTable> ParameterTable::build(IEditController* ctrl) {
+    auto table = std::make_shared<ParameterTable>();
+
+    int32 count = ctrl->getParameterCount();
+    if (count > 0) {
+        table->parameters_.reserve(static_cast<size_t>(count));
+        table->indexById_.reserve(static_cast<size_t>(count));
+    }
+
+    for (int32 i = 0; i < count; ++i) {
+        ParameterInfo info = {};
+        if (ctrl->getParameterInfo(i, info) != kResultOk)
+            continue;
+        // First occurrence wins, matching the linear scan this replaces
+        if (!table->indexById_.emplace(info.id, table->parameters_.size()).second)
+            continue;
+        table->parameters_.push_back({info, i, utf16ToUtf8(info.title), utf16ToUtf8(info.units)});
+    }
+
+    return table;
+}
+
+const CachedParameter* ParameterTable::find(ParamID id) const {
+    auto it = indexById_.find(id);
+    return it != indexById_.end() ? &parameters_[it->second] : nullptr;
+}
+
+// ---- ParamChangeTracker ----
+
+uint64_t ParamChangeTracker::markChanged(ParamID id) {
+    return markChanged(&id, 1);
+}
+
+uint64_t ParamChangeTracker::markChanged(const ParamID* ids, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++version_;
+    for (size_t i = 0; i < count; ++i)
+        versions_[ids[i]] = version_;
+    return version_;
+}
+
+uint64_t ParamChangeTracker::markAllChanged() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    allChangedVersion_ = ++version_;
+    versions_.clear(); // Every stamp is now older than allChangedVersion_
+    return version_;
+}
+
+uint64_t ParamChangeTracker::currentVersion() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return version_;
+}
+
+ParamChangeTracker::Delta ParamChangeTracker::changesSince(uint64_t sinceVersion) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Delta delta;
+    delta.version = version_;
+    // A version from the future was handed out by an earlier tracker (the
+    // wrapper restarted or the project was reloaded): nothing it covered is known
+    delta.all = sinceVersion < allChangedVersion_ || sinceVersion > version_;
+    if (!delta.all) {
+        for (const auto& [id, version] : versions_) {
+            if (version > sinceVersion)
+                delta.changed.emplace(id, version);
+        }
+    }
+    return delta;
+}
+
+// ---- ParameterInfoCache ----
+
+std::shared_ptr<const ParameterTable> ParameterInfoCache::get(IEditController* ctrl) {
+    if (!ctrl)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!table_ || builtFor_ != ctrl) {
+        table_ = ParameterTable::build(ctrl);
+        builtFor_ = ctrl;
+    }
+    return table_;
+}
+
+void ParameterInfoCache::invalidate() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        table_.reset();
+        builtFor_ = nullptr;
+    }
+    versions_.markAllChanged();
+}
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "pluginterfaces/vst/ivsteditcontroller.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// One hosted parameter's static metadata, with strings already converted to UTF-8.
+struct CachedParameter {
+    Steinberg::Vst::ParameterInfo info;
+    Steinberg::int32 index; // Index passed to getParameterInfo()
+    std::string title;
+    std::string units;
+};
+
+// Immutable snapshot of a hosted controller's parameter list with an
+// O(1) ParamID lookup. Values are not cached — they change constantly and
+// are read live from the controller.
+class ParameterTable {
+public:
+    // Walks getParameterCount()/getParameterInfo() once. ctrl must not be null.
+    static std::shared_ptr<const ParameterTable> build(Steinberg::Vst::IEditController* ctrl);
+
+    const std::vector<CachedParameter>& parameters() const { return parameters_; }
+    size_t size() const { return parameters_.size(); }
+
+    // nullptr if the plugin has no parameter with this ID.
+    const CachedParameter* find(Steinberg::Vst::ParamID id) const;
+    bool contains(Steinberg::Vst::ParamID id) const { return find(id) != nullptr; }
+
+private:
+    std::vector<CachedParameter> parameters_;
+    std::unordered_map<Steinberg::Vst::ParamID, size_t> indexById_;
+};
+
+// Change versions for the hosted plugin's parameter values.
+//
+// A global counter is bumped on every recorded change and stamped on the
+// parameter that changed, so clients can ask for "everything that changed
+// after version N" instead of re-reading the whole list. Events that may
+// have touched any parameter (state loads, plugin reload, the hosted plugin
+// reporting kParamValuesChanged) mark everything as changed.
+//
+// Versions start at 1; asking for changes since 0, or since a version newer
+// than the current one (from before a restart), returns everything.
+// Thread-safe.
+class ParamChangeTracker {
+public:
+    // Record a change and return the new version.
+    uint64_t markChanged(Steinberg::Vst::ParamID id);
+    uint64_t markChanged(const Steinberg::Vst::ParamID* ids, size_t count);
+    uint64_t markAllChanged();
+
+    uint64_t currentVersion() const;
+
+    struct Delta {
+        uint64_t version = 0;     // Pass this as sinceVersion next time
+        bool all = false;         // Every parameter counts as changed
+        std::unordered_map<Steinberg::Vst::ParamID, uint64_t> changed; // Only when !all
+    };
+    Delta changesSince(uint64_t sinceVersion) const;
+
+private:
+    mutable std::mutex mutex_;
+    uint64_t version_ = 1;
+    uint64_t allChangedVersion_ = 1;
+    std::unordered_map<Steinberg::Vst::ParamID, uint64_t> versions_;
+};
+
+// Per-load cache of the hosted controller's ParameterTable, plus the value
+// change versions of its parameters.
+//
+// Built lazily on first use and reused until invalidate() — the Controller
+// invalidates it when a plugin is loaded or unloaded and when the hosted
+// plugin calls restartComponent() with kParamTitlesChanged or
+// kReloadComponent. Asking for a different controller than the one the
+// table was built from also rebuilds it.
+//
+// Thread-safe. Callers keep the returned snapshot alive while they use it,
+// so an invalidation never pulls a table out from under a running handler.
+class ParameterInfoCache {
+public:
+    // Returns nullptr if ctrl is null.
+    std::shared_ptr<const ParameterTable> get(Steinberg::Vst::IEditController* ctrl);
+
+    // Also marks every parameter value as changed (see ParamChangeTracker).
+    void invalidate();
+
+    // Value change versions for the same controller, used by list_parameters
+    // deltas. Not reset by invalidate() so versions stay monotonic.
+    ParamChangeTracker& versions() { return versions_; }
+
+private:
+    ParamChangeTracker versions_;
+    std::mutex mutex_;
+    std::shared_ptr<const ParameterTable> table_;
+    // Identity only, never dereferenced. Reloads invalidate explicitly, so a
+    // new controller reusing a freed address cannot pick up a stale table.
+    const Steinberg::Vst::IEditController* builtFor_ = nullptr;
+};
+
+} // namespace VST3MCPWrapper
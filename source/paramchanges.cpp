@@ -0,0 +1,114 @@
+#include "paramchanges.h"
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace VST3MCPWrapper {
+
+// ---- PreallocatedParamValueQueue ----
+
+void PreallocatedParamValueQueue::allocate(int32 maxPoints) {
+    maxPoints_ = maxPoints > 0 ? static_cast<size_t>(maxPoints) : 0;
+    points_.clear();
+    points_.reserve(maxPoints_);
+}
+
+void PreallocatedParamValueQueue::reset(ParamID id) {
+    paramId_ = id;
+    points_.clear();
+}
+
+int32 PLUGIN_API PreallocatedParamValueQueue::getPointCount() {
+    return static_cast<int32>(points_.size());
+}
+
+tresult PLUGIN_API PreallocatedParamValueQueue::getPoint(int32 index, int32& sampleOffset, ParamValue& value) {
+    if (index < 0 || index >= static_cast<int32>(points_.size()))
+        return kResultFalse;
+    sampleOffset = points_[index].sampleOffset;
+    value = points_[index].value;
+    return kResultTrue;
+}
+
+tresult PLUGIN_API PreallocatedParamValueQueue::addPoint(int32 sampleOffset, ParamValue value, int32& index) {
+    size_t dest = points_.size();
+    for (size_t i = 0; i < points_.size(); ++i) {
+        if (points_[i].sampleOffset == sampleOffset) {
+            points_[i].value = value;
+            index = static_cast<int32>(i);
+            return kResultTrue;
+        }
+        if (points_[i].sampleOffset > sampleOffset) {
+            dest = i;
+            break;
+        }
+    }
+
+    // Never grow past the reserved capacity — that would allocate on the audio thread
+    if (points_.size() >= maxPoints_)
+        return kResultFalse;
+
+    points_.insert(points_.begin() + static_cast<std::ptrdiff_t>(dest), Point{sampleOffset, value});
+    index = static_cast<int32>(dest);
+    return kResultTrue;
+}
+
+tresult PLUGIN_API PreallocatedParamValueQueue::queryInterface(const TUID iid, void** obj) {
+    if (FUnknownPrivate::iidEqual(iid, IParamValueQueue::iid) ||
+        FUnknownPrivate::iidEqual(iid, FUnknown::iid)) {
+        *obj = static_cast<IParamValueQueue*>(this);
+        return kResultOk;
+    }
+    *obj = nullptr;
+    return kNoInterface;
+}
+
+// ---- PreallocatedParameterChanges ----
+
+void PreallocatedParameterChanges::allocate(int32 maxParameters, int32 maxPointsPerParameter) {
+    if (maxParameters < 0)
+        maxParameters = 0;
+    if (maxParameters == getMaxParameters() && maxPointsPerParameter == maxPointsPerParameter_)
+        return;
+
+    queues_.resize(static_cast<size_t>(maxParameters));
+    for (auto& queue : queues_)
+        queue.allocate(maxPointsPerParameter);
+    maxPointsPerParameter_ = maxPointsPerParameter;
+    usedCount_ = 0;
+}
+
+IParamValueQueue* PLUGIN_API PreallocatedParameterChanges::getParameterData(int32 index) {
+    if (index < 0 || index >= usedCount_)
+        return nullptr;
+    return &queues_[index];
+}
+
+IParamValueQueue* PLUGIN_API PreallocatedParameterChanges::addParameterData(const ParamID& id, int32& index) {
+    for (int32 i = 0; i < usedCount_; ++i) {
+        if (queues_[i].getParameterId() == id) {
+            index = i;
+            return &queues_[i];
+        }
+    }
+
+    if (usedCount_ >= getMaxParameters())
+        return nullptr;
+
+    auto& queue = queues_[usedCount_];
+    queue.reset(id);
+    index = usedCount_++;
+    return &queue;
+}
+
+tresult PLUGIN_API PreallocatedParameterChanges::queryInterface(const TUID iid, void** obj) {
+    if (FUnknownPrivate::iidEqual(iid, IParameterChanges::iid) ||
+        FUnknownPrivate::iidEqual(iid, FUnknown::iid)) {
+        *obj = static_cast<IParameterChanges*>(this);
+        return kResultOk;
+    }
+    *obj = nullptr;
+    return kNoInterface;
+}
+
+} // namespace VST3MCPWrapper
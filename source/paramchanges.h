@@ -0,0 +1,85 @@
+#pragma once
+
+#include "pluginterfaces/vst/ivstparameterchanges.h"
+
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// IParamValueQueue with storage reserved up front.
+// addPoint() never allocates: once the queue holds maxPoints points, further
+// points at new sample offsets are rejected with kResultFalse.
+// Points are kept sorted by sample offset; adding a point at an existing
+// offset replaces its value (same semantics as the SDK's ParameterValueQueue).
+class PreallocatedParamValueQueue : public Steinberg::Vst::IParamValueQueue {
+public:
+    // Reserve storage for maxPoints points. Allocates — call off the audio thread.
+    void allocate(Steinberg::int32 maxPoints);
+
+    // Reuse the queue for a new parameter. Real-time safe.
+    void reset(Steinberg::Vst::ParamID id);
+
+    // IParamValueQueue
+    Steinberg::Vst::ParamID PLUGIN_API getParameterId() override { return paramId_; }
+    Steinberg::int32 PLUGIN_API getPointCount() override;
+    Steinberg::tresult PLUGIN_API getPoint(Steinberg::int32 index, Steinberg::int32& sampleOffset,
+                                           Steinberg::Vst::ParamValue& value) override;
+    Steinberg::tresult PLUGIN_API addPoint(Steinberg::int32 sampleOffset, Steinberg::Vst::ParamValue value,
+                                           Steinberg::int32& index) override;
+
+    // FUnknown — lifetime is owned by PreallocatedParameterChanges, so
+    // reference counting is a no-op.
+    Steinberg::tresult PLUGIN_API queryInterface(const Steinberg::TUID iid, void** obj) override;
+    Steinberg::uint32 PLUGIN_API addRef() override { return 1; }
+    Steinberg::uint32 PLUGIN_API release() override { return 1; }
+
+private:
+    struct Point {
+        Steinberg::int32 sampleOffset;
+        Steinberg::Vst::ParamValue value;
+    };
+
+    Steinberg::Vst::ParamID paramId_ = Steinberg::Vst::kNoParamId;
+    std::vector<Point> points_;
+    size_t maxPoints_ = 0;
+};
+
+// IParameterChanges backed by a fixed pool of PreallocatedParamValueQueues.
+// Used by Processor::process() to merge DAW automation with queued MCP/GUI
+// changes without touching the heap on the audio thread: allocate() sizes the
+// pool once, clear() resets it per block. addParameterData() returns nullptr
+// when all queues are in use.
+//
+// Owned by value — the COM reference count is a no-op, so the object must
+// outlive every process() call it is passed to (the hosted plugin must not
+// retain it beyond the call, as required by the VST3 spec).
+class PreallocatedParameterChanges : public Steinberg::Vst::IParameterChanges {
+public:
+    // Size the pool. Allocates — call off the audio thread.
+    // No-op if the pool already has exactly this shape.
+    void allocate(Steinberg::int32 maxParameters, Steinberg::int32 maxPointsPerParameter);
+
+    // Drop all queued parameters. Real-time safe.
+    void clear() { usedCount_ = 0; }
+
+    Steinberg::int32 getMaxParameters() const { return static_cast<Steinberg::int32>(queues_.size()); }
+    Steinberg::int32 getMaxPointsPerParameter() const { return maxPointsPerParameter_; }
+
+    // IParameterChanges
+    Steinberg::int32 PLUGIN_API getParameterCount() override { return usedCount_; }
+    Steinberg::Vst::IParamValueQueue* PLUGIN_API getParameterData(Steinberg::int32 index) override;
+    Steinberg::Vst::IParamValueQueue* PLUGIN_API addParameterData(const Steinberg::Vst::ParamID& id,
+                                                                  Steinberg::int32& index) override;
+
+    // FUnknown — owned by value, reference counting is a no-op.
+    Steinberg::tresult PLUGIN_API queryInterface(const Steinberg::TUID iid, void** obj) override;
+    Steinberg::uint32 PLUGIN_API addRef() override { return 1; }
+    Steinberg::uint32 PLUGIN_API release() override { return 1; }
+
+private:
+    std::vector<PreallocatedParamValueQueue> queues_;
+    Steinberg::int32 usedCount_ = 0;
+    Steinberg::int32 maxPointsPerParameter_ = 0;
+};
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,174 @@
+#include "paramhistory.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace VST3MCPWrapper {
+
+ParamHistory::ParamHistory(size_t capacity) : entries_(std::max<size_t>(capacity, 1)) {}
+
+void ParamHistory::record(const std::vector<ParamEdit>& edits) {
+    size_t count = static_cast<size_t>(std::count_if(edits.begin(), edits.end(), [](const ParamEdit& edit) {
+        return edit.oldValue != edit.newValue;
+    }));
+    if (count == 0)
+        return;
+
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_ = applied_; // A new step ends the redo branch
+    if (count > entries_.size()) {
+        begin_ = size_ = applied_ = 0;
+        return;
+    }
+    while (entries_.size() - size_ < count)
+        dropOldestStep();
+
+    bool first = true;
+    for (const auto& edit : edits) {
+        if (edit.oldValue == edit.newValue)
+            continue;
+        at(size_++) = {edit.id, first, edit.oldValue, edit.newValue, now};
+        first = false;
+    }
+    applied_ = size_;
+    ++stepsSinceSnapshot_;
+}
+
+void ParamHistory::dropOldestStep() {
+    // Caller must hold mutex_
+    size_t dropped = 1;
+    while (dropped < size_ && !at(dropped).startsStep)
+        ++dropped;
+    begin_ = (begin_ + dropped) % entries_.size();
+    size_ -= dropped;
+    applied_ = applied_ > dropped ? applied_ - dropped : 0;
+}
+
+bool ParamHistory::undo(Step& step) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    step = {};
+    if (applied_ == 0)
+        return false;
+
+    size_t start = applied_ - 1;
+    while (start > 0 && !at(start).startsStep)
+        --start;
+    // Reverse order, so a parameter set twice in one step ends at its first old value
+    for (size_t i = applied_; i-- > start;)
+        step.changes.push_back({at(i).id, at(i).oldValue});
+    step.timeMs = at(start).timeMs;
+    applied_ = start;
+    return true;
+}
+
+bool ParamHistory::redo(Step& step) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    step = {};
+    if (applied_ == size_)
+        return false;
+
+    size_t end = applied_ + 1;
+    while (end < size_ && !at(end).startsStep)
+        ++end;
+    for (size_t i = applied_; i < end; ++i)
+        step.changes.push_back({at(i).id, at(i).newValue});
+    step.timeMs = at(applied_).timeMs;
+    applied_ = end;
+    return true;
+}
+
+size_t ParamHistory::countSteps(size_t from, size_t to) const {
+    // Caller must hold mutex_
+    size_t steps = 0;
+    for (size_t i = from; i < to; ++i) {
+        if (entries_[(begin_ + i) % entries_.size()].startsStep)
+            ++steps;
+    }
+    return steps;
+}
+
+size_t ParamHistory::undoSteps() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return countSteps(0, applied_);
+}
+
+size_t ParamHistory::redoSteps() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return countSteps(applied_, size_);
+}
+
+void ParamHistory::storeCheckpoint(Checkpoint checkpoint) {
+    // Caller must hold mutex_
+    checkpoints_.erase(std::remove_if(checkpoints_.begin(), checkpoints_.end(),
+                                      [&](const Checkpoint& existing) { return existing.name == checkpoint.name; }),
+                       checkpoints_.end());
+    bool automatic = checkpoint.automatic;
+    checkpoints_.push_back(std::move(checkpoint));
+    stepsSinceSnapshot_ = 0;
+
+    // Automatic and requested checkpoints are bounded separately, so the
+    // automatic ones never push out a checkpoint a client named
+    size_t limit = automatic ? kMaxAutoSnapshots : kMaxCheckpoints;
+    size_t kept = static_cast<size_t>(std::count_if(checkpoints_.begin(), checkpoints_.end(),
+                                                    [&](const Checkpoint& c) { return c.automatic == automatic; }));
+    for (auto it = checkpoints_.begin(); kept > limit && it != checkpoints_.end();) {
+        if (it->automatic == automatic) {
+            it = checkpoints_.erase(it);
+            --kept;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ParamHistory::checkpoint(const std::string& name, ParamSnapshot values) {
+    std::sort(values.begin(), values.end());
+    std::lock_guard<std::mutex> lock(mutex_);
+    storeCheckpoint({name, false, std::make_shared<const ParamSnapshot>(std::move(values))});
+}
+
+std::shared_ptr<const ParamSnapshot> ParamHistory::findCheckpoint(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& checkpoint : checkpoints_) {
+        if (checkpoint.name == name)
+            return checkpoint.values;
+    }
+    return nullptr;
+}
+
+std::vector<std::string> ParamHistory::checkpointNames() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> names;
+    names.reserve(checkpoints_.size());
+    for (const auto& checkpoint : checkpoints_)
+        names.push_back(checkpoint.name);
+    return names;
+}
+
+bool ParamHistory::autoSnapshotDue() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stepsSinceSnapshot_ >= kSnapshotInterval;
+}
+
+std::string ParamHistory::addAutoSnapshot(ParamSnapshot values) {
+    std::sort(values.begin(), values.end());
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string name = "auto-" + std::to_string(++autoSnapshotCount_);
+    storeCheckpoint({name, true, std::make_shared<const ParamSnapshot>(std::move(values))});
+    return name;
+}
+
+void ParamHistory::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    begin_ = size_ = applied_ = 0;
+    stepsSinceSnapshot_ = 0;
+    checkpoints_.clear();
+}
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "hostedplugin.h"
+
+#include "pluginterfaces/vst/vsttypes.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// One parameter change made through an MCP tool.
+struct ParamEdit {
+    Steinberg::Vst::ParamID id;
+    Steinberg::Vst::ParamValue oldValue;
+    Steinberg::Vst::ParamValue newValue;
+};
+
+// Every parameter's value at one point, sorted by ParamID.
+using ParamSnapshot = std::vector<std::pair<Steinberg::Vst::ParamID, Steinberg::Vst::ParamValue>>;
+
+// Undo/redo history for MCP-driven parameter edits.
+//
+// Edits are kept as a delta log of {id, old, new, time} entries in a fixed
+// ring; the entries recorded by one tool call form one step, undone and
+// redone as a whole. When the ring is full the oldest steps are dropped
+// whole, so an undo never reverts half a step. Recording a step discards
+// the steps that could have been redone.
+//
+// Checkpoints are full snapshots of every parameter value under a name, so
+// reverting to one doesn't depend on the deltas still being in the ring.
+// Besides the ones clients ask for, an automatic checkpoint is due every
+// kSnapshotInterval recorded steps (see autoSnapshotDue()); only the most
+// recent kMaxAutoSnapshots of those are kept.
+//
+// Only MCP tools record steps: changes made in the plugin GUI or by host
+// automation are not in the log, and undoing a step restores the values
+// it recorded regardless of them.
+//
+// Thread-safe.
+class ParamHistory {
+public:
+    static constexpr size_t kDefaultCapacity = 2048; // Entries, not steps
+    static constexpr size_t kMaxCheckpoints = 32;
+    static constexpr size_t kSnapshotInterval = 64;
+    static constexpr size_t kMaxAutoSnapshots = 4;
+
+    struct Step {
+        std::vector<ParamChange> changes; // In application order
+        int64_t timeMs = 0;               // When the step was recorded (ms since the Unix epoch)
+    };
+
+    explicit ParamHistory(size_t capacity = kDefaultCapacity);
+
+    // Record one step. Entries that don't change the value are left out; a
+    // step with none is not recorded. A step larger than the ring clears
+    // the history instead.
+    void record(const std::vector<ParamEdit>& edits);
+
+    // Move back (forward) one step and return the changes that revert
+    // (reapply) it. Returns false if there is nothing to undo (redo).
+    bool undo(Step& step);
+    bool redo(Step& step);
+
+    size_t undoSteps() const;
+    size_t redoSteps() const;
+
+    // Store a checkpoint, replacing one of the same name. Beyond
+    // kMaxCheckpoints the oldest one is dropped.
+    void checkpoint(const std::string& name, ParamSnapshot values);
+
+    // nullptr if there is no checkpoint of that name.
+    std::shared_ptr<const ParamSnapshot> findCheckpoint(const std::string& name) const;
+
+    // Oldest first, automatic ones included.
+    std::vector<std::string> checkpointNames() const;
+
+    // Whether kSnapshotInterval steps were recorded since the last
+    // checkpoint. addAutoSnapshot() stores one as "auto-<n>" and returns
+    // its name.
+    bool autoSnapshotDue() const;
+    std::string addAutoSnapshot(ParamSnapshot values);
+
+    // Drop all steps and checkpoints, e.g. when another plugin is loaded.
+    void clear();
+
+private:
+    struct Entry {
+        Steinberg::Vst::ParamID id;
+        bool startsStep;
+        Steinberg::Vst::ParamValue oldValue;
+        Steinberg::Vst::ParamValue newValue;
+        int64_t timeMs;
+    };
+
+    struct Checkpoint {
+        std::string name;
+        bool automatic;
+        std::shared_ptr<const ParamSnapshot> values;
+    };
+
+    // Caller must hold mutex_
+    Entry& at(size_t offset) { return entries_[(begin_ + offset) % entries_.size()]; }
+    void dropOldestStep();
+    void storeCheckpoint(Checkpoint checkpoint);
+    size_t countSteps(size_t from, size_t to) const;
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_; // Ring storage
+    size_t begin_ = 0;           // Oldest entry
+    size_t size_ = 0;            // Entries stored, redoable ones included
+    size_t applied_ = 0;         // Entries not undone; the rest can be redone
+    size_t stepsSinceSnapshot_ = 0;
+    uint64_t autoSnapshotCount_ = 0;
+    std::deque<Checkpoint> checkpoints_;
+};
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,166 @@
+#include "paramnotify.h"
+
+#include <algorithm>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace VST3MCPWrapper {
+
+ParamChangeNotifier::~ParamChangeNotifier() {
+    stop();
+}
+
+int ParamChangeNotifier::subscribe(const std::string& sessionId, const std::vector<ParamID>& ids,
+                                   int intervalMs) {
+    intervalMs = std::clamp(intervalMs, kMinIntervalMs, kMaxIntervalMs);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sessions_.find(sessionId) == sessions_.end() && sessions_.size() >= kMaxSessions) {
+        auto oldest = std::min_element(sessions_.begin(), sessions_.end(),
+            [](const auto& a, const auto& b) { return a.second.subscribedSeq < b.second.subscribedSeq; });
+        sessions_.erase(oldest);
+    }
+
+    auto& sub = sessions_[sessionId];
+    if (ids.empty())
+        sub.all = true;
+    else
+        sub.ids.insert(ids.begin(), ids.end());
+    sub.interval = std::chrono::milliseconds(intervalMs);
+    sub.subscribedSeq = ++subscribeSeq_;
+    hasSubscribers_.store(true, std::memory_order_release);
+    return intervalMs;
+}
+
+void ParamChangeNotifier::unsubscribe(const std::string& sessionId, const std::vector<ParamID>& ids) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(sessionId);
+    if (it == sessions_.end())
+        return;
+
+    auto& sub = it->second;
+    if (!ids.empty() && !sub.all) {
+        for (ParamID id : ids)
+            sub.ids.erase(id);
+    }
+    // Removing single ids from an "all" subscription is not tracked — the
+    // session stays subscribed to everything until it unsubscribes fully.
+    if (ids.empty() || (!sub.all && sub.ids.empty()))
+        sessions_.erase(it);
+
+    hasSubscribers_.store(!sessions_.empty(), std::memory_order_release);
+}
+
+bool ParamChangeNotifier::isSubscribed(const std::string& sessionId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.count(sessionId) != 0;
+}
+
+size_t ParamChangeNotifier::sessionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size();
+}
+
+void ParamChangeNotifier::clearPending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [sessionId, sub] : sessions_) {
+        sub.pending.clear();
+        sub.pendingIndex.clear();
+    }
+}
+
+void ParamChangeNotifier::publish(ParamID id, ParamValue value) {
+    if (!hasSubscribers_.load(std::memory_order_acquire))
+        return;
+
+    bool becamePending = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [sessionId, sub] : sessions_) {
+            if (!sub.all && sub.ids.count(id) == 0)
+                continue;
+
+            // Coalesce: one entry per parameter per interval, latest value wins
+            auto [slot, inserted] = sub.pendingIndex.emplace(id, sub.pending.size());
+            if (inserted) {
+                becamePending |= sub.pending.empty();
+                sub.pending.push_back({id, value});
+            } else {
+                sub.pending[slot->second].value = value;
+            }
+        }
+    }
+    if (becamePending)
+        wake_.notify_one();
+}
+
+ParamChangeNotifier::Clock::time_point ParamChangeNotifier::nextDueLocked() const {
+    auto due = Clock::time_point::max();
+    for (const auto& [sessionId, sub] : sessions_) {
+        if (!sub.pending.empty())
+            due = std::min(due, sub.lastSent + sub.interval);
+    }
+    return due;
+}
+
+ParamChangeNotifier::Clock::time_point ParamChangeNotifier::flush(Clock::time_point now, const Sender& send) {
+    std::vector<std::pair<std::string, std::vector<ParamUpdate>>> batches;
+    Clock::time_point next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [sessionId, sub] : sessions_) {
+            if (sub.pending.empty() || now < sub.lastSent + sub.interval)
+                continue;
+            batches.emplace_back(sessionId, std::move(sub.pending));
+            sub.pending.clear();
+            sub.pendingIndex.clear();
+            sub.lastSent = now;
+        }
+        next = nextDueLocked();
+    }
+
+    for (const auto& [sessionId, updates] : batches)
+        send(sessionId, updates);
+    return next;
+}
+
+void ParamChangeNotifier::start(Sender send) {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sender_ = std::move(send);
+        running_ = true;
+    }
+    thread_ = std::thread([this]() { run(); });
+}
+
+void ParamChangeNotifier::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void ParamChangeNotifier::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        auto due = nextDueLocked();
+        if (due == Clock::time_point::max())
+            wake_.wait(lock);
+        else
+            wake_.wait_until(lock, due);
+        if (!running_)
+            break;
+
+        // sender_ is only replaced by start(), which joins this thread first
+        lock.unlock();
+        flush(Clock::now(), sender_);
+        lock.lock();
+    }
+}
+
+} // namespace VST3MCPWrapper
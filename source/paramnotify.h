@@ -0,0 +1,106 @@
+#pragma once
+
+#include "pluginterfaces/vst/vsttypes.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+struct ParamUpdate {
+    Steinberg::Vst::ParamID id = Steinberg::Vst::kNoParamId;
+    Steinberg::Vst::ParamValue value = 0.0;
+};
+
+// Push-based parameter change notifications for MCP sessions.
+//
+// A session subscribes to a set of parameter IDs (or to all of them) with a
+// notification interval. publish() records the latest value per subscribed
+// parameter; at most once per interval, everything pending for a session is
+// handed to the sender as one batch, so a knob sweep of hundreds of
+// performEdit() calls reaches each client as one update per parameter.
+//
+// There is no session-closed callback from the MCP server, so the number of
+// subscribed sessions is capped: subscribing a new session when full evicts
+// the one that subscribed least recently.
+//
+// publish() is cheap when nobody is subscribed (one atomic load) and never
+// calls the sender; delivery runs on the notifier's own thread after start().
+// Thread-safe.
+class ParamChangeNotifier {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Sender = std::function<void(const std::string& sessionId, const std::vector<ParamUpdate>& updates)>;
+
+    static constexpr int kDefaultIntervalMs = 50;
+    static constexpr int kMinIntervalMs = 10;
+    static constexpr int kMaxIntervalMs = 60000;
+    static constexpr size_t kMaxSessions = 64;
+
+    ParamChangeNotifier() = default;
+    ~ParamChangeNotifier();
+
+    ParamChangeNotifier(const ParamChangeNotifier&) = delete;
+    ParamChangeNotifier& operator=(const ParamChangeNotifier&) = delete;
+
+    // Add ids to the session's subscription; empty ids subscribes to every
+    // parameter. intervalMs is clamped to [kMinIntervalMs, kMaxIntervalMs]
+    // and replaces the session's previous interval. Returns the clamped interval.
+    int subscribe(const std::string& sessionId, const std::vector<Steinberg::Vst::ParamID>& ids,
+                  int intervalMs = kDefaultIntervalMs);
+
+    // Remove ids from the session's subscription; empty ids drops the session.
+    // A session left with no ids is dropped as well.
+    void unsubscribe(const std::string& sessionId, const std::vector<Steinberg::Vst::ParamID>& ids);
+
+    bool isSubscribed(const std::string& sessionId) const;
+    size_t sessionCount() const;
+
+    // Discard undelivered updates (plugin load/unload — the IDs may no longer exist).
+    void clearPending();
+
+    void publish(Steinberg::Vst::ParamID id, Steinberg::Vst::ParamValue value);
+
+    // Deliver every session whose interval has elapsed at now. The sender is
+    // called without the lock held. Returns the earliest time another session
+    // becomes due, or Clock::time_point::max() if nothing is pending.
+    Clock::time_point flush(Clock::time_point now, const Sender& send);
+
+    // Run flush() on a background thread until stop(). stop() is idempotent.
+    void start(Sender send);
+    void stop();
+
+private:
+    struct Subscription {
+        bool all = false;
+        std::unordered_set<Steinberg::Vst::ParamID> ids;
+        Clock::duration interval{};
+        Clock::time_point lastSent{};
+        uint64_t subscribedSeq = 0;
+        std::vector<ParamUpdate> pending;
+        std::unordered_map<Steinberg::Vst::ParamID, size_t> pendingIndex;
+    };
+
+    Clock::time_point nextDueLocked() const;
+    void run();
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::unordered_map<std::string, Subscription> sessions_;
+    std::atomic<bool> hasSubscribers_{false};
+    uint64_t subscribeSeq_ = 0;
+
+    Sender sender_;
+    std::thread thread_;
+    bool running_ = false;
+};
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "pluginterfaces/vst/vsttypes.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace VST3MCPWrapper {
+
+// Bounded lock-free queue (Vyukov's bounded MPMC ring).
+//
+// Any number of producers may push concurrently. The audio thread is the
+// normal consumer; other threads may also pop (e.g. to discard pending items
+// on plugin reload) without corrupting the queue. Neither side ever takes a
+// lock or allocates after construction.
+//
+// Overflow policy: drop-newest. tryPush() returns false when the ring is full
+// and leaves the queued items untouched — older changes are never overwritten.
+//
+// Each slot carries a sequence number that encodes whether it is ready for
+// the producer (seq == pos) or the consumer (seq == pos + 1), so positions can
+// grow without bound and the capacity does not need to be a power of two.
+template <typename T>
+class BoundedParamQueue {
+public:
+    explicit BoundedParamQueue(size_t capacity)
+        : capacity_(capacity > 0 ? capacity : 1),
+          cells_(std::make_unique<Cell[]>(capacity_))
+    {
+        for (size_t i = 0; i < capacity_; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedParamQueue(const BoundedParamQueue&) = delete;
+    BoundedParamQueue& operator=(const BoundedParamQueue&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    // Returns false if the queue is full (the item is dropped).
+    bool tryPush(const T& item) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos % capacity_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = item;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is empty. A slot claimed by a producer that
+    // has not finished writing also reads as empty — it is picked up next call.
+    bool tryPop(T& item) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos % capacity_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    item = cell.data;
+                    cell.sequence.store(pos + capacity_, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Discard everything currently queued.
+    void clear() {
+        T discard;
+        while (tryPop(discard)) {}
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T data{};
+    };
+
+    const size_t capacity_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Separate cache lines so producers and the consumer don't false-share
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) std::atomic<size_t> dequeuePos_{0};
+};
+
+// Last-value-wins parameter store for coalescing queued changes.
+//
+// A fixed open-addressing table maps each ParamID to a dense slot holding the
+// latest value and a dirty flag. Storing a value for a parameter that is
+// already pending only overwrites the slot, so a sweep of hundreds of values
+// between two audio blocks reaches the consumer as a single change. Newly
+// dirtied slots are queued in FIFO order on a BoundedParamQueue of slot
+// indices; a slot is on that ring at most once, so it never overflows.
+//
+// Producers, the consumer and clear() are lock-free and may run concurrently.
+// clear() only requests the reset; whichever of clear() and drain() finds no
+// store() or drain() in flight carries it out. Until then store() returns
+// false (the caller falls back to the FIFO queue) and drain() delivers
+// nothing, so no slot is reassigned while a producer is writing to it.
+class CoalescingParamTable {
+public:
+    // slotCount is rounded up to a power of two.
+    explicit CoalescingParamTable(size_t slotCount)
+        : mask_(roundUpPow2(slotCount) - 1),
+          slots_(std::make_unique<Slot[]>(mask_ + 1)),
+          dirtySlots_(mask_ + 1)
+    {
+    }
+
+    CoalescingParamTable(const CoalescingParamTable&) = delete;
+    CoalescingParamTable& operator=(const CoalescingParamTable&) = delete;
+
+    size_t slotCount() const { return mask_ + 1; }
+
+    // Returns false if no slot could be claimed for id within kMaxProbes
+    // (table saturated) — the caller should fall back to the FIFO queue.
+    bool store(Steinberg::Vst::ParamID id, Steinberg::Vst::ParamValue value) {
+        if (id == kEmptyKey)
+            return false;
+
+        ActiveScope active(active_);
+        if (resetPending_.load(std::memory_order_seq_cst))
+            return false;
+
+        size_t index = hash(id) & mask_;
+        for (size_t probe = 0; probe < kMaxProbes && probe <= mask_; ++probe, index = (index + 1) & mask_) {
+            Slot& slot = slots_[index];
+            Steinberg::Vst::ParamID key = slot.key.load(std::memory_order_acquire);
+            if (key == kEmptyKey) {
+                if (!slot.key.compare_exchange_strong(key, id, std::memory_order_acq_rel)
+                    && key != id)
+                    continue; // another parameter claimed this slot first
+            } else if (key != id) {
+                continue;
+            }
+
+            slot.value.store(value, std::memory_order_relaxed);
+            if (!slot.dirty.exchange(true, std::memory_order_acq_rel))
+                dirtySlots_.tryPush(static_cast<uint32_t>(index));
+            return true;
+        }
+        return false;
+    }
+
+    // Hands up to maxCount pending (id, value) pairs to fn(id, value) in the
+    // order the parameters first became dirty. Returns the number delivered.
+    template <typename Fn>
+    size_t drain(size_t maxCount, Fn&& fn) {
+        ActiveScope active(active_);
+        if (resetPending_.load(std::memory_order_seq_cst) && !tryReset(1))
+            return 0;
+
+        size_t delivered = 0;
+        uint32_t index = 0;
+        while (delivered < maxCount && dirtySlots_.tryPop(index)) {
+            Slot& slot = slots_[index];
+            // Clear dirty before reading so a concurrent store re-queues the
+            // slot. The exchange acquires the last store() that found the slot
+            // already dirty, so its value is the one read below.
+            slot.dirty.exchange(false, std::memory_order_acq_rel);
+            auto value = slot.value.load(std::memory_order_relaxed);
+            fn(slot.key.load(std::memory_order_relaxed), value);
+            ++delivered;
+        }
+        return delivered;
+    }
+
+    // Discard all pending values and release every slot.
+    void clear() {
+        resetPending_.store(true, std::memory_order_seq_cst);
+        tryReset(0);
+    }
+
+private:
+    static constexpr Steinberg::Vst::ParamID kEmptyKey = Steinberg::Vst::kNoParamId;
+    static constexpr size_t kMaxProbes = 64;
+
+    struct Slot {
+        std::atomic<Steinberg::Vst::ParamID> key{kEmptyKey};
+        std::atomic<Steinberg::Vst::ParamValue> value{0.0};
+        std::atomic<bool> dirty{false};
+    };
+
+    // Counts a store() or drain() in flight
+    struct ActiveScope {
+        explicit ActiveScope(std::atomic<size_t>& count) : count_(count) {
+            count_.fetch_add(1, std::memory_order_seq_cst);
+        }
+        ~ActiveScope() { count_.fetch_sub(1, std::memory_order_seq_cst); }
+        std::atomic<size_t>& count_;
+    };
+
+    // Carries out a requested reset if the caller's own scopes (self) are
+    // the only ones active. A store() that starts meanwhile sees
+    // resetPending_ and backs off without touching a slot.
+    bool tryReset(size_t self) {
+        if (resetting_.exchange(true, std::memory_order_acquire))
+            return false;
+        bool done = active_.load(std::memory_order_seq_cst) == self;
+        if (done) {
+            dirtySlots_.clear();
+            for (size_t i = 0; i <= mask_; ++i) {
+                slots_[i].dirty.store(false, std::memory_order_relaxed);
+                slots_[i].key.store(kEmptyKey, std::memory_order_relaxed);
+            }
+            resetPending_.store(false, std::memory_order_seq_cst);
+        }
+        resetting_.store(false, std::memory_order_release);
+        return done;
+    }
+
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+
+    // Fibonacci hashing — VST3 parameter IDs are often sequential or hashed
+    // four-char codes; multiplying spreads both across the table.
+    static size_t hash(Steinberg::Vst::ParamID id) {
+        return static_cast<size_t>((static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    BoundedParamQueue<uint32_t> dirtySlots_;
+    std::atomic<size_t> active_{0};
+    std::atomic<bool> resetPending_{false};
+    std::atomic<bool> resetting_{false};
+};
+
+} // namespace VST3MCPWrapper
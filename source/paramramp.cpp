@@ -0,0 +1,121 @@
+#include "paramramp.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace VST3MCPWrapper {
+
+bool parseRampCurve(const std::string& name, RampCurve& curve) {
+    if (name == "linear")
+        curve = RampCurve::Linear;
+    else if (name == "ease_in")
+        curve = RampCurve::EaseIn;
+    else if (name == "ease_out")
+        curve = RampCurve::EaseOut;
+    else if (name == "s_curve")
+        curve = RampCurve::SCurve;
+    else
+        return false;
+    return true;
+}
+
+const char* rampCurveName(RampCurve curve) {
+    switch (curve) {
+        case RampCurve::Linear: return "linear";
+        case RampCurve::EaseIn: return "ease_in";
+        case RampCurve::EaseOut: return "ease_out";
+        case RampCurve::SCurve: return "s_curve";
+    }
+    return "linear";
+}
+
+double applyRampCurve(RampCurve curve, double t) {
+    t = std::clamp(t, 0.0, 1.0);
+    switch (curve) {
+        case RampCurve::Linear: return t;
+        case RampCurve::EaseIn: return t * t;
+        case RampCurve::EaseOut: return t * (2.0 - t);
+        case RampCurve::SCurve: return t * t * (3.0 - 2.0 * t);
+    }
+    return t;
+}
+
+ParamValue ParamRampEngine::ActiveRamp::valueAt(int64_t samplePos) const {
+    double t = static_cast<double>(samplePos) / static_cast<double>(totalSamples);
+    return startValue + (targetValue - startValue) * applyRampCurve(curve, t);
+}
+
+ParamRampEngine::ActiveRamp* ParamRampEngine::find(ParamID id) {
+    for (size_t i = 0; i < activeCount_; ++i) {
+        if (ramps_[i].id == id)
+            return &ramps_[i];
+    }
+    return nullptr;
+}
+
+bool ParamRampEngine::start(const ParamRamp& ramp, double sampleRate) {
+    // A ramp always spans at least one sample so the target point is emitted
+    auto totalSamples = static_cast<int64_t>(std::llround(ramp.durationMs * sampleRate / 1000.0));
+    totalSamples = std::max<int64_t>(totalSamples, 1);
+
+    ActiveRamp* slot = find(ramp.id);
+    ParamValue startValue = ramp.startValue;
+    if (slot) {
+        startValue = slot->valueAt(slot->elapsedSamples);
+    } else {
+        if (activeCount_ >= kMaxActiveRamps)
+            return false;
+        slot = &ramps_[activeCount_++];
+    }
+
+    *slot = {ramp.id, startValue, ramp.targetValue, ramp.curve, totalSamples, 0};
+    return true;
+}
+
+void ParamRampEngine::cancel(ParamID id) {
+    if (ActiveRamp* ramp = find(id))
+        *ramp = ramps_[--activeCount_];
+}
+
+void ParamRampEngine::render(PreallocatedParameterChanges& changes, int32 numSamples) {
+    if (numSamples <= 0)
+        return;
+
+    int32 pointCount = std::min(kPointsPerBlock, numSamples);
+    size_t i = 0;
+    while (i < activeCount_) {
+        ActiveRamp& ramp = ramps_[i];
+        int64_t remaining = ramp.totalSamples - ramp.elapsedSamples;
+
+        int32 index;
+        auto* queue = changes.addParameterData(ramp.id, index);
+        if (queue) {
+            int32 pointIndex;
+            for (int32 p = 0; p < pointCount; ++p) {
+                int32 offset = pointCount > 1
+                    ? static_cast<int32>(static_cast<int64_t>(p) * (numSamples - 1) / (pointCount - 1))
+                    : 0;
+                if (offset >= remaining)
+                    break;
+                queue->addPoint(offset, ramp.valueAt(ramp.elapsedSamples + offset), pointIndex);
+            }
+            // Land exactly on the target; a ramp ending on the block boundary
+            // gets it on the last sample (replacing the regular point there)
+            if (remaining <= numSamples) {
+                auto endOffset = static_cast<int32>(std::min<int64_t>(remaining, numSamples - 1));
+                queue->addPoint(endOffset, ramp.targetValue, pointIndex);
+            }
+        }
+
+        ramp.elapsedSamples += numSamples;
+        if (ramp.elapsedSamples >= ramp.totalSamples)
+            ramp = ramps_[--activeCount_]; // Swap-remove; re-examine slot i
+        else
+            ++i;
+    }
+}
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "paramchanges.h"
+
+#include "pluginterfaces/vst/vsttypes.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace VST3MCPWrapper {
+
+// Interpolation shape of a parameter ramp, applied to normalized progress t in [0, 1].
+enum class RampCurve : uint8_t {
+    Linear,
+    EaseIn,  // Quadratic: slow start
+    EaseOut, // Quadratic: slow end
+    SCurve,  // Smoothstep: slow start and end
+};
+
+// Parse "linear" / "ease_in" / "ease_out" / "s_curve". Returns false for anything else.
+bool parseRampCurve(const std::string& name, RampCurve& curve);
+const char* rampCurveName(RampCurve curve);
+
+// Map linear progress t (clamped to [0, 1]) through the curve.
+double applyRampCurve(RampCurve curve, double t);
+
+// A ramp request queued from MCP to the audio thread.
+struct ParamRamp {
+    Steinberg::Vst::ParamID id = Steinberg::Vst::kNoParamId;
+    Steinberg::Vst::ParamValue startValue = 0.0;
+    Steinberg::Vst::ParamValue targetValue = 0.0;
+    double durationMs = 0.0;
+    RampCurve curve = RampCurve::Linear;
+};
+
+// Runs parameter ramps on the audio thread.
+//
+// Active ramps live in a fixed table, so starting, rendering and cancelling
+// never allocate. render() writes each ramp's points for one block into the
+// merged IParameterChanges: up to kPointsPerBlock points spread evenly over
+// the block (the hosted plugin interpolates linearly between them), plus an
+// exact point on the target at the sample where the ramp ends.
+//
+// Not thread-safe — owned and used by the audio thread only (and by the
+// processor while processorReady_ is false).
+class ParamRampEngine {
+public:
+    static constexpr size_t kMaxActiveRamps = 64;
+    static constexpr Steinberg::int32 kPointsPerBlock = 16;
+
+    // Start a ramp. If the parameter is already ramping, the new ramp
+    // continues from its current value instead of ramp.startValue.
+    // Returns false if the table is full.
+    bool start(const ParamRamp& ramp, double sampleRate);
+
+    // Stop ramping id (e.g. an explicit set_parameter overrides the ramp).
+    void cancel(Steinberg::Vst::ParamID id);
+
+    void clear() { activeCount_ = 0; }
+    size_t activeCount() const { return activeCount_; }
+
+    // Add this block's points for every active ramp and advance them by
+    // numSamples. Finished ramps are removed.
+    void render(PreallocatedParameterChanges& changes, Steinberg::int32 numSamples);
+
+private:
+    struct ActiveRamp {
+        Steinberg::Vst::ParamID id;
+        Steinberg::Vst::ParamValue startValue;
+        Steinberg::Vst::ParamValue targetValue;
+        RampCurve curve;
+        int64_t totalSamples;
+        int64_t elapsedSamples;
+
+        Steinberg::Vst::ParamValue valueAt(int64_t samplePos) const;
+    };
+
+    ActiveRamp* find(Steinberg::Vst::ParamID id);
+
+    // Dense: the first activeCount_ entries are live
+    std::array<ActiveRamp, kMaxActiveRamps> ramps_{};
+    size_t activeCount_ = 0;
+};
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,202 @@
+#include "pluginjobs.h"
+#include "logging.h"
+
+#include <algorithm>
+
+namespace VST3MCPWrapper {
+
+const char* pluginJobPhaseName(PluginJobPhase phase) {
+    switch (phase) {
+        case PluginJobPhase::Queued: return "queued";
+        case PluginJobPhase::ModuleOpen: return "module_open";
+        case PluginJobPhase::ComponentInit: return "component_init";
+        case PluginJobPhase::ControllerSetup: return "controller_setup";
+        case PluginJobPhase::StateSync: return "state_sync";
+        case PluginJobPhase::Teardown: return "teardown";
+        case PluginJobPhase::Done: return "done";
+    }
+    return "unknown";
+}
+
+const char* pluginJobStateName(PluginJobState state) {
+    switch (state) {
+        case PluginJobState::Queued: return "queued";
+        case PluginJobState::Running: return "running";
+        case PluginJobState::Succeeded: return "succeeded";
+        case PluginJobState::Failed: return "failed";
+        case PluginJobState::Cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+// ---- PluginJob ----
+
+PluginJob::PluginJob(uint64_t id, std::string operation, std::string path)
+    : id_(id), operation_(std::move(operation)), path_(std::move(path)), created_(Clock::now())
+{
+}
+
+bool PluginJob::enterPhase(PluginJobPhase phase) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != PluginJobState::Queued && state_ != PluginJobState::Running)
+        return false;
+    if (cancelRequested_ && !swapped_)
+        return false;
+    state_ = PluginJobState::Running;
+    phase_ = phase;
+    return true;
+}
+
+bool PluginJob::beginSwap() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cancelRequested_)
+        return false;
+    swapped_ = true;
+    return true;
+}
+
+bool PluginJob::requestCancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (swapped_)
+        return false;
+    if (state_ == PluginJobState::Queued) {
+        // Never started: done right away, the queue skips it
+        cancelRequested_ = true;
+        state_ = PluginJobState::Cancelled;
+        finished_ = Clock::now();
+        return true;
+    }
+    if (state_ != PluginJobState::Running)
+        return false;
+    cancelRequested_ = true;
+    return true;
+}
+
+bool PluginJob::isCancelled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cancelRequested_ && !swapped_;
+}
+
+void PluginJob::finish(const std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != PluginJobState::Queued && state_ != PluginJobState::Running)
+        return;
+    if (cancelRequested_ && !swapped_) {
+        state_ = PluginJobState::Cancelled;
+    } else if (error.empty()) {
+        state_ = PluginJobState::Succeeded;
+        phase_ = PluginJobPhase::Done;
+    } else {
+        state_ = PluginJobState::Failed;
+        error_ = error;
+    }
+    finished_ = Clock::now();
+}
+
+bool PluginJob::isFinished() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_ != PluginJobState::Queued && state_ != PluginJobState::Running;
+}
+
+PluginJob::Status PluginJob::status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Status status;
+    status.id = id_;
+    status.operation = operation_;
+    status.path = path_;
+    status.state = state_;
+    status.phase = phase_;
+    status.cancelRequested = cancelRequested_;
+    status.swapped = swapped_;
+    status.error = error_;
+    bool finished = state_ != PluginJobState::Queued && state_ != PluginJobState::Running;
+    status.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        (finished ? finished_ : Clock::now()) - created_);
+    return status;
+}
+
+// ---- PluginJobQueue ----
+
+PluginJobQueue::~PluginJobQueue() {
+    stop();
+}
+
+std::shared_ptr<PluginJob> PluginJobQueue::submit(const std::string& operation, const std::string& path, Work work) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping())
+        return nullptr;
+    auto job = std::make_shared<PluginJob>(nextId_++, operation, path);
+    jobs_.push_back(job);
+    pending_.push_back({job, std::move(work)});
+    if (!thread_.joinable())
+        thread_ = std::thread([this]() { run(); });
+    wake_.notify_one();
+    return job;
+}
+
+std::shared_ptr<PluginJob> PluginJobQueue::find(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& job : jobs_) {
+        if (job->id() == id)
+            return job;
+    }
+    return nullptr;
+}
+
+void PluginJobQueue::stop() {
+    std::thread finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_.store(true, std::memory_order_release);
+        for (auto& entry : pending_) {
+            entry.job->requestCancel();
+            retire(entry.job);
+        }
+        pending_.clear();
+        finished = std::move(thread_);
+    }
+    wake_.notify_all();
+    if (finished.joinable())
+        finished.join();
+}
+
+void PluginJobQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this]() { return stopping() || !pending_.empty(); });
+        if (pending_.empty())
+            return;
+        Entry entry = std::move(pending_.front());
+        pending_.pop_front();
+
+        // Cancelled while queued: already finished, nothing to run
+        if (!entry.job->isFinished()) {
+            lock.unlock();
+            try {
+                entry.work(entry.job);
+                entry.job->finish({});
+            } catch (const std::exception& e) {
+                WRAPPER_LOG_ERROR("Plugin job %llu failed: %s",
+                                  static_cast<unsigned long long>(entry.job->id()), e.what());
+                entry.job->finish(e.what());
+            } catch (...) {
+                entry.job->finish("Unknown error");
+            }
+            lock.lock();
+        }
+        retire(entry.job);
+    }
+}
+
+void PluginJobQueue::retire(const std::shared_ptr<PluginJob>& job) {
+    finishedOrder_.push_back(job->id());
+    while (finishedOrder_.size() > kMaxFinishedJobs) {
+        uint64_t oldest = finishedOrder_.front();
+        finishedOrder_.pop_front();
+        jobs_.erase(std::remove_if(jobs_.begin(), jobs_.end(),
+                                   [oldest](const std::shared_ptr<PluginJob>& j) { return j->id() == oldest; }),
+                    jobs_.end());
+    }
+}
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// Steps of a load/unload job, in the order a load goes through them.
+enum class PluginJobPhase {
+    Queued,
+    ModuleOpen,      // Opening the bundle (job thread, before the swap point)
+    ComponentInit,   // Creating/initializing the component to find the controller class
+    ControllerSetup, // Creating/initializing the hosted edit controller
+    StateSync,       // Handing the plugin to the processor, syncing state and view
+    Teardown,        // Unload: releasing the hosted plugin
+    Done,
+};
+
+enum class PluginJobState { Queued, Running, Succeeded, Failed, Cancelled };
+
+const char* pluginJobPhaseName(PluginJobPhase phase);
+const char* pluginJobStateName(PluginJobState state);
+
+// One asynchronous load_plugin/unload_plugin request.
+//
+// The job runs up to its swap point — where the current plugin is torn down
+// and replaced — without touching the hosted plugin, so until beginSwap()
+// succeeds it can be cancelled and nothing changes. After that it always
+// runs to completion. Thread-safe.
+class PluginJob {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Status {
+        uint64_t id = 0;
+        std::string operation; // "load" or "unload"
+        std::string path;
+        PluginJobState state = PluginJobState::Queued;
+        PluginJobPhase phase = PluginJobPhase::Queued;
+        bool cancelRequested = false;
+        bool swapped = false;
+        std::string error;
+        std::chrono::milliseconds elapsed{0}; // Since submission, frozen once finished
+    };
+
+    PluginJob(uint64_t id, std::string operation, std::string path);
+
+    uint64_t id() const { return id_; }
+    const std::string& operation() const { return operation_; }
+    const std::string& path() const { return path_; }
+
+    // Report progress. Returns false if the job has been cancelled and has
+    // not passed its swap point yet — the caller should stop.
+    bool enterPhase(PluginJobPhase phase);
+
+    // Called right before the current plugin is replaced. Returns false (and
+    // the caller must back out) if cancellation was requested; afterwards
+    // requestCancel() is refused.
+    bool beginSwap();
+
+    // Returns true if the job will stop before its swap point: it is still
+    // queued or running and has not swapped yet.
+    bool requestCancel();
+    bool isCancelled() const;
+
+    // Record the outcome. An empty error is success, unless the job was
+    // cancelled before swapping, which makes it Cancelled.
+    void finish(const std::string& error);
+
+    bool isFinished() const;
+    Status status() const;
+
+private:
+    const uint64_t id_;
+    const std::string operation_;
+    const std::string path_;
+    const Clock::time_point created_;
+
+    mutable std::mutex mutex_;
+    PluginJobState state_ = PluginJobState::Queued;
+    PluginJobPhase phase_ = PluginJobPhase::Queued;
+    bool cancelRequested_ = false;
+    bool swapped_ = false;
+    std::string error_;
+    Clock::time_point finished_{};
+};
+
+// Runs plugin jobs one at a time, in submission order, on its own thread, so
+// MCP handlers can return a job ID immediately instead of blocking a server
+// thread for the duration of a load.
+//
+// Finished jobs stay queryable until kMaxFinishedJobs newer ones have
+// finished. stop() cancels everything still queued and joins the thread;
+// work() of a running job should poll stopping() while it waits on anything
+// that may not complete during shutdown. Thread-safe.
+class PluginJobQueue {
+public:
+    using Work = std::function<void(const std::shared_ptr<PluginJob>& job)>;
+
+    static constexpr size_t kMaxFinishedJobs = 32;
+
+    PluginJobQueue() = default;
+    ~PluginJobQueue();
+
+    PluginJobQueue(const PluginJobQueue&) = delete;
+    PluginJobQueue& operator=(const PluginJobQueue&) = delete;
+
+    // Queue work(). If work() returns without calling finish(), the job is
+    // finished as succeeded. Returns nullptr once stopped.
+    std::shared_ptr<PluginJob> submit(const std::string& operation, const std::string& path, Work work);
+
+    // nullptr for unknown IDs and for jobs that have been evicted.
+    std::shared_ptr<PluginJob> find(uint64_t id) const;
+
+    void stop();
+    bool stopping() const { return stopping_.load(std::memory_order_acquire); }
+
+private:
+    struct Entry {
+        std::shared_ptr<PluginJob> job;
+        Work work;
+    };
+
+    void run();
+    void retire(const std::shared_ptr<PluginJob>& job); // Caller holds mutex_
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Entry> pending_;
+    std::vector<std::shared_ptr<PluginJob>> jobs_; // Queued, running and retained finished jobs
+    std::deque<uint64_t> finishedOrder_;
+    uint64_t nextId_ = 1;
+    std::thread thread_;
+    std::atomic<bool> stopping_{false};
+};
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,491 @@
+#include "pluginscan.h"
+#include "logging.h"
+
+#include "public.sdk/source/vst/hosting/module.h"
+
+#include "mcp_message.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace VST3MCPWrapper {
+
+namespace {
+
+constexpr int kIndexFormatVersion = 1;
+
+int64_t mtimeOf(const fs::path& path, std::error_code& ec) {
+    auto time = fs::last_write_time(path, ec);
+    return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+// Identify the on-disk version of a bundle. For directory bundles the
+// moduleinfo.json is what we read, so its mtime and size are folded in —
+// the bundle directory's own mtime does not change when files inside are
+// rewritten in place.
+bool statBundle(const std::string& bundlePath, int64_t& mtime, uint64_t& size) {
+    std::error_code ec;
+    fs::path bundle(bundlePath);
+    auto status = fs::status(bundle, ec);
+    if (ec || !fs::exists(status))
+        return false;
+
+    mtime = mtimeOf(bundle, ec);
+    size = 0;
+    if (fs::is_regular_file(status)) {
+        size = fs::file_size(bundle, ec);
+        return true;
+    }
+
+    for (const auto& candidate : {bundle / "Contents" / "Resources" / "moduleinfo.json",
+                                  bundle / "Contents" / "moduleinfo.json"}) {
+        std::error_code infoEc;
+        if (!fs::is_regular_file(candidate, infoEc))
+            continue;
+        mtime = std::max(mtime, mtimeOf(candidate, infoEc));
+        size = fs::file_size(candidate, infoEc);
+        break;
+    }
+    return true;
+}
+
+std::string jsonString(const mcp::json& obj, const char* key) {
+    auto it = obj.find(key);
+    return it != obj.end() && it->is_string() ? it->get<std::string>() : std::string();
+}
+
+std::vector<std::string> stringList(const mcp::json& obj, const char* key) {
+    std::vector<std::string> list;
+    auto it = obj.find(key);
+    if (it != obj.end() && it->is_array()) {
+        for (const auto& item : *it) {
+            if (item.is_string())
+                list.push_back(item.get<std::string>());
+        }
+    }
+    return list;
+}
+
+} // namespace
+
+// ---- Index format ----
+
+mcp::json scannedPluginToJson(const ScannedPlugin& plugin) {
+    mcp::json classes = mcp::json::array();
+    for (const auto& cls : plugin.classes) {
+        mcp::json buses = mcp::json::array();
+        for (const auto& bus : cls.buses) {
+            buses.push_back({
+                {"name", bus.name},
+                {"mediaType", bus.mediaType},
+                {"direction", bus.direction},
+                {"busType", bus.busType},
+                {"channelCount", bus.channelCount}
+            });
+        }
+        classes.push_back({
+            {"cid", cls.cid},
+            {"name", cls.name},
+            {"category", cls.category},
+            {"subCategories", cls.subCategories},
+            {"vendor", cls.vendor},
+            {"version", cls.version},
+            {"buses", std::move(buses)}
+        });
+    }
+    return {
+        {"path", plugin.path},
+        {"mtime", plugin.mtime},
+        {"size", plugin.size},
+        {"hasModuleInfo", plugin.hasModuleInfo},
+        {"name", plugin.name},
+        {"vendor", plugin.vendor},
+        {"version", plugin.version},
+        {"classes", std::move(classes)},
+        {"scanStatus", plugin.scanStatus},
+        {"scanError", plugin.scanError}
+    };
+}
+
+bool scannedPluginFromJson(const mcp::json& obj, ScannedPlugin& plugin) {
+    if (!obj.is_object() || !obj.contains("path") || !obj["path"].is_string())
+        return false;
+    plugin.path = obj["path"].get<std::string>();
+    plugin.mtime = obj.value("mtime", int64_t(0));
+    plugin.size = obj.value("size", uint64_t(0));
+    plugin.hasModuleInfo = obj.value("hasModuleInfo", false);
+    plugin.name = jsonString(obj, "name");
+    plugin.vendor = jsonString(obj, "vendor");
+    plugin.version = jsonString(obj, "version");
+    plugin.scanStatus = jsonString(obj, "scanStatus");
+    plugin.scanError = jsonString(obj, "scanError");
+    plugin.classes.clear();
+    if (obj.contains("classes") && obj["classes"].is_array()) {
+        for (const auto& cls : obj["classes"]) {
+            if (!cls.is_object())
+                continue;
+            ScannedPluginClass info;
+            info.cid = jsonString(cls, "cid");
+            info.name = jsonString(cls, "name");
+            info.category = jsonString(cls, "category");
+            info.vendor = jsonString(cls, "vendor");
+            info.version = jsonString(cls, "version");
+            info.subCategories = stringList(cls, "subCategories");
+            if (cls.contains("buses") && cls["buses"].is_array()) {
+                for (const auto& bus : cls["buses"]) {
+                    if (!bus.is_object())
+                        continue;
+                    ScannedBus busInfo;
+                    busInfo.name = jsonString(bus, "name");
+                    busInfo.mediaType = jsonString(bus, "mediaType");
+                    busInfo.direction = jsonString(bus, "direction");
+                    busInfo.busType = jsonString(bus, "busType");
+                    busInfo.channelCount = bus.value("channelCount", int32_t(0));
+                    info.buses.push_back(std::move(busInfo));
+                }
+            }
+            plugin.classes.push_back(std::move(info));
+        }
+    }
+    return true;
+}
+
+// ---- PluginScanCache ----
+
+PluginScanCache& PluginScanCache::shared() {
+    static PluginScanCache cache(defaultIndexPath(), [] { return VST3::Hosting::Module::getModulePaths(); });
+    return cache;
+}
+
+PluginScanCache::PluginScanCache(std::string indexPath, PathProvider paths)
+    : indexPath_(std::move(indexPath)),
+      paths_(std::move(paths)),
+      plugins_(std::make_shared<const std::vector<ScannedPlugin>>())
+{
+    loadIndex();
+}
+
+PluginScanCache::~PluginScanCache() {
+    {
+        std::lock_guard<std::mutex> lock(threadMutex_);
+        stopThread_ = true;
+    }
+    threadWake_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+PluginScanCache::Snapshot PluginScanCache::plugins() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (populated_)
+            return plugins_;
+    }
+    refresh();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return plugins_;
+}
+
+size_t PluginScanCache::refresh() {
+    std::lock_guard<std::mutex> scanLock(refreshMutex_);
+    reloadIfIndexChanged();
+
+    Snapshot previous;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        previous = plugins_;
+    }
+    std::unordered_map<std::string, const ScannedPlugin*> known;
+    for (const auto& plugin : *previous)
+        known.emplace(plugin.path, &plugin);
+
+    auto paths = paths_ ? paths_() : std::vector<std::string>();
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    auto next = std::make_shared<std::vector<ScannedPlugin>>();
+    next->reserve(paths.size());
+    size_t reread = 0;
+
+    for (const auto& path : paths) {
+        ScannedPlugin entry;
+        entry.path = path;
+        if (!statBundle(path, entry.mtime, entry.size))
+            continue;
+
+        auto it = known.find(path);
+        if (it != known.end() && it->second->mtime == entry.mtime && it->second->size == entry.size) {
+            next->push_back(*it->second);
+            continue;
+        }
+
+        entry.name = fs::path(path).stem().string();
+        entry.hasModuleInfo = readModuleInfo(path, entry);
+        next->push_back(std::move(entry));
+        ++reread;
+    }
+
+    bool changed = reread > 0 || next->size() != previous->size();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        plugins_ = std::move(next);
+        populated_ = true;
+    }
+    if (changed)
+        saveIndex();
+    return reread;
+}
+
+bool PluginScanCache::loadIndex() {
+    if (indexPath_.empty())
+        return false;
+
+    int64_t stamp = indexFileStamp();
+    std::ifstream in(indexPath_);
+    if (!in)
+        return false;
+
+    auto index = mcp::json::parse(in, nullptr, false);
+    if (index.is_discarded() || !index.is_object()
+        || index.value("formatVersion", 0) != kIndexFormatVersion
+        || !index.contains("plugins") || !index["plugins"].is_array()) {
+        WRAPPER_LOG_ERROR("Ignoring unreadable plugin index %s", indexPath_.c_str());
+        return false;
+    }
+
+    auto plugins = std::make_shared<std::vector<ScannedPlugin>>();
+    for (const auto& obj : index["plugins"]) {
+        ScannedPlugin plugin;
+        if (scannedPluginFromJson(obj, plugin))
+            plugins->push_back(std::move(plugin));
+    }
+    std::sort(plugins->begin(), plugins->end(),
+              [](const ScannedPlugin& a, const ScannedPlugin& b) { return a.path < b.path; });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    plugins_ = std::move(plugins);
+    populated_ = true;
+    indexStamp_ = stamp;
+    return true;
+}
+
+bool PluginScanCache::saveIndex() const {
+    if (indexPath_.empty())
+        return false;
+
+    Snapshot plugins;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        plugins = plugins_;
+    }
+
+    mcp::json list = mcp::json::array();
+    for (const auto& plugin : *plugins)
+        list.push_back(scannedPluginToJson(plugin));
+    mcp::json index = {
+        {"formatVersion", kIndexFormatVersion},
+        {"plugins", std::move(list)}
+    };
+
+    // Write to a temporary file and rename, so a concurrent reader in another
+    // process never sees a half-written index.
+    std::error_code ec;
+    fs::path target(indexPath_);
+    fs::create_directories(target.parent_path(), ec);
+    fs::path temp = target;
+    temp += ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        if (!out)
+            return false;
+        out << index.dump();
+        if (!out)
+            return false;
+    }
+    fs::rename(temp, target, ec);
+    if (ec) {
+        WRAPPER_LOG_ERROR("Failed to write plugin index %s: %s", indexPath_.c_str(), ec.message().c_str());
+        fs::remove(temp, ec);
+        return false;
+    }
+
+    int64_t stamp = indexFileStamp();
+    std::lock_guard<std::mutex> lock(mutex_);
+    indexStamp_ = stamp;
+    return true;
+}
+
+void PluginScanCache::applyScanResults(const std::vector<ScannedPlugin>& results) {
+    {
+        std::lock_guard<std::mutex> scanLock(refreshMutex_);
+        reloadIfIndexChanged();
+
+        Snapshot previous;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            previous = plugins_;
+        }
+        auto next = std::make_shared<std::vector<ScannedPlugin>>(*previous);
+        std::unordered_map<std::string, size_t> indexByPath;
+        for (size_t i = 0; i < next->size(); ++i)
+            indexByPath.emplace((*next)[i].path, i);
+
+        for (const auto& result : results) {
+            auto it = indexByPath.find(result.path);
+            if (it == indexByPath.end()) {
+                ScannedPlugin entry = result;
+                statBundle(entry.path, entry.mtime, entry.size);
+                indexByPath.emplace(entry.path, next->size());
+                next->push_back(std::move(entry));
+                continue;
+            }
+
+            ScannedPlugin& entry = (*next)[it->second];
+            if (result.scanStatus == "ok") {
+                // Keep the stamp the index was built against
+                int64_t mtime = entry.mtime;
+                uint64_t size = entry.size;
+                bool hasModuleInfo = entry.hasModuleInfo;
+                entry = result;
+                entry.mtime = mtime;
+                entry.size = size;
+                entry.hasModuleInfo = hasModuleInfo;
+            } else {
+                entry.scanStatus = result.scanStatus;
+                entry.scanError = result.scanError;
+            }
+        }
+        std::sort(next->begin(), next->end(),
+                  [](const ScannedPlugin& a, const ScannedPlugin& b) { return a.path < b.path; });
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        plugins_ = std::move(next);
+        populated_ = true;
+    }
+    saveIndex();
+}
+
+int64_t PluginScanCache::indexFileStamp() const {
+    std::error_code ec;
+    return indexPath_.empty() ? 0 : mtimeOf(indexPath_, ec);
+}
+
+void PluginScanCache::reloadIfIndexChanged() {
+    if (indexPath_.empty())
+        return;
+    int64_t stamp = indexFileStamp();
+    bool changed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        changed = stamp != 0 && stamp != indexStamp_;
+    }
+    if (changed)
+        loadIndex();
+}
+
+void PluginScanCache::startBackgroundRefresh(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(threadMutex_);
+    if (backgroundUsers_++ > 0)
+        return;
+    stopThread_ = false;
+    thread_ = std::thread([this, interval]() { runRefreshLoop(interval); });
+}
+
+void PluginScanCache::stopBackgroundRefresh() {
+    std::thread finished;
+    {
+        std::lock_guard<std::mutex> lock(threadMutex_);
+        if (backgroundUsers_ == 0 || --backgroundUsers_ > 0)
+            return;
+        stopThread_ = true;
+        finished = std::move(thread_);
+    }
+    threadWake_.notify_all();
+    if (finished.joinable())
+        finished.join();
+}
+
+void PluginScanCache::runRefreshLoop(std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(threadMutex_);
+    while (!stopThread_) {
+        lock.unlock();
+        try {
+            refresh();
+        } catch (const std::exception& e) {
+            WRAPPER_LOG_ERROR("Plugin scan failed: %s", e.what());
+        }
+        lock.lock();
+        threadWake_.wait_for(lock, interval, [this] { return stopThread_; });
+    }
+}
+
+bool PluginScanCache::readModuleInfo(const std::string& bundlePath, ScannedPlugin& entry) {
+    fs::path bundle(bundlePath);
+    std::ifstream in;
+    for (const auto& candidate : {bundle / "Contents" / "Resources" / "moduleinfo.json",
+                                  bundle / "Contents" / "moduleinfo.json"}) {
+        in.open(candidate);
+        if (in)
+            break;
+        in.clear();
+    }
+    if (!in.is_open())
+        return false;
+
+    // moduleinfo.json is JSON5 in principle; the SDK's moduleinfotool writes
+    // plain JSON, and comments are tolerated here.
+    auto info = mcp::json::parse(in, nullptr, false, true);
+    if (info.is_discarded() || !info.is_object())
+        return false;
+
+    std::string name = jsonString(info, "Name");
+    if (!name.empty())
+        entry.name = name;
+    entry.version = jsonString(info, "Version");
+    if (info.contains("Factory Info") && info["Factory Info"].is_object())
+        entry.vendor = jsonString(info["Factory Info"], "Vendor");
+
+    entry.classes.clear();
+    if (info.contains("Classes") && info["Classes"].is_array()) {
+        for (const auto& cls : info["Classes"]) {
+            if (!cls.is_object())
+                continue;
+            ScannedPluginClass classInfo;
+            classInfo.cid = jsonString(cls, "CID");
+            classInfo.name = jsonString(cls, "Name");
+            classInfo.category = jsonString(cls, "Category");
+            classInfo.vendor = jsonString(cls, "Vendor");
+            classInfo.version = jsonString(cls, "Version");
+            classInfo.subCategories = stringList(cls, "Sub Categories");
+            entry.classes.push_back(std::move(classInfo));
+        }
+    }
+    return true;
+}
+
+std::string PluginScanCache::defaultIndexPath() {
+    const char* home = std::getenv("HOME");
+#ifdef __APPLE__
+    if (!home || !*home)
+        return {};
+    return (fs::path(home) / "Library" / "Caches" / "vst3mcpwrapper" / "plugin-index.json").string();
+#else
+    fs::path base;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        base = xdg;
+    else if (home && *home)
+        base = fs::path(home) / ".cache";
+    else
+        return {};
+    return (base / "vst3mcpwrapper" / "plugin-index.json").string();
+#endif
+}
+
+} // namespace VST3MCPWrapper
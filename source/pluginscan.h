@@ -0,0 +1,145 @@
+#pragma once
+
+#include "mcp_message.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// Bus of an audio module class; only known after an out-of-process scan.
+struct ScannedBus {
+    std::string name;
+    std::string mediaType; // "audio" or "event"
+    std::string direction; // "input" or "output"
+    std::string busType;   // "main" or "aux"
+    int32_t channelCount = 0;
+};
+
+struct ScannedPluginClass {
+    std::string cid;
+    std::string name;
+    std::string category;
+    std::vector<std::string> subCategories;
+    std::string vendor;
+    std::string version;
+    std::vector<ScannedBus> buses;
+};
+
+// One installed .vst3 bundle. mtime/size identify the version of the bundle
+// on disk that the metadata was read from.
+struct ScannedPlugin {
+    std::string path;
+    int64_t mtime = 0;
+    uint64_t size = 0;
+
+    bool hasModuleInfo = false; // Metadata below came from moduleinfo.json
+    std::string name;           // Falls back to the bundle file name
+    std::string vendor;
+    std::string version;
+    std::vector<ScannedPluginClass> classes;
+
+    // Result of loading the bundle in vst3mcp-scanner: empty if it was never
+    // scanned out of process, else "ok", "failed", "timeout" or "crashed".
+    std::string scanStatus;
+    std::string scanError;
+};
+
+// Index / scanner wire format.
+mcp::json scannedPluginToJson(const ScannedPlugin& plugin);
+bool scannedPluginFromJson(const mcp::json& obj, ScannedPlugin& plugin);
+
+// Persistent index of installed plugins for list_available_plugins.
+//
+// refresh() lists the bundle paths, stats each one and only re-reads
+// metadata for bundles whose mtime/size changed since the last scan;
+// removed bundles are dropped. Metadata comes from the bundle's
+// moduleinfo.json (Contents/Resources/moduleinfo.json) without loading the
+// plugin binary — bundles without one are listed by path and name only
+// until the out-of-process scanner (vst3mcp-scanner) has loaded them.
+//
+// The index is persisted as JSON so a new process starts from the previous
+// scan, and plugins() hands out an immutable snapshot, so readers never wait
+// for a scan in progress. A background thread re-scans periodically while at
+// least one user has called startBackgroundRefresh().
+//
+// All public methods are thread-safe.
+class PluginScanCache {
+public:
+    using PathProvider = std::function<std::vector<std::string>()>;
+    using Snapshot = std::shared_ptr<const std::vector<ScannedPlugin>>;
+
+    static constexpr auto kDefaultRefreshInterval = std::chrono::seconds(30);
+
+    // Process-wide cache over VST3::Hosting::Module::getModulePaths(),
+    // persisted at defaultIndexPath().
+    static PluginScanCache& shared();
+
+    // Empty indexPath disables persistence.
+    PluginScanCache(std::string indexPath, PathProvider paths);
+    ~PluginScanCache();
+
+    PluginScanCache(const PluginScanCache&) = delete;
+    PluginScanCache& operator=(const PluginScanCache&) = delete;
+
+    // Current index, sorted by path. Runs the first scan synchronously if
+    // neither a scan nor a successful load from disk has happened yet.
+    Snapshot plugins();
+
+    // Re-scan now. Returns the number of bundles whose metadata was (re)read.
+    // Picks up an index rewritten by another process (vst3mcp-scanner) first.
+    size_t refresh();
+
+    // Merge results of out-of-process scans into the index and save it.
+    // Successful results replace the bundle's metadata; failures only record
+    // scanStatus/scanError. Results for bundles not in the index are added.
+    void applyScanResults(const std::vector<ScannedPlugin>& results);
+
+    // Replace the in-memory index with the one on disk. Returns false if
+    // there is no readable index.
+    bool loadIndex();
+    bool saveIndex() const;
+
+    // Reference-counted: the first call starts the refresh thread, the
+    // matching last stopBackgroundRefresh() joins it.
+    void startBackgroundRefresh(std::chrono::milliseconds interval = kDefaultRefreshInterval);
+    void stopBackgroundRefresh();
+
+    // Fill name/vendor/version/classes from the bundle's moduleinfo.json.
+    // Returns false (leaving entry untouched) if there is none or it can't be parsed.
+    static bool readModuleInfo(const std::string& bundlePath, ScannedPlugin& entry);
+
+    // $XDG_CACHE_HOME (or ~/.cache) /vst3mcpwrapper/plugin-index.json on
+    // Linux, ~/Library/Caches/vst3mcpwrapper/plugin-index.json on macOS.
+    static std::string defaultIndexPath();
+
+private:
+    void runRefreshLoop(std::chrono::milliseconds interval);
+    int64_t indexFileStamp() const;
+    void reloadIfIndexChanged(); // Caller holds refreshMutex_
+
+    const std::string indexPath_;
+    const PathProvider paths_;
+
+    mutable std::mutex mutex_; // Guards plugins_, populated_ and indexStamp_
+    Snapshot plugins_;
+    bool populated_ = false;
+    mutable int64_t indexStamp_ = 0; // mtime of the index as last loaded or saved
+
+    std::mutex refreshMutex_; // Serializes scans
+
+    std::mutex threadMutex_;
+    std::condition_variable threadWake_;
+    std::thread thread_;
+    int backgroundUsers_ = 0;
+    bool stopThread_ = false;
+};
+
+} // namespace VST3MCPWrapper
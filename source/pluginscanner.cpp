@@ -0,0 +1,275 @@
+#include "pluginscanner.h"
+#include "hostedplugin.h"
+
+#include "public.sdk/source/vst/hosting/hostclasses.h"
+#include "public.sdk/source/vst/hosting/module.h"
+#include "pluginterfaces/vst/ivstcomponent.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+namespace VST3MCPWrapper {
+
+// ---- In-process scan (worker side) ----
+
+namespace {
+
+void readBuses(IComponent* component, ScannedPluginClass& cls) {
+    for (MediaType media : {static_cast<MediaType>(kAudio), static_cast<MediaType>(kEvent)}) {
+        for (BusDirection dir : {static_cast<BusDirection>(kInput), static_cast<BusDirection>(kOutput)}) {
+            int32 count = component->getBusCount(media, dir);
+            for (int32 i = 0; i < count; ++i) {
+                BusInfo info{};
+                if (component->getBusInfo(media, dir, i, info) != kResultOk)
+                    continue;
+                ScannedBus bus;
+                bus.name = utf16ToUtf8(info.name);
+                bus.mediaType = media == kAudio ? "audio" : "event";
+                bus.direction = dir == kInput ? "input" : "output";
+                bus.busType = info.busType == kMain ? "main" : "aux";
+                bus.channelCount = info.channelCount;
+                cls.buses.push_back(std::move(bus));
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool scanBundleInProcess(const std::string& bundlePath, ScannedPlugin& entry, std::string& error) {
+    auto module = VST3::Hosting::Module::create(bundlePath, error);
+    if (!module)
+        return false;
+
+    entry.path = bundlePath;
+    entry.classes.clear();
+    const auto& factory = module->getFactory();
+    entry.vendor = factory.info().vendor();
+
+    auto hostContext = owned(new HostApplication());
+    for (const auto& classInfo : factory.classInfos()) {
+        ScannedPluginClass cls;
+        cls.cid = classInfo.ID().toString();
+        cls.name = classInfo.name();
+        cls.category = classInfo.category();
+        cls.subCategories = classInfo.subCategories();
+        cls.vendor = classInfo.vendor();
+        cls.version = classInfo.version();
+
+        if (classInfo.category() == kVstAudioEffectClass) {
+            if (entry.name.empty())
+                entry.name = classInfo.name();
+            if (entry.version.empty())
+                entry.version = classInfo.version();
+            if (auto component = factory.createInstance<IComponent>(classInfo.ID())) {
+                if (component->initialize(static_cast<IHostApplication*>(hostContext.get())) == kResultOk) {
+                    readBuses(component, cls);
+                    component->terminate();
+                }
+            }
+        }
+        entry.classes.push_back(std::move(cls));
+    }
+
+    if (entry.name.empty())
+        entry.name = std::filesystem::path(bundlePath).stem().string();
+    entry.scanStatus = "ok";
+    entry.scanError.clear();
+    return true;
+}
+
+// ---- OutOfProcessScanner ----
+
+namespace {
+
+struct Worker {
+    std::string bundle;
+    pid_t pid = -1;
+    int fd = -1;
+    std::string output;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+bool spawnWorker(const std::vector<std::string>& command, Worker& worker) {
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+    std::vector<std::string> args = command;
+    args.push_back(worker.bundle);
+    std::vector<char*> argv;
+    for (auto& arg : args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        // Child: stdout to the pipe, plugin chatter on stderr discarded
+        dup2(fds[1], STDOUT_FILENO);
+        int devNull = open("/dev/null", O_WRONLY);
+        if (devNull >= 0)
+            dup2(devNull, STDERR_FILENO);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    worker.pid = pid;
+    worker.fd = fds[0];
+    return true;
+}
+
+ScannedPlugin finishWorker(Worker& worker, int status, bool timedOut) {
+    ScannedPlugin result;
+    result.path = worker.bundle;
+
+    if (timedOut) {
+        result.scanStatus = "timeout";
+        result.scanError = "Scan did not finish in time";
+        return result;
+    }
+    if (WIFSIGNALED(status)) {
+        result.scanStatus = "crashed";
+        result.scanError = std::string("Worker terminated by signal ") + std::to_string(WTERMSIG(status));
+        return result;
+    }
+
+    auto json = mcp::json::parse(worker.output, nullptr, false);
+    int exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    if (exitCode == 0 && scannedPluginFromJson(json, result) && result.path == worker.bundle) {
+        result.scanStatus = "ok";
+        result.scanError.clear();
+        return result;
+    }
+
+    result = ScannedPlugin{};
+    result.path = worker.bundle;
+    result.scanStatus = "failed";
+    if (json.is_object() && json.contains("error") && json["error"].is_string())
+        result.scanError = json["error"].get<std::string>();
+    else if (exitCode != 0)
+        result.scanError = "Worker exited with code " + std::to_string(exitCode);
+    else
+        result.scanError = "Worker produced no valid result";
+    return result;
+}
+
+} // namespace
+
+OutOfProcessScanner::OutOfProcessScanner(Options options)
+    : options_(std::move(options))
+{
+    if (options_.jobs == 0)
+        options_.jobs = 1;
+}
+
+std::vector<ScannedPlugin> OutOfProcessScanner::run(const std::vector<std::string>& bundles,
+                                                    const Progress& progress) const {
+    std::vector<ScannedPlugin> results;
+    results.reserve(bundles.size());
+    std::vector<Worker> running;
+    size_t next = 0;
+
+    auto complete = [&](ScannedPlugin result) {
+        if (progress)
+            progress(result);
+        results.push_back(std::move(result));
+    };
+
+    while (next < bundles.size() || !running.empty()) {
+        while (running.size() < options_.jobs && next < bundles.size()) {
+            Worker worker;
+            worker.bundle = bundles[next++];
+            worker.deadline = std::chrono::steady_clock::now() + options_.timeout;
+            if (!spawnWorker(options_.workerCommand, worker)) {
+                ScannedPlugin failed;
+                failed.path = worker.bundle;
+                failed.scanStatus = "failed";
+                failed.scanError = "Could not start scanner worker";
+                complete(std::move(failed));
+                continue;
+            }
+            running.push_back(std::move(worker));
+        }
+
+        // Wait for output or the nearest deadline, capped so exits of workers
+        // that closed stdout early are still noticed
+        auto now = std::chrono::steady_clock::now();
+        auto wait = std::chrono::milliseconds(50);
+        std::vector<pollfd> fds;
+        for (const auto& worker : running) {
+            wait = std::min(wait, std::max(std::chrono::milliseconds(0),
+                std::chrono::duration_cast<std::chrono::milliseconds>(worker.deadline - now)));
+            if (worker.fd >= 0)
+                fds.push_back({worker.fd, POLLIN, 0});
+        }
+        if (!fds.empty())
+            poll(fds.data(), fds.size(), static_cast<int>(wait.count()));
+        else if (!running.empty())
+            usleep(static_cast<useconds_t>(wait.count() * 1000));
+
+        char buffer[4096];
+        for (auto& worker : running) {
+            while (worker.fd >= 0) {
+                ssize_t n = read(worker.fd, buffer, sizeof(buffer));
+                if (n > 0) {
+                    worker.output.append(buffer, static_cast<size_t>(n));
+                } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                    close(worker.fd);
+                    worker.fd = -1;
+                } else {
+                    break;
+                }
+            }
+        }
+
+        now = std::chrono::steady_clock::now();
+        for (auto it = running.begin(); it != running.end();) {
+            int status = 0;
+            pid_t done = waitpid(it->pid, &status, WNOHANG);
+            bool timedOut = done == 0 && now >= it->deadline;
+            if (timedOut) {
+                kill(it->pid, SIGKILL);
+                waitpid(it->pid, &status, 0);
+            }
+            if (done == 0 && !timedOut) {
+                ++it;
+                continue;
+            }
+
+            // Collect anything written between the last read and exit
+            while (it->fd >= 0) {
+                ssize_t n = read(it->fd, buffer, sizeof(buffer));
+                if (n <= 0) {
+                    close(it->fd);
+                    it->fd = -1;
+                } else {
+                    it->output.append(buffer, static_cast<size_t>(n));
+                }
+            }
+            complete(finishWorker(*it, status, timedOut));
+            it = running.erase(it);
+        }
+    }
+    return results;
+}
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "pluginscan.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// Load a bundle in this process and read its factory: vendor, every class
+// and, for audio module classes, the bus layout of an initialized component.
+// This is what a vst3mcp-scanner worker runs — a misbehaving plugin can hang
+// or crash the calling process, so never call it from the wrapper itself.
+bool scanBundleInProcess(const std::string& bundlePath, ScannedPlugin& entry, std::string& error);
+
+// Scans bundles in a pool of worker subprocesses.
+//
+// Each bundle gets its own worker (workerCommand + bundle path), at most
+// `jobs` at a time. A worker prints one scannedPluginToJson() object on
+// stdout and exits 0; any other exit code is reported as "failed" with the
+// worker's {"error": ...} output, a worker killed by a signal as "crashed",
+// and one still running after `timeout` is killed and reported as "timeout".
+// A crash or hang only ever costs the one bundle. POSIX only.
+class OutOfProcessScanner {
+public:
+    struct Options {
+        // argv of the worker, the bundle path is appended as the last argument
+        std::vector<std::string> workerCommand;
+        size_t jobs = 4;
+        std::chrono::milliseconds timeout{10000};
+    };
+
+    explicit OutOfProcessScanner(Options options);
+
+    // Called as each bundle finishes, on the calling thread.
+    using Progress = std::function<void(const ScannedPlugin& result)>;
+
+    // Returns one result per bundle, in completion order. scanStatus is set
+    // on every result; path is always the bundle path that was scanned.
+    std::vector<ScannedPlugin> run(const std::vector<std::string>& bundles,
+                                   const Progress& progress = {}) const;
+
+private:
+    Options options_;
+};
+
+} // namespace VST3MCPWrapper
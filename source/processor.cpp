@@ -2,23 +2,124 @@
 #include "pluginids.h"
 #include "messageids.h"
 #include "hostedplugin.h"
+#include "instancepool.h"
+#include "instanceregistry.h"
+#include "modulecache.h"
 #include "logging.h"
 #include "stateformat.h"
 
-#include "public.sdk/source/vst/hosting/parameterchanges.h"
 #include "pluginterfaces/base/ibstream.h"
 #include "pluginterfaces/vst/ivstmessage.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstring>
+#include <random>
+#include <thread>
 
 using namespace Steinberg;
 using namespace Steinberg::Vst;
 
 namespace VST3MCPWrapper {
 
-Processor::Processor() {
+namespace {
+
+// Time reference for placing timed parameter changes inside one block.
+struct BlockClock {
+    const ProcessData& data;
+    double fallbackSampleRate;
+    int64 steadyNowNs = -1; // Read lazily — most blocks carry no wall-clock changes
+
+    double sampleRate() const {
+        return data.processContext && data.processContext->sampleRate > 0
+            ? data.processContext->sampleRate : fallbackSampleRate;
+    }
+
+    bool transportPlaying() const {
+        return data.processContext && (data.processContext->state & ProcessContext::kPlaying);
+    }
+
+    // Whether the transport loops back before reaching projectSample: a
+    // cycle is playing and the target lies at or past its end. The cycle
+    // end is converted to samples at the current tempo.
+    bool passesCycleEnd(int64 projectSample) const {
+        const auto* context = data.processContext;
+        constexpr uint32 kCycleFlags = ProcessContext::kCycleActive | ProcessContext::kCycleValid
+            | ProcessContext::kTempoValid;
+        if ((context->state & kCycleFlags) != kCycleFlags || context->tempo <= 0)
+            return false;
+        double cycleEnd = context->cycleEndMusic * 60.0 / context->tempo * sampleRate();
+        return context->projectTimeSamples < cycleEnd && static_cast<double>(projectSample) >= cycleEnd;
+    }
+
+    // Sample offset of change within this block. Returns false if the change
+    // is due in a later block. Late changes land on offset 0.
+    bool offsetFor(const ParamChange& change, int32& offset) {
+        int64 delta = 0;
+        switch (change.timing) {
+            case ParamChangeTiming::Immediate:
+                break;
+            case ParamChangeTiming::ProjectSample:
+                // Without a playing transport the position may never reach
+                // the target, so the change is applied now
+                if (transportPlaying() && !passesCycleEnd(change.time))
+                    delta = change.time - data.processContext->projectTimeSamples;
+                break;
+            case ParamChangeTiming::SteadyClock: {
+                double rate = sampleRate();
+                if (rate <= 0)
+                    break;
+                if (steadyNowNs < 0) {
+                    steadyNowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count();
+                }
+                delta = static_cast<int64>(
+                    static_cast<double>(change.time - steadyNowNs) * rate / 1e9);
+                break;
+            }
+        }
+
+        if (delta >= data.numSamples)
+            return false;
+        offset = delta > 0 ? static_cast<int32>(delta) : 0;
+        return true;
+    }
+};
+
+void addQueuedPoint(PreallocatedParameterChanges& changes, ParamID id, int32 sampleOffset, ParamValue value) {
+    int32 index;
+    auto* queue = changes.addParameterData(id, index);
+    if (queue) {
+        int32 pointIndex;
+        queue->addPoint(sampleOffset, value, pointIndex);
+    }
+}
+
+// Random 64-bit ID as 16 hex digits.
+std::string makeInstanceId() {
+    std::random_device device;
+    uint64 id = (static_cast<uint64>(device()) << 32) | device();
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(id));
+    return text;
+}
+
+constexpr const char* kSettingParamQueueMode = "paramQueueMode";
+
+} // namespace
+
+Processor::Processor() : hosted_(std::make_shared<HostedPluginInstance>()), instanceId_(makeInstanceId()) {
     setControllerClass(kControllerUID);
-    drainBuffer_.reserve(256);
+    drainBuffer_.reserve(HostedPluginInstance::kMaxParamDrainSize);
+    scheduledChanges_.reserve(kMaxScheduledParamChanges);
+    rampBuffer_.reserve(HostedPluginInstance::kRampQueueCapacity);
+    prepareMergedChanges();
+}
+
+void Processor::prepareMergedChanges() {
+    // Allocates only when the capacity changes — call off the audio thread.
+    mergedChanges_.allocate(kMaxMergedParameters, kMaxMergedPointsPerParameter);
 }
 
 tresult PLUGIN_API Processor::initialize(FUnknown* context) {
@@ -27,30 +128,125 @@ tresult PLUGIN_API Processor::initialize(FUnknown* context) {
         return result;
 
     hostContext_ = context;
+    registered_ = InstanceRegistry::shared().add(instanceId_, hosted_);
+    if (!registered_)
+        WRAPPER_LOG_ERROR("Instance ID %s is already registered", instanceId_.c_str());
 
     addAudioInput(STR16("Stereo In"), SpeakerArr::kStereo);
     addAudioOutput(STR16("Stereo Out"), SpeakerArr::kStereo);
     addEventInput(STR16("Event In"));
 
+    // Build warm instances for the pool with this processor's configuration
+    hosted_->warmPool().setComponentFactory(this, [this](const std::string& path, WarmComponent& out) {
+        std::string error;
+        auto module = ModuleCache::shared().acquire(path, error);
+        return module && createComponent(module, out);
+    });
+
     return kResultOk;
 }
 
 tresult PLUGIN_API Processor::terminate() {
+    hosted_->warmPool().removeComponentFactory(this);
+    pendingRestore_.reset();
     unloadHostedPlugin();
+    if (registered_) {
+        InstanceRegistry::shared().remove(instanceId_, hosted_.get());
+        registered_ = false;
+    }
     return AudioEffect::terminate();
 }
 
-bool Processor::loadHostedPlugin(const std::string& path) {
-    auto& pluginModule = HostedPluginModule::instance();
+void Processor::adoptInstanceId(const std::string& id) {
+    if (id == instanceId_)
+        return;
+    if (registered_) {
+        if (!InstanceRegistry::shared().add(id, hosted_)) {
+            WRAPPER_LOG_ERROR("Instance ID %s is in use by another instance, keeping %s",
+                              id.c_str(), instanceId_.c_str());
+            return;
+        }
+        InstanceRegistry::shared().remove(instanceId_, hosted_.get());
+    }
+    instanceId_ = id;
+    sendInstanceId();
+}
+
+void Processor::sendInstanceId() {
+    if (auto msg = owned(allocateMessage())) {
+        msg->setMessageID(MessageIds::kInstanceId);
+        msg->getAttributes()->setBinary("id", instanceId_.data(), static_cast<uint32>(instanceId_.size()));
+        sendMessage(msg);
+    }
+}
+
+tresult PLUGIN_API Processor::connect(IConnectionPoint* other) {
+    tresult result = AudioEffect::connect(other);
+    if (result == kResultOk)
+        sendInstanceId();
+    return result;
+}
+
+bool Processor::createHostedInstance(const std::string& path, HostedInstance& instance) {
+    // A warm instance from the pool skips initialize() and the replay below
+    WarmComponent warm;
+    if (!hosted_->warmPool().takeComponent(path, warm)) {
+        std::string error;
+        auto module = ModuleCache::shared().acquire(path, error);
+        if (!module) {
+            WRAPPER_LOG_ERROR("Failed to load module: %s", error.c_str());
+            return false;
+        }
+        if (!createComponent(module, warm))
+            return false;
+    }
+
+    instance.component = warm.component;
+    instance.processor = warm.processor;
+    instance.module = warm.module;
+    instance.path = path;
+    instance.hasControllerClassID = warm.hasControllerClassID;
+    std::memcpy(instance.controllerClassID, warm.controllerClassID, sizeof(TUID));
+    return true;
+}
+
+void Processor::shareHostedInstance(const HostedInstance& instance) {
+    auto& pluginModule = *hosted_;
     std::string error;
-    if (!pluginModule.load(path, error))
+    if (instance.module && !pluginModule.load(instance.path, instance.module, error))
+        WRAPPER_LOG_ERROR("Failed to share '%s': %s", instance.path.c_str(), error.c_str());
+
+    // Extract controller class ID for the controller to use
+    if (instance.hasControllerClassID)
+        pluginModule.setControllerClassID(instance.controllerClassID);
+    pluginModule.setHostedComponent(instance.component);
+}
+
+Processor::HostedInstance Processor::currentHostedInstance() const {
+    HostedInstance instance{hostedComponent_, hostedProcessor_, hostedModule_, currentPluginPath_};
+    instance.hasControllerClassID = hostedHasControllerClassID_;
+    std::memcpy(instance.controllerClassID, hostedControllerClassID_, sizeof(TUID));
+    return instance;
+}
+
+void Processor::adoptHostedInstance(const HostedInstance& instance) {
+    hostedComponent_ = instance.component;
+    hostedProcessor_ = instance.processor;
+    hostedModule_ = instance.module;
+    currentPluginPath_ = instance.path;
+    hostedHasControllerClassID_ = instance.hasControllerClassID;
+    std::memcpy(hostedControllerClassID_, instance.controllerClassID, sizeof(TUID));
+}
+
+bool Processor::createComponent(const VST3::Hosting::Module::Ptr& module, WarmComponent& out) {
+    if (!module)
         return false;
 
-    auto factory = pluginModule.getFactory();
-    if (!factory)
+    auto classes = ModuleCache::shared().classes(module);
+    if (!classes->hasAudioEffect)
         return false;
 
-    auto component = factory->createInstance<IComponent>(pluginModule.getEffectClassID());
+    auto component = module->getFactory().createInstance<IComponent>(classes->audioEffectClassID);
     if (!component)
         return false;
 
@@ -63,10 +259,6 @@ bool Processor::loadHostedPlugin(const std::string& path) {
         return false;
     }
 
-    hostedComponent_ = component;
-    hostedProcessor_ = IPtr<IAudioProcessor>(proc);
-    currentPluginPath_ = path;
-
     // Activate only the buses that match our wrapper's layout (1 audio in, 1 audio out,
     // 1 event in). Deactivate any extra buses (e.g. sidechain) since we don't provide
     // ProcessData buffers for them.
@@ -79,29 +271,66 @@ bool Processor::loadHostedPlugin(const std::string& path) {
     for (int32 i = 0; i < component->getBusCount(kEvent, kOutput); ++i)
         component->activateBus(kEvent, kOutput, i, false);
 
-    // Extract controller class ID for the controller to use
-    TUID controllerCID;
-    if (component->getControllerClassId(controllerCID) == kResultOk) {
-        pluginModule.setControllerClassID(controllerCID);
+    out.hasControllerClassID = component->getControllerClassId(out.controllerClassID) == kResultOk;
+
+    IPtr<IAudioProcessor> processor(proc);
+
+    {
+        // Warm instances are built on the dispatcher thread while the host
+        // may be reconfiguring us
+        std::lock_guard<std::mutex> lock(configMutex_);
+
+        // Replay stored bus arrangements
+        if (!storedInputArr_.empty() || !storedOutputArr_.empty()) {
+            processor->setBusArrangements(
+                storedInputArr_.empty() ? nullptr : storedInputArr_.data(),
+                static_cast<int32>(storedInputArr_.size()),
+                storedOutputArr_.empty() ? nullptr : storedOutputArr_.data(),
+                static_cast<int32>(storedOutputArr_.size()));
+        }
+
+        // Replay current processing setup if we have one
+        if (currentSetup_.sampleRate > 0) {
+            processor->setupProcessing(currentSetup_);
+        }
     }
 
-    // Share the hosted component so the controller can connect to it
-    pluginModule.setHostedComponent(hostedComponent_);
+    out.component = component;
+    out.processor = processor;
+    out.module = module;
+    return true;
+}
 
-    // Replay stored bus arrangements
-    if (!storedInputArr_.empty() || !storedOutputArr_.empty()) {
-        hostedProcessor_->setBusArrangements(
-            storedInputArr_.empty() ? nullptr : storedInputArr_.data(),
-            static_cast<int32>(storedInputArr_.size()),
-            storedOutputArr_.empty() ? nullptr : storedOutputArr_.data(),
-            static_cast<int32>(storedOutputArr_.size()));
+void Processor::releaseHostedInstance(HostedInstance& instance, bool active, bool processing) {
+    if (instance.component) {
+        if (processing && instance.processor)
+            instance.processor->setProcessing(false);
+        if (active)
+            instance.component->setActive(false);
+        instance.component->terminate();
     }
+    instance.processor = nullptr;
+    instance.component = nullptr;
+    instance.module.reset();
+}
 
-    // Replay current processing setup if we have one
-    if (currentSetup_.sampleRate > 0) {
-        hostedProcessor_->setupProcessing(currentSetup_);
+bool Processor::loadHostedPlugin(const std::string& path) {
+    HostedInstance instance;
+    if (!createHostedInstance(path, instance)) {
+        // Nothing is loaded now; don't leave the controller a module to use
+        hosted_->unload();
+        return false;
     }
 
+    adoptHostedInstance(instance);
+
+    // Share the hosted component so the controller can connect to it
+    shareHostedInstance(instance);
+
+    prepareMergedChanges();
+    scheduledChanges_.clear();
+    rampEngine_.clear();
+
     processorReady_.store(true, std::memory_order_release);
     return true;
 }
@@ -117,6 +346,22 @@ void Processor::replayDawStateOntoHosted() {
     }
 }
 
+void Processor::sendPluginLoaded(const std::string& path) {
+    if (auto msg = owned(allocateMessage())) {
+        msg->setMessageID(MessageIds::kPluginLoaded);
+        msg->getAttributes()->setBinary("path", path.data(), static_cast<uint32>(path.size()));
+        sendMessage(msg);
+    }
+}
+
+void Processor::sendPluginLoadFailed(const std::string& path) {
+    if (auto msg = owned(allocateMessage())) {
+        msg->setMessageID(MessageIds::kPluginLoadFailed);
+        msg->getAttributes()->setBinary("path", path.data(), static_cast<uint32>(path.size()));
+        sendMessage(msg);
+    }
+}
+
 void Processor::unloadHostedPlugin() {
     processorReady_.store(false, std::memory_order_release);
 
@@ -130,15 +375,120 @@ void Processor::unloadHostedPlugin() {
             hostedActive_.store(false, std::memory_order_relaxed);
         }
 
-        HostedPluginModule::instance().setHostedComponent(nullptr);
+        hosted_->setHostedComponent(nullptr);
         hostedComponent_->terminate();
         hostedProcessor_ = nullptr;
         hostedComponent_ = nullptr;
     }
+    hostedModule_.reset();
     currentPluginPath_.clear();
+    hostedHasControllerClassID_ = false;
+}
+
+// --- Hot swap ---
+
+bool Processor::canHotSwap() const {
+    return processorReady_.load(std::memory_order_acquire) && hostedProcessor_
+        && hostedActive_.load(std::memory_order_relaxed)
+        && hostedProcessing_.load(std::memory_order_relaxed)
+        && currentSetup_.sampleRate > 0 && currentSetup_.maxSamplesPerBlock > 0
+        && swapPhase_.load(std::memory_order_acquire) == SwapPhase::Idle;
+}
+
+bool Processor::hotSwapHostedPlugin(const std::string& path) {
+    HostedInstance incoming;
+    if (!createHostedInstance(path, incoming))
+        return false;
+
+    // Bring the new instance to the same state as the one playing
+    if (wrapperActive_.load(std::memory_order_relaxed))
+        incoming.component->setActive(true);
+    if (wrapperProcessing_.load(std::memory_order_relaxed))
+        incoming.processor->setProcessing(true);
+
+    beginHotSwap(std::move(incoming));
+    finishHotSwap(kSwapPickupTimeout, kSwapFadeTimeout);
+    return true;
+}
+
+void Processor::beginHotSwap(HostedInstance incoming) {
+    int32 channels = 2;
+    for (const auto* arrangements : {&storedInputArr_, &storedOutputArr_}) {
+        if (!arrangements->empty())
+            channels = std::max(channels, SpeakerArr::getChannelCount((*arrangements)[0]));
+    }
+    auto fadeSamples = static_cast<int32>(currentSetup_.sampleRate * kCrossfadeMs / 1000.0);
+    crossfade_.prepare(channels, currentSetup_.maxSamplesPerBlock, currentSetup_.symbolicSampleSize, fadeSamples);
+
+    incoming_ = std::move(incoming);
+    incomingRaw_ = incoming_.processor.get();
+    swapPhase_.store(SwapPhase::Pending, std::memory_order_release);
+}
+
+bool Processor::finishHotSwap(std::chrono::milliseconds pickupTimeout, std::chrono::milliseconds fadeTimeout) {
+    using Clock = std::chrono::steady_clock;
+    auto waitFor = [this](SwapPhase until, Clock::time_point deadline) {
+        while (swapPhase_.load(std::memory_order_acquire) != until && Clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return swapPhase_.load(std::memory_order_acquire) == until;
+    };
+
+    auto start = Clock::now();
+    bool crossfaded = true;
+    if (!waitFor(SwapPhase::Finished, start + pickupTimeout)) {
+        // Audio thread never took it (e.g. host stopped calling process()):
+        // withdraw the swap and switch over the way a cold load does
+        SwapPhase expected = SwapPhase::Pending;
+        if (swapPhase_.compare_exchange_strong(expected, SwapPhase::Idle, std::memory_order_acq_rel)) {
+            crossfaded = false;
+        } else if (!waitFor(SwapPhase::Finished, start + fadeTimeout)) {
+            WRAPPER_LOG_ERROR("Hot swap crossfade stalled, switching without it");
+            crossfaded = false;
+        }
+    }
+
+    if (!crossfaded) {
+        // The outgoing instance may still be inside a process() call
+        processorReady_.store(false, std::memory_order_seq_cst);
+        waitForProcessExit();
+    }
+    commitHotSwap();
+    if (!crossfaded)
+        processorReady_.store(true, std::memory_order_release);
+    return crossfaded;
+}
+
+void Processor::waitForProcessExit() {
+    // Odd while a process() call is running; any change means it returned
+    uint64_t epoch = processEpoch_.load(std::memory_order_seq_cst);
+    if (epoch % 2 == 0)
+        return;
+    while (processEpoch_.load(std::memory_order_seq_cst) == epoch)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void Processor::commitHotSwap() {
+    HostedInstance outgoing = currentHostedInstance();
+    bool wasActive = hostedActive_.load(std::memory_order_relaxed);
+    bool wasProcessing = hostedProcessing_.load(std::memory_order_relaxed);
+
+    HostedInstance incoming = std::move(incoming_);
+    incoming_ = {};
+    adoptHostedInstance(incoming);
+    hostedActive_.store(wrapperActive_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    hostedProcessing_.store(wrapperProcessing_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    swapPhase_.store(SwapPhase::Idle, std::memory_order_release);
+
+    // Only now does the shared instance move to the new plugin, so MCP and
+    // GUI edits kept going to the outgoing one while it played
+    shareHostedInstance(incoming);
+
+    // Off the audio thread, after it has stopped using the outgoing instance
+    releaseHostedInstance(outgoing, wasActive, wasProcessing);
 }
 
 tresult PLUGIN_API Processor::setActive(TBool state) {
+    completeRestore();
     wrapperActive_.store(state, std::memory_order_relaxed);
     if (hostedComponent_) {
         hostedComponent_->setActive(state);
@@ -164,8 +514,16 @@ tresult PLUGIN_API Processor::setBusArrangements(
         return kInvalidArgument;
 
     // Store for replay when loading a hosted plugin mid-session
-    storedInputArr_.assign(inputs, inputs + numIns);
-    storedOutputArr_.assign(outputs, outputs + numOuts);
+    bool changed;
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        changed = !std::equal(storedInputArr_.begin(), storedInputArr_.end(), inputs, inputs + numIns)
+               || !std::equal(storedOutputArr_.begin(), storedOutputArr_.end(), outputs, outputs + numOuts);
+        storedInputArr_.assign(inputs, inputs + numIns);
+        storedOutputArr_.assign(outputs, outputs + numOuts);
+    }
+    if (changed)
+        hosted_->warmPool().invalidateComponents();
 
     if (hostedProcessor_) {
         hostedProcessor_->setBusArrangements(inputs, numIns, outputs, numOuts);
@@ -174,7 +532,18 @@ tresult PLUGIN_API Processor::setBusArrangements(
 }
 
 tresult PLUGIN_API Processor::setupProcessing(ProcessSetup& setup) {
-    currentSetup_ = setup;
+    bool changed;
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        changed = currentSetup_.processMode != setup.processMode
+               || currentSetup_.symbolicSampleSize != setup.symbolicSampleSize
+               || currentSetup_.maxSamplesPerBlock != setup.maxSamplesPerBlock
+               || currentSetup_.sampleRate != setup.sampleRate;
+        currentSetup_ = setup;
+    }
+    if (changed)
+        hosted_->warmPool().invalidateComponents();
+    prepareMergedChanges();
     if (hostedProcessor_) {
         hostedProcessor_->setupProcessing(setup);
     }
@@ -182,18 +551,21 @@ tresult PLUGIN_API Processor::setupProcessing(ProcessSetup& setup) {
 }
 
 uint32 PLUGIN_API Processor::getLatencySamples() {
+    completeRestore();
     if (hostedProcessor_)
         return hostedProcessor_->getLatencySamples();
     return 0;
 }
 
 uint32 PLUGIN_API Processor::getTailSamples() {
+    completeRestore();
     if (hostedProcessor_)
         return hostedProcessor_->getTailSamples();
     return 0;
 }
 
 tresult PLUGIN_API Processor::canProcessSampleSize(int32 symbolicSampleSize) {
+    completeRestore();
     if (hostedProcessor_) {
         return hostedProcessor_->canProcessSampleSize(symbolicSampleSize);
     }
@@ -202,18 +574,42 @@ tresult PLUGIN_API Processor::canProcessSampleSize(int32 symbolicSampleSize) {
 }
 
 tresult PLUGIN_API Processor::process(ProcessData& data) {
-    if (processorReady_.load(std::memory_order_acquire) && hostedProcessor_ && hostedActive_.load(std::memory_order_relaxed)) {
+    ProcessScope scope(processEpoch_);
+    hosted_->setTransportPlaying(data.processContext
+                                 && (data.processContext->state & ProcessContext::kPlaying));
+
+    // Hot swap handshake, see SwapPhase in processor.h
+    SwapPhase swap = swapPhase_.load(std::memory_order_acquire);
+    if (swap == SwapPhase::Pending
+        && swapPhase_.compare_exchange_strong(swap, SwapPhase::Fading, std::memory_order_acq_rel)) {
+        swap = SwapPhase::Fading;
+        crossfade_.start();
+        // Queued timing state belongs to the outgoing plugin's parameters
+        scheduledChanges_.clear();
+        rampEngine_.clear();
+    }
+    IAudioProcessor* hosted = nullptr;
+    if (processorReady_.load(std::memory_order_seq_cst))
+        hosted = swap == SwapPhase::Finished ? incomingRaw_ : hostedProcessor_.get();
+
+    if (hosted && hostedActive_.load(std::memory_order_relaxed)) {
         // Drain pending parameter changes from MCP/GUI and inject into ProcessData
-        auto& pluginModule = HostedPluginModule::instance();
+        auto& pluginModule = *hosted_;
         drainBuffer_.clear();
         pluginModule.drainParamChanges(drainBuffer_);
-
-        if (!drainBuffer_.empty()) {
-            // Merge DAW automation changes with our queued MCP/GUI changes
+        rampBuffer_.clear();
+        ParamRamp ramp;
+        while (rampBuffer_.size() < HostedPluginInstance::kRampQueueCapacity && pluginModule.popParamRamp(ramp))
+            rampBuffer_.push_back(ramp);
+
+        if (!drainBuffer_.empty() || !scheduledChanges_.empty()
+            || !rampBuffer_.empty() || rampEngine_.activeCount() > 0) {
+            // Merge DAW automation changes with our queued MCP/GUI changes into the
+            // preallocated member — no heap allocation on the audio thread. Changes
+            // beyond its capacity are dropped rather than growing storage here.
             int32 dawParamCount = data.inputParameterChanges
                 ? data.inputParameterChanges->getParameterCount() : 0;
-            ParameterChanges mergedChanges(
-                dawParamCount + static_cast<int32>(drainBuffer_.size()));
+            mergedChanges_.clear();
 
             // Copy DAW automation changes first
             if (data.inputParameterChanges) {
@@ -221,7 +617,7 @@ tresult PLUGIN_API Processor::process(ProcessData& data) {
                     auto* srcQueue = data.inputParameterChanges->getParameterData(i);
                     if (!srcQueue) continue;
                     int32 index;
-                    auto* dstQueue = mergedChanges.addParameterData(
+                    auto* dstQueue = mergedChanges_.addParameterData(
                         srcQueue->getParameterId(), index);
                     if (!dstQueue) continue;
                     int32 pointCount = srcQueue->getPointCount();
@@ -236,24 +632,57 @@ tresult PLUGIN_API Processor::process(ProcessData& data) {
                 }
             }
 
-            // Add queued MCP/GUI changes (appended after DAW points for same param)
+            // Add queued MCP/GUI changes (appended after DAW points for same param).
+            // Immediate changes land on offset 0; timed ones at their target
+            // sample, or are held back until the block that contains it. An
+            // explicit change overrides a running ramp on the same parameter.
+            BlockClock clock{data, currentSetup_.sampleRate};
+            int32 sampleOffset = 0;
+            auto applyChange = [this](const ParamChange& change, int32 offset) {
+                addQueuedPoint(mergedChanges_, change.id, offset, change.value);
+                if (rampEngine_.activeCount() > 0)
+                    rampEngine_.cancel(change.id);
+            };
+
+            size_t stillScheduled = 0;
+            for (auto& change : scheduledChanges_) {
+                if (clock.offsetFor(change, sampleOffset))
+                    applyChange(change, sampleOffset);
+                else
+                    scheduledChanges_[stillScheduled++] = change;
+            }
+            scheduledChanges_.resize(stillScheduled);
+
             for (auto& change : drainBuffer_) {
-                int32 index;
-                auto* queue = mergedChanges.addParameterData(change.id, index);
-                if (queue) {
-                    int32 pointIndex;
-                    queue->addPoint(0, change.value, pointIndex);
-                }
+                if (clock.offsetFor(change, sampleOffset))
+                    applyChange(change, sampleOffset);
+                else if (scheduledChanges_.size() < kMaxScheduledParamChanges)
+                    scheduledChanges_.push_back(change);
+                else
+                    applyChange(change, 0);
+            }
+
+            // Ramps requested since the last block start after the explicit
+            // changes. If the ramp table is full the parameter jumps straight
+            // to its target.
+            for (auto& newRamp : rampBuffer_) {
+                if (!rampEngine_.start(newRamp, clock.sampleRate()))
+                    addQueuedPoint(mergedChanges_, newRamp.id, 0, newRamp.targetValue);
             }
+            rampEngine_.render(mergedChanges_, data.numSamples);
 
             auto* origInputChanges = data.inputParameterChanges;
-            data.inputParameterChanges = &mergedChanges;
-            auto result = hostedProcessor_->process(data);
+            data.inputParameterChanges = &mergedChanges_;
+            auto result = swap == SwapPhase::Fading ? processCrossfade(data) : hosted->process(data);
             data.inputParameterChanges = origInputChanges;
+            noteAppliedParamChanges(data, mergedChanges_.getParameterCount() > 0);
             return result;
         }
 
-        return hostedProcessor_->process(data);
+        auto result = swap == SwapPhase::Fading ? processCrossfade(data) : hosted->process(data);
+        noteAppliedParamChanges(data, data.inputParameterChanges
+                                          && data.inputParameterChanges->getParameterCount() > 0);
+        return result;
     }
 
     // Passthrough: copy input to output
@@ -287,17 +716,67 @@ tresult PLUGIN_API Processor::process(ProcessData& data) {
     return kResultOk;
 }
 
+void Processor::noteAppliedParamChanges(const ProcessData& data, bool inputChanged) {
+    // Changes queued by MCP/GUI already invalidated the state snapshot when
+    // they were pushed, but a getState() between push and this block may have
+    // cached the state from before they were applied
+    if (inputChanged || (data.outputParameterChanges && data.outputParameterChanges->getParameterCount() > 0))
+        hosted_->markStateChanged();
+}
+
+tresult Processor::processCrossfade(ProcessData& data) {
+    if (!crossfade_.fits(data)) {
+        // Block larger than prepared for: switch without a fade
+        swapPhase_.store(SwapPhase::Finished, std::memory_order_release);
+        return incomingRaw_->process(data);
+    }
+
+    // Incoming input is copied before the outgoing plugin may overwrite it in place
+    ProcessData incoming = crossfade_.incomingData(data);
+
+    // Only the incoming plugin reports output changes and events
+    ProcessData outgoing = data;
+    outgoing.outputParameterChanges = nullptr;
+    outgoing.outputEvents = nullptr;
+    hostedProcessor_->process(outgoing);
+
+    auto result = incomingRaw_->process(incoming);
+    if (crossfade_.mix(data))
+        swapPhase_.store(SwapPhase::Finished, std::memory_order_release);
+    return result;
+}
+
 tresult PLUGIN_API Processor::setState(IBStream* state) {
     if (!state)
         return kResultFalse;
 
-    // Read and validate wrapper state header
-    std::string pluginPath;
-    if (readStateHeader(state, pluginPath) != kResultOk)
+    // Read and validate the wrapper state (v1 header or v2 sections)
+    WrapperState saved;
+    if (readWrapperState(state, saved) != kResultOk)
         return kResultFalse;
 
+    // Whatever happens below, the state no longer matches the snapshot
+    hosted_->markStateChanged();
+
+    if (!saved.instanceId.empty())
+        adoptInstanceId(saved.instanceId);
+    auto mode = saved.settings.find(kSettingParamQueueMode);
+    if (mode != saved.settings.end()) {
+        hosted_->setParamQueueMode(mode->second == "fifo"
+                                       ? HostedPluginInstance::ParamQueueMode::Fifo
+                                       : HostedPluginInstance::ParamQueueMode::Coalesce);
+    }
+
+    // A newer state replaces one still waiting for its plugin
+    pendingRestore_.reset();
+
     // Load the plugin if needed
+    const std::string& pluginPath = saved.pluginPath;
     if (!pluginPath.empty() && pluginPath != currentPluginPath_) {
+        // Not active yet, e.g. opening a project: load it when it's needed
+        if (!wrapperActive_.load(std::memory_order_relaxed) && deferRestore(state, saved))
+            return kResultOk;
+
         unloadHostedPlugin();
         if (loadHostedPlugin(pluginPath)) {
             // Replay activation and processing state — setState() can be called
@@ -310,29 +789,123 @@ tresult PLUGIN_API Processor::setState(IBStream* state) {
         }
     }
 
-    // Forward remaining state to hosted component
-    if (hostedComponent_) {
+    return applyHostedState(state, saved);
+}
+
+tresult Processor::applyHostedState(IBStream* state, const WrapperState& saved) {
+    if (!hostedComponent_)
+        return kResultOk;
+
+    if (saved.effectClassId.size() == sizeof(TUID)
+        && std::memcmp(saved.effectClassId.data(), hosted_->getEffectClassID().toTUID(),
+                       sizeof(TUID)) != 0)
+        WRAPPER_LOG_ERROR("setState: '%s' no longer exports the saved effect class", saved.pluginPath.c_str());
+
+    // v1: the rest of the stream is the hosted component state
+    if (saved.version == kStateVersion)
         return hostedComponent_->setState(state);
+
+    if (!saved.componentState.present())
+        return kResultOk;
+    hosted_->setRestoredComponentState(saved.componentState.buffer);
+    return loadPayload(state, saved.componentState, [this](IBStream* hosted) {
+        return hostedComponent_->setState(hosted);
+    });
+}
+
+bool Processor::deferRestore(IBStream* state, WrapperState& saved) {
+    saved.controllerState = StatePayload(); // The controller restores its own
+    if (detachWrapperState(state, saved) != kResultOk) {
+        WRAPPER_LOG_ERROR("setState: could not copy the state of '%s', loading it now", saved.pluginPath.c_str());
+        return false;
     }
 
-    return kResultOk;
+    ModuleCache::shared().prefetch(saved.pluginPath);
+    // The controller restores from the same stream next and reuses the buffer
+    hosted_->setRestoredComponentState(saved.componentState.buffer);
+    pendingRestore_ = std::move(saved);
+    return true;
+}
+
+void Processor::completeRestore() {
+    if (!pendingRestore_)
+        return;
+    WrapperState saved = std::move(*pendingRestore_);
+    pendingRestore_.reset();
+
+    unloadHostedPlugin();
+    if (!loadHostedPlugin(saved.pluginPath)) {
+        WRAPPER_LOG_ERROR("setState: failed to load plugin '%s' — continuing in passthrough mode",
+                          saved.pluginPath.c_str());
+        return;
+    }
+    applyHostedState(nullptr, saved);
+    replayDawStateOntoHosted();
+    hosted_->markStateChanged();
+
+    // The controller may have set up its side before the component existed
+    sendPluginLoaded(saved.pluginPath);
 }
 
 tresult PLUGIN_API Processor::getState(IBStream* state) {
     if (!state)
         return kResultFalse;
+    completeRestore();
+
+    // Autosave and undo points call this often; as long as nothing marked the
+    // state changed since the last call, the same bytes are written again
+    // without asking the hosted plugin to serialize itself
+    auto& pluginModule = *hosted_;
+    std::lock_guard<std::mutex> lock(stateSnapshotMutex_);
+    uint64_t generation = pluginModule.getStateGeneration();
+    bool cacheable = !pluginModule.isHostedEditorOpen();
+    if (cacheable && stateSnapshot_ && stateSnapshotGeneration_ == generation)
+        return writeStateBytes(state, *stateSnapshot_);
+
+    CaptureStream capture;
+    tresult result = writeCurrentState(&capture);
+    if (result != kResultOk)
+        return result;
+    auto bytes = capture.take();
+    result = writeStateBytes(state, *bytes);
+
+    // A change during the capture bumped the generation past the one read
+    // above, so the next call captures again
+    if (result == kResultOk && cacheable) {
+        stateSnapshot_ = std::move(bytes);
+        stateSnapshotGeneration_ = generation;
+    } else {
+        stateSnapshot_.reset();
+    }
+    return result;
+}
 
-    // Write wrapper state header
-    tresult headerResult = writeStateHeader(state, currentPluginPath_);
-    if (headerResult != kResultOk)
-        return headerResult;
+tresult Processor::writeCurrentState(IBStream* state) {
+    WrapperState saved;
+    saved.instanceId = instanceId_;
+    saved.pluginPath = currentPluginPath_;
+    saved.settings[kSettingParamQueueMode] =
+        hosted_->getParamQueueMode() == HostedPluginInstance::ParamQueueMode::Fifo
+            ? "fifo"
+            : "coalesce";
 
-    // Write hosted component state
     if (hostedComponent_) {
-        return hostedComponent_->getState(state);
+        auto& pluginModule = *hosted_;
+        const TUID& effectClassId = pluginModule.getEffectClassID().toTUID();
+        saved.effectClassId.assign(effectClassId, effectClassId + sizeof(TUID));
+        if (pluginModule.hasControllerClassID()) {
+            TUID controllerClassId;
+            pluginModule.getControllerClassID(controllerClassId);
+            saved.controllerClassId.assign(controllerClassId, controllerClassId + sizeof(TUID));
+        }
+
+        tresult result = savePayload([this](IBStream* hosted) { return hostedComponent_->getState(hosted); },
+                                     saved.componentState);
+        if (result != kResultOk)
+            return result;
     }
 
-    return kResultOk;
+    return writeWrapperState(state, saved);
 }
 
 tresult PLUGIN_API Processor::notify(IMessage* message) {
@@ -348,26 +921,41 @@ tresult PLUGIN_API Processor::notify(IMessage* message) {
                 return kResultOk;
             }
             std::string path(static_cast<const char*>(data), size);
+            pendingRestore_.reset(); // Superseded by this load
+
+            if (canHotSwap()) {
+                // Audio is running through the current plugin: keep it playing
+                // while the new one is prepared, then crossfade
+                if (!hotSwapHostedPlugin(path)) {
+                    WRAPPER_LOG_ERROR("Failed to prepare '%s' for hot swap, keeping '%s'",
+                                      path.c_str(), currentPluginPath_.c_str());
+                    // The controller already moved the shared instance to path
+                    shareHostedInstance(currentHostedInstance());
+                    sendPluginLoadFailed(path);
+                    return kResultOk;
+                }
+            } else {
+                unloadHostedPlugin();
+                if (!loadHostedPlugin(path)) {
+                    WRAPPER_LOG_ERROR("Failed to load '%s'", path.c_str());
+                    sendPluginLoadFailed(path);
+                    return kResultOk;
+                }
 
-            unloadHostedPlugin();
-            loadHostedPlugin(path);
-
-            // Replay activation and processing state. On first load, these were
-            // never set because setActive()/setProcessing() were called by the DAW
-            // before any hosted component existed — use wrapper flags to replay.
-            replayDawStateOntoHosted();
+                // Replay activation and processing state. On first load, these were
+                // never set because setActive()/setProcessing() were called by the DAW
+                // before any hosted component existed — use wrapper flags to replay.
+                replayDawStateOntoHosted();
+            }
 
             // Send acknowledgment back to controller
-            if (auto msg = owned(allocateMessage())) {
-                msg->setMessageID(MessageIds::kPluginLoaded);
-                msg->getAttributes()->setBinary("path", path.data(), static_cast<uint32>(path.size()));
-                sendMessage(msg);
-            }
+            sendPluginLoaded(path);
         }
         return kResultOk;
     }
 
     if (strcmp(message->getMessageID(), MessageIds::kUnloadPlugin) == 0) {
+        pendingRestore_.reset();
         unloadHostedPlugin();
         return kResultOk;
     }
@@ -1,15 +1,28 @@
 #pragma once
 
+#include "crossfade.h"
+#include "instancepool.h"
+#include "paramchanges.h"
+#include "paramramp.h"
+#include "stateformat.h"
+#include "statestream.h"
+
+#include "public.sdk/source/vst/hosting/module.h"
 #include "public.sdk/source/vst/vstaudioeffect.h"
 #include "pluginterfaces/vst/ivstaudioprocessor.h"
 
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
 namespace VST3MCPWrapper {
 
 struct ParamChange;
+class HostedPluginInstance;
 class ProcessorTestAccess;
 
 class Processor : public Steinberg::Vst::AudioEffect {
@@ -38,31 +51,194 @@ public:
     Steinberg::tresult PLUGIN_API setState(Steinberg::IBStream* state) override;
     Steinberg::tresult PLUGIN_API getState(Steinberg::IBStream* state) override;
 
+    Steinberg::tresult PLUGIN_API connect(Steinberg::Vst::IConnectionPoint* other) override;
     Steinberg::tresult PLUGIN_API notify(Steinberg::Vst::IMessage* message) override;
 
+    // Random ID assigned at construction, saved with the state and restored
+    // by setState(), so an instance keeps its identity across sessions.
+    const std::string& getInstanceId() const { return instanceId_; }
+
+    // This wrapper instance's shared state, registered in InstanceRegistry
+    // under getInstanceId() while initialized. Created with the processor
+    // and never replaced, so the audio thread reads it without locking.
+    HostedPluginInstance& getHostedInstance() const { return *hosted_; }
+
 private:
+    // Hot swap: replacing a plugin that is processing audio.
+    //
+    // The message thread prepares the incoming instance completely
+    // (initialize, buses, setupProcessing, setActive, setProcessing) while the
+    // outgoing one keeps playing, then publishes it by setting swapPhase_ to
+    // Pending. The audio thread picks it up at the start of a block (Fading),
+    // runs both instances and crossfades over kCrossfadeMs with equal-power
+    // gains, then switches to the incoming one alone (Finished). The message
+    // thread waits for that, makes the incoming instance the hosted one
+    // (Idle), points hosted_ at it and only then deactivates and terminates
+    // the outgoing one. Without a finished fade it first waits for a running
+    // process() call to return (waitForProcessExit()).
+    //
+    // While the phase is not Idle, only the audio thread reads the incoming
+    // instance (through incomingRaw_), and the message thread doesn't touch
+    // hostedComponent_/hostedProcessor_ until the phase is Finished. In the
+    // Finished phase the audio thread no longer reads them.
+    enum class SwapPhase { Idle, Pending, Fading, Finished };
+
+    static constexpr double kCrossfadeMs = 10.0;
+    static constexpr auto kSwapPickupTimeout = std::chrono::milliseconds(500);
+    static constexpr auto kSwapFadeTimeout = std::chrono::milliseconds(2000);
+
+    struct HostedInstance {
+        Steinberg::IPtr<Steinberg::Vst::IComponent> component;
+        Steinberg::IPtr<Steinberg::Vst::IAudioProcessor> processor;
+        VST3::Hosting::Module::Ptr module; // Keeps the binary loaded while the instance lives
+        std::string path;
+        bool hasControllerClassID = false;
+        Steinberg::TUID controllerClassID = {};
+    };
+
+    // Counts process() calls in and out: the epoch is odd while one runs
+    struct ProcessScope {
+        explicit ProcessScope(std::atomic<uint64_t>& epoch) : epoch_(epoch) {
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+        }
+        ~ProcessScope() { epoch_.fetch_add(1, std::memory_order_release); }
+        std::atomic<uint64_t>& epoch_;
+    };
+
     bool loadHostedPlugin(const std::string& path);
     void unloadHostedPlugin();
     void replayDawStateOntoHosted();
+    void prepareMergedChanges();
+    // Tell the controller the hosted component is available (kPluginLoaded)
+    void sendPluginLoaded(const std::string& path);
+    // Tell the controller path couldn't be loaded (kPluginLoadFailed)
+    void sendPluginLoadFailed(const std::string& path);
+
+    // Session restore: setState() for another plugin while the DAW hasn't
+    // activated us (opening a project) doesn't load the plugin right away.
+    // It starts opening the module in the background (ModuleCache::prefetch())
+    // and keeps the state in pendingRestore_, so the module opens of every
+    // instance in the project overlap instead of running one after another.
+    // completeRestore() creates the component and applies the state on the
+    // host thread the first time it is needed: setActive(), getState() and
+    // the latency, tail and sample size queries.
+    //
+    // Keep saved for completeRestore(), its hosted state copied out of
+    // state. Returns false if that copy fails; state is then still usable.
+    bool deferRestore(Steinberg::IBStream* state, WrapperState& saved);
+    void completeRestore();
+    // Hand saved's hosted state to the hosted component. state is the stream
+    // saved was read from, or null for a state kept by deferRestore().
+    Steinberg::tresult applyHostedState(Steinberg::IBStream* state, const WrapperState& saved);
+
+    // Take a warm instance of path from the pool, or acquire its module from
+    // ModuleCache and create one with createComponent(). Not activated, and
+    // hosted_ is left alone: a hot swap keeps the outgoing plugin there
+    // until it commits.
+    bool createHostedInstance(const std::string& path, HostedInstance& instance);
+    // Point hosted_ (module, controller class ID, component) at instance
+    void shareHostedInstance(const HostedInstance& instance);
+    // The hosted* members as one instance, and back
+    HostedInstance currentHostedInstance() const;
+    void adoptHostedInstance(const HostedInstance& instance);
+    // Create and initialize an instance of the module's effect class, with
+    // buses, arrangements and processing setup replayed. Also the factory
+    // for warm instances, so it may run on the dispatcher thread.
+    bool createComponent(const VST3::Hosting::Module::Ptr& module, WarmComponent& out);
+    static void releaseHostedInstance(HostedInstance& instance, bool active, bool processing);
+
+    // Whether a load should hot swap instead of unload + load.
+    bool canHotSwap() const;
+    // Prepare path and crossfade to it. Returns false, leaving the current
+    // plugin untouched, if the new instance can't be created.
+    bool hotSwapHostedPlugin(const std::string& path);
+    void beginHotSwap(HostedInstance incoming);
+    // Wait for the audio thread to finish the fade and retire the outgoing
+    // instance. Falls back to a hard switch if the audio thread doesn't pick
+    // up the swap within pickupTimeout or finish it within fadeTimeout.
+    // Returns true if the swap was crossfaded.
+    bool finishHotSwap(std::chrono::milliseconds pickupTimeout, std::chrono::milliseconds fadeTimeout);
+    void commitHotSwap();
+    // Return once a process() call running now (if any) has returned. Calls
+    // that start later see processorReady_ as it was before this call.
+    void waitForProcessExit();
+
+    Steinberg::tresult processCrossfade(Steinberg::Vst::ProcessData& data);
+    // Invalidate the state snapshot if this block changed parameters
+    void noteAppliedParamChanges(const Steinberg::Vst::ProcessData& data, bool inputChanged);
+
+    // Serialize the wrapper and hosted state (what getState() caches)
+    Steinberg::tresult writeCurrentState(Steinberg::IBStream* state);
+
+    // Register hosted_ under id and make it instanceId_. Keeps the current ID
+    // if id belongs to another live instance (e.g. a duplicated track).
+    void adoptInstanceId(const std::string& id);
+    // Tell the controller which registry entry to share (kInstanceId)
+    void sendInstanceId();
 
     Steinberg::IPtr<Steinberg::Vst::IComponent> hostedComponent_;
     Steinberg::IPtr<Steinberg::Vst::IAudioProcessor> hostedProcessor_;
+    VST3::Hosting::Module::Ptr hostedModule_;
+    bool hostedHasControllerClassID_ = false;
+    Steinberg::TUID hostedControllerClassID_ = {};
+
+    std::atomic<SwapPhase> swapPhase_{SwapPhase::Idle};
+    HostedInstance incoming_;
+    Steinberg::Vst::IAudioProcessor* incomingRaw_ = nullptr;
+    Crossfade crossfade_;
     std::atomic<bool> wrapperActive_{false};      // Whether the DAW has activated our processor
     std::atomic<bool> wrapperProcessing_{false};  // Whether the DAW has called setProcessing(true)
     std::atomic<bool> hostedActive_{false};       // Whether the hosted component is active
     std::atomic<bool> hostedProcessing_{false};   // Whether the hosted processor is processing
     std::atomic<bool> processorReady_{false};
+    std::atomic<uint64_t> processEpoch_{0};
 
     Steinberg::FUnknown* hostContext_ = nullptr;
+    std::shared_ptr<HostedPluginInstance> hosted_;
+    bool registered_ = false; // Whether hosted_ is in InstanceRegistry under instanceId_
+
+    // Guards currentSetup_ and the stored arrangements between the host's
+    // setters and warm instance creation. The audio thread doesn't lock it.
+    std::mutex configMutex_;
     Steinberg::Vst::ProcessSetup currentSetup_{};
     std::string currentPluginPath_;
+    std::string instanceId_;
+
+    // State whose plugin isn't loaded yet (see deferRestore()). Host thread only.
+    std::optional<WrapperState> pendingRestore_;
+
+    // Last getState() output and the HostedPluginInstance state generation it
+    // was captured at
+    std::mutex stateSnapshotMutex_;
+    StateBuffer stateSnapshot_;
+    uint64_t stateSnapshotGeneration_ = 0;
 
     // Stored bus arrangements for replay when loading a plugin mid-session
     std::vector<Steinberg::Vst::SpeakerArrangement> storedInputArr_;
     std::vector<Steinberg::Vst::SpeakerArrangement> storedOutputArr_;
 
-    // Reusable buffer for draining parameter changes (avoids allocation in process())
+    // Reusable buffer for draining parameter changes. Reserved to the maximum
+    // drain size (FIFO ring + coalescing table) so process() never allocates.
     std::vector<ParamChange> drainBuffer_;
+
+    // Timed changes whose target lies beyond the current block. Reserved up
+    // front; if it fills, further early changes are applied immediately.
+    // Cleared on plugin load, before processorReady_ is published.
+    std::vector<ParamChange> scheduledChanges_;
+
+    // Ramp requests popped this block (reserved to the ramp queue capacity)
+    // and the engine that renders active ramps into mergedChanges_.
+    std::vector<ParamRamp> rampBuffer_;
+    ParamRampEngine rampEngine_;
+
+    // Reusable merge target for DAW automation + queued MCP/GUI changes.
+    // Sized off the audio thread (constructor, setupProcessing, plugin load),
+    // cleared per block in process() — the merge path never allocates.
+    PreallocatedParameterChanges mergedChanges_;
+
+    static constexpr Steinberg::int32 kMaxMergedParameters = 512;
+    static constexpr Steinberg::int32 kMaxMergedPointsPerParameter = 32;
+    static constexpr size_t kMaxScheduledParamChanges = 1024;
 };
 
 } // namespace VST3MCPWrapper
@@ -0,0 +1,136 @@
+// vst3mcp-scanner — rebuilds the wrapper's plugin index out of process.
+//
+//   vst3mcp-scanner [--jobs N] [--timeout-ms MS] [--index PATH] [--full] [BUNDLE...]
+//
+// Without bundles, scans every path from Module::getModulePaths(); bundles
+// already scanned at their current mtime/size are skipped unless --full is
+// given. Bundles named on the command line are always scanned. Each bundle
+// is loaded by a worker process (this executable with --scan-one), so a
+// plugin that hangs or crashes only fails its own entry.
+
+#include "pluginscan.h"
+#include "pluginscanner.h"
+
+#include "public.sdk/source/vst/hosting/module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+using namespace VST3MCPWrapper;
+
+namespace {
+
+std::string currentExecutablePath(const char* argv0) {
+#ifdef __APPLE__
+    char buffer[4096];
+    uint32_t size = sizeof(buffer);
+    if (_NSGetExecutablePath(buffer, &size) == 0)
+        return buffer;
+#else
+    std::error_code ec;
+    auto self = std::filesystem::read_symlink("/proc/self/exe", ec);
+    if (!ec)
+        return self.string();
+#endif
+    return argv0;
+}
+
+int scanOne(const std::string& bundle) {
+    ScannedPlugin entry;
+    std::string error;
+    if (!scanBundleInProcess(bundle, entry, error)) {
+        std::printf("%s\n", mcp::json{{"error", error.empty() ? "Failed to load module" : error}}.dump().c_str());
+        return 1;
+    }
+    std::printf("%s\n", scannedPluginToJson(entry).dump().c_str());
+    return 0;
+}
+
+void usage() {
+    std::fprintf(stderr,
+        "usage: vst3mcp-scanner [--jobs N] [--timeout-ms MS] [--index PATH] [--full] [BUNDLE...]\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+    long timeoutMs = 10000;
+    std::string indexPath = PluginScanCache::defaultIndexPath();
+    bool full = false;
+    std::vector<std::string> bundles;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        if (arg == "--scan-one") {
+            const char* bundle = value();
+            return bundle ? scanOne(bundle) : 2;
+        } else if (arg == "--jobs") {
+            const char* v = value();
+            if (!v || std::atoi(v) <= 0) { usage(); return 2; }
+            jobs = static_cast<size_t>(std::atoi(v));
+        } else if (arg == "--timeout-ms") {
+            const char* v = value();
+            if (!v || std::atol(v) <= 0) { usage(); return 2; }
+            timeoutMs = std::atol(v);
+        } else if (arg == "--index") {
+            const char* v = value();
+            if (!v) { usage(); return 2; }
+            indexPath = v;
+        } else if (arg == "--full") {
+            full = true;
+        } else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        } else {
+            bundles.push_back(arg);
+        }
+    }
+
+    // The index always covers the installed plugins; explicitly named
+    // bundles are added to it and always rescanned.
+    PluginScanCache::PathProvider provider = [bundles]() {
+        auto paths = VST3::Hosting::Module::getModulePaths();
+        paths.insert(paths.end(), bundles.begin(), bundles.end());
+        return paths;
+    };
+    PluginScanCache cache(indexPath, provider);
+    cache.refresh();
+
+    std::vector<std::string> pending = bundles;
+    if (bundles.empty()) {
+        for (const auto& plugin : *cache.plugins()) {
+            if (full || plugin.scanStatus.empty())
+                pending.push_back(plugin.path);
+        }
+    }
+
+    OutOfProcessScanner::Options options;
+    options.workerCommand = {currentExecutablePath(argv[0]), "--scan-one"};
+    options.jobs = jobs;
+    options.timeout = std::chrono::milliseconds(timeoutMs);
+
+    size_t failures = 0;
+    auto results = OutOfProcessScanner(options).run(pending, [&](const ScannedPlugin& result) {
+        if (result.scanStatus != "ok")
+            ++failures;
+        std::fprintf(stderr, "%-8s %s%s%s\n", result.scanStatus.c_str(), result.path.c_str(),
+                     result.scanError.empty() ? "" : ": ", result.scanError.c_str());
+    });
+    cache.applyScanResults(results);
+
+    std::fprintf(stderr, "Scanned %zu of %zu bundles (%zu failed), index: %s\n",
+                 results.size(), cache.plugins()->size(), failures, indexPath.c_str());
+    return 0;
+}
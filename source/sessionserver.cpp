@@ -0,0 +1,301 @@
+#include "sessionserver.h"
+#include "logging.h"
+#include "version.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <set>
+
+namespace VST3MCPWrapper {
+
+namespace {
+
+// Their notifications go out through the instance's own server
+const std::set<std::string> kUnroutableTools = {"subscribe_parameters", "unsubscribe_parameters"};
+
+mcp::json errorResult(const std::string& message) {
+    return {
+        {"content", {{{"type", "text"}, {"text", message}}}},
+        {"isError", true}
+    };
+}
+
+mcp::json textResult(const mcp::json& body) {
+    return {
+        {"content", {{{"type", "text"}, {"text", body.dump()}}}}
+    };
+}
+
+// One batch entry: the tool's text parsed back into JSON where it is JSON
+mcp::json batchEntry(const std::string& instance, const std::string& tool, const mcp::json& result) {
+    mcp::json entry = {{"instance", instance}, {"tool", tool}, {"isError", result.value("isError", false)}};
+    std::string text;
+    if (result.contains("content") && result["content"].is_array() && !result["content"].empty())
+        text = result["content"][0].value("text", "");
+    auto parsed = mcp::json::parse(text, nullptr, false);
+    entry["result"] = parsed.is_discarded() ? mcp::json(text) : parsed;
+    return entry;
+}
+
+} // namespace
+
+// ---- InstanceToolTable ----
+
+void InstanceToolTable::add(const mcp::tool& tool, mcp::tool_handler handler) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    handlers_[tool.name] = std::move(handler);
+}
+
+mcp::json InstanceToolTable::call(const std::string& name, const mcp::json& params,
+                                  const std::string& sessionId) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (closed_)
+        return errorResult("Instance is shutting down");
+    auto it = handlers_.find(name);
+    if (it == handlers_.end())
+        return errorResult("Unknown tool: " + name);
+    try {
+        return it->second(params, sessionId);
+    } catch (const std::exception& e) {
+        return errorResult(std::string("Invalid arguments: ") + e.what());
+    }
+}
+
+std::vector<std::string> InstanceToolTable::names() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<std::string> names;
+    for (const auto& [name, handler] : handlers_) {
+        if (!kUnroutableTools.count(name))
+            names.push_back(name);
+    }
+    return names;
+}
+
+void InstanceToolTable::setDescriber(std::function<mcp::json()> describe) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    describe_ = std::move(describe);
+}
+
+mcp::json InstanceToolTable::describe() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return describe_ && !closed_ ? describe_() : mcp::json::object();
+}
+
+void InstanceToolTable::close() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    closed_ = true;
+}
+
+// ---- SessionServer ----
+
+SessionServer& SessionServer::shared() {
+    static SessionServer server;
+    return server;
+}
+
+int SessionServer::configuredPort() {
+    const char* value = std::getenv("VST3MCP_SESSION_PORT");
+    if (!value || !*value)
+        return 0;
+    char* end = nullptr;
+    long port = std::strtol(value, &end, 10);
+    if (*end != '\0' || port <= 0 || port > 65535) {
+        WRAPPER_LOG_ERROR("Ignoring invalid VST3MCP_SESSION_PORT '%s'", value);
+        return 0;
+    }
+    return static_cast<int>(port);
+}
+
+SessionServer::~SessionServer() {
+    std::lock_guard<std::mutex> lock(serverMutex_);
+    if (server_)
+        server_->stop();
+    if (serverThread_.joinable())
+        serverThread_.join();
+}
+
+void SessionServer::start(int port) {
+    std::lock_guard<std::mutex> lock(serverMutex_);
+    if (users_++ > 0)
+        return;
+
+    mcp::server::configuration conf;
+    conf.host = "127.0.0.1";
+    conf.port = port;
+    conf.name = "VST3 MCP Wrapper Session";
+    conf.version = FULL_VERSION_STR;
+
+    try {
+        server_ = std::make_unique<mcp::server>(conf);
+        registerTools();
+        serverThread_ = std::thread([this]() {
+            try {
+                server_->start(true);
+            } catch (const std::exception& e) {
+                WRAPPER_LOG_ERROR("Session MCP server thread error: %s", e.what());
+            } catch (...) {
+                WRAPPER_LOG_ERROR("Session MCP server thread unknown error");
+            }
+        });
+    } catch (const std::exception& e) {
+        WRAPPER_LOG_ERROR("Failed to start session MCP server: %s", e.what());
+        server_.reset();
+    }
+}
+
+void SessionServer::stop() {
+    std::unique_ptr<mcp::server> server;
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(serverMutex_);
+        if (users_ == 0 || --users_ > 0)
+            return;
+        server = std::move(server_);
+        thread = std::move(serverThread_);
+    }
+    if (server)
+        server->stop();
+    if (thread.joinable())
+        thread.join();
+}
+
+void SessionServer::registerTools() {
+    // Caller must hold serverMutex_
+    auto listTool = mcp::tool_builder("list_instances")
+        .with_description("List the wrapper instances in this DAW process with their IDs, loaded plugin "
+                          "and the tools call_instance and batch can run on them")
+        .build();
+
+    server_->register_tool(listTool, [this](const mcp::json& params, const std::string& session_id) -> mcp::json {
+        return handleListInstances();
+    });
+
+    auto callTool = mcp::tool_builder("call_instance")
+        .with_description("Run one of an instance's tools (e.g. set_parameters, list_parameters, load_plugin) "
+                          "and return its result. Parameter subscriptions are only available on the "
+                          "instance's own server.")
+        .with_string_param("instance", "Instance ID from list_instances", true)
+        .with_string_param("tool", "Name of the instance tool", true)
+        .with_object_param("arguments", "Optional: the tool's arguments", mcp::json::object(), false)
+        .build();
+
+    server_->register_tool(callTool, [this](const mcp::json& params, const std::string& session_id) -> mcp::json {
+        mcp::json arguments = params.contains("arguments") ? params["arguments"] : mcp::json::object();
+        return handleCallInstance(params["instance"].get<std::string>(), params["tool"].get<std::string>(),
+                                  arguments, session_id);
+    });
+
+    auto batchTool = mcp::tool_builder("batch")
+        .with_description("Run many instance tool calls in one request. Calls for different instances run in "
+                          "parallel, calls for the same instance in the order given. Returns {results: "
+                          "[{instance, tool, isError, result}]} in the order of calls; one failing call "
+                          "does not stop the others.")
+        .with_array_param("calls", "Array of {\"instance\": string, \"tool\": string, \"arguments\": object} "
+                          "(at most 256)", "object", true)
+        .build();
+
+    server_->register_tool(batchTool, [this](const mcp::json& params, const std::string& session_id) -> mcp::json {
+        return handleBatch(params["calls"], session_id);
+    });
+}
+
+void SessionServer::attach(const std::string& id, std::shared_ptr<InstanceToolTable> tools) {
+    std::lock_guard<std::mutex> lock(instancesMutex_);
+    instances_[id] = std::move(tools);
+}
+
+void SessionServer::detach(const std::string& id, const InstanceToolTable* tools) {
+    std::lock_guard<std::mutex> lock(instancesMutex_);
+    auto it = instances_.find(id);
+    if (it != instances_.end() && it->second.get() == tools)
+        instances_.erase(it);
+}
+
+std::shared_ptr<InstanceToolTable> SessionServer::find(const std::string& id) const {
+    std::lock_guard<std::mutex> lock(instancesMutex_);
+    auto it = instances_.find(id);
+    return it != instances_.end() ? it->second : nullptr;
+}
+
+mcp::json SessionServer::handleListInstances() const {
+    std::map<std::string, std::shared_ptr<InstanceToolTable>> instances;
+    {
+        std::lock_guard<std::mutex> lock(instancesMutex_);
+        instances = instances_;
+    }
+
+    mcp::json list = mcp::json::array();
+    for (const auto& [id, tools] : instances) {
+        mcp::json entry = tools->describe();
+        entry["id"] = id;
+        entry["tools"] = tools->names();
+        list.push_back(std::move(entry));
+    }
+    return textResult({{"instances", std::move(list)}});
+}
+
+mcp::json SessionServer::handleCallInstance(const std::string& id, const std::string& tool, const mcp::json& params,
+                                            const std::string& sessionId) const {
+    if (kUnroutableTools.count(tool))
+        return errorResult(tool + " is only available on the instance's own server");
+    auto tools = find(id);
+    if (!tools)
+        return errorResult("Unknown instance: " + id);
+    return tools->call(tool, params.is_object() ? params : mcp::json::object(), sessionId);
+}
+
+mcp::json SessionServer::handleBatch(const mcp::json& calls, const std::string& sessionId) const {
+    if (!calls.is_array())
+        return errorResult("calls must be an array");
+    if (calls.size() > kMaxBatchCalls)
+        return errorResult("Too many calls (max " + std::to_string(kMaxBatchCalls) + ")");
+
+    // Validate every call before running any
+    for (size_t i = 0; i < calls.size(); ++i) {
+        const auto& call = calls[i];
+        if (!call.is_object() || !call.contains("instance") || !call["instance"].is_string()
+            || !call.contains("tool") || !call["tool"].is_string()
+            || (call.contains("arguments") && !call["arguments"].is_object())) {
+            return errorResult("calls[" + std::to_string(i)
+                               + "] must be {\"instance\": string, \"tool\": string, \"arguments\": object}");
+        }
+    }
+
+    // One group per instance, in order of first appearance
+    std::vector<std::vector<size_t>> groups;
+    std::map<std::string, size_t> groupOf;
+    for (size_t i = 0; i < calls.size(); ++i) {
+        auto [it, added] = groupOf.emplace(calls[i]["instance"].get<std::string>(), groups.size());
+        if (added)
+            groups.emplace_back();
+        groups[it->second].push_back(i);
+    }
+
+    std::vector<mcp::json> results(calls.size());
+    std::atomic<size_t> nextGroup{0};
+    auto runGroups = [&]() {
+        for (size_t g = nextGroup++; g < groups.size(); g = nextGroup++) {
+            for (size_t i : groups[g]) {
+                const auto& call = calls[i];
+                auto instance = call["instance"].get<std::string>();
+                auto tool = call["tool"].get<std::string>();
+                mcp::json arguments = call.contains("arguments") ? call["arguments"] : mcp::json::object();
+                results[i] = batchEntry(instance, tool, handleCallInstance(instance, tool, arguments, sessionId));
+            }
+        }
+    };
+
+    // The calling thread takes a share of the groups too
+    size_t workers = std::min(groups.size(), kMaxParallelInstances);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i)
+        threads.emplace_back(runGroups);
+    runGroups();
+    for (auto& thread : threads)
+        thread.join();
+
+    return textResult({{"results", std::move(results)}});
+}
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "mcp_message.h"
+#include "mcp_server.h"
+#include "mcp_tool.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// The tools of one wrapper instance's MCP server, callable by name so the
+// session server can route calls to them.
+//
+// close() waits for calls that are running and makes later ones fail, so
+// the controller can tear down what the handlers use right after it.
+//
+// Thread-safe.
+class InstanceToolTable {
+public:
+    void add(const mcp::tool& tool, mcp::tool_handler handler);
+
+    // Unknown tools and calls after close() return an isError result.
+    mcp::json call(const std::string& name, const mcp::json& params, const std::string& sessionId) const;
+
+    std::vector<std::string> names() const;
+
+    // Extra fields for list_instances (e.g. the loaded plugin)
+    void setDescriber(std::function<mcp::json()> describe);
+    mcp::json describe() const;
+
+    void close();
+
+private:
+    mutable std::shared_mutex mutex_; // Shared while a call runs
+    bool closed_ = false;
+    std::map<std::string, mcp::tool_handler> handlers_;
+    std::function<mcp::json()> describe_;
+};
+
+// Optional MCP server that puts every wrapper instance in the DAW process
+// behind one endpoint.
+//
+// Controllers attach their tool table under their instance ID once bound
+// to the processor. Clients address an instance with call_instance, or
+// send many calls at once with batch: calls for different instances run
+// in parallel (up to kMaxParallelInstances at a time), calls for the same
+// instance run in the order given.
+//
+// Off unless VST3MCP_SESSION_PORT names a port (configuredPort()). The
+// per-instance servers keep running either way.
+//
+// All public methods are thread-safe.
+class SessionServer {
+public:
+    static constexpr size_t kMaxBatchCalls = 256;
+    static constexpr size_t kMaxParallelInstances = 8;
+
+    static SessionServer& shared();
+
+    // Port from VST3MCP_SESSION_PORT, or 0 if unset or invalid
+    static int configuredPort();
+
+    SessionServer() = default;
+    ~SessionServer();
+
+    SessionServer(const SessionServer&) = delete;
+    SessionServer& operator=(const SessionServer&) = delete;
+
+    // Reference-counted: the first call starts the HTTP server on port, the
+    // matching last stop() shuts it down.
+    void start(int port);
+    void stop();
+
+    // Route calls for id to tools. Replaces an earlier table for id.
+    void attach(const std::string& id, std::shared_ptr<InstanceToolTable> tools);
+    // Remove id if it is routed to tools.
+    void detach(const std::string& id, const InstanceToolTable* tools);
+
+    // Tool implementations, callable without the HTTP server
+    mcp::json handleListInstances() const;
+    mcp::json handleCallInstance(const std::string& id, const std::string& tool, const mcp::json& params,
+                                 const std::string& sessionId) const;
+    mcp::json handleBatch(const mcp::json& calls, const std::string& sessionId) const;
+
+private:
+    std::shared_ptr<InstanceToolTable> find(const std::string& id) const;
+    void registerTools();
+
+    mutable std::mutex instancesMutex_;
+    std::map<std::string, std::shared_ptr<InstanceToolTable>> instances_;
+
+    std::mutex serverMutex_; // Guards the members below
+    size_t users_ = 0;
+    std::unique_ptr<mcp::server> server_;
+    std::thread serverThread_;
+};
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,516 @@
+#include "stateformat.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace Steinberg;
+
+namespace VST3MCPWrapper {
+
+namespace {
+
+// Streams take int32 byte counts: larger payloads go through in chunks.
+constexpr size_t kMaxStreamChunk = size_t(1) << 30;
+
+bool writeAll(IBStream* state, const void* data, size_t size) {
+    auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        int32 chunk = static_cast<int32>(std::min(size, kMaxStreamChunk));
+        int32 numBytesWritten = 0;
+        if (state->write(const_cast<char*>(bytes), chunk, &numBytesWritten) != kResultOk
+            || numBytesWritten != chunk)
+            return false;
+        bytes += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+bool readAll(IBStream* state, void* data, size_t size) {
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        int32 chunk = static_cast<int32>(std::min(size, kMaxStreamChunk));
+        int32 numBytesRead = 0;
+        if (state->read(bytes, chunk, &numBytesRead) != kResultOk || numBytesRead != chunk)
+            return false;
+        bytes += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+// Section header; packed field by field so there is no padding on disk.
+struct SectionHeader {
+    char tag[4] = {};
+    uint8 codec = 0;
+    uint64 rawSize = 0;
+    uint64 storedSize = 0;
+    uint32 crc = 0;
+};
+
+constexpr size_t kSectionHeaderSize = 28;
+// Unit for streaming payloads through CRC and (de)compression.
+constexpr size_t kPayloadChunk = 64 * 1024;
+// Bytes of a large payload deflated first to tell whether it compresses at all.
+constexpr size_t kCompressSample = 256 * 1024;
+
+void packHeader(const SectionHeader& header, char out[kSectionHeaderSize]) {
+    std::memset(out, 0, kSectionHeaderSize);
+    std::memcpy(out, header.tag, 4);
+    out[4] = static_cast<char>(header.codec);
+    std::memcpy(out + 8, &header.rawSize, 8);
+    std::memcpy(out + 16, &header.storedSize, 8);
+    std::memcpy(out + 24, &header.crc, 4);
+}
+
+void unpackHeader(const char in[kSectionHeaderSize], SectionHeader& header) {
+    std::memcpy(header.tag, in, 4);
+    header.codec = static_cast<uint8>(in[4]);
+    std::memcpy(&header.rawSize, in + 8, 8);
+    std::memcpy(&header.storedSize, in + 16, 8);
+    std::memcpy(&header.crc, in + 24, 4);
+}
+
+uint32 crcOf(const char* data, size_t size, uint32 crc = 0) {
+    // Sections are capped at kMaxStateSectionSize, which fits in uInt
+    return static_cast<uint32>(crc32(crc, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size)));
+}
+
+// Deflate data into out. Returns false, leaving the data to be stored raw,
+// if that wouldn't make it smaller; a sample of the head is tried first so
+// incompressible state isn't run through deflate in full.
+bool deflatePayload(const char* data, size_t size, std::vector<char>& out) {
+    if (size > kCompressSample) {
+        uLongf sampleSize = compressBound(kCompressSample);
+        std::vector<Bytef> sample(sampleSize);
+        if (compress2(sample.data(), &sampleSize, reinterpret_cast<const Bytef*>(data), kCompressSample,
+                      Z_BEST_SPEED) != Z_OK
+            || sampleSize >= kCompressSample / 10 * 9)
+            return false;
+    }
+
+    z_stream zs = {};
+    if (deflateInit(&zs, Z_BEST_SPEED) != Z_OK)
+        return false;
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs.avail_in = static_cast<uInt>(size);
+
+    // Grow the output a chunk at a time, giving up once it reaches the input size
+    out.clear();
+    int status = Z_OK;
+    while (status == Z_OK && out.size() < size) {
+        size_t used = out.size();
+        out.resize(std::min(size, used + kPayloadChunk));
+        zs.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+        zs.avail_out = static_cast<uInt>(out.size() - used);
+        status = deflate(&zs, Z_FINISH);
+        out.resize(zs.total_out);
+    }
+    deflateEnd(&zs);
+    return status == Z_STREAM_END && out.size() < size;
+}
+
+// Inflate storedSize bytes of the stream into out, which is sized to the raw size.
+bool inflatePayload(IBStream* state, uint64 storedSize, std::vector<char>& out) {
+    z_stream zs = {};
+    if (inflateInit(&zs) != Z_OK)
+        return false;
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+
+    std::vector<char> chunk(static_cast<size_t>(std::min<uint64>(storedSize, kPayloadChunk)));
+    uint64 remaining = storedSize;
+    int status = Z_OK;
+    while (remaining > 0 && status == Z_OK) {
+        size_t count = static_cast<size_t>(std::min<uint64>(remaining, chunk.size()));
+        if (!readAll(state, chunk.data(), count))
+            break;
+        remaining -= count;
+        zs.next_in = reinterpret_cast<Bytef*>(chunk.data());
+        zs.avail_in = static_cast<uInt>(count);
+        status = inflate(&zs, Z_NO_FLUSH);
+        // Input left over with the output full: more data than rawSize
+        if (status == Z_OK && zs.avail_in > 0)
+            break;
+    }
+    bool ok = status == Z_STREAM_END && remaining == 0 && zs.avail_in == 0 && zs.total_out == out.size();
+    inflateEnd(&zs);
+    return ok;
+}
+
+bool writeSection(IBStream* state, const char tag[4], const char* data, size_t size, size_t compressThreshold) {
+    if (size > kMaxStateSectionSize)
+        return false;
+
+    SectionHeader header;
+    std::memcpy(header.tag, tag, sizeof(header.tag));
+    header.rawSize = size;
+    header.storedSize = size;
+    header.crc = crcOf(data, size);
+
+    const char* payload = data;
+    std::vector<char> compressed;
+    if (size >= compressThreshold && deflatePayload(data, size, compressed)) {
+        header.codec = static_cast<uint8>(StateCodec::Deflate);
+        header.storedSize = compressed.size();
+        payload = compressed.data();
+    }
+
+    char packed[kSectionHeaderSize];
+    packHeader(header, packed);
+    return writeAll(state, packed, sizeof(packed)) && writeAll(state, payload, static_cast<size_t>(header.storedSize));
+}
+
+bool writeSection(IBStream* state, const char tag[4], const std::string& value) {
+    return writeSection(state, tag, value.data(), value.size(), std::numeric_limits<size_t>::max());
+}
+
+bool readSectionHeader(IBStream* state, SectionHeader& header) {
+    char packed[kSectionHeaderSize];
+    if (!readAll(state, packed, sizeof(packed)))
+        return false;
+    unpackHeader(packed, header);
+    return true;
+}
+
+bool skipPayload(IBStream* state, uint64 size) {
+    int64 target = 0;
+    int64 current = 0;
+    if (state->tell(&current) != kResultOk)
+        return false;
+    return state->seek(static_cast<int64>(size), IBStream::kIBSeekCur, &target) == kResultOk
+           && target == current + static_cast<int64>(size);
+}
+
+bool readPayload(IBStream* state, const SectionHeader& header, std::vector<char>& out) {
+    if (header.rawSize > kMaxStateSectionSize || header.storedSize > kMaxStateSectionSize)
+        return false;
+
+    out.resize(static_cast<size_t>(header.rawSize));
+    switch (static_cast<StateCodec>(header.codec)) {
+        case StateCodec::None:
+            if (header.storedSize != header.rawSize || !readAll(state, out.data(), out.size()))
+                return false;
+            break;
+
+        case StateCodec::Deflate:
+            if (!inflatePayload(state, header.storedSize, out))
+                return false;
+            break;
+
+        default:
+            return false;
+    }
+
+    return crcOf(out.data(), out.size()) == header.crc;
+}
+
+// Hosted state: shared with known if it matches, left in the stream if it is
+// stored raw (the stream is read through once to check the CRC), otherwise
+// decompressed into a buffer.
+bool readHostedPayload(IBStream* state, const SectionHeader& header, const StateBuffer& known,
+                       StatePayload& payload) {
+    payload = StatePayload();
+    payload.size = header.rawSize;
+    payload.crc = header.crc;
+
+    if (known && known->size() == header.rawSize && crcOf(known->data(), known->size()) == header.crc) {
+        payload.buffer = known;
+        return skipPayload(state, header.storedSize);
+    }
+
+    int64 offset = 0;
+    if (static_cast<StateCodec>(header.codec) == StateCodec::None && header.storedSize == header.rawSize
+        && header.rawSize <= kMaxStateSectionSize && state->tell(&offset) == kResultOk) {
+        std::vector<char> chunk(static_cast<size_t>(std::min<uint64>(header.rawSize, kPayloadChunk)));
+        uint32 crc = 0;
+        for (uint64 remaining = header.rawSize; remaining > 0;) {
+            size_t count = static_cast<size_t>(std::min<uint64>(remaining, chunk.size()));
+            if (!readAll(state, chunk.data(), count))
+                return false;
+            crc = crcOf(chunk.data(), count, crc);
+            remaining -= count;
+        }
+        payload.offset = offset;
+        return crc == header.crc;
+    }
+
+    std::vector<char> bytes;
+    if (!readPayload(state, header, bytes))
+        return false;
+    payload.buffer = std::make_shared<const std::vector<char>>(std::move(bytes));
+    return true;
+}
+
+std::string encodeSettings(const std::map<std::string, std::string>& settings) {
+    std::string text;
+    for (const auto& [key, value] : settings)
+        text += key + "=" + value + "\n";
+    return text;
+}
+
+void decodeSettings(const std::vector<char>& text, std::map<std::string, std::string>& settings) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        auto end = std::find(text.begin() + pos, text.end(), '\n');
+        std::string line(text.begin() + pos, end);
+        pos = static_cast<size_t>(end - text.begin()) + 1;
+
+        auto eq = line.find('=');
+        if (eq != std::string::npos)
+            settings[line.substr(0, eq)] = line.substr(eq + 1);
+    }
+}
+
+bool tagIs(const SectionHeader& header, const char tag[4]) {
+    return std::memcmp(header.tag, tag, sizeof(header.tag)) == 0;
+}
+
+// Reads the v1 path field that follows magic and version.
+tresult readPath(IBStream* state, std::string& pluginPath) {
+    int32 numBytesRead = 0;
+    uint32 pathLen = 0;
+    if (state->read(&pathLen, sizeof(pathLen), &numBytesRead) != kResultOk
+        || numBytesRead != sizeof(pathLen))
+        return kResultFalse;
+
+    if (pathLen > kMaxPathLen)
+        return kResultFalse;
+
+    pluginPath.clear();
+    if (pathLen > 0) {
+        pluginPath.resize(pathLen);
+        if (state->read(pluginPath.data(), pathLen, &numBytesRead) != kResultOk
+            || numBytesRead != static_cast<int32>(pathLen))
+            return kResultFalse;
+    }
+
+    return kResultOk;
+}
+
+tresult readMagicAndVersion(IBStream* state, uint32& version) {
+    char header[8] = {};
+    int32 numBytesRead = 0;
+    if (state->read(header, sizeof(header), &numBytesRead) != kResultOk || numBytesRead != sizeof(header))
+        return kResultFalse;
+
+    if (std::memcmp(header, kStateMagic, sizeof(kStateMagic)) != 0)
+        return kResultFalse;
+
+    std::memcpy(&version, header + 4, sizeof(version));
+    return kResultOk;
+}
+
+tresult writeMagicAndVersion(IBStream* state, uint32 version) {
+    char header[8];
+    std::memcpy(header, kStateMagic, sizeof(kStateMagic));
+    std::memcpy(header + 4, &version, sizeof(version));
+
+    int32 numBytesWritten = 0;
+    if (state->write(header, sizeof(header), &numBytesWritten) != kResultOk
+        || numBytesWritten != sizeof(header))
+        return kResultFalse;
+
+    return kResultOk;
+}
+
+// The rest of stream from its current position (a v1 stream's hosted state),
+// left in the stream. Not present if the stream can't seek.
+StatePayload remainingPayload(IBStream* stream) {
+    StatePayload payload;
+    int64 pos = 0;
+    int64 end = 0;
+    int64 back = 0;
+    if (!stream || stream->tell(&pos) != kResultOk || stream->seek(0, IBStream::kIBSeekEnd, &end) != kResultOk
+        || stream->seek(pos, IBStream::kIBSeekSet, &back) != kResultOk || back != pos || end < pos)
+        return payload;
+    payload.offset = pos;
+    payload.size = static_cast<uint64>(end - pos);
+    return payload;
+}
+
+} // namespace
+
+tresult writeStateHeader(IBStream* state, const std::string& pluginPath) {
+    if (!state)
+        return kResultFalse;
+
+    if (writeMagicAndVersion(state, kStateVersion) != kResultOk)
+        return kResultFalse;
+
+    int32 numBytesWritten = 0;
+    uint32 pathLen = static_cast<uint32>(pluginPath.size());
+    if (state->write(&pathLen, sizeof(pathLen), &numBytesWritten) != kResultOk
+        || numBytesWritten != sizeof(pathLen))
+        return kResultFalse;
+
+    if (pathLen > 0) {
+        if (state->write(const_cast<char*>(pluginPath.data()), pathLen, &numBytesWritten) != kResultOk
+            || numBytesWritten != static_cast<int32>(pathLen))
+            return kResultFalse;
+    }
+
+    return kResultOk;
+}
+
+tresult readStateHeader(IBStream* state, std::string& pluginPath) {
+    if (!state)
+        return kResultFalse;
+
+    uint32 version = 0;
+    if (readMagicAndVersion(state, version) != kResultOk || version != kStateVersion)
+        return kResultFalse;
+
+    return readPath(state, pluginPath);
+}
+
+tresult writeWrapperState(IBStream* stream, const WrapperState& state, size_t compressThreshold) {
+    if (!stream || state.pluginPath.size() > kMaxPathLen)
+        return kResultFalse;
+
+    if (writeMagicAndVersion(stream, kStateVersionV2) != kResultOk)
+        return kResultFalse;
+
+    bool ok = true;
+    if (!state.instanceId.empty())
+        ok = ok && writeSection(stream, StateTag::kInstanceId, state.instanceId);
+    if (!state.pluginPath.empty())
+        ok = ok && writeSection(stream, StateTag::kPluginPath, state.pluginPath);
+    if (!state.effectClassId.empty())
+        ok = ok && writeSection(stream, StateTag::kEffectClassId, state.effectClassId.data(),
+                                state.effectClassId.size(), compressThreshold);
+    if (!state.controllerClassId.empty())
+        ok = ok && writeSection(stream, StateTag::kControllerClassId, state.controllerClassId.data(),
+                                state.controllerClassId.size(), compressThreshold);
+    if (!state.settings.empty())
+        ok = ok && writeSection(stream, StateTag::kSettings, encodeSettings(state.settings));
+    if (state.componentState.buffer)
+        ok = ok && writeSection(stream, StateTag::kComponentState, state.componentState.buffer->data(),
+                                state.componentState.buffer->size(), compressThreshold);
+    if (state.controllerState.buffer)
+        ok = ok && writeSection(stream, StateTag::kControllerState, state.controllerState.buffer->data(),
+                                state.controllerState.buffer->size(), compressThreshold);
+    ok = ok && writeSection(stream, StateTag::kEnd, nullptr, 0, compressThreshold);
+
+    return ok ? kResultOk : kResultFalse;
+}
+
+tresult readWrapperState(IBStream* stream, WrapperState& state, const StateBuffer& known) {
+    if (!stream)
+        return kResultFalse;
+
+    state = WrapperState();
+    if (readMagicAndVersion(stream, state.version) != kResultOk)
+        return kResultFalse;
+
+    if (state.version == kStateVersion)
+        return readPath(stream, state.pluginPath);
+    if (state.version != kStateVersionV2)
+        return kResultFalse;
+
+    std::vector<char> text;
+    for (;;) {
+        SectionHeader header;
+        if (!readSectionHeader(stream, header))
+            return kResultFalse;
+        if (tagIs(header, StateTag::kEnd))
+            return kResultOk;
+
+        bool ok = true;
+        if (tagIs(header, StateTag::kComponentState)) {
+            ok = readHostedPayload(stream, header, known, state.componentState);
+        } else if (tagIs(header, StateTag::kControllerState)) {
+            ok = readHostedPayload(stream, header, known, state.controllerState);
+        } else if (tagIs(header, StateTag::kEffectClassId)) {
+            ok = readPayload(stream, header, state.effectClassId);
+        } else if (tagIs(header, StateTag::kControllerClassId)) {
+            ok = readPayload(stream, header, state.controllerClassId);
+        } else if (tagIs(header, StateTag::kInstanceId)) {
+            ok = readPayload(stream, header, text);
+            state.instanceId.assign(text.begin(), text.end());
+        } else if (tagIs(header, StateTag::kPluginPath)) {
+            ok = readPayload(stream, header, text) && text.size() <= kMaxPathLen;
+            state.pluginPath.assign(text.begin(), text.end());
+        } else if (tagIs(header, StateTag::kSettings)) {
+            ok = readPayload(stream, header, text);
+            decodeSettings(text, state.settings);
+        } else {
+            // Written by a newer version: not ours to interpret
+            ok = skipPayload(stream, header.storedSize);
+        }
+
+        if (!ok)
+            return kResultFalse;
+    }
+}
+
+tresult writeStateBytes(IBStream* stream, const std::vector<char>& bytes) {
+    if (!stream)
+        return kResultFalse;
+    return writeAll(stream, bytes.data(), bytes.size()) ? kResultOk : kResultFalse;
+}
+
+tresult savePayload(const std::function<tresult(IBStream*)>& save, StatePayload& payload) {
+    CaptureStream stream;
+    tresult result = save(&stream);
+    if (result != kResultOk)
+        return result;
+
+    payload = StatePayload();
+    payload.buffer = stream.take();
+    payload.size = payload.buffer->size();
+    return kResultOk;
+}
+
+tresult loadPayload(IBStream* source, const StatePayload& payload, const std::function<tresult(IBStream*)>& load) {
+    if (payload.buffer) {
+        BufferStream stream(payload.buffer);
+        return load(&stream);
+    }
+    if (!source || payload.offset < 0)
+        return kResultFalse;
+
+    SubRangeStream stream(source, payload.offset, static_cast<int64>(payload.size));
+    return load(&stream);
+}
+
+tresult detachPayload(IBStream* source, StatePayload& payload) {
+    if (payload.buffer || !payload.present())
+        return kResultOk;
+    if (!source || payload.size > kMaxStateSectionSize)
+        return kResultFalse;
+
+    std::vector<char> bytes(static_cast<size_t>(payload.size));
+    SubRangeStream stream(source, payload.offset, static_cast<int64>(payload.size));
+    if (!readAll(&stream, bytes.data(), bytes.size()))
+        return kResultFalse;
+    payload.buffer = std::make_shared<const std::vector<char>>(std::move(bytes));
+    payload.offset = -1;
+    return kResultOk;
+}
+
+tresult detachWrapperState(IBStream* stream, WrapperState& state) {
+    WrapperState detached = state;
+    int64 hostedStart = -1;
+    if (detached.version == kStateVersion) {
+        detached.componentState = remainingPayload(stream);
+        if (!detached.componentState.present())
+            return kResultFalse;
+        detached.version = kStateVersionV2;
+        hostedStart = detached.componentState.offset;
+    }
+    bool ok = detachPayload(stream, detached.componentState) == kResultOk
+           && detachPayload(stream, detached.controllerState) == kResultOk;
+    // Leave a v1 stream at its hosted state for a caller falling back to it
+    if (hostedStart >= 0)
+        stream->seek(hostedStart, IBStream::kIBSeekSet, nullptr);
+    if (!ok)
+        return kResultFalse;
+    state = std::move(detached);
+    return kResultOk;
+}
+
+} // namespace VST3MCPWrapper
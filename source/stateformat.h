@@ -2,92 +2,118 @@
 
 #include "pluginterfaces/base/ftypes.h"
 #include "pluginterfaces/base/ibstream.h"
+#include "statestream.h"
 
-#include <cstring>
+#include <cstddef>
+#include <functional>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace VST3MCPWrapper {
 
 // Wrapper state persistence format constants.
 // Used by both Processor (setState/getState) and Controller (setComponentState).
 static constexpr char kStateMagic[4] = {'V', 'M', 'C', 'W'};
-static constexpr Steinberg::uint32 kStateVersion = 1;
+static constexpr Steinberg::uint32 kStateVersion = 1; // v1: header followed by raw hosted state
+static constexpr Steinberg::uint32 kStateVersionV2 = 2;
 static constexpr Steinberg::uint32 kMaxPathLen = 4096;
 
-// Write the wrapper state header to a stream.
+// Write the v1 wrapper state header to a stream.
 // Format: [4 bytes magic] [4 bytes version] [4 bytes pathLen] [pathLen bytes path]
-inline Steinberg::tresult writeStateHeader(Steinberg::IBStream* state, const std::string& pluginPath) {
-    using namespace Steinberg;
-    if (!state)
-        return kResultFalse;
+Steinberg::tresult writeStateHeader(Steinberg::IBStream* state, const std::string& pluginPath);
 
-    int32 numBytesWritten = 0;
-
-    if (state->write(const_cast<char*>(kStateMagic), sizeof(kStateMagic), &numBytesWritten) != kResultOk
-        || numBytesWritten != sizeof(kStateMagic))
-        return kResultFalse;
-
-    uint32 version = kStateVersion;
-    if (state->write(&version, sizeof(version), &numBytesWritten) != kResultOk
-        || numBytesWritten != sizeof(version))
-        return kResultFalse;
-
-    uint32 pathLen = static_cast<uint32>(pluginPath.size());
-    if (state->write(&pathLen, sizeof(pathLen), &numBytesWritten) != kResultOk
-        || numBytesWritten != sizeof(pathLen))
-        return kResultFalse;
-
-    if (pathLen > 0) {
-        if (state->write(const_cast<char*>(pluginPath.data()), pathLen, &numBytesWritten) != kResultOk
-            || numBytesWritten != static_cast<int32>(pathLen))
-            return kResultFalse;
-    }
-
-    return kResultOk;
-}
-
-// Read and validate the wrapper state header from a stream.
+// Read and validate a v1 wrapper state header from a stream.
 // Returns kResultOk on success with pluginPath populated.
 // Returns kResultFalse on invalid magic, unsupported version, bad path length, or truncated data.
-inline Steinberg::tresult readStateHeader(Steinberg::IBStream* state, std::string& pluginPath) {
-    using namespace Steinberg;
-    if (!state)
-        return kResultFalse;
-
-    int32 numBytesRead = 0;
-
-    char magic[4] = {};
-    if (state->read(magic, sizeof(magic), &numBytesRead) != kResultOk || numBytesRead != sizeof(magic))
-        return kResultFalse;
-
-    if (std::memcmp(magic, kStateMagic, sizeof(magic)) != 0)
-        return kResultFalse;
-
-    uint32 version = 0;
-    if (state->read(&version, sizeof(version), &numBytesRead) != kResultOk
-        || numBytesRead != sizeof(version))
-        return kResultFalse;
-
-    if (version != kStateVersion)
-        return kResultFalse;
-
-    uint32 pathLen = 0;
-    if (state->read(&pathLen, sizeof(pathLen), &numBytesRead) != kResultOk
-        || numBytesRead != sizeof(pathLen))
-        return kResultFalse;
-
-    if (pathLen > kMaxPathLen)
-        return kResultFalse;
-
-    pluginPath.clear();
-    if (pathLen > 0) {
-        pluginPath.resize(pathLen);
-        if (state->read(pluginPath.data(), pathLen, &numBytesRead) != kResultOk
-            || numBytesRead != static_cast<int32>(pathLen))
-            return kResultFalse;
-    }
-
-    return kResultOk;
-}
+Steinberg::tresult readStateHeader(Steinberg::IBStream* state, std::string& pluginPath);
+
+// --- v2 ---
+//
+// [4 bytes magic] [4 bytes version = 2] then a list of sections, each
+//   [4 bytes tag] [1 byte codec] [3 bytes reserved]
+//   [8 bytes rawSize] [8 bytes storedSize] [4 bytes CRC-32 of the raw bytes]
+//   [storedSize bytes payload]
+// terminated by an END section with no payload. Integers are in native byte
+// order, like v1. Readers skip sections with unknown tags, so new ones can be
+// added without a version bump.
+namespace StateTag {
+static constexpr char kInstanceId[4] = {'I', 'N', 'S', 'T'};
+static constexpr char kPluginPath[4] = {'P', 'A', 'T', 'H'};
+static constexpr char kEffectClassId[4] = {'E', 'C', 'I', 'D'};
+static constexpr char kControllerClassId[4] = {'C', 'C', 'I', 'D'};
+static constexpr char kComponentState[4] = {'C', 'S', 'T', 'A'};
+static constexpr char kControllerState[4] = {'K', 'S', 'T', 'A'};
+static constexpr char kSettings[4] = {'W', 'S', 'E', 'T'}; // "key=value" lines
+static constexpr char kEnd[4] = {'E', 'N', 'D', ' '};
+} // namespace StateTag
+
+enum class StateCodec : Steinberg::uint8 {
+    None = 0,
+    Deflate = 1, // zlib stream
+};
+
+// Payloads at least this large are compressed (kept raw if that doesn't shrink them).
+static constexpr size_t kStateCompressThreshold = 4096;
+static constexpr Steinberg::uint64 kMaxStateSectionSize = Steinberg::uint64(1) << 30;
+
+// A hosted plugin's state carried in a section: in memory, or, for a section
+// stored uncompressed, a range of the stream it was read from (CRC-checked
+// but not copied).
+struct StatePayload {
+    StateBuffer buffer;
+    Steinberg::int64 offset = -1; // Start in the source stream when not in buffer
+    Steinberg::uint64 size = 0;
+    Steinberg::uint32 crc = 0; // Of the raw bytes; set when read
+
+    bool present() const { return buffer || offset >= 0; }
+};
+
+// Everything a wrapper state stream can carry. Sections that were absent
+// when reading are left empty.
+struct WrapperState {
+    Steinberg::uint32 version = kStateVersionV2; // Set by readWrapperState
+    std::string instanceId;
+    std::string pluginPath;
+    std::vector<char> effectClassId;     // 16 bytes (TUID) when present
+    std::vector<char> controllerClassId; // 16 bytes (TUID) when present
+    StatePayload componentState;
+    StatePayload controllerState;
+    std::map<std::string, std::string> settings;
+};
+
+// Write state as a v2 stream. Empty fields are omitted; hosted states are
+// written from their buffer.
+Steinberg::tresult writeWrapperState(Steinberg::IBStream* stream, const WrapperState& state,
+                                     size_t compressThreshold = kStateCompressThreshold);
+
+// Read a v1 or v2 stream. For v1, only version and pluginPath are set and the
+// stream is left positioned at the raw hosted state that follows the header.
+// A hosted state section with the size and CRC of known is not read again:
+// its payload shares known instead.
+// Returns kResultFalse on bad magic, unsupported version, truncated data, a
+// corrupt payload (CRC or decompression failure) or an oversized section.
+Steinberg::tresult readWrapperState(Steinberg::IBStream* stream, WrapperState& state,
+                                    const StateBuffer& known = nullptr);
+
+// Write bytes previously produced by writeWrapperState() (e.g. a cached
+// snapshot) to stream.
+Steinberg::tresult writeStateBytes(Steinberg::IBStream* stream, const std::vector<char>& bytes);
+
+// Run a hosted getState() into payload's buffer.
+Steinberg::tresult savePayload(const std::function<Steinberg::tresult(Steinberg::IBStream*)>& save,
+                               StatePayload& payload);
+// Run a hosted setState() on a payload; source is the stream it was read
+// from, for payloads left there.
+Steinberg::tresult loadPayload(Steinberg::IBStream* source, const StatePayload& payload,
+                               const std::function<Steinberg::tresult(Steinberg::IBStream*)>& load);
+
+// Copy a payload left in source into its buffer, so it can be applied after
+// source is gone. Payloads already in memory, or absent, are kept as they are.
+Steinberg::tresult detachPayload(Steinberg::IBStream* source, StatePayload& payload);
+// Same for both hosted states of state, read from stream. A v1 stream's
+// hosted state (the rest of the stream) becomes componentState and version
+// becomes v2. On failure state is unchanged and stream is where it was.
+Steinberg::tresult detachWrapperState(Steinberg::IBStream* stream, WrapperState& state);
 
 } // namespace VST3MCPWrapper
@@ -0,0 +1,178 @@
+#include "statestream.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Steinberg;
+
+namespace VST3MCPWrapper {
+
+namespace {
+
+// New position for an IBStream seek, or -1 if it lands before the start.
+int64 seekTarget(int64 pos, int32 mode, int64 current, int64 size) {
+    int64 target = -1;
+    switch (mode) {
+        case IBStream::kIBSeekSet: target = pos; break;
+        case IBStream::kIBSeekCur: target = current + pos; break;
+        case IBStream::kIBSeekEnd: target = size + pos; break;
+        default: return -1;
+    }
+    return target < 0 ? -1 : target;
+}
+
+tresult queryStream(IBStream* stream, const TUID iid, void** obj) {
+    if (FUnknownPrivate::iidEqual(iid, IBStream::iid) || FUnknownPrivate::iidEqual(iid, FUnknown::iid)) {
+        *obj = stream;
+        return kResultOk;
+    }
+    *obj = nullptr;
+    return kNoInterface;
+}
+
+} // namespace
+
+// ---- BufferStream ----
+
+tresult PLUGIN_API BufferStream::read(void* buffer, int32 numBytes, int32* numBytesRead) {
+    int64 size = buffer_ ? static_cast<int64>(buffer_->size()) : 0;
+    int32 count = static_cast<int32>(std::clamp<int64>(size - pos_, 0, std::max(numBytes, 0)));
+    if (count > 0)
+        std::memcpy(buffer, buffer_->data() + pos_, static_cast<size_t>(count));
+    pos_ += count;
+    if (numBytesRead)
+        *numBytesRead = count;
+    return kResultOk;
+}
+
+tresult PLUGIN_API BufferStream::write(void*, int32, int32* numBytesWritten) {
+    if (numBytesWritten)
+        *numBytesWritten = 0;
+    return kResultFalse;
+}
+
+tresult PLUGIN_API BufferStream::seek(int64 pos, int32 mode, int64* result) {
+    int64 size = buffer_ ? static_cast<int64>(buffer_->size()) : 0;
+    int64 target = seekTarget(pos, mode, pos_, size);
+    if (target < 0)
+        return kInvalidArgument;
+    pos_ = std::min(target, size);
+    if (result)
+        *result = pos_;
+    return kResultOk;
+}
+
+tresult PLUGIN_API BufferStream::tell(int64* pos) {
+    if (!pos)
+        return kInvalidArgument;
+    *pos = pos_;
+    return kResultOk;
+}
+
+tresult PLUGIN_API BufferStream::queryInterface(const TUID iid, void** obj) {
+    return queryStream(this, iid, obj);
+}
+
+// ---- CaptureStream ----
+
+StateBuffer CaptureStream::take() {
+    pos_ = 0;
+    return std::make_shared<const std::vector<char>>(std::move(data_));
+}
+
+tresult PLUGIN_API CaptureStream::read(void* buffer, int32 numBytes, int32* numBytesRead) {
+    int32 count = static_cast<int32>(
+        std::clamp<int64>(static_cast<int64>(data_.size()) - static_cast<int64>(pos_), 0, std::max(numBytes, 0)));
+    if (count > 0)
+        std::memcpy(buffer, data_.data() + pos_, static_cast<size_t>(count));
+    pos_ += static_cast<size_t>(count);
+    if (numBytesRead)
+        *numBytesRead = count;
+    return kResultOk;
+}
+
+tresult PLUGIN_API CaptureStream::write(void* buffer, int32 numBytes, int32* numBytesWritten) {
+    if (numBytes < 0)
+        return kInvalidArgument;
+    size_t end = pos_ + static_cast<size_t>(numBytes);
+    if (end > data_.size())
+        data_.resize(end);
+    if (numBytes > 0)
+        std::memcpy(data_.data() + pos_, buffer, static_cast<size_t>(numBytes));
+    pos_ = end;
+    if (numBytesWritten)
+        *numBytesWritten = numBytes;
+    return kResultOk;
+}
+
+tresult PLUGIN_API CaptureStream::seek(int64 pos, int32 mode, int64* result) {
+    int64 target = seekTarget(pos, mode, static_cast<int64>(pos_), static_cast<int64>(data_.size()));
+    if (target < 0)
+        return kInvalidArgument;
+    // Seeking past the end and writing there leaves a zero-filled gap, as in
+    // the SDK's memory streams
+    pos_ = static_cast<size_t>(target);
+    if (result)
+        *result = target;
+    return kResultOk;
+}
+
+tresult PLUGIN_API CaptureStream::tell(int64* pos) {
+    if (!pos)
+        return kInvalidArgument;
+    *pos = static_cast<int64>(pos_);
+    return kResultOk;
+}
+
+tresult PLUGIN_API CaptureStream::queryInterface(const TUID iid, void** obj) {
+    return queryStream(this, iid, obj);
+}
+
+// ---- SubRangeStream ----
+
+tresult PLUGIN_API SubRangeStream::read(void* buffer, int32 numBytes, int32* numBytesRead) {
+    if (numBytesRead)
+        *numBytesRead = 0;
+    int32 count = static_cast<int32>(std::clamp<int64>(size_ - pos_, 0, std::max(numBytes, 0)));
+    if (count == 0)
+        return kResultOk;
+
+    int64 parentPos = 0;
+    if (parent_->seek(begin_ + pos_, kIBSeekSet, &parentPos) != kResultOk || parentPos != begin_ + pos_)
+        return kResultFalse;
+    int32 read = 0;
+    tresult result = parent_->read(buffer, count, &read);
+    pos_ += read;
+    if (numBytesRead)
+        *numBytesRead = read;
+    return result;
+}
+
+tresult PLUGIN_API SubRangeStream::write(void*, int32, int32* numBytesWritten) {
+    if (numBytesWritten)
+        *numBytesWritten = 0;
+    return kResultFalse;
+}
+
+tresult PLUGIN_API SubRangeStream::seek(int64 pos, int32 mode, int64* result) {
+    int64 target = seekTarget(pos, mode, pos_, size_);
+    if (target < 0)
+        return kInvalidArgument;
+    pos_ = std::min(target, size_);
+    if (result)
+        *result = pos_;
+    return kResultOk;
+}
+
+tresult PLUGIN_API SubRangeStream::tell(int64* pos) {
+    if (!pos)
+        return kInvalidArgument;
+    *pos = pos_;
+    return kResultOk;
+}
+
+tresult PLUGIN_API SubRangeStream::queryInterface(const TUID iid, void** obj) {
+    return queryStream(this, iid, obj);
+}
+
+} // namespace VST3MCPWrapper
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "pluginterfaces/base/ibstream.h"
+
+#include <memory>
+#include <vector>
+
+namespace VST3MCPWrapper {
+
+// Immutable state bytes shared between their readers (processor, controller)
+// without copying.
+using StateBuffer = std::shared_ptr<const std::vector<char>>;
+
+// The streams below are owned by value and only lent to a plugin for the
+// duration of one getState()/setState() call (plugins must not retain the
+// stream), so reference counting is a no-op.
+
+// Read-only stream over a StateBuffer.
+class BufferStream : public Steinberg::IBStream {
+public:
+    explicit BufferStream(StateBuffer buffer) : buffer_(std::move(buffer)) {}
+
+    Steinberg::tresult PLUGIN_API read(void* buffer, Steinberg::int32 numBytes, Steinberg::int32* numBytesRead) override;
+    Steinberg::tresult PLUGIN_API write(void* buffer, Steinberg::int32 numBytes, Steinberg::int32* numBytesWritten) override;
+    Steinberg::tresult PLUGIN_API seek(Steinberg::int64 pos, Steinberg::int32 mode, Steinberg::int64* result) override;
+    Steinberg::tresult PLUGIN_API tell(Steinberg::int64* pos) override;
+
+    Steinberg::tresult PLUGIN_API queryInterface(const Steinberg::TUID iid, void** obj) override;
+    Steinberg::uint32 PLUGIN_API addRef() override { return 1; }
+    Steinberg::uint32 PLUGIN_API release() override { return 1; }
+
+private:
+    StateBuffer buffer_;
+    Steinberg::int64 pos_ = 0;
+};
+
+// Stream a plugin writes its state into. take() hands the bytes over as a
+// StateBuffer without copying them.
+class CaptureStream : public Steinberg::IBStream {
+public:
+    StateBuffer take();
+
+    Steinberg::tresult PLUGIN_API read(void* buffer, Steinberg::int32 numBytes, Steinberg::int32* numBytesRead) override;
+    Steinberg::tresult PLUGIN_API write(void* buffer, Steinberg::int32 numBytes, Steinberg::int32* numBytesWritten) override;
+    Steinberg::tresult PLUGIN_API seek(Steinberg::int64 pos, Steinberg::int32 mode, Steinberg::int64* result) override;
+    Steinberg::tresult PLUGIN_API tell(Steinberg::int64* pos) override;
+
+    Steinberg::tresult PLUGIN_API queryInterface(const Steinberg::TUID iid, void** obj) override;
+    Steinberg::uint32 PLUGIN_API addRef() override { return 1; }
+    Steinberg::uint32 PLUGIN_API release() override { return 1; }
+
+private:
+    std::vector<char> data_;
+    size_t pos_ = 0;
+};
+
+// Read-only window onto [begin, begin + size) of another stream, e.g. one
+// section of the stream the DAW passed to setState(). Positions are relative
+// to begin; every read seeks the parent first, so the parent may be used in
+// between.
+class SubRangeStream : public Steinberg::IBStream {
+public:
+    SubRangeStream(Steinberg::IBStream* parent, Steinberg::int64 begin, Steinberg::int64 size)
+    : parent_(parent), begin_(begin), size_(size) {}
+
+    Steinberg::tresult PLUGIN_API read(void* buffer, Steinberg::int32 numBytes, Steinberg::int32* numBytesRead) override;
+    Steinberg::tresult PLUGIN_API write(void* buffer, Steinberg::int32 numBytes, Steinberg::int32* numBytesWritten) override;
+    Steinberg::tresult PLUGIN_API seek(Steinberg::int64 pos, Steinberg::int32 mode, Steinberg::int64* result) override;
+    Steinberg::tresult PLUGIN_API tell(Steinberg::int64* pos) override;
+
+    Steinberg::tresult PLUGIN_API queryInterface(const Steinberg::TUID iid, void** obj) override;
+    Steinberg::uint32 PLUGIN_API addRef() override { return 1; }
+    Steinberg::uint32 PLUGIN_API release() override { return 1; }
+
+private:
+    Steinberg::IBStream* parent_;
+    Steinberg::int64 begin_;
+    Steinberg::int64 size_;
+    Steinberg::int64 pos_ = 0;
+};
+
+} // namespace VST3MCPWrapper
@@ -59,6 +59,9 @@ public:
 private:
     void removeDropZone();
     void removeHostedView();
+    // Tell the controller's HostedPluginInstance whether the hosted editor is
+    // showing (getState() doesn't serve cached state while it is)
+    void setHostedEditorOpen(bool open);
 
     Controller* controller_;
     Steinberg::IPlugFrame* hostFrame_ = nullptr;       // DAW's plug frame
@@ -1,5 +1,6 @@
 #include "wrapperview.h"
 #include "controller.h"
+#include "hostedplugin.h"
 
 #import <Cocoa/Cocoa.h>
 
@@ -149,6 +150,7 @@ void WrapperPlugView::switchToHostedView(IPlugView* hostedView) {
 
     // Attach the hosted view to the same parent
     hostedView_->attached(parentNSView_, kPlatformTypeNSView);
+    setHostedEditorOpen(true);
 
     // Ask the DAW to resize to the hosted plugin's preferred size
     if (hostFrame_) {
@@ -193,9 +195,15 @@ void WrapperPlugView::removeHostedView() {
         hostedView_->setFrame(nullptr);
         hostedView_->removed();
         hostedView_ = nullptr;
+        setHostedEditorOpen(false);
     }
 }
 
+void WrapperPlugView::setHostedEditorOpen(bool open) {
+    if (controller_)
+        controller_->getHostedInstance()->setHostedEditorOpen(open);
+}
+
 // --- IPlugView ---
 
 tresult PLUGIN_API WrapperPlugView::isPlatformTypeSupported(FIDString type) {
@@ -218,6 +226,7 @@ tresult PLUGIN_API WrapperPlugView::attached(void* parent, FIDString type) {
             hostedView_ = owned(hostedPlugView);
             hostedView_->setFrame(this);
             hostedView_->attached(parent, type);
+            setHostedEditorOpen(true);
             return kResultOk;
         }
     }
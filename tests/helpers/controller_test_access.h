@@ -21,6 +21,14 @@ public:
         std::lock_guard<std::mutex> lock (c.hostedControllerMutex_);
         return c.hostedController_;
     }
+
+    static void setHostedController (Controller& c, Steinberg::Vst::IEditController* ctrl,
+                                     const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock (c.hostedControllerMutex_);
+        c.hostedController_ = ctrl;
+        c.currentPluginPath_ = path;
+    }
 };
 
 } // namespace VST3MCPWrapper
@@ -4,6 +4,7 @@
 #include "pluginterfaces/vst/ivstaudioprocessor.h"
 #include "pluginterfaces/vst/ivstcomponent.h"
 
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -34,11 +35,14 @@ public:
         return p.storedOutputArr_;
     }
     static const Steinberg::Vst::ProcessSetup& currentSetup (const Processor& p) { return p.currentSetup_; }
+    static bool hasPendingRestore (const Processor& p) { return p.pendingRestore_.has_value (); }
 
     // --- Setters ---
+    // Like a real load, swapping the component or path drops the cached state
     static void setHostedComponent (Processor& p, Steinberg::Vst::IComponent* comp)
     {
         p.hostedComponent_ = comp;
+        p.stateSnapshot_.reset ();
     }
     static void setHostedProcessor (Processor& p, Steinberg::Vst::IAudioProcessor* proc)
     {
@@ -59,9 +63,39 @@ public:
     static void setCurrentPluginPath (Processor& p, const std::string& path)
     {
         p.currentPluginPath_ = path;
+        p.stateSnapshot_.reset ();
     }
 
     static void callReplayDawState (Processor& p) { p.replayDawStateOntoHosted (); }
+    static void completeRestore (Processor& p) { p.completeRestore (); }
+
+    // --- Hot swap ---
+    static void beginHotSwap (Processor& p, Steinberg::Vst::IComponent* comp,
+                              Steinberg::Vst::IAudioProcessor* proc)
+    {
+        Processor::HostedInstance incoming;
+        incoming.component = comp;
+        incoming.processor = Steinberg::IPtr<Steinberg::Vst::IAudioProcessor> (proc);
+        p.beginHotSwap (std::move (incoming));
+    }
+    static bool finishHotSwap (Processor& p, std::chrono::milliseconds pickupTimeout,
+                               std::chrono::milliseconds fadeTimeout)
+    {
+        return p.finishHotSwap (pickupTimeout, fadeTimeout);
+    }
+    static bool swapIdle (const Processor& p)
+    {
+        return p.swapPhase_.load () == Processor::SwapPhase::Idle;
+    }
+    static bool swapFinished (const Processor& p)
+    {
+        return p.swapPhase_.load () == Processor::SwapPhase::Finished;
+    }
+    static Steinberg::Vst::IAudioProcessor* hostedProcessor (const Processor& p)
+    {
+        return p.hostedProcessor_.get ();
+    }
+    static bool canHotSwap (const Processor& p) { return p.canHotSwap (); }
 };
 
 } // namespace VST3MCPWrapper
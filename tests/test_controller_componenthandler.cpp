@@ -14,7 +14,7 @@ using namespace VST3MCPWrapper::Testing;
 
 //------------------------------------------------------------------------
 // Test fixture — creates a Controller WITHOUT initialize() to avoid
-// starting the MCP server (heavyweight, binds port 8771). The
+// starting the MCP server (heavyweight, binds a port). The
 // IComponentHandler methods don't need MCP or bus setup.
 //------------------------------------------------------------------------
 class ControllerComponentHandlerTest : public ::testing::Test {
@@ -22,26 +22,18 @@ protected:
     void SetUp () override
     {
         controller_ = new Controller ();
-
-        // Drain any leftover param changes from previous tests
-        std::vector<ParamChange> discard;
-        HostedPluginModule::instance ().drainParamChanges (discard);
     }
 
     void TearDown () override
     {
         controller_->release ();
-
-        // Drain any leftover param changes for test isolation
-        std::vector<ParamChange> discard;
-        HostedPluginModule::instance ().drainParamChanges (discard);
     }
 
     Controller* controller_ = nullptr;
 };
 
 //------------------------------------------------------------------------
-// performEdit queues a parameter change via HostedPluginModule
+// performEdit queues a parameter change via HostedPluginInstance
 //------------------------------------------------------------------------
 TEST_F (ControllerComponentHandlerTest, PerformEditQueuesParamChange)
 {
@@ -51,7 +43,7 @@ TEST_F (ControllerComponentHandlerTest, PerformEditQueuesParamChange)
 
     // Drain the queue and verify the change is there
     std::vector<ParamChange> drained;
-    HostedPluginModule::instance ().drainParamChanges (drained);
+    controller_->getHostedInstance ()->drainParamChanges (drained);
 
     ASSERT_EQ (drained.size (), 1u);
     EXPECT_EQ (drained[0].id, 42u);
@@ -128,3 +120,85 @@ TEST_F (ControllerComponentHandlerTest, BeginEndEditReturnOkWithoutDawHandler)
     EXPECT_EQ (handler->beginEdit (7), kResultOk);
     EXPECT_EQ (handler->endEdit (7), kResultOk);
 }
+
+//------------------------------------------------------------------------
+// restartComponent with title/reload flags invalidates the parameter cache
+//------------------------------------------------------------------------
+TEST_F (ControllerComponentHandlerTest, RestartComponentInvalidatesParameterCache)
+{
+    MockEditController ctrl;
+    // Built once initially, then once after each invalidating restart
+    EXPECT_CALL (ctrl, getParameterCount ()).Times (3).WillRepeatedly (::testing::Return (0));
+
+    auto& cache = controller_->getParameterCache ();
+    auto* handler = static_cast<IComponentHandler*> (controller_);
+
+    auto initial = cache.get (&ctrl);
+    handler->restartComponent (kParamValuesChanged);
+    EXPECT_EQ (cache.get (&ctrl), initial) << "value changes must not drop the cache";
+
+    handler->restartComponent (kParamTitlesChanged);
+    auto afterTitles = cache.get (&ctrl);
+    EXPECT_NE (afterTitles, initial);
+
+    handler->restartComponent (kReloadComponent);
+    EXPECT_NE (cache.get (&ctrl), afterTitles);
+}
+
+//------------------------------------------------------------------------
+// performEdit and restartComponent(kParamValuesChanged) bump change versions
+//------------------------------------------------------------------------
+TEST_F (ControllerComponentHandlerTest, EditsAndValueRestartsBumpChangeVersions)
+{
+    auto& versions = controller_->getParameterCache ().versions ();
+    auto* handler = static_cast<IComponentHandler*> (controller_);
+
+    uint64_t start = versions.currentVersion ();
+    handler->performEdit (7, 0.5);
+    auto delta = versions.changesSince (start);
+    EXPECT_FALSE (delta.all);
+    ASSERT_EQ (delta.changed.size (), 1u);
+    EXPECT_EQ (delta.changed.count (7), 1u);
+
+    handler->restartComponent (kParamValuesChanged);
+    EXPECT_TRUE (versions.changesSince (delta.version).all);
+}
+
+//------------------------------------------------------------------------
+// performEdit publishes to parameter change subscribers
+//------------------------------------------------------------------------
+TEST_F (ControllerComponentHandlerTest, PerformEditNotifiesSubscribers)
+{
+    auto& notifier = controller_->getParamNotifier ();
+    notifier.subscribe ("session", {42});
+
+    auto* handler = static_cast<IComponentHandler*> (controller_);
+    handler->performEdit (42, 0.25);
+    handler->performEdit (43, 0.5);
+
+    std::vector<ParamUpdate> sent;
+    notifier.flush (ParamChangeNotifier::Clock::now (),
+                    [&] (const std::string&, const std::vector<ParamUpdate>& updates) { sent = updates; });
+    ASSERT_EQ (sent.size (), 1u);
+    EXPECT_EQ (sent[0].id, 42u);
+    EXPECT_DOUBLE_EQ (sent[0].value, 0.25);
+}
+
+//------------------------------------------------------------------------
+// Edits and restarts from the hosted plugin invalidate the processor's
+// cached state
+//------------------------------------------------------------------------
+TEST_F (ControllerComponentHandlerTest, EditsAndRestartsMarkHostedStateChanged)
+{
+    auto hostedInstance = controller_->getHostedInstance ();
+    auto& pluginModule = *hostedInstance;
+    auto* handler = static_cast<IComponentHandler*> (controller_);
+
+    uint64_t start = pluginModule.getStateGeneration ();
+    handler->performEdit (7, 0.5);
+    uint64_t afterEdit = pluginModule.getStateGeneration ();
+    EXPECT_GT (afterEdit, start);
+
+    handler->restartComponent (kLatencyChanged);
+    EXPECT_GT (pluginModule.getStateGeneration (), afterEdit);
+}
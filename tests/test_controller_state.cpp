@@ -1,8 +1,11 @@
 #include <gtest/gtest.h>
+#include <gmock/gmock.h>
 
 #include "controller.h"
+#include "hostedplugin.h"
 #include "stateformat.h"
 #include "helpers/controller_test_access.h"
+#include "mocks/mock_vst3.h"
 
 #include "public.sdk/source/vst/utility/memoryibstream.h"
 
@@ -169,3 +172,84 @@ TEST_F (ControllerSetComponentStateTest, EmptyStreamReturnsOk)
 
     EXPECT_EQ (ControllerTestAccess::hostedController (*controller_), nullptr);
 }
+
+//------------------------------------------------------------------------
+// getState()/setState() carry the hosted controller's own state
+//------------------------------------------------------------------------
+TEST_F (ControllerSetComponentStateTest, HostedControllerStateRoundTrips)
+{
+    const std::string path = "/usr/lib/vst3/Gui.vst3";
+    const std::string hostedState = "ZOOM=2;TAB=3";
+
+    ::testing::NiceMock<Testing::MockEditController> source;
+    ON_CALL (source, getState (::testing::_)).WillByDefault ([&] (IBStream* s) {
+        int32 written = 0;
+        return s->write (const_cast<char*> (hostedState.data ()), static_cast<int32> (hostedState.size ()),
+                         &written);
+    });
+    ControllerTestAccess::setHostedController (*controller_, &source, path);
+
+    ResizableMemoryIBStream stream;
+    EXPECT_EQ (controller_->getState (&stream), kResultOk);
+    ControllerTestAccess::setHostedController (*controller_, nullptr, "");
+
+    std::string restored;
+    ::testing::NiceMock<Testing::MockEditController> target;
+    ON_CALL (target, setState (::testing::_)).WillByDefault ([&] (IBStream* s) {
+        restored.resize (64);
+        int32 read = 0;
+        s->read (restored.data (), static_cast<int32> (restored.size ()), &read);
+        restored.resize (read);
+        return kResultOk;
+    });
+
+    // Saved for another plugin: ignored
+    ControllerTestAccess::setHostedController (*controller_, &target, "/other.vst3");
+    stream.seek (0, IBStream::kIBSeekSet, nullptr);
+    EXPECT_EQ (controller_->setState (&stream), kResultOk);
+    EXPECT_TRUE (restored.empty ());
+
+    ControllerTestAccess::setHostedController (*controller_, &target, path);
+    stream.seek (0, IBStream::kIBSeekSet, nullptr);
+    EXPECT_EQ (controller_->setState (&stream), kResultOk);
+    EXPECT_EQ (restored, hostedState);
+
+    ControllerTestAccess::setHostedController (*controller_, nullptr, "");
+}
+
+//------------------------------------------------------------------------
+// setComponentState() takes the buffer the processor restored from the
+// same stream instead of decompressing the section again
+//------------------------------------------------------------------------
+TEST_F (ControllerSetComponentStateTest, ReusesComponentStateRestoredByProcessor)
+{
+    const std::string path = "/usr/lib/vst3/Shared.vst3";
+    auto componentState = std::make_shared<const std::vector<char>> (50000, 'p');
+
+    WrapperState written;
+    written.pluginPath = path;
+    written.componentState.buffer = componentState;
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ (writeWrapperState (&stream, written), kResultOk);
+
+    auto hostedInstance = controller_->getHostedInstance ();
+    auto& pluginModule = *hostedInstance;
+    auto restored = std::make_shared<const std::vector<char>> (*componentState);
+    pluginModule.setRestoredComponentState (restored);
+
+    int64 restoredSize = 0;
+    ::testing::NiceMock<Testing::MockEditController> hosted;
+    ON_CALL (hosted, setComponentState (::testing::_)).WillByDefault ([&] (IBStream* s) {
+        s->seek (0, IBStream::kIBSeekEnd, &restoredSize);
+        return kResultOk;
+    });
+    ControllerTestAccess::setHostedController (*controller_, &hosted, path);
+
+    stream.seek (0, IBStream::kIBSeekSet, nullptr);
+    EXPECT_EQ (controller_->setComponentState (&stream), kResultOk);
+    EXPECT_EQ (restoredSize, 50000);
+    EXPECT_EQ (restored.use_count (), 1) << "taken from the module and released";
+    EXPECT_FALSE (pluginModule.takeRestoredComponentState ());
+
+    ControllerTestAccess::setHostedController (*controller_, nullptr, "");
+}
@@ -8,43 +8,34 @@ using namespace VST3MCPWrapper;
 using namespace Steinberg;
 using namespace Steinberg::Vst;
 
-class HostedPluginModuleTest : public ::testing::Test {
+class HostedPluginInstanceTest : public ::testing::Test {
 protected:
-    void SetUp() override {
-        auto& mod = HostedPluginModule::instance();
-        mod.unload();
-        // Drain any leftover param changes from other tests
-        std::vector<ParamChange> drain;
-        mod.drainParamChanges(drain);
-    }
-
     void TearDown() override {
-        auto& mod = HostedPluginModule::instance();
-        mod.unload();
-        std::vector<ParamChange> drain;
-        mod.drainParamChanges(drain);
+        instance_.unload();
     }
+
+    HostedPluginInstance instance_;
 };
 
 // --- isLoaded tests ---
 
-TEST_F(HostedPluginModuleTest, IsLoadedReturnsFalseOnFreshSingleton) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, IsLoadedReturnsFalseOnFreshInstance) {
+    auto& mod = instance_;
     EXPECT_FALSE(mod.isLoaded());
 }
 
 // --- load with invalid path ---
 
-TEST_F(HostedPluginModuleTest, LoadInvalidPathReturnsFalseWithError) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, LoadInvalidPathReturnsFalseWithError) {
+    auto& mod = instance_;
     std::string error;
     bool result = mod.load("/nonexistent/path/to/plugin.vst3", error);
     EXPECT_FALSE(result);
     EXPECT_FALSE(error.empty());
 }
 
-TEST_F(HostedPluginModuleTest, IsLoadedRemainsFalseAfterFailedLoad) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, IsLoadedRemainsFalseAfterFailedLoad) {
+    auto& mod = instance_;
     std::string error;
     mod.load("/nonexistent/path/to/plugin.vst3", error);
     EXPECT_FALSE(mod.isLoaded());
@@ -52,20 +43,20 @@ TEST_F(HostedPluginModuleTest, IsLoadedRemainsFalseAfterFailedLoad) {
 
 // --- getPluginPath ---
 
-TEST_F(HostedPluginModuleTest, GetPluginPathReturnsEmptyWhenNotLoaded) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, GetPluginPathReturnsEmptyWhenNotLoaded) {
+    auto& mod = instance_;
     EXPECT_TRUE(mod.getPluginPath().empty());
 }
 
 // --- Controller class ID ---
 
-TEST_F(HostedPluginModuleTest, HasControllerClassIDReturnsFalseBeforeSet) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, HasControllerClassIDReturnsFalseBeforeSet) {
+    auto& mod = instance_;
     EXPECT_FALSE(mod.hasControllerClassID());
 }
 
-TEST_F(HostedPluginModuleTest, SetGetControllerClassIDRoundTrip) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, SetGetControllerClassIDRoundTrip) {
+    auto& mod = instance_;
 
     // Create a known TUID
     TUID testCID;
@@ -80,8 +71,8 @@ TEST_F(HostedPluginModuleTest, SetGetControllerClassIDRoundTrip) {
     EXPECT_EQ(std::memcmp(testCID, retrieved, sizeof(TUID)), 0);
 }
 
-TEST_F(HostedPluginModuleTest, SetControllerClassIDOverwritesPrevious) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, SetControllerClassIDOverwritesPrevious) {
+    auto& mod = instance_;
 
     TUID first;
     std::memset(first, 0xAA, sizeof(TUID));
@@ -98,23 +89,23 @@ TEST_F(HostedPluginModuleTest, SetControllerClassIDOverwritesPrevious) {
 
 // --- Hosted component ---
 
-TEST_F(HostedPluginModuleTest, SetHostedComponentNullReturnsNullptr) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, SetHostedComponentNullReturnsNullptr) {
+    auto& mod = instance_;
     mod.setHostedComponent(nullptr);
     auto comp = mod.getHostedComponent();
     EXPECT_EQ(comp, nullptr);
 }
 
-TEST_F(HostedPluginModuleTest, GetHostedComponentReturnsNullptrInitially) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, GetHostedComponentReturnsNullptrInitially) {
+    auto& mod = instance_;
     auto comp = mod.getHostedComponent();
     EXPECT_EQ(comp, nullptr);
 }
 
 // --- unload resets all state ---
 
-TEST_F(HostedPluginModuleTest, UnloadResetsAllState) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, UnloadResetsAllState) {
+    auto& mod = instance_;
 
     // Set some state
     TUID testCID;
@@ -147,8 +138,8 @@ TEST_F(HostedPluginModuleTest, UnloadResetsAllState) {
 
 // --- getFactory ---
 
-TEST_F(HostedPluginModuleTest, GetFactoryReturnsNulloptWhenNotLoaded) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, GetFactoryReturnsNulloptWhenNotLoaded) {
+    auto& mod = instance_;
     auto factory = mod.getFactory();
     EXPECT_FALSE(factory.has_value());
 }
@@ -166,8 +157,8 @@ static std::string getOwnBundlePath() {
     return "";
 }
 
-TEST_F(HostedPluginModuleTest, FailedLoadLeavesModuleInCleanState) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, FailedLoadLeavesModuleInCleanState) {
+    auto& mod = instance_;
     std::string error;
     mod.load("/nonexistent/path/to/plugin.vst3", error);
 
@@ -182,12 +173,12 @@ TEST_F(HostedPluginModuleTest, FailedLoadLeavesModuleInCleanState) {
     EXPECT_TRUE(drain.empty());
 }
 
-TEST_F(HostedPluginModuleTest, ValidLoadAfterFailedLoadSucceeds) {
+TEST_F(HostedPluginInstanceTest, ValidLoadAfterFailedLoadSucceeds) {
     std::string bundlePath = getOwnBundlePath();
     if (bundlePath.empty())
         GTEST_SKIP() << "Own plugin bundle path not available";
 
-    auto& mod = HostedPluginModule::instance();
+    auto& mod = instance_;
     std::string error;
 
     // First: failed load
@@ -205,8 +196,8 @@ TEST_F(HostedPluginModuleTest, ValidLoadAfterFailedLoadSucceeds) {
     EXPECT_TRUE(mod.getFactory().has_value());
 }
 
-TEST_F(HostedPluginModuleTest, UnloadWhenNothingLoadedIsNoOp) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, UnloadWhenNothingLoadedIsNoOp) {
+    auto& mod = instance_;
     ASSERT_FALSE(mod.isLoaded());
 
     // Should not crash or change state
@@ -217,8 +208,8 @@ TEST_F(HostedPluginModuleTest, UnloadWhenNothingLoadedIsNoOp) {
     EXPECT_FALSE(mod.getFactory().has_value());
 }
 
-TEST_F(HostedPluginModuleTest, DoubleUnloadIsNoOp) {
-    auto& mod = HostedPluginModule::instance();
+TEST_F(HostedPluginInstanceTest, DoubleUnloadIsNoOp) {
+    auto& mod = instance_;
 
     mod.unload();
     mod.unload();
@@ -228,12 +219,12 @@ TEST_F(HostedPluginModuleTest, DoubleUnloadIsNoOp) {
     EXPECT_FALSE(mod.getFactory().has_value());
 }
 
-TEST_F(HostedPluginModuleTest, LoadDifferentPathReplacesExistingPlugin) {
+TEST_F(HostedPluginInstanceTest, LoadDifferentPathReplacesExistingPlugin) {
     std::string bundlePath = getOwnBundlePath();
     if (bundlePath.empty())
         GTEST_SKIP() << "Own plugin bundle path not available";
 
-    auto& mod = HostedPluginModule::instance();
+    auto& mod = instance_;
     std::string error;
 
     // Load a valid plugin first
@@ -0,0 +1,273 @@
+/**
+ * @file test_instance_discovery.cpp
+ * @brief Tests for the instances.json discovery file and the list_instances tool.
+ *
+ * Every test works on a file under a temporary root. A second
+ * InstanceDiscovery on the same path stands in for another DAW process.
+ */
+
+#include <gtest/gtest.h>
+
+#include "controller.h"
+#include "instancediscovery.h"
+#include "mcp_plugin_handlers.h"
+#include "messageids.h"
+#include "processor.h"
+#include "mocks/mock_vst3.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Return;
+using ::testing::SetArgReferee;
+using ::testing::StrEq;
+
+namespace {
+
+bool loopbackPortAccepts(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    bool accepted = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    ::close(fd);
+    return accepted;
+}
+
+class InstanceDiscoveryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = fs::temp_directory_path() / ("vst3mcp_discovery_" + std::to_string(::getpid()) + "_"
+                                             + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        fs::remove_all(root_);
+        filePath_ = (root_ / "VST3MCPWrapper" / "instances.json").string();
+    }
+
+    void TearDown() override {
+        fs::remove_all(root_);
+    }
+
+    DiscoveredInstance makeInstance(const std::string& id, int port, int64_t pid = ::getpid()) {
+        DiscoveredInstance instance;
+        instance.id = id;
+        instance.port = port;
+        instance.pid = pid;
+        instance.pluginPath = "/plugins/" + id + ".vst3";
+        instance.pluginName = "Plugin " + id;
+        return instance;
+    }
+
+    // Write the file directly, as another process would have
+    void writeFile(const std::vector<DiscoveredInstance>& instances) {
+        mcp::json list = mcp::json::array();
+        for (const auto& instance : instances)
+            list.push_back(discoveredInstanceToJson(instance));
+        fs::create_directories(fs::path(filePath_).parent_path());
+        std::ofstream(filePath_) << mcp::json({{"formatVersion", InstanceDiscovery::kFormatVersion},
+                                               {"instances", list}}).dump();
+    }
+
+    // PID of a process that has exited and been reaped
+    static int64_t deadPid() {
+        pid_t child = ::fork();
+        if (child == 0)
+            ::_exit(0);
+        ::waitpid(child, nullptr, 0);
+        return child;
+    }
+
+    static std::vector<std::string> ids(const std::vector<DiscoveredInstance>& instances) {
+        std::vector<std::string> result;
+        for (const auto& instance : instances)
+            result.push_back(instance.id);
+        return result;
+    }
+
+    fs::path root_;
+    std::string filePath_;
+};
+
+} // namespace
+
+TEST_F(InstanceDiscoveryTest, JsonRoundTrip) {
+    auto instance = makeInstance("a", 40001);
+    DiscoveredInstance parsed;
+    ASSERT_TRUE(discoveredInstanceFromJson(discoveredInstanceToJson(instance), parsed));
+    EXPECT_EQ(parsed.id, "a");
+    EXPECT_EQ(parsed.port, 40001);
+    EXPECT_EQ(parsed.pid, instance.pid);
+    EXPECT_EQ(parsed.pluginPath, instance.pluginPath);
+    EXPECT_EQ(parsed.pluginName, instance.pluginName);
+
+    EXPECT_FALSE(discoveredInstanceFromJson({{"id", "a"}, {"pid", 1}}, parsed));
+    EXPECT_FALSE(discoveredInstanceFromJson({{"id", "a"}, {"port", 0}, {"pid", 1}}, parsed));
+}
+
+TEST_F(InstanceDiscoveryTest, PublishedEntriesAreVisibleToOtherReaders) {
+    InstanceDiscovery writer(filePath_);
+    InstanceDiscovery reader(filePath_);
+    EXPECT_TRUE(reader.instances().empty());
+
+    ASSERT_TRUE(writer.publish(makeInstance("a", 40001)));
+    ASSERT_TRUE(writer.publish(makeInstance("b", 40002)));
+
+    auto instances = reader.instances();
+    ASSERT_EQ(instances.size(), 2u);
+    EXPECT_EQ(instances[0].id, "a");
+    EXPECT_EQ(instances[1].port, 40002);
+    EXPECT_EQ(writer.instances().size(), 2u);
+}
+
+TEST_F(InstanceDiscoveryTest, PublishReplacesEntryWithSameId) {
+    InstanceDiscovery discovery(filePath_);
+    ASSERT_TRUE(discovery.publish(makeInstance("a", 40001)));
+
+    auto updated = makeInstance("a", 40001);
+    updated.pluginName = "Other";
+    ASSERT_TRUE(discovery.publish(updated));
+
+    auto instances = InstanceDiscovery(filePath_).instances();
+    ASSERT_EQ(instances.size(), 1u);
+    EXPECT_EQ(instances[0].pluginName, "Other");
+}
+
+TEST_F(InstanceDiscoveryTest, WithdrawOnlyRemovesOwnEntries) {
+    // An entry with the same ID from another live process (our parent)
+    writeFile({makeInstance("other", 40003, ::getppid())});
+    InstanceDiscovery discovery(filePath_);
+    ASSERT_TRUE(discovery.publish(makeInstance("a", 40001)));
+
+    EXPECT_TRUE(discovery.withdraw("a"));
+    EXPECT_FALSE(discovery.withdraw("other"));
+    EXPECT_EQ(ids(InstanceDiscovery(filePath_).instances()), std::vector<std::string>{"other"});
+}
+
+TEST_F(InstanceDiscoveryTest, EntriesOfDeadProcessesAreSkippedAndDropped) {
+    writeFile({makeInstance("dead", 40004, deadPid())});
+    InstanceDiscovery discovery(filePath_);
+    EXPECT_TRUE(discovery.instances().empty());
+
+    ASSERT_TRUE(discovery.publish(makeInstance("a", 40001)));
+    auto file = mcp::json::parse(std::ifstream(filePath_));
+    ASSERT_EQ(file["instances"].size(), 1u);
+    EXPECT_EQ(file["instances"][0]["id"], "a");
+}
+
+TEST_F(InstanceDiscoveryTest, UnreadableFileIsTreatedAsEmpty) {
+    fs::create_directories(fs::path(filePath_).parent_path());
+    std::ofstream(filePath_) << "{ not json";
+    InstanceDiscovery discovery(filePath_);
+    EXPECT_TRUE(discovery.instances().empty());
+
+    ASSERT_TRUE(discovery.publish(makeInstance("a", 40001)));
+    EXPECT_EQ(ids(InstanceDiscovery(filePath_).instances()), std::vector<std::string>{"a"});
+}
+
+TEST_F(InstanceDiscoveryTest, WatcherPicksUpChangesFromOtherWriters) {
+    InstanceDiscovery reader(filePath_);
+    reader.startWatching();
+    EXPECT_TRUE(reader.instances().empty());
+
+    InstanceDiscovery writer(filePath_);
+    ASSERT_TRUE(writer.publish(makeInstance("a", 40001)));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (reader.instances().empty() && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(ids(reader.instances()), std::vector<std::string>{"a"});
+
+    reader.stopWatching();
+}
+
+TEST_F(InstanceDiscoveryTest, ConcurrentWritersDontLoseEntries) {
+    constexpr int kWriters = 8;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kWriters; ++i) {
+        threads.emplace_back([this, i] {
+            InstanceDiscovery discovery(filePath_);
+            EXPECT_TRUE(discovery.publish(makeInstance("w" + std::to_string(i), 40000 + i)));
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(InstanceDiscovery(filePath_).instances().size(), static_cast<size_t>(kWriters));
+}
+
+TEST_F(InstanceDiscoveryTest, EmptyPathDisablesTheFile) {
+    InstanceDiscovery discovery("");
+    EXPECT_FALSE(discovery.publish(makeInstance("a", 40001)));
+    EXPECT_TRUE(discovery.instances().empty());
+}
+
+TEST_F(InstanceDiscoveryTest, ListInstancesMarksSelf) {
+    auto result = handleListInstances({makeInstance("a", 40001), makeInstance("b", 40002)}, "b");
+    auto body = mcp::json::parse(result["content"][0]["text"].get<std::string>());
+    ASSERT_EQ(body["instances"].size(), 2u);
+    EXPECT_FALSE(body["instances"][0].contains("self"));
+    EXPECT_TRUE(body["instances"][1]["self"].get<bool>());
+    EXPECT_EQ(body["instances"][1]["port"], 40002);
+}
+
+TEST(InstanceDiscoveryController, PublishedOnceBoundAndWithdrawnOnTerminate) {
+    auto* processor = new Processor();
+    ASSERT_EQ(processor->initialize(nullptr), kResultOk);
+    auto* controller = new Controller();
+    ASSERT_EQ(controller->initialize(nullptr), kResultOk);
+    const std::string id = processor->getInstanceId();
+
+    auto find = [&id]() -> std::optional<DiscoveredInstance> {
+        for (const auto& instance : InstanceDiscovery::shared().instances()) {
+            if (instance.id == id)
+                return instance;
+        }
+        return std::nullopt;
+    };
+    EXPECT_FALSE(find());
+
+    MockMessage msg;
+    MockAttributeList attrs;
+    const void* data = id.data();
+    uint32 size = static_cast<uint32>(id.size());
+    EXPECT_CALL(msg, getMessageID()).WillRepeatedly(Return(MessageIds::kInstanceId));
+    EXPECT_CALL(msg, getAttributes()).WillRepeatedly(Return(&attrs));
+    EXPECT_CALL(attrs, getBinary(StrEq("id"), _, _))
+        .WillOnce(DoAll(SetArgReferee<1>(data), SetArgReferee<2>(size), Return(kResultOk)));
+    EXPECT_EQ(controller->notify(&msg), kResultOk);
+
+    auto entry = find();
+    ASSERT_TRUE(entry);
+    EXPECT_GT(entry->port, 0);
+    // Only published once the server listens
+    EXPECT_TRUE(loopbackPortAccepts(entry->port));
+    EXPECT_EQ(entry->pid, ::getpid());
+    EXPECT_TRUE(entry->pluginPath.empty());
+
+    controller->terminate();
+    EXPECT_FALSE(find());
+
+    controller->release();
+    processor->terminate();
+    processor->release();
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "instancepool.h"
+#include "mocks/mock_vst3.h"
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace {
+
+class WarmInstancePoolTest : public ::testing::Test {
+protected:
+    void SetUp () override
+    {
+        std::memset (controllerCID_, 0x42, sizeof (TUID));
+        pool_.setScheduler ([this] (std::function<void ()> task) { tasks_.push_back (std::move (task)); });
+        pool_.setComponentFactory (this, [this] (const std::string& path, WarmComponent& out) {
+            componentPaths_.push_back (path);
+            if (failComponents_)
+                return false;
+            if (onBuildComponent_)
+                onBuildComponent_ ();
+            out.component = &component_;
+            out.processor = &processor_;
+            out.hasControllerClassID = true;
+            std::memcpy (out.controllerClassID, controllerCID_, sizeof (TUID));
+            return true;
+        });
+        pool_.setControllerFactory (this, [this] (const std::string& path, const TUID* cid, WarmController& out) {
+            controllerPaths_.push_back (path);
+            receivedCID_ = cid && std::memcmp (*cid, controllerCID_, sizeof (TUID)) == 0;
+            out.controller = &controller_;
+            return true;
+        });
+    }
+
+    void TearDown () override
+    {
+        pool_.setScheduler (nullptr);
+        pool_.clear ();
+    }
+
+    // Run posted refill tasks until the pool stops posting
+    void runTasks ()
+    {
+        for (int i = 0; i < 100 && !tasks_.empty (); ++i) {
+            auto task = std::move (tasks_.front ());
+            tasks_.erase (tasks_.begin ());
+            task ();
+        }
+    }
+
+    WarmInstancePool::PluginStatus statusOf (const std::string& path)
+    {
+        for (const auto& plugin : pool_.status ())
+            if (plugin.path == path)
+                return plugin;
+        return {};
+    }
+
+    NiceMock<MockComponent> component_;
+    NiceMock<MockAudioProcessor> processor_;
+    NiceMock<MockEditController> controller_;
+    TUID controllerCID_;
+
+    std::vector<std::function<void ()>> tasks_;
+    std::vector<std::string> componentPaths_, controllerPaths_;
+    bool failComponents_ = false;
+    bool receivedCID_ = false;
+    std::function<void ()> onBuildComponent_;
+
+    WarmInstancePool pool_; // Declared last: terminates pooled mocks before they die
+};
+
+} // namespace
+
+TEST_F (WarmInstancePoolTest, RefillBuildsBothHalvesOnTheScheduler)
+{
+    pool_.configure ({"/a.vst3", "/b.vst3"}, 1);
+    EXPECT_TRUE (componentPaths_.empty ()) << "nothing built inline";
+
+    runTasks ();
+    EXPECT_EQ (componentPaths_, (std::vector<std::string>{"/a.vst3", "/b.vst3"}));
+    EXPECT_EQ (controllerPaths_.size (), 2u);
+    EXPECT_TRUE (receivedCID_) << "controller class learned from the component";
+
+    auto a = statusOf ("/a.vst3");
+    EXPECT_EQ (a.components, 1u);
+    EXPECT_EQ (a.controllers, 1u);
+    EXPECT_TRUE (tasks_.empty ()) << "no work once full";
+}
+
+TEST_F (WarmInstancePoolTest, TakeHandsOutWarmInstanceAndRefills)
+{
+    pool_.configure ({"/a.vst3"}, 2);
+    runTasks ();
+    EXPECT_EQ (statusOf ("/a.vst3").components, 2u);
+
+    WarmComponent component;
+    ASSERT_TRUE (pool_.takeComponent ("/a.vst3", component));
+    EXPECT_EQ (component.component.get (), &component_);
+    EXPECT_EQ (component.processor.get (), &processor_);
+    WarmController controller;
+    ASSERT_TRUE (pool_.takeController ("/a.vst3", controller));
+    EXPECT_EQ (controller.controller.get (), &controller_);
+    EXPECT_EQ (statusOf ("/a.vst3").components, 1u);
+
+    runTasks ();
+    EXPECT_EQ (statusOf ("/a.vst3").components, 2u);
+    EXPECT_EQ (statusOf ("/a.vst3").controllers, 2u);
+}
+
+TEST_F (WarmInstancePoolTest, TakeMissesForUnlistedOrEmptyPlugin)
+{
+    WarmComponent component;
+    EXPECT_FALSE (pool_.takeComponent ("/a.vst3", component));
+
+    pool_.configure ({"/a.vst3"}, 1);
+    EXPECT_FALSE (pool_.takeComponent ("/a.vst3", component)) << "not built yet";
+}
+
+TEST_F (WarmInstancePoolTest, NothingIsBuiltWithoutScheduler)
+{
+    pool_.setScheduler (nullptr);
+    pool_.configure ({"/a.vst3"}, 1);
+    EXPECT_TRUE (tasks_.empty ());
+    EXPECT_TRUE (componentPaths_.empty ());
+}
+
+TEST_F (WarmInstancePoolTest, InvalidatedComponentsAreTerminatedAndRebuilt)
+{
+    pool_.configure ({"/a.vst3"}, 1);
+    runTasks ();
+
+    EXPECT_CALL (component_, terminate ()).Times (1);
+    EXPECT_CALL (controller_, terminate ()).Times (0);
+    pool_.invalidateComponents ();
+    EXPECT_EQ (statusOf ("/a.vst3").components, 0u);
+    EXPECT_EQ (statusOf ("/a.vst3").controllers, 1u);
+    ::testing::Mock::VerifyAndClearExpectations (&component_);
+    ::testing::Mock::VerifyAndClearExpectations (&controller_);
+
+    runTasks ();
+    EXPECT_EQ (statusOf ("/a.vst3").components, 1u);
+    EXPECT_EQ (componentPaths_.size (), 2u);
+}
+
+TEST_F (WarmInstancePoolTest, ComponentBuiltWithStaleConfigurationIsDiscarded)
+{
+    pool_.configure ({"/a.vst3"}, 1);
+    // The host reconfigures while the first component is being built
+    onBuildComponent_ = [this] {
+        onBuildComponent_ = nullptr;
+        pool_.invalidateComponents ();
+    };
+
+    EXPECT_CALL (component_, terminate ()).Times (1);
+    runTasks ();
+    ::testing::Mock::VerifyAndClearExpectations (&component_);
+    EXPECT_EQ (componentPaths_.size (), 2u);
+    EXPECT_EQ (statusOf ("/a.vst3").components, 1u);
+}
+
+TEST_F (WarmInstancePoolTest, UnlistedPluginsInstancesAreTerminated)
+{
+    pool_.configure ({"/a.vst3", "/b.vst3"}, 1);
+    runTasks ();
+
+    EXPECT_CALL (component_, terminate ()).Times (1);
+    EXPECT_CALL (controller_, terminate ()).Times (1);
+    pool_.configure ({"/b.vst3"}, 1);
+    ::testing::Mock::VerifyAndClearExpectations (&component_);
+    ::testing::Mock::VerifyAndClearExpectations (&controller_);
+
+    ASSERT_EQ (pool_.status ().size (), 1u);
+    EXPECT_EQ (statusOf ("/b.vst3").components, 1u) << "kept across reconfiguration";
+    EXPECT_TRUE (tasks_.empty ());
+}
+
+TEST_F (WarmInstancePoolTest, FailingPluginIsNotRetriedUntilListedAgain)
+{
+    failComponents_ = true;
+    pool_.configure ({"/a.vst3"}, 1);
+    runTasks ();
+    EXPECT_EQ (componentPaths_.size (), 1u);
+    EXPECT_FALSE (statusOf ("/a.vst3").error.empty ());
+    EXPECT_TRUE (controllerPaths_.empty ());
+
+    failComponents_ = false;
+    pool_.configure ({"/a.vst3"}, 1);
+    runTasks ();
+    EXPECT_TRUE (statusOf ("/a.vst3").error.empty ());
+    EXPECT_EQ (statusOf ("/a.vst3").components, 1u);
+}
+
+TEST_F (WarmInstancePoolTest, RemovingFactoryOnlyAppliesToItsOwner)
+{
+    pool_.configure ({"/a.vst3"}, 1);
+    runTasks ();
+
+    int otherOwner = 0;
+    pool_.removeComponentFactory (&otherOwner);
+    EXPECT_EQ (statusOf ("/a.vst3").components, 1u);
+
+    EXPECT_CALL (component_, terminate ()).Times (1);
+    pool_.removeComponentFactory (this);
+    ::testing::Mock::VerifyAndClearExpectations (&component_);
+    EXPECT_EQ (statusOf ("/a.vst3").components, 0u);
+    EXPECT_EQ (statusOf ("/a.vst3").controllers, 1u);
+    EXPECT_TRUE (tasks_.empty ()) << "no factory left to build components";
+}
+
+TEST_F (WarmInstancePoolTest, LimitsPluginsAndInstances)
+{
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < WarmInstancePool::kMaxPlugins + 4; ++i)
+        paths.push_back ("/p" + std::to_string (i) + ".vst3");
+    paths.push_back ("/p0.vst3"); // duplicate
+    pool_.configure (paths, 100);
+
+    EXPECT_EQ (pool_.status ().size (), WarmInstancePool::kMaxPlugins);
+    EXPECT_EQ (pool_.instancesPerPlugin (), WarmInstancePool::kMaxInstancesPerPlugin);
+}
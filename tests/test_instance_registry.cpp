@@ -0,0 +1,298 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "controller.h"
+#include "hostedplugin.h"
+#include "instanceregistry.h"
+#include "messageids.h"
+#include "processor.h"
+#include "stateformat.h"
+#include "mocks/mock_vst3.h"
+
+#include "public.sdk/source/vst/utility/memoryibstream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Return;
+using ::testing::SetArgReferee;
+using ::testing::StrEq;
+
+// ============================================================
+// InstanceRegistry
+// ============================================================
+
+TEST (InstanceRegistry, FindReturnsAddedInstance)
+{
+    InstanceRegistry registry;
+    auto instance = std::make_shared<HostedPluginInstance> ();
+
+    EXPECT_TRUE (registry.add ("a", instance));
+    EXPECT_EQ (registry.find ("a"), instance);
+    EXPECT_EQ (registry.find ("b"), nullptr);
+}
+
+TEST (InstanceRegistry, AddRejectsIdOfAnotherLiveInstance)
+{
+    InstanceRegistry registry;
+    auto first = std::make_shared<HostedPluginInstance> ();
+    auto second = std::make_shared<HostedPluginInstance> ();
+
+    EXPECT_TRUE (registry.add ("a", first));
+    EXPECT_TRUE (registry.add ("a", first)) << "re-adding the same instance is fine";
+    EXPECT_FALSE (registry.add ("a", second));
+    EXPECT_EQ (registry.find ("a"), first);
+}
+
+TEST (InstanceRegistry, EntryGoesAwayWithItsInstance)
+{
+    InstanceRegistry registry;
+    auto first = std::make_shared<HostedPluginInstance> ();
+    ASSERT_TRUE (registry.add ("a", first));
+
+    first.reset ();
+    EXPECT_EQ (registry.find ("a"), nullptr);
+    EXPECT_TRUE (registry.ids ().empty ());
+
+    auto second = std::make_shared<HostedPluginInstance> ();
+    EXPECT_TRUE (registry.add ("a", second));
+    EXPECT_EQ (registry.find ("a"), second);
+}
+
+TEST (InstanceRegistry, RemoveOnlyRemovesTheGivenInstance)
+{
+    InstanceRegistry registry;
+    auto first = std::make_shared<HostedPluginInstance> ();
+    auto second = std::make_shared<HostedPluginInstance> ();
+    ASSERT_TRUE (registry.add ("a", first));
+
+    registry.remove ("a", second.get ());
+    EXPECT_EQ (registry.find ("a"), first);
+
+    registry.remove ("a", first.get ());
+    EXPECT_EQ (registry.find ("a"), nullptr);
+}
+
+TEST (InstanceRegistry, ConcurrentAddAndFindAcrossShards)
+{
+    InstanceRegistry registry;
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 16;
+
+    std::vector<std::shared_ptr<HostedPluginInstance>> instances;
+    for (int i = 0; i < kThreads * kPerThread; ++i)
+        instances.push_back (std::make_shared<HostedPluginInstance> ());
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back ([&, t] {
+            for (int i = t * kPerThread; i < (t + 1) * kPerThread; ++i) {
+                std::string id = "instance-" + std::to_string (i);
+                EXPECT_TRUE (registry.add (id, instances[i]));
+                EXPECT_EQ (registry.find (id), instances[i]);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join ();
+
+    auto ids = registry.ids ();
+    EXPECT_EQ (ids.size (), instances.size ());
+    std::sort (ids.begin (), ids.end ());
+    EXPECT_TRUE (std::adjacent_find (ids.begin (), ids.end ()) == ids.end ());
+}
+
+// ============================================================
+// Processor and controller binding
+// ============================================================
+
+namespace {
+
+class InstanceBindingTest : public ::testing::Test {
+protected:
+    void SetUp () override
+    {
+        processor_ = new Processor ();
+        ASSERT_EQ (processor_->initialize (nullptr), kResultOk);
+        controller_ = new Controller ();
+    }
+
+    void TearDown () override
+    {
+        controller_->release ();
+        processor_->terminate ();
+        processor_->release ();
+    }
+
+    // A v2 wrapper state carrying only an instance ID
+    static void writeIdState (ResizableMemoryIBStream& stream, const std::string& id)
+    {
+        WrapperState state;
+        state.instanceId = id;
+        ASSERT_EQ (writeWrapperState (&stream, state), kResultOk);
+        stream.seek (0, IBStream::kIBSeekSet, nullptr);
+    }
+
+    // Deliver kInstanceId with id to the controller, as the processor does on connect
+    void sendInstanceId (const std::string& id)
+    {
+        MockMessage msg;
+        MockAttributeList attrs;
+        const void* data = id.data ();
+        uint32 size = static_cast<uint32> (id.size ());
+        EXPECT_CALL (msg, getMessageID ()).WillRepeatedly (Return (MessageIds::kInstanceId));
+        EXPECT_CALL (msg, getAttributes ()).WillRepeatedly (Return (&attrs));
+        EXPECT_CALL (attrs, getBinary (StrEq ("id"), _, _))
+            .WillOnce (DoAll (SetArgReferee<1> (data), SetArgReferee<2> (size), Return (kResultOk)));
+        EXPECT_EQ (controller_->notify (&msg), kResultOk);
+    }
+
+    Processor* processor_ = nullptr;
+    Controller* controller_ = nullptr;
+};
+
+} // namespace
+
+TEST_F (InstanceBindingTest, ProcessorIsRegisteredWhileInitialized)
+{
+    const std::string id = processor_->getInstanceId ();
+    auto found = InstanceRegistry::shared ().find (id);
+    EXPECT_EQ (found.get (), &processor_->getHostedInstance ());
+
+    found.reset ();
+    processor_->terminate ();
+    EXPECT_EQ (InstanceRegistry::shared ().find (id), nullptr);
+}
+
+TEST_F (InstanceBindingTest, ProcessorsHaveIndependentParamQueues)
+{
+    auto* other = new Processor ();
+    ASSERT_EQ (other->initialize (nullptr), kResultOk);
+    EXPECT_NE (other->getInstanceId (), processor_->getInstanceId ());
+
+    processor_->getHostedInstance ().pushParamChange (1, 0.5);
+
+    std::vector<ParamChange> drained;
+    other->getHostedInstance ().drainParamChanges (drained);
+    EXPECT_TRUE (drained.empty ());
+    processor_->getHostedInstance ().drainParamChanges (drained);
+    EXPECT_EQ (drained.size (), 1u);
+
+    other->terminate ();
+    other->release ();
+}
+
+TEST_F (InstanceBindingTest, ProcessorsHaveIndependentWarmPools)
+{
+    auto& pool = processor_->getHostedInstance ().warmPool ();
+    std::vector<std::function<void ()>> tasks;
+    pool.setScheduler ([&tasks] (std::function<void ()> task) { tasks.push_back (std::move (task)); });
+    pool.configure ({"/nonexistent/Warm.vst3"}, 1);
+    ASSERT_EQ (tasks.size (), 1u) << "this processor's component factory is registered";
+
+    // Another instance coming and going neither sees nor disturbs this pool
+    auto* other = new Processor ();
+    ASSERT_EQ (other->initialize (nullptr), kResultOk);
+    EXPECT_NE (&other->getHostedInstance ().warmPool (), &pool);
+    EXPECT_TRUE (other->getHostedInstance ().warmPool ().status ().empty ());
+    other->terminate ();
+    other->release ();
+
+    // The pending refill still runs this processor's factory (the bundle
+    // doesn't exist, so it records the failure)
+    tasks[0] ();
+    auto status = pool.status ();
+    ASSERT_EQ (status.size (), 1u);
+    EXPECT_EQ (status[0].error, "Failed to create component");
+    pool.setScheduler (nullptr);
+}
+
+TEST_F (InstanceBindingTest, ControllerMovesWarmPoolRegistrationWhenBinding)
+{
+    ASSERT_EQ (controller_->initialize (nullptr), kResultOk);
+    sendInstanceId (processor_->getInstanceId ());
+
+    // The controller's MCP server now refills the shared instance's pool
+    auto& pool = processor_->getHostedInstance ().warmPool ();
+    pool.configure ({"/nonexistent/Warm.vst3"}, 1);
+    auto deadline = std::chrono::steady_clock::now () + std::chrono::seconds (5);
+    while (pool.status ()[0].error.empty () && std::chrono::steady_clock::now () < deadline)
+        std::this_thread::sleep_for (std::chrono::milliseconds (5));
+    EXPECT_EQ (pool.status ()[0].error, "Failed to create component");
+
+    controller_->terminate ();
+}
+
+TEST_F (InstanceBindingTest, SetStateMovesRegistrationToSavedId)
+{
+    const std::string oldId = processor_->getInstanceId ();
+    const std::string savedId = "00000000000000aa";
+    ResizableMemoryIBStream stream;
+    writeIdState (stream, savedId);
+
+    EXPECT_EQ (processor_->setState (&stream), kResultOk);
+    EXPECT_EQ (processor_->getInstanceId (), savedId);
+    EXPECT_EQ (InstanceRegistry::shared ().find (savedId).get (), &processor_->getHostedInstance ());
+    EXPECT_EQ (InstanceRegistry::shared ().find (oldId), nullptr);
+}
+
+TEST_F (InstanceBindingTest, SetStateKeepsIdWhenSavedOneIsLive)
+{
+    // A duplicated track restores the state of an instance that still exists
+    auto* original = new Processor ();
+    ASSERT_EQ (original->initialize (nullptr), kResultOk);
+    const std::string ownId = processor_->getInstanceId ();
+    ResizableMemoryIBStream stream;
+    writeIdState (stream, original->getInstanceId ());
+
+    EXPECT_EQ (processor_->setState (&stream), kResultOk);
+    EXPECT_EQ (processor_->getInstanceId (), ownId);
+    EXPECT_EQ (InstanceRegistry::shared ().find (original->getInstanceId ()).get (),
+               &original->getHostedInstance ());
+    EXPECT_EQ (InstanceRegistry::shared ().find (ownId).get (), &processor_->getHostedInstance ());
+
+    original->terminate ();
+    original->release ();
+}
+
+TEST_F (InstanceBindingTest, ControllerSharesProcessorInstanceAfterMessage)
+{
+    EXPECT_NE (controller_->getHostedInstance ().get (), &processor_->getHostedInstance ());
+
+    sendInstanceId (processor_->getInstanceId ());
+    EXPECT_EQ (controller_->getHostedInstance ().get (), &processor_->getHostedInstance ());
+
+    // Edits from the hosted GUI now reach this processor's queue
+    static_cast<IComponentHandler*> (controller_)->performEdit (3, 0.25);
+    std::vector<ParamChange> drained;
+    processor_->getHostedInstance ().drainParamChanges (drained);
+    ASSERT_EQ (drained.size (), 1u);
+    EXPECT_EQ (drained[0].id, 3u);
+}
+
+TEST_F (InstanceBindingTest, ControllerKeepsOwnInstanceForUnknownId)
+{
+    auto before = controller_->getHostedInstance ();
+    sendInstanceId ("ffffffffffffffff");
+    EXPECT_EQ (controller_->getHostedInstance (), before);
+}
+
+TEST_F (InstanceBindingTest, ControllerBindsFromComponentStateWithoutMessage)
+{
+    ResizableMemoryIBStream stream;
+    writeIdState (stream, processor_->getInstanceId ());
+
+    EXPECT_EQ (controller_->setComponentState (&stream), kResultOk);
+    EXPECT_EQ (controller_->getHostedInstance ().get (), &processor_->getHostedInstance ());
+}
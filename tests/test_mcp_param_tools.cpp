@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <chrono>
 #include <limits>
 
 #include "mcp_param_handlers.h"
@@ -30,16 +31,8 @@ ParameterInfo makeParamInfo(ParamID id, const char16_t* title, const char16_t* u
 
 class MCPParamToolsTest : public ::testing::Test {
 protected:
-    void SetUp() override {
-        // Drain any leftover param changes from previous tests
-        std::vector<ParamChange> drain;
-        HostedPluginModule::instance().drainParamChanges(drain);
-    }
-
-    void TearDown() override {
-        std::vector<ParamChange> drain;
-        HostedPluginModule::instance().drainParamChanges(drain);
-    }
+    ParameterInfoCache cache_;
+    HostedPluginInstance instance_;
 };
 
 // ============================================================
@@ -47,7 +40,7 @@ protected:
 // ============================================================
 
 TEST_F(MCPParamToolsTest, ListParametersNoPluginLoaded) {
-    auto result = handleListParameters(nullptr);
+    auto result = handleListParameters(nullptr, cache_);
     EXPECT_TRUE(result.contains("isError"));
     EXPECT_TRUE(result["isError"].get<bool>());
     auto content = result["content"][0]["text"].get<std::string>();
@@ -75,7 +68,7 @@ TEST_F(MCPParamToolsTest, ListParametersReturnsAllFields) {
     EXPECT_CALL(mockCtrl, getParamStringByValue(_, _, _))
         .WillRepeatedly(Return(kResultFalse));
 
-    auto result = handleListParameters(&mockCtrl);
+    auto result = handleListParameters(&mockCtrl, cache_);
     EXPECT_FALSE(result.contains("isError"));
 
     // Parse the embedded JSON text
@@ -123,7 +116,7 @@ TEST_F(MCPParamToolsTest, ListParametersWithDisplayValue) {
             return kResultOk;
         }));
 
-    auto result = handleListParameters(&mockCtrl);
+    auto result = handleListParameters(&mockCtrl, cache_);
     auto contentText = result["content"][0]["text"].get<std::string>();
     auto paramList = mcp::json::parse(contentText);
 
@@ -131,12 +124,160 @@ TEST_F(MCPParamToolsTest, ListParametersWithDisplayValue) {
     EXPECT_EQ(paramList[0]["displayValue"].get<std::string>(), "-6.0 dB");
 }
 
+TEST_F(MCPParamToolsTest, ListParametersSinceVersionReturnsOnlyChanged) {
+    MockEditController mockCtrl;
+    ParameterInfo infoA = makeParamInfo(1, u"A", u"", 0.0, 0, 0);
+    ParameterInfo infoB = makeParamInfo(2, u"B", u"", 0.0, 0, 0);
+
+    EXPECT_CALL(mockCtrl, getParameterCount()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(infoA), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, getParameterInfo(1, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(infoB), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, setParamNormalized(_, _)).WillRepeatedly(Return(kResultOk));
+    EXPECT_CALL(mockCtrl, getParamNormalized(_)).WillRepeatedly(Return(0.5));
+    EXPECT_CALL(mockCtrl, getParamStringByValue(_, _, _)).WillRepeatedly(Return(kResultFalse));
+
+    // First poll from 0 lists everything
+    ListParametersOptions options;
+    options.sinceVersion = 0;
+    auto full = mcp::json::parse(
+        handleListParameters(&mockCtrl, cache_, options)["content"][0]["text"].get<std::string>());
+    EXPECT_TRUE(full["full"].get<bool>());
+    EXPECT_EQ(full["parameters"].size(), 2u);
+    uint64_t version = full["version"].get<uint64_t>();
+
+    // Nothing changed yet
+    options.sinceVersion = version;
+    auto unchanged = mcp::json::parse(
+        handleListParameters(&mockCtrl, cache_, options)["content"][0]["text"].get<std::string>());
+    EXPECT_FALSE(unchanged["full"].get<bool>());
+    EXPECT_TRUE(unchanged["parameters"].empty());
+    EXPECT_EQ(unchanged["version"].get<uint64_t>(), version);
+
+    handleSetParameter(&mockCtrl, cache_, instance_, 2, 0.5);
+    auto delta = mcp::json::parse(
+        handleListParameters(&mockCtrl, cache_, options)["content"][0]["text"].get<std::string>());
+    EXPECT_FALSE(delta["full"].get<bool>());
+    ASSERT_EQ(delta["parameters"].size(), 1u);
+    EXPECT_EQ(delta["parameters"][0]["id"].get<uint32>(), 2u);
+    EXPECT_GT(delta["version"].get<uint64_t>(), version);
+}
+
+TEST_F(MCPParamToolsTest, ListParametersOutputIsCompact) {
+    MockEditController mockCtrl;
+    ParameterInfo info = makeParamInfo(1, u"A", u"", 0.0, 0, 0);
+    EXPECT_CALL(mockCtrl, getParameterCount()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, getParamNormalized(_)).WillRepeatedly(Return(0.5));
+    EXPECT_CALL(mockCtrl, getParamStringByValue(_, _, _)).WillRepeatedly(Return(kResultFalse));
+
+    auto text = handleListParameters(&mockCtrl, cache_)["content"][0]["text"].get<std::string>();
+    EXPECT_EQ(text.find('\n'), std::string::npos);
+    EXPECT_TRUE(mcp::json::parse(text).is_array());
+}
+
+TEST_F(MCPParamToolsTest, ListParametersPaginatesFilteredList) {
+    MockEditController mockCtrl;
+    const char16_t* titles[] = {u"Osc1 Level", u"Cutoff", u"osc2 level", u"OSC3 Level", u"Resonance"};
+    EXPECT_CALL(mockCtrl, getParameterCount()).WillRepeatedly(Return(5));
+    for (int32 i = 0; i < 5; ++i) {
+        ParameterInfo info = makeParamInfo(static_cast<ParamID>(i + 10), titles[i], u"", 0.0, 0, 0);
+        EXPECT_CALL(mockCtrl, getParameterInfo(i, _))
+            .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
+    }
+    // Only the page is queried for live values
+    EXPECT_CALL(mockCtrl, getParamNormalized(12)).WillOnce(Return(0.2));
+    EXPECT_CALL(mockCtrl, getParamNormalized(10)).Times(0);
+    EXPECT_CALL(mockCtrl, getParamNormalized(13)).Times(0);
+    EXPECT_CALL(mockCtrl, getParamStringByValue(_, _, _)).WillRepeatedly(Return(kResultFalse));
+
+    ListParametersOptions options;
+    options.nameFilter = "OSC";
+    options.offset = 1;
+    options.limit = 1;
+    auto data = mcp::json::parse(
+        handleListParameters(&mockCtrl, cache_, options)["content"][0]["text"].get<std::string>());
+
+    EXPECT_EQ(data["total"].get<size_t>(), 3u);
+    EXPECT_EQ(data["offset"].get<size_t>(), 1u);
+    EXPECT_EQ(data["nextOffset"].get<size_t>(), 2u);
+    EXPECT_FALSE(data.contains("full"));
+    ASSERT_EQ(data["parameters"].size(), 1u);
+    EXPECT_EQ(data["parameters"][0]["id"].get<uint32>(), 12u);
+    EXPECT_EQ(data["parameters"][0]["title"].get<std::string>(), "osc2 level");
+}
+
+TEST_F(MCPParamToolsTest, ListParametersFieldsProjection) {
+    MockEditController mockCtrl;
+    ParameterInfo info = makeParamInfo(7, u"Gain", u"dB", 0.0, 0, ParameterInfo::kCanAutomate);
+    EXPECT_CALL(mockCtrl, getParameterCount()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, getParamNormalized(7)).WillOnce(Return(0.25));
+    EXPECT_CALL(mockCtrl, getParamStringByValue(_, _, _)).Times(0);
+
+    ListParametersOptions options;
+    std::string error;
+    ASSERT_TRUE(parseListParametersOptions(
+        mcp::json{{"fields", {"id", "normalizedValue"}}}, options, error)) << error;
+    auto data = mcp::json::parse(
+        handleListParameters(&mockCtrl, cache_, options)["content"][0]["text"].get<std::string>());
+
+    ASSERT_EQ(data["parameters"].size(), 1u);
+    const auto& entry = data["parameters"][0];
+    EXPECT_EQ(entry.size(), 2u);
+    EXPECT_EQ(entry["id"].get<uint32>(), 7u);
+    EXPECT_DOUBLE_EQ(entry["normalizedValue"].get<double>(), 0.25);
+    EXPECT_FALSE(data.contains("nextOffset"));
+}
+
+TEST_F(MCPParamToolsTest, ParseListParametersOptionsRejectsBadInput) {
+    ListParametersOptions options;
+    std::string error;
+    EXPECT_FALSE(parseListParametersOptions(mcp::json{{"fields", {"id", "bogus"}}}, options, error));
+    EXPECT_NE(error.find("bogus"), std::string::npos);
+    EXPECT_FALSE(parseListParametersOptions(mcp::json{{"offset", -1}}, options, error));
+    EXPECT_FALSE(parseListParametersOptions(mcp::json{{"limit", "ten"}}, options, error));
+    EXPECT_FALSE(parseListParametersOptions(mcp::json{{"filter", 3}}, options, error));
+
+    ASSERT_TRUE(parseListParametersOptions(mcp::json::object(), options, error));
+    EXPECT_TRUE(options.isDefault());
+    ASSERT_TRUE(parseListParametersOptions(mcp::json{{"limit", 0}}, options, error));
+    EXPECT_EQ(options.limit, std::optional<size_t>(0));
+    EXPECT_FALSE(options.isDefault());
+}
+
+TEST_F(MCPParamToolsTest, SetParametersMarksEveryIdChanged) {
+    MockEditController mockCtrl;
+    ParameterInfo infoA = makeParamInfo(1, u"A", u"", 0.0, 0, 0);
+    ParameterInfo infoB = makeParamInfo(2, u"B", u"", 0.0, 0, 0);
+
+    EXPECT_CALL(mockCtrl, getParameterCount()).WillRepeatedly(Return(2));
+    EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(infoA), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, getParameterInfo(1, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(infoB), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, setParamNormalized(_, _)).WillRepeatedly(Return(kResultOk));
+    EXPECT_CALL(mockCtrl, getParamNormalized(_)).WillRepeatedly(Return(0.5));
+
+    uint64_t before = cache_.versions().currentVersion();
+    handleSetParameters(&mockCtrl, cache_, instance_, mcp::json::array({
+        {{"id", 1}, {"value", 0.1}},
+        {{"id", 2}, {"value", 0.2}}
+    }));
+
+    auto delta = cache_.versions().changesSince(before);
+    EXPECT_EQ(delta.changed.size(), 2u);
+}
+
 // ============================================================
 // get_parameter
 // ============================================================
 
 TEST_F(MCPParamToolsTest, GetParameterNoPluginLoaded) {
-    auto result = handleGetParameter(nullptr, 100);
+    auto result = handleGetParameter(nullptr, cache_, 100);
     EXPECT_TRUE(result.contains("isError"));
     EXPECT_TRUE(result["isError"].get<bool>());
     auto content = result["content"][0]["text"].get<std::string>();
@@ -160,7 +301,7 @@ TEST_F(MCPParamToolsTest, GetParameterValidId) {
             return kResultOk;
         }));
 
-    auto result = handleGetParameter(&mockCtrl, 42);
+    auto result = handleGetParameter(&mockCtrl, cache_, 42);
     EXPECT_FALSE(result.contains("isError"));
 
     auto contentText = result["content"][0]["text"].get<std::string>();
@@ -175,7 +316,7 @@ TEST_F(MCPParamToolsTest, GetParameterInvalidId) {
 
     EXPECT_CALL(mockCtrl, getParameterCount()).WillRepeatedly(Return(0));
 
-    auto result = handleGetParameter(&mockCtrl, 999);
+    auto result = handleGetParameter(&mockCtrl, cache_, 999);
     EXPECT_TRUE(result.contains("isError"));
     EXPECT_TRUE(result["isError"].get<bool>());
     auto content = result["content"][0]["text"].get<std::string>();
@@ -187,7 +328,7 @@ TEST_F(MCPParamToolsTest, GetParameterInvalidId) {
 // ============================================================
 
 TEST_F(MCPParamToolsTest, SetParameterNoPluginLoaded) {
-    auto result = handleSetParameter(nullptr, 100, 0.5);
+    auto result = handleSetParameter(nullptr, cache_, instance_, 100, 0.5);
     EXPECT_TRUE(result.contains("isError"));
     EXPECT_TRUE(result["isError"].get<bool>());
     auto content = result["content"][0]["text"].get<std::string>();
@@ -210,7 +351,7 @@ TEST_F(MCPParamToolsTest, SetParameterValidIdUpdates) {
     EXPECT_CALL(mockCtrl, getParamStringByValue(50, 0.75, _))
         .WillRepeatedly(Return(kResultFalse));
 
-    auto result = handleSetParameter(&mockCtrl, 50, 0.75);
+    auto result = handleSetParameter(&mockCtrl, cache_, instance_, 50, 0.75);
     EXPECT_FALSE(result.contains("isError"));
 
     auto contentText = result["content"][0]["text"].get<std::string>();
@@ -220,7 +361,7 @@ TEST_F(MCPParamToolsTest, SetParameterValidIdUpdates) {
 
     // Verify param change was queued in the singleton
     std::vector<ParamChange> changes;
-    HostedPluginModule::instance().drainParamChanges(changes);
+    instance_.drainParamChanges(changes);
     ASSERT_EQ(changes.size(), 1u);
     EXPECT_EQ(changes[0].id, 50u);
     EXPECT_DOUBLE_EQ(changes[0].value, 0.75);
@@ -231,7 +372,7 @@ TEST_F(MCPParamToolsTest, SetParameterInvalidId) {
 
     EXPECT_CALL(mockCtrl, getParameterCount()).WillRepeatedly(Return(0));
 
-    auto result = handleSetParameter(&mockCtrl, 999, 0.5);
+    auto result = handleSetParameter(&mockCtrl, cache_, instance_, 999, 0.5);
     EXPECT_TRUE(result.contains("isError"));
     EXPECT_TRUE(result["isError"].get<bool>());
     auto content = result["content"][0]["text"].get<std::string>();
@@ -239,7 +380,7 @@ TEST_F(MCPParamToolsTest, SetParameterInvalidId) {
 
     // Verify nothing was queued
     std::vector<ParamChange> changes;
-    HostedPluginModule::instance().drainParamChanges(changes);
+    instance_.drainParamChanges(changes);
     EXPECT_TRUE(changes.empty());
 }
 
@@ -260,16 +401,185 @@ TEST_F(MCPParamToolsTest, SetParameterClampsValue) {
     EXPECT_CALL(mockCtrl, getParamStringByValue(10, 1.0, _))
         .WillRepeatedly(Return(kResultFalse));
 
-    auto result = handleSetParameter(&mockCtrl, 10, 1.5);
+    auto result = handleSetParameter(&mockCtrl, cache_, instance_, 10, 1.5);
     EXPECT_FALSE(result.contains("isError"));
 
     // Verify clamped value was queued
     std::vector<ParamChange> changes;
-    HostedPluginModule::instance().drainParamChanges(changes);
+    instance_.drainParamChanges(changes);
     ASSERT_EQ(changes.size(), 1u);
     EXPECT_DOUBLE_EQ(changes[0].value, 1.0);
 }
 
+TEST_F(MCPParamToolsTest, SetParameterAtSampleQueuesTimedChange) {
+    MockEditController mockCtrl;
+
+    ParameterInfo info = makeParamInfo(
+        10, u"Level", u"", 0.5, 0, ParameterInfo::kCanAutomate);
+
+    EXPECT_CALL(mockCtrl, getParameterCount()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, setParamNormalized(10, 0.25))
+        .WillOnce(Return(kResultOk));
+    EXPECT_CALL(mockCtrl, getParamNormalized(10))
+        .WillRepeatedly(Return(0.25));
+    EXPECT_CALL(mockCtrl, getParamStringByValue(10, 0.25, _))
+        .WillRepeatedly(Return(kResultFalse));
+
+    instance_.setTransportPlaying(true);
+    auto result = handleSetParameter(&mockCtrl, cache_, instance_, 10, 0.25, ParamChangeTiming::ProjectSample, 48000);
+    EXPECT_FALSE(result.contains("isError"));
+    auto data = mcp::json::parse(result["content"][0]["text"].get<std::string>());
+    EXPECT_EQ(data["scheduledAtSample"].get<int64>(), 48000);
+    EXPECT_FALSE(data.contains("appliedImmediately"));
+
+    std::vector<ParamChange> changes;
+    instance_.drainParamChanges(changes);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].timing, ParamChangeTiming::ProjectSample);
+    EXPECT_EQ(changes[0].time, 48000);
+}
+
+TEST_F(MCPParamToolsTest, SetParameterAtSampleReportsStoppedTransport) {
+    MockEditController mockCtrl;
+
+    ParameterInfo info = makeParamInfo(
+        10, u"Level", u"", 0.5, 0, ParameterInfo::kCanAutomate);
+
+    EXPECT_CALL(mockCtrl, getParameterCount()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, setParamNormalized(10, 0.25))
+        .WillOnce(Return(kResultOk));
+    EXPECT_CALL(mockCtrl, getParamNormalized(10))
+        .WillRepeatedly(Return(0.25));
+    EXPECT_CALL(mockCtrl, getParamStringByValue(10, 0.25, _))
+        .WillRepeatedly(Return(kResultFalse));
+
+    instance_.setTransportPlaying(false);
+    auto result = handleSetParameter(&mockCtrl, cache_, instance_, 10, 0.25, ParamChangeTiming::ProjectSample, 48000);
+    EXPECT_FALSE(result.contains("isError"));
+    auto data = mcp::json::parse(result["content"][0]["text"].get<std::string>());
+    EXPECT_TRUE(data["appliedImmediately"].get<bool>());
+    EXPECT_FALSE(data.contains("scheduledAtSample"));
+}
+
+// ============================================================
+// set_parameters (batch)
+// ============================================================
+
+TEST_F(MCPParamToolsTest, SetParametersNoPluginLoaded) {
+    auto result = handleSetParameters(nullptr, cache_, instance_, mcp::json::array({{{"id", 1}, {"value", 0.5}}}));
+    EXPECT_TRUE(result["isError"].get<bool>());
+}
+
+TEST_F(MCPParamToolsTest, SetParametersAppliesWholeBatch) {
+    MockEditController mockCtrl;
+    ParameterInfo infoA = makeParamInfo(1, u"A", u"", 0.0, 0, 0);
+    ParameterInfo infoB = makeParamInfo(2, u"B", u"", 0.0, 0, 0);
+
+    EXPECT_CALL(mockCtrl, getParameterCount()).Times(1).WillOnce(Return(2));
+    EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
+        .Times(1).WillOnce(DoAll(SetArgReferee<1>(infoA), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, getParameterInfo(1, _))
+        .Times(1).WillOnce(DoAll(SetArgReferee<1>(infoB), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, setParamNormalized(1, 0.25)).WillOnce(Return(kResultOk));
+    EXPECT_CALL(mockCtrl, setParamNormalized(2, 1.0)).WillOnce(Return(kResultOk));
+    EXPECT_CALL(mockCtrl, getParamNormalized(1)).WillRepeatedly(Return(0.25));
+    EXPECT_CALL(mockCtrl, getParamNormalized(2)).WillRepeatedly(Return(1.0));
+
+    auto batch = mcp::json::array({
+        {{"id", 1}, {"value", 0.25}},
+        {{"id", 2}, {"value", 7.0}} // clamped
+    });
+    auto result = handleSetParameters(&mockCtrl, cache_, instance_, batch);
+    ASSERT_FALSE(result.contains("isError"));
+
+    auto text = result["content"][0]["text"].get<std::string>();
+    EXPECT_EQ(text.find('\n'), std::string::npos) << "batch result should be compact";
+    auto data = mcp::json::parse(text);
+    EXPECT_EQ(data["applied"].get<int>(), 2);
+    ASSERT_EQ(data["parameters"].size(), 2u);
+    EXPECT_EQ(data["parameters"][1]["id"].get<uint32>(), 2u);
+    EXPECT_DOUBLE_EQ(data["parameters"][1]["normalizedValue"].get<double>(), 1.0);
+    EXPECT_FALSE(data.contains("dropped"));
+
+    std::vector<ParamChange> changes;
+    instance_.drainParamChanges(changes);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].id, 1u);
+    EXPECT_DOUBLE_EQ(changes[1].value, 1.0);
+}
+
+TEST_F(MCPParamToolsTest, SetParametersRejectsBatchWithInvalidEntry) {
+    MockEditController mockCtrl;
+    ParameterInfo info = makeParamInfo(1, u"A", u"", 0.0, 0, 0);
+
+    EXPECT_CALL(mockCtrl, getParameterCount()).WillRepeatedly(Return(1));
+    EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
+    EXPECT_CALL(mockCtrl, setParamNormalized(_, _)).Times(0);
+
+    auto unknownId = handleSetParameters(&mockCtrl, cache_, instance_, mcp::json::array({
+        {{"id", 1}, {"value", 0.5}}, {{"id", 99}, {"value", 0.5}}}));
+    EXPECT_TRUE(unknownId["isError"].get<bool>());
+    EXPECT_NE(unknownId["content"][0]["text"].get<std::string>().find("99"), std::string::npos);
+
+    auto badShape = handleSetParameters(&mockCtrl, cache_, instance_, mcp::json::array({{{"id", 1}}}));
+    EXPECT_TRUE(badShape["isError"].get<bool>());
+
+    auto notArray = handleSetParameters(&mockCtrl, cache_, instance_, mcp::json::object());
+    EXPECT_TRUE(notArray["isError"].get<bool>());
+
+    auto nan = handleSetParameters(&mockCtrl, cache_, instance_, mcp::json::array({
+        {{"id", 1}, {"value", std::numeric_limits<double>::quiet_NaN()}}}));
+    EXPECT_TRUE(nan["isError"].get<bool>());
+
+    std::vector<ParamChange> changes;
+    instance_.drainParamChanges(changes);
+    EXPECT_TRUE(changes.empty());
+}
+
+TEST(ParseParamChangeTiming, NoTimingMeansImmediate) {
+    ParamChangeTiming timing;
+    int64 time = -1;
+    std::string error;
+    EXPECT_TRUE(parseParamChangeTiming({{"id", 1}, {"value", 0.5}}, timing, time, error));
+    EXPECT_EQ(timing, ParamChangeTiming::Immediate);
+    EXPECT_EQ(time, 0);
+}
+
+TEST(ParseParamChangeTiming, AtSampleIsProjectSample) {
+    ParamChangeTiming timing;
+    int64 time;
+    std::string error;
+    EXPECT_TRUE(parseParamChangeTiming({{"at_sample", 96000}}, timing, time, error));
+    EXPECT_EQ(timing, ParamChangeTiming::ProjectSample);
+    EXPECT_EQ(time, 96000);
+}
+
+TEST(ParseParamChangeTiming, DelayIsSteadyClockInTheFuture) {
+    ParamChangeTiming timing;
+    int64 time;
+    std::string error;
+    auto before = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    EXPECT_TRUE(parseParamChangeTiming({{"delay_ms", 250}}, timing, time, error));
+    EXPECT_EQ(timing, ParamChangeTiming::SteadyClock);
+    EXPECT_GE(time, before + 250000000);
+}
+
+TEST(ParseParamChangeTiming, RejectsInvalidArguments) {
+    ParamChangeTiming timing;
+    int64 time;
+    std::string error;
+    EXPECT_FALSE(parseParamChangeTiming({{"at_sample", 1}, {"delay_ms", 1}}, timing, time, error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(parseParamChangeTiming({{"delay_ms", -5}}, timing, time, error));
+    EXPECT_FALSE(parseParamChangeTiming({{"at_sample", "soon"}}, timing, time, error));
+}
+
 // ============================================================
 // set_parameter — NaN / Inf rejection
 // ============================================================
@@ -284,7 +594,7 @@ TEST_F(MCPParamToolsTest, SetParameterRejectsNaN) {
     EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
         .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
 
-    auto result = handleSetParameter(&mockCtrl, 10, std::numeric_limits<double>::quiet_NaN());
+    auto result = handleSetParameter(&mockCtrl, cache_, instance_, 10, std::numeric_limits<double>::quiet_NaN());
     EXPECT_TRUE(result.contains("isError"));
     EXPECT_TRUE(result["isError"].get<bool>());
     auto content = result["content"][0]["text"].get<std::string>();
@@ -292,7 +602,7 @@ TEST_F(MCPParamToolsTest, SetParameterRejectsNaN) {
 
     // Verify nothing was queued
     std::vector<ParamChange> changes;
-    HostedPluginModule::instance().drainParamChanges(changes);
+    instance_.drainParamChanges(changes);
     EXPECT_TRUE(changes.empty());
 }
 
@@ -306,13 +616,13 @@ TEST_F(MCPParamToolsTest, SetParameterRejectsPosInf) {
     EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
         .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
 
-    auto result = handleSetParameter(&mockCtrl, 10, std::numeric_limits<double>::infinity());
+    auto result = handleSetParameter(&mockCtrl, cache_, instance_, 10, std::numeric_limits<double>::infinity());
     EXPECT_TRUE(result.contains("isError"));
     EXPECT_TRUE(result["isError"].get<bool>());
 
     // Verify nothing was queued
     std::vector<ParamChange> changes;
-    HostedPluginModule::instance().drainParamChanges(changes);
+    instance_.drainParamChanges(changes);
     EXPECT_TRUE(changes.empty());
 }
 
@@ -326,13 +636,13 @@ TEST_F(MCPParamToolsTest, SetParameterRejectsNegInf) {
     EXPECT_CALL(mockCtrl, getParameterInfo(0, _))
         .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
 
-    auto result = handleSetParameter(&mockCtrl, 10, -std::numeric_limits<double>::infinity());
+    auto result = handleSetParameter(&mockCtrl, cache_, instance_, 10, -std::numeric_limits<double>::infinity());
     EXPECT_TRUE(result.contains("isError"));
     EXPECT_TRUE(result["isError"].get<bool>());
 
     // Verify nothing was queued
     std::vector<ParamChange> changes;
-    HostedPluginModule::instance().drainParamChanges(changes);
+    instance_.drainParamChanges(changes);
     EXPECT_TRUE(changes.empty());
 }
 
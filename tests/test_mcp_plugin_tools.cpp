@@ -152,4 +152,46 @@ TEST(MCPPluginTools, TimeoutResponse) {
     EXPECT_EQ(content, "Load plugin timed out");
 }
 
+// ============================================================
+// configure_warm_pool
+// ============================================================
+
+TEST(MCPPluginTools, ConfigureWarmPoolSetsListAndReports) {
+    WarmInstancePool pool;
+    auto result = handleConfigureWarmPool(pool, {{"paths", {"/a.vst3", "/b.vst3"}}, {"instances", 2}});
+    ASSERT_FALSE(result.contains("isError"));
+
+    auto data = mcp::json::parse(result["content"][0]["text"].get<std::string>());
+    EXPECT_EQ(data["instancesPerPlugin"].get<int>(), 2);
+    ASSERT_EQ(data["plugins"].size(), 2u);
+    EXPECT_EQ(data["plugins"][0]["path"].get<std::string>(), "/a.vst3");
+    EXPECT_EQ(data["plugins"][0]["readyComponents"].get<int>(), 0);
+    EXPECT_FALSE(data["plugins"][0]["ready"].get<bool>());
+
+    // Without arguments the pool is only reported; instances alone keeps the list
+    data = mcp::json::parse(handleConfigureWarmPool(pool, mcp::json::object())["content"][0]["text"].get<std::string>());
+    EXPECT_EQ(data["plugins"].size(), 2u);
+    handleConfigureWarmPool(pool, {{"instances", 1}});
+    EXPECT_EQ(pool.status().size(), 2u);
+    EXPECT_EQ(pool.instancesPerPlugin(), 1u);
+
+    handleConfigureWarmPool(pool, {{"paths", mcp::json::array()}});
+    EXPECT_TRUE(pool.status().empty());
+}
+
+TEST(MCPPluginTools, ConfigureWarmPoolRejectsBadArguments) {
+    WarmInstancePool pool;
+    EXPECT_TRUE(handleConfigureWarmPool(pool, {{"paths", "/a.vst3"}})["isError"].get<bool>());
+    EXPECT_TRUE(handleConfigureWarmPool(pool, {{"paths", {1, 2}}})["isError"].get<bool>());
+    EXPECT_TRUE(handleConfigureWarmPool(pool, {{"instances", 0}})["isError"].get<bool>());
+    EXPECT_TRUE(handleConfigureWarmPool(pool, {{"instances", 1.5}})["isError"].get<bool>());
+    EXPECT_TRUE(handleConfigureWarmPool(pool, {{"instances", 99}})["isError"].get<bool>());
+
+    mcp::json tooMany = mcp::json::array();
+    for (size_t i = 0; i <= WarmInstancePool::kMaxPlugins; ++i)
+        tooMany.push_back("/p" + std::to_string(i) + ".vst3");
+    EXPECT_TRUE(handleConfigureWarmPool(pool, {{"paths", tooMany}})["isError"].get<bool>());
+    EXPECT_TRUE(pool.status().empty());
+}
+
 } // anonymous namespace
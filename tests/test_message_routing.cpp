@@ -1,9 +1,11 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include "controller.h"
 #include "processor.h"
 #include "messageids.h"
 #include "hostedplugin.h"
+#include "helpers/controller_test_access.h"
 #include "helpers/processor_test_access.h"
 #include "mocks/mock_vst3.h"
 
@@ -21,10 +23,6 @@ protected:
     {
         processor_ = new Processor ();
         ASSERT_EQ (processor_->initialize (nullptr), kResultOk);
-
-        // Drain any stale param changes from singleton
-        std::vector<ParamChange> drain;
-        HostedPluginModule::instance ().drainParamChanges (drain);
     }
 
     void TearDown () override
@@ -221,3 +219,24 @@ TEST_F (MessageRoutingTest, UnloadPluginMessageUnloadsPlugin)
     ProcessorTestAccess::setHostedComponent (*processor_, nullptr);
     ProcessorTestAccess::setHostedProcessor (*processor_, nullptr);
 }
+
+//------------------------------------------------------------------------
+// PluginLoadFailed drops the hosted controller set up for the plugin the
+// processor couldn't load, since the shared instance has no plugin
+//------------------------------------------------------------------------
+TEST (ControllerMessageRoutingTest, PluginLoadFailedFollowsTheProcessor)
+{
+    auto* controller = new Controller ();
+    ::testing::NiceMock<MockEditController> hostedCtrl;
+    ControllerTestAccess::setHostedController (*controller, &hostedCtrl, "/path/to/next.vst3");
+    EXPECT_CALL (hostedCtrl, terminate ()).WillOnce (::testing::Return (kResultOk));
+
+    MockMessage msg;
+    EXPECT_CALL (msg, getMessageID ())
+        .WillRepeatedly (::testing::Return (MessageIds::kPluginLoadFailed));
+    EXPECT_EQ (controller->notify (&msg), kResultOk);
+
+    EXPECT_EQ (ControllerTestAccess::hostedController (*controller), nullptr);
+    EXPECT_TRUE (ControllerTestAccess::currentPluginPath (*controller).empty ());
+    controller->release ();
+}
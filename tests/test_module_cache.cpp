@@ -0,0 +1,465 @@
+#include <gtest/gtest.h>
+
+#include "modulecache.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace VST3MCPWrapper;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Stand-in for a loaded bundle; counts how often a binary was "unloaded".
+class FakeModule : public VST3::Hosting::Module {
+public:
+    explicit FakeModule(int& released) : released_(released) {}
+    ~FakeModule() { ++released_; }
+
+protected:
+    bool load(const std::string&, std::string&) { return true; }
+
+private:
+    int& released_;
+};
+
+class ModuleCacheTest : public ::testing::Test {
+protected:
+    ModuleCache makeCache(ModuleCache::Limits limits)
+    {
+        return ModuleCache(
+            limits,
+            [this](const std::string& path, std::string& error) -> VST3::Hosting::Module::Ptr {
+                ++opens[path];
+                if (path.find("broken") != std::string::npos) {
+                    error = "cannot open " + path;
+                    return nullptr;
+                }
+                return std::make_shared<FakeModule>(released);
+            },
+            [this](const std::string& path) { return sizes.count(path) ? sizes[path] : uint64_t(1); },
+            [this](const VST3::Hosting::Module&) {
+                ++classReads;
+                return VST3::Hosting::PluginFactory::ClassInfos();
+            });
+    }
+
+    std::map<std::string, int> opens;
+    std::map<std::string, uint64_t> sizes;
+    int released = 0;
+    int classReads = 0;
+};
+
+} // namespace
+
+TEST_F(ModuleCacheTest, SwitchingBackToRecentModuleSkipsOpen) {
+    auto cache = makeCache(ModuleCache::Limits());
+    std::string error;
+
+    auto a = cache.acquire("/a.vst3", error);
+    auto b = cache.acquire("/b.vst3", error);
+    ASSERT_TRUE(a);
+    ASSERT_TRUE(b);
+
+    // A/B back and forth: each bundle is opened once
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(cache.acquire("/a.vst3", error), a);
+        EXPECT_EQ(cache.acquire("/b.vst3", error), b);
+    }
+    EXPECT_EQ(opens["/a.vst3"], 1);
+    EXPECT_EQ(opens["/b.vst3"], 1);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.modules, 2u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.hits, 6u);
+}
+
+TEST_F(ModuleCacheTest, EvictsLeastRecentlyUsedOverCountBudget) {
+    ModuleCache::Limits limits;
+    limits.maxModules = 2;
+    auto cache = makeCache(limits);
+    std::string error;
+
+    cache.acquire("/a.vst3", error);
+    cache.acquire("/b.vst3", error);
+    cache.acquire("/a.vst3", error); // b is now least recently used
+    cache.acquire("/c.vst3", error);
+
+    EXPECT_TRUE(cache.contains("/a.vst3"));
+    EXPECT_FALSE(cache.contains("/b.vst3"));
+    EXPECT_TRUE(cache.contains("/c.vst3"));
+    EXPECT_EQ(cache.stats().evictions, 1u);
+    EXPECT_EQ(released, 1);
+}
+
+TEST_F(ModuleCacheTest, EvictsOverMemoryBudgetButKeepsNewest) {
+    ModuleCache::Limits limits;
+    limits.maxBytes = 100;
+    auto cache = makeCache(limits);
+    sizes["/small.vst3"] = 40;
+    sizes["/medium.vst3"] = 50;
+    sizes["/huge.vst3"] = 500;
+    std::string error;
+
+    cache.acquire("/small.vst3", error);
+    cache.acquire("/medium.vst3", error);
+    EXPECT_EQ(cache.stats().bytes, 90u);
+
+    // Over budget on its own: everything else goes, the new module stays
+    ASSERT_TRUE(cache.acquire("/huge.vst3", error));
+    EXPECT_EQ(cache.stats().modules, 1u);
+    EXPECT_TRUE(cache.contains("/huge.vst3"));
+    EXPECT_EQ(cache.stats().bytes, 500u);
+}
+
+TEST_F(ModuleCacheTest, EvictedModuleStaysLoadedWhileInUse) {
+    ModuleCache::Limits limits;
+    limits.maxModules = 1;
+    auto cache = makeCache(limits);
+    std::string error;
+
+    auto inUse = cache.acquire("/a.vst3", error);
+    cache.acquire("/b.vst3", error);
+    EXPECT_FALSE(cache.contains("/a.vst3"));
+    EXPECT_EQ(released, 0) << "the hosted instance still holds a reference";
+
+    inUse.reset();
+    EXPECT_EQ(released, 1);
+}
+
+TEST_F(ModuleCacheTest, FailedOpenIsNotCached) {
+    auto cache = makeCache(ModuleCache::Limits());
+    std::string error;
+
+    EXPECT_FALSE(cache.acquire("/broken.vst3", error));
+    EXPECT_EQ(error, "cannot open /broken.vst3");
+    EXPECT_FALSE(cache.contains("/broken.vst3"));
+
+    cache.acquire("/broken.vst3", error);
+    EXPECT_EQ(opens["/broken.vst3"], 2);
+}
+
+TEST_F(ModuleCacheTest, TighterLimitsEvictImmediately) {
+    auto cache = makeCache(ModuleCache::Limits());
+    std::string error;
+    cache.acquire("/a.vst3", error);
+    cache.acquire("/b.vst3", error);
+    cache.acquire("/c.vst3", error);
+
+    ModuleCache::Limits limits;
+    limits.maxModules = 1;
+    cache.setLimits(limits);
+    EXPECT_EQ(cache.stats().modules, 1u);
+    EXPECT_TRUE(cache.contains("/c.vst3"));
+    EXPECT_EQ(released, 2);
+}
+
+TEST_F(ModuleCacheTest, EvictAndClearDropEntries) {
+    auto cache = makeCache(ModuleCache::Limits());
+    std::string error;
+    cache.acquire("/a.vst3", error);
+    cache.acquire("/b.vst3", error);
+
+    cache.evict("/a.vst3");
+    EXPECT_FALSE(cache.contains("/a.vst3"));
+    cache.acquire("/a.vst3", error);
+    EXPECT_EQ(opens["/a.vst3"], 2);
+
+    cache.clear();
+    EXPECT_EQ(cache.stats().modules, 0u);
+    EXPECT_EQ(cache.stats().bytes, 0u);
+    EXPECT_EQ(released, 3);
+}
+
+TEST_F(ModuleCacheTest, InstancesShareModuleAfterEviction) {
+    ModuleCache::Limits limits;
+    limits.maxModules = 1;
+    auto cache = makeCache(limits);
+    std::string error;
+
+    // 16 instances of one plugin, loaded while another plugin keeps
+    // pushing it out of the cache
+    std::vector<VST3::Hosting::Module::Ptr> instances;
+    for (int i = 0; i < 16; ++i) {
+        instances.push_back(cache.acquire("/eq.vst3", error));
+        cache.acquire("/other.vst3", error);
+    }
+    EXPECT_EQ(opens["/eq.vst3"], 1);
+    for (const auto& module : instances)
+        EXPECT_EQ(module, instances[0]);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.live, 2u);
+    EXPECT_EQ(stats.shared, 15u);
+}
+
+TEST_F(ModuleCacheTest, ClearKeepsModulesInUseShared) {
+    auto cache = makeCache(ModuleCache::Limits());
+    std::string error;
+
+    auto inUse = cache.acquire("/a.vst3", error);
+    cache.acquire("/b.vst3", error);
+    cache.clear();
+    EXPECT_EQ(released, 1) << "/b.vst3 had no other user";
+
+    EXPECT_EQ(cache.acquire("/a.vst3", error), inUse);
+    EXPECT_EQ(opens["/a.vst3"], 1);
+    EXPECT_TRUE(cache.contains("/a.vst3"));
+}
+
+TEST_F(ModuleCacheTest, ReleasedModuleIsOpenedAgain) {
+    auto cache = makeCache(ModuleCache::Limits());
+    std::string error;
+
+    cache.acquire("/a.vst3", error);
+    cache.clear();
+    EXPECT_EQ(cache.stats().live, 0u);
+
+    cache.acquire("/a.vst3", error);
+    EXPECT_EQ(opens["/a.vst3"], 2);
+}
+
+TEST_F(ModuleCacheTest, EvictStopsSharingInUseModule) {
+    auto cache = makeCache(ModuleCache::Limits());
+    std::string error;
+
+    auto old = cache.acquire("/a.vst3", error);
+    cache.evict("/a.vst3");
+    EXPECT_NE(cache.acquire("/a.vst3", error), old) << "the bundle may have changed on disk";
+    EXPECT_EQ(opens["/a.vst3"], 2);
+}
+
+TEST_F(ModuleCacheTest, ClassesAreReadOncePerModule) {
+    auto cache = makeCache(ModuleCache::Limits());
+    std::string error;
+
+    auto module = cache.acquire("/a.vst3", error);
+    auto classes = cache.classes(module);
+    EXPECT_EQ(cache.classes(module), classes);
+    EXPECT_EQ(cache.classes(cache.acquire("/a.vst3", error)), classes);
+    EXPECT_EQ(classReads, 1);
+    EXPECT_FALSE(classes->hasAudioEffect);
+
+    // Not acquired here: nothing to share it with
+    int otherReleased = 0;
+    VST3::Hosting::Module::Ptr other = std::make_shared<FakeModule>(otherReleased);
+    cache.classes(other);
+    cache.classes(other);
+    EXPECT_EQ(classReads, 3);
+
+    EXPECT_TRUE(cache.classes(nullptr)->classes.empty());
+}
+
+namespace {
+
+// Opener safe to call from prefetch threads. Opening a bundle whose path
+// contains "slow" blocks until release().
+class ModulePrefetchTest : public ::testing::Test {
+protected:
+    ModuleCache makeCache(ModuleCache::Limits limits)
+    {
+        return ModuleCache(
+            limits,
+            [this](const std::string& path, std::string& error) -> VST3::Hosting::Module::Ptr {
+                std::unique_lock<std::mutex> lock(mutex);
+                ++opens[path];
+                ++opening;
+                changed.notify_all();
+                if (path.find("slow") != std::string::npos)
+                    changed.wait(lock, [this] { return released; });
+                --opening;
+                if (path.find("broken") != std::string::npos) {
+                    error = "cannot open " + path;
+                    return nullptr;
+                }
+                return std::make_shared<FakeModule>(unloaded);
+            },
+            [](const std::string&) { return uint64_t(1); },
+            [this](const VST3::Hosting::Module&) {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++classReads;
+                return VST3::Hosting::PluginFactory::ClassInfos();
+            });
+    }
+
+    // Wait until count opens are in progress at the same time
+    bool waitForOpening(int count)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, std::chrono::seconds(5), [this, count] { return opening >= count; });
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = true;
+        changed.notify_all();
+    }
+
+    template <typename Predicate>
+    static bool eventually(Predicate predicate)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!predicate()) {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    int opensOf(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return opens[path];
+    }
+
+    int classReadCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return classReads;
+    }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::map<std::string, int> opens;
+    int opening = 0;
+    bool released = false;
+    int unloaded = 0;
+    int classReads = 0;
+};
+
+} // namespace
+
+TEST_F(ModulePrefetchTest, OpensBundlesInParallel) {
+    ModuleCache::Limits limits;
+    limits.prefetchThreads = 4;
+    auto cache = makeCache(limits);
+    const std::vector<std::string> paths = {"/slow-a.vst3", "/slow-b.vst3", "/slow-c.vst3", "/slow-d.vst3"};
+
+    for (const auto& path : paths)
+        cache.prefetch(path);
+    // Every open blocks until released, so they only all start if they run
+    // at the same time
+    EXPECT_TRUE(waitForOpening(4));
+    release();
+
+    std::string error;
+    for (const auto& path : paths) {
+        EXPECT_TRUE(cache.acquire(path, error));
+        EXPECT_EQ(opensOf(path), 1);
+    }
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.prefetches, 4u);
+    EXPECT_EQ(stats.misses, 4u);
+    EXPECT_EQ(stats.hits, 4u);
+}
+
+TEST_F(ModulePrefetchTest, AcquireWaitsForOpenInProgress) {
+    ModuleCache::Limits limits;
+    limits.prefetchThreads = 1;
+    auto cache = makeCache(limits);
+
+    cache.prefetch("/slow.vst3");
+    ASSERT_TRUE(waitForOpening(1));
+
+    VST3::Hosting::Module::Ptr acquired;
+    std::thread host([&cache, &acquired] {
+        std::string error;
+        acquired = cache.acquire("/slow.vst3", error);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(opensOf("/slow.vst3"), 1);
+    release();
+    host.join();
+
+    EXPECT_TRUE(acquired);
+    EXPECT_EQ(opensOf("/slow.vst3"), 1) << "the prefetched module is shared, not opened again";
+}
+
+TEST_F(ModulePrefetchTest, AcquireOpensQueuedBundleItself) {
+    ModuleCache::Limits limits;
+    limits.prefetchThreads = 1;
+    auto cache = makeCache(limits);
+
+    cache.prefetch("/slow.vst3"); // Keeps the only prefetch thread busy
+    ASSERT_TRUE(waitForOpening(1));
+    cache.prefetch("/b.vst3");
+
+    std::string error;
+    EXPECT_TRUE(cache.acquire("/b.vst3", error));
+    EXPECT_EQ(opensOf("/b.vst3"), 1);
+    release();
+}
+
+TEST_F(ModulePrefetchTest, PrefetchedModulesAreHeldUntilAcquired) {
+    ModuleCache::Limits limits;
+    limits.maxModules = 1;
+    limits.prefetchThreads = 2;
+    auto cache = makeCache(limits);
+
+    cache.prefetch("/a.vst3");
+    cache.prefetch("/b.vst3");
+    ASSERT_TRUE(eventually([&cache] { return cache.stats().prefetched == 2; }));
+    EXPECT_TRUE(eventually([this] { return classReadCount() == 2; })) << "classes are read by the prefetch";
+    EXPECT_EQ(unloaded, 0) << "over the module budget, but not acquired yet";
+
+    std::string error;
+    auto a = cache.acquire("/a.vst3", error);
+    EXPECT_TRUE(a);
+    EXPECT_EQ(opensOf("/a.vst3"), 1);
+    EXPECT_EQ(cache.stats().prefetched, 1u);
+    cache.classes(a);
+    EXPECT_EQ(classReadCount(), 2);
+
+    cache.clear();
+    EXPECT_EQ(cache.stats().prefetched, 0u);
+    EXPECT_EQ(unloaded, 1) << "b was never acquired";
+}
+
+TEST_F(ModulePrefetchTest, SkipsCachedAndInUseModules) {
+    auto cache = makeCache(ModuleCache::Limits());
+    std::string error;
+
+    auto a = cache.acquire("/a.vst3", error);
+    cache.prefetch("/a.vst3");
+    cache.clear();
+    cache.prefetch("/a.vst3"); // No longer cached, but still in use
+    EXPECT_EQ(cache.stats().prefetches, 0u);
+    EXPECT_EQ(opensOf("/a.vst3"), 1);
+}
+
+TEST_F(ModulePrefetchTest, FailedPrefetchIsRetriedByAcquire) {
+    auto cache = makeCache(ModuleCache::Limits());
+
+    cache.prefetch("/broken.vst3");
+    ASSERT_TRUE(eventually([this] { return opensOf("/broken.vst3") == 1; }));
+    std::string error;
+    EXPECT_FALSE(cache.acquire("/broken.vst3", error));
+    EXPECT_EQ(error, "cannot open /broken.vst3");
+    EXPECT_EQ(opensOf("/broken.vst3"), 2);
+    EXPECT_EQ(cache.stats().prefetched, 0u);
+}
+
+TEST(ModuleCacheSizeTest, EstimatesBinariesButNotResources) {
+    fs::path bundle = fs::temp_directory_path()
+                      / ("modulecache-test-" + std::to_string(::getpid())) / "Size.vst3";
+    fs::create_directories(bundle / "Contents" / "x86_64-linux");
+    fs::create_directories(bundle / "Contents" / "Resources");
+    std::ofstream(bundle / "Contents" / "x86_64-linux" / "Size.so") << std::string(1000, 'x');
+    std::ofstream(bundle / "Contents" / "Resources" / "samples.wav") << std::string(5000, 'x');
+
+    EXPECT_EQ(ModuleCache::estimateModuleSize(bundle.string()), 1000u);
+    EXPECT_EQ(ModuleCache::estimateModuleSize((bundle / "Contents" / "x86_64-linux" / "Size.so").string()), 1000u);
+    EXPECT_EQ(ModuleCache::estimateModuleSize("/nonexistent/Missing.vst3"), 0u);
+
+    fs::remove_all(bundle.parent_path());
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "paramcache.h"
+#include "helpers/test_helpers.h"
+#include "mocks/mock_vst3.h"
+
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace testing;
+
+namespace {
+
+ParameterInfo makeInfo(ParamID id, const char16_t* title, const char16_t* units = u"") {
+    ParameterInfo info = {};
+    info.id = id;
+    fillTChar(info.title, title);
+    fillTChar(info.units, units);
+    return info;
+}
+
+// Controller exposing the given parameters at indices 0..n-1
+void exposeParams(MockEditController& ctrl, const std::vector<ParameterInfo>& params) {
+    EXPECT_CALL(ctrl, getParameterCount()).WillRepeatedly(Return(static_cast<int32>(params.size())));
+    for (size_t i = 0; i < params.size(); ++i) {
+        EXPECT_CALL(ctrl, getParameterInfo(static_cast<int32>(i), _))
+            .WillRepeatedly(DoAll(SetArgReferee<1>(params[i]), Return(kResultOk)));
+    }
+}
+
+} // namespace
+
+// ============================================================
+// ParameterTable
+// ============================================================
+
+TEST(ParameterTable, IndexesParametersByIdWithUtf8Strings) {
+    MockEditController ctrl;
+    exposeParams(ctrl, {makeInfo(100, u"Cutoff", u"Hz"), makeInfo(7, u"Gain", u"dB")});
+
+    auto table = ParameterTable::build(&ctrl);
+    ASSERT_EQ(table->size(), 2u);
+
+    const auto* gain = table->find(7);
+    ASSERT_NE(gain, nullptr);
+    EXPECT_EQ(gain->index, 1);
+    EXPECT_EQ(gain->title, "Gain");
+    EXPECT_EQ(gain->units, "dB");
+    EXPECT_EQ(table->parameters()[0].info.id, 100u);
+
+    EXPECT_FALSE(table->contains(8));
+}
+
+TEST(ParameterTable, SkipsFailedEntriesAndDuplicateIds) {
+    MockEditController ctrl;
+    EXPECT_CALL(ctrl, getParameterCount()).WillRepeatedly(Return(3));
+    EXPECT_CALL(ctrl, getParameterInfo(0, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(makeInfo(1, u"First")), Return(kResultOk)));
+    EXPECT_CALL(ctrl, getParameterInfo(1, _)).WillRepeatedly(Return(kResultFalse));
+    EXPECT_CALL(ctrl, getParameterInfo(2, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(makeInfo(1, u"Again")), Return(kResultOk)));
+
+    auto table = ParameterTable::build(&ctrl);
+    ASSERT_EQ(table->size(), 1u);
+    EXPECT_EQ(table->find(1)->title, "First");
+}
+
+TEST(ParameterTable, LargeParameterListLooksUpEveryId) {
+    constexpr int32 kCount = 5000;
+    MockEditController ctrl;
+    EXPECT_CALL(ctrl, getParameterCount()).WillRepeatedly(Return(kCount));
+    EXPECT_CALL(ctrl, getParameterInfo(_, _))
+        .WillRepeatedly([](int32 index, ParameterInfo& info) {
+            info = {};
+            info.id = static_cast<ParamID>(index) * 3 + 1000;
+            return kResultOk;
+        });
+
+    auto table = ParameterTable::build(&ctrl);
+    ASSERT_EQ(table->size(), static_cast<size_t>(kCount));
+    for (int32 i = 0; i < kCount; ++i) {
+        const auto* param = table->find(static_cast<ParamID>(i) * 3 + 1000);
+        ASSERT_NE(param, nullptr);
+        EXPECT_EQ(param->index, i);
+    }
+    EXPECT_FALSE(table->contains(1001));
+}
+
+// ============================================================
+// ParamChangeTracker
+// ============================================================
+
+TEST(ParamChangeTracker, SinceZeroIsEverything) {
+    ParamChangeTracker tracker;
+    auto delta = tracker.changesSince(0);
+    EXPECT_TRUE(delta.all);
+    EXPECT_EQ(delta.version, tracker.currentVersion());
+}
+
+TEST(ParamChangeTracker, ReportsOnlyChangesAfterVersion) {
+    ParamChangeTracker tracker;
+    uint64_t v0 = tracker.currentVersion();
+    uint64_t v1 = tracker.markChanged(1);
+    uint64_t v2 = tracker.markChanged(2);
+    EXPECT_GT(v1, v0);
+    EXPECT_GT(v2, v1);
+
+    auto delta = tracker.changesSince(v0);
+    EXPECT_FALSE(delta.all);
+    EXPECT_EQ(delta.version, v2);
+    ASSERT_EQ(delta.changed.size(), 2u);
+    EXPECT_EQ(delta.changed.at(1), v1);
+
+    auto later = tracker.changesSince(v1);
+    ASSERT_EQ(later.changed.size(), 1u);
+    EXPECT_EQ(later.changed.count(2), 1u);
+
+    EXPECT_TRUE(tracker.changesSince(v2).changed.empty());
+}
+
+TEST(ParamChangeTracker, BatchSharesOneVersion) {
+    ParamChangeTracker tracker;
+    uint64_t v0 = tracker.currentVersion();
+    ParamID ids[] = {3, 4, 5};
+    uint64_t v = tracker.markChanged(ids, 3);
+    EXPECT_EQ(v, v0 + 1);
+
+    auto delta = tracker.changesSince(v0);
+    ASSERT_EQ(delta.changed.size(), 3u);
+    for (ParamID id : ids)
+        EXPECT_EQ(delta.changed.at(id), v);
+}
+
+TEST(ParamChangeTracker, MarkAllChangedForcesFullListing) {
+    ParamChangeTracker tracker;
+    uint64_t v1 = tracker.markChanged(1);
+    uint64_t all = tracker.markAllChanged();
+
+    EXPECT_TRUE(tracker.changesSince(v1).all);
+    auto after = tracker.changesSince(all);
+    EXPECT_FALSE(after.all);
+    EXPECT_TRUE(after.changed.empty());
+}
+
+TEST(ParamChangeTracker, VersionFromBeforeARestartForcesFullListing) {
+    ParamChangeTracker previous;
+    for (ParamID id = 0; id < 10; ++id)
+        previous.markChanged(id);
+    uint64_t stale = previous.currentVersion();
+
+    // A new tracker starts counting again
+    ParamChangeTracker tracker;
+    tracker.markChanged(1);
+    ASSERT_GT(stale, tracker.currentVersion());
+
+    auto delta = tracker.changesSince(stale);
+    EXPECT_TRUE(delta.all);
+    EXPECT_EQ(delta.version, tracker.currentVersion());
+    EXPECT_FALSE(tracker.changesSince(delta.version).all);
+}
+
+TEST(ParameterInfoCache, InvalidateMarksAllValuesChanged) {
+    ParameterInfoCache cache;
+    uint64_t before = cache.versions().currentVersion();
+    cache.invalidate();
+    EXPECT_TRUE(cache.versions().changesSince(before).all);
+}
+
+// ============================================================
+// ParameterInfoCache
+// ============================================================
+
+TEST(ParameterInfoCache, BuildsOnceUntilInvalidated) {
+    MockEditController ctrl;
+    EXPECT_CALL(ctrl, getParameterCount()).Times(2).WillRepeatedly(Return(1));
+    EXPECT_CALL(ctrl, getParameterInfo(0, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(makeInfo(5, u"P")), Return(kResultOk)));
+
+    ParameterInfoCache cache;
+    auto first = cache.get(&ctrl);
+    auto second = cache.get(&ctrl);
+    EXPECT_EQ(first, second);
+
+    cache.invalidate();
+    auto rebuilt = cache.get(&ctrl);
+    EXPECT_NE(rebuilt, first);
+    // The old snapshot stays valid for whoever still holds it
+    EXPECT_TRUE(first->contains(5));
+}
+
+TEST(ParameterInfoCache, DifferentControllerRebuilds) {
+    MockEditController a;
+    MockEditController b;
+    exposeParams(a, {makeInfo(1, u"A")});
+    exposeParams(b, {makeInfo(2, u"B")});
+
+    ParameterInfoCache cache;
+    EXPECT_TRUE(cache.get(&a)->contains(1));
+    EXPECT_TRUE(cache.get(&b)->contains(2));
+    EXPECT_FALSE(cache.get(&b)->contains(1));
+}
+
+TEST(ParameterInfoCache, NullControllerReturnsNull) {
+    ParameterInfoCache cache;
+    EXPECT_EQ(cache.get(nullptr), nullptr);
+}
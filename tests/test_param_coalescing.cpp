@@ -0,0 +1,301 @@
+#include <gtest/gtest.h>
+#include "hostedplugin.h"
+#include "paramqueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace VST3MCPWrapper;
+using namespace Steinberg::Vst;
+
+namespace {
+std::vector<ParamChange> drainTable(CoalescingParamTable& table, size_t maxCount = SIZE_MAX) {
+    std::vector<ParamChange> out;
+    table.drain(maxCount, [&out](ParamID id, ParamValue value) { out.push_back({id, value}); });
+    return out;
+}
+} // namespace
+
+// ============================================================
+// CoalescingParamTable
+// ============================================================
+
+TEST(CoalescingParamTable, LastValueWinsPerParameter) {
+    CoalescingParamTable table(16);
+    for (int i = 0; i < 100; ++i)
+        EXPECT_TRUE(table.store(5, i / 100.0));
+
+    auto changes = drainTable(table);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].id, 5u);
+    EXPECT_DOUBLE_EQ(changes[0].value, 0.99);
+    EXPECT_TRUE(drainTable(table).empty());
+}
+
+TEST(CoalescingParamTable, DrainsInOrderOfFirstChange) {
+    CoalescingParamTable table(16);
+    table.store(30, 0.1);
+    table.store(10, 0.2);
+    table.store(20, 0.3);
+    table.store(30, 0.4); // already pending: keeps its position
+
+    auto changes = drainTable(table);
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_EQ(changes[0].id, 30u);
+    EXPECT_DOUBLE_EQ(changes[0].value, 0.4);
+    EXPECT_EQ(changes[1].id, 10u);
+    EXPECT_EQ(changes[2].id, 20u);
+}
+
+TEST(CoalescingParamTable, ParameterIsPendingAgainAfterDrain) {
+    CoalescingParamTable table(16);
+    table.store(1, 0.1);
+    drainTable(table);
+    table.store(1, 0.2);
+
+    auto changes = drainTable(table);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_DOUBLE_EQ(changes[0].value, 0.2);
+}
+
+TEST(CoalescingParamTable, DrainRespectsMaxCount) {
+    CoalescingParamTable table(16);
+    for (ParamID id = 0; id < 5; ++id)
+        table.store(id, 0.5);
+
+    EXPECT_EQ(drainTable(table, 2).size(), 2u);
+    EXPECT_EQ(drainTable(table).size(), 3u);
+}
+
+TEST(CoalescingParamTable, RejectsWhenNoSlotIsFree) {
+    CoalescingParamTable table(4);
+    EXPECT_EQ(table.slotCount(), 4u);
+    for (ParamID id = 0; id < 4; ++id)
+        EXPECT_TRUE(table.store(id, 0.5));
+    EXPECT_FALSE(table.store(99, 0.5));
+    // Parameters that already own a slot still coalesce
+    EXPECT_TRUE(table.store(2, 0.7));
+}
+
+TEST(CoalescingParamTable, RejectsNoParamId) {
+    CoalescingParamTable table(4);
+    EXPECT_FALSE(table.store(kNoParamId, 0.5));
+}
+
+TEST(CoalescingParamTable, ClearReleasesSlots) {
+    CoalescingParamTable table(2);
+    table.store(1, 0.1);
+    table.store(2, 0.2);
+    table.clear();
+
+    EXPECT_TRUE(drainTable(table).empty());
+    EXPECT_TRUE(table.store(3, 0.3));
+    EXPECT_TRUE(table.store(4, 0.4));
+}
+
+TEST(CoalescingParamTable, ClearIsDeferredWhileADrainIsRunning) {
+    CoalescingParamTable table(16);
+    table.store(1, 0.1);
+
+    bool cleared = false;
+    table.drain(SIZE_MAX, [&](ParamID, ParamValue) {
+        // Runs inside drain(): the reset has to wait for it
+        table.clear();
+        EXPECT_FALSE(table.store(2, 0.2));
+        cleared = true;
+    });
+    ASSERT_TRUE(cleared);
+
+    // The next drain carries out the reset and delivers nothing stale
+    EXPECT_TRUE(drainTable(table).empty());
+    EXPECT_TRUE(table.store(2, 0.2));
+    auto changes = drainTable(table);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].id, 2u);
+}
+
+TEST(CoalescingParamTable, ConcurrentClearNeverLosesOrCorruptsSlots) {
+    CoalescingParamTable table(64);
+    constexpr ParamID kParams = 16;
+    std::atomic<bool> stop{false};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([&]() {
+            for (int step = 0; !stop.load(std::memory_order_relaxed); ++step)
+                table.store(static_cast<ParamID>(step % kParams), 0.5);
+        });
+    }
+    threads.emplace_back([&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            table.clear();
+            std::this_thread::yield();
+        }
+    });
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+    while (std::chrono::steady_clock::now() < deadline) {
+        table.drain(SIZE_MAX, [&](ParamID id, ParamValue) { EXPECT_LT(id, kParams); });
+    }
+    stop.store(true);
+    for (auto& th : threads)
+        th.join();
+
+    // Every parameter must still reach the consumer once things settle
+    table.clear();
+    drainTable(table);
+    for (ParamID id = 0; id < kParams; ++id)
+        ASSERT_TRUE(table.store(id, 1.0));
+    EXPECT_EQ(drainTable(table).size(), static_cast<size_t>(kParams));
+}
+
+TEST(CoalescingParamTable, ConcurrentProducersDeliverFinalValues) {
+    CoalescingParamTable table(64);
+
+    constexpr int kNumThreads = 4;
+    constexpr int kParamsPerThread = 8;
+    constexpr int kSweepSteps = 2000;
+    std::atomic<bool> go{false};
+    std::atomic<int> finished{0};
+    std::vector<std::thread> producers;
+
+    for (int t = 0; t < kNumThreads; ++t) {
+        producers.emplace_back([&, t]() {
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            for (int step = 1; step <= kSweepSteps; ++step)
+                for (int p = 0; p < kParamsPerThread; ++p)
+                    table.store(static_cast<ParamID>(t * kParamsPerThread + p),
+                                static_cast<double>(step));
+            finished.fetch_add(1, std::memory_order_release);
+        });
+    }
+
+    // Values per parameter must never go backwards, and the final drain must
+    // leave every parameter at its last swept value.
+    std::vector<double> lastSeen(kNumThreads * kParamsPerThread, 0.0);
+    auto consume = [&lastSeen](ParamID id, ParamValue value) {
+        ASSERT_LT(id, lastSeen.size());
+        EXPECT_GE(value, lastSeen[id]);
+        lastSeen[id] = value;
+    };
+    go.store(true, std::memory_order_release);
+    while (finished.load(std::memory_order_acquire) < kNumThreads)
+        table.drain(SIZE_MAX, consume);
+    for (auto& th : producers)
+        th.join();
+    table.drain(SIZE_MAX, consume);
+
+    for (double v : lastSeen)
+        EXPECT_DOUBLE_EQ(v, static_cast<double>(kSweepSteps));
+}
+
+// Many short sweeps, each racing the consumer right up to its last store: a
+// store that finds the slot still dirty must not lose its value to a drain
+// that is clearing the flag at the same moment.
+TEST(CoalescingParamTable, FinalValueSurvivesRacingDrains) {
+    CoalescingParamTable table(64);
+    constexpr ParamID kParams = 8;
+    constexpr int kRounds = 200;
+    constexpr int kSweepSteps = 50;
+
+    for (int round = 1; round <= kRounds; ++round) {
+        const double base = round * 1000.0;
+        std::atomic<bool> done{false};
+        std::vector<double> lastSeen(kParams, 0.0);
+        auto consume = [&lastSeen](ParamID id, ParamValue value) {
+            ASSERT_LT(id, lastSeen.size());
+            lastSeen[id] = value;
+        };
+
+        std::thread producer([&]() {
+            for (int step = 1; step <= kSweepSteps; ++step)
+                for (ParamID id = 0; id < kParams; ++id)
+                    table.store(id, base + step);
+            done.store(true, std::memory_order_release);
+        });
+        while (!done.load(std::memory_order_acquire))
+            table.drain(SIZE_MAX, consume);
+        producer.join();
+        table.drain(SIZE_MAX, consume);
+
+        for (ParamID id = 0; id < kParams; ++id)
+            ASSERT_DOUBLE_EQ(lastSeen[id], base + kSweepSteps) << "round " << round << ", param " << id;
+    }
+}
+
+// ============================================================
+// HostedPluginInstance in Coalesce mode
+// ============================================================
+
+class ParamCoalescingTest : public ::testing::Test {
+protected:
+    HostedPluginInstance instance_;
+};
+
+TEST_F(ParamCoalescingTest, CoalesceIsTheDefaultMode) {
+    EXPECT_EQ(instance_.getParamQueueMode(),
+              HostedPluginInstance::ParamQueueMode::Coalesce);
+}
+
+TEST_F(ParamCoalescingTest, SweepDrainsAsOneChangePerParameter) {
+    auto& mod = instance_;
+    for (int i = 0; i <= 1000; ++i) {
+        EXPECT_TRUE(mod.pushParamChange(1, i / 1000.0));
+        EXPECT_TRUE(mod.pushParamChange(2, 1.0 - i / 1000.0));
+    }
+
+    std::vector<ParamChange> changes;
+    mod.drainParamChanges(changes);
+
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].id, 1u);
+    EXPECT_DOUBLE_EQ(changes[0].value, 1.0);
+    EXPECT_EQ(changes[1].id, 2u);
+    EXPECT_DOUBLE_EQ(changes[1].value, 0.0);
+}
+
+TEST_F(ParamCoalescingTest, SweepNeverFillsTheFifoQueue) {
+    auto& mod = instance_;
+    auto droppedBefore = mod.getDroppedParamChangeCount();
+
+    for (size_t i = 0; i < HostedPluginInstance::kParamQueueCapacity * 2; ++i)
+        EXPECT_TRUE(mod.pushParamChange(3, 0.5));
+
+    EXPECT_EQ(mod.getDroppedParamChangeCount(), droppedBefore);
+    std::vector<ParamChange> changes;
+    mod.drainParamChanges(changes);
+    EXPECT_EQ(changes.size(), 1u);
+}
+
+TEST_F(ParamCoalescingTest, FifoChangesQueuedBeforeModeSwitchDrainFirst) {
+    auto& mod = instance_;
+    mod.setParamQueueMode(HostedPluginInstance::ParamQueueMode::Fifo);
+    mod.pushParamChange(4, 0.1);
+    mod.pushParamChange(4, 0.2);
+    mod.setParamQueueMode(HostedPluginInstance::ParamQueueMode::Coalesce);
+    mod.pushParamChange(4, 0.3);
+    mod.pushParamChange(4, 0.4);
+
+    std::vector<ParamChange> changes;
+    mod.drainParamChanges(changes);
+
+    // Latest value is last, so the hosted plugin ends up at 0.4
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_DOUBLE_EQ(changes[0].value, 0.1);
+    EXPECT_DOUBLE_EQ(changes[1].value, 0.2);
+    EXPECT_DOUBLE_EQ(changes[2].value, 0.4);
+}
+
+TEST_F(ParamCoalescingTest, UnloadDiscardsCoalescedChanges) {
+    auto& mod = instance_;
+    mod.pushParamChange(5, 0.5);
+    mod.unload();
+
+    std::vector<ParamChange> changes;
+    mod.drainParamChanges(changes);
+    EXPECT_TRUE(changes.empty());
+}
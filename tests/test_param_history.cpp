@@ -0,0 +1,289 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "mcp_param_handlers.h"
+#include "paramhistory.h"
+#include "helpers/test_helpers.h"
+#include "mocks/mock_vst3.h"
+#include "hostedplugin.h"
+
+#include <map>
+
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace testing;
+
+namespace {
+
+std::vector<std::pair<ParamID, ParamValue>> pairs(const std::vector<ParamChange>& changes) {
+    std::vector<std::pair<ParamID, ParamValue>> out;
+    for (const auto& change : changes)
+        out.emplace_back(change.id, change.value);
+    return out;
+}
+
+} // namespace
+
+// ============================================================
+// ParamHistory
+// ============================================================
+
+TEST(ParamHistory, UndoAndRedoWholeSteps) {
+    ParamHistory history;
+    history.record({{1, 0.0, 0.5}, {2, 0.1, 0.2}});
+    history.record({{1, 0.5, 0.9}});
+    EXPECT_EQ(history.undoSteps(), 2u);
+
+    ParamHistory::Step step;
+    ASSERT_TRUE(history.undo(step));
+    EXPECT_EQ(pairs(step.changes), (std::vector<std::pair<ParamID, ParamValue>>{{1, 0.5}}));
+    EXPECT_GT(step.timeMs, 0);
+
+    ASSERT_TRUE(history.undo(step));
+    EXPECT_EQ(pairs(step.changes), (std::vector<std::pair<ParamID, ParamValue>>{{2, 0.1}, {1, 0.0}}));
+    EXPECT_FALSE(history.undo(step));
+    EXPECT_EQ(history.redoSteps(), 2u);
+
+    ASSERT_TRUE(history.redo(step));
+    EXPECT_EQ(pairs(step.changes), (std::vector<std::pair<ParamID, ParamValue>>{{1, 0.5}, {2, 0.2}}));
+    ASSERT_TRUE(history.redo(step));
+    EXPECT_EQ(pairs(step.changes), (std::vector<std::pair<ParamID, ParamValue>>{{1, 0.9}}));
+    EXPECT_FALSE(history.redo(step));
+}
+
+TEST(ParamHistory, RecordingDiscardsRedoBranch) {
+    ParamHistory history;
+    history.record({{1, 0.0, 0.5}});
+    history.record({{1, 0.5, 0.6}});
+
+    ParamHistory::Step step;
+    ASSERT_TRUE(history.undo(step));
+    history.record({{2, 0.0, 1.0}});
+    EXPECT_EQ(history.redoSteps(), 0u);
+    EXPECT_EQ(history.undoSteps(), 2u);
+    EXPECT_FALSE(history.redo(step));
+}
+
+TEST(ParamHistory, UnchangedValuesAreNotRecorded) {
+    ParamHistory history;
+    history.record({{1, 0.5, 0.5}});
+    EXPECT_EQ(history.undoSteps(), 0u);
+
+    history.record({{1, 0.5, 0.5}, {2, 0.0, 0.3}});
+    ParamHistory::Step step;
+    ASSERT_TRUE(history.undo(step));
+    EXPECT_EQ(pairs(step.changes), (std::vector<std::pair<ParamID, ParamValue>>{{2, 0.0}}));
+}
+
+TEST(ParamHistory, FullRingDropsOldestStepsWhole) {
+    ParamHistory history(4);
+    history.record({{1, 0.0, 0.1}, {2, 0.0, 0.2}, {3, 0.0, 0.3}});
+    history.record({{4, 0.0, 0.4}});
+    history.record({{5, 0.0, 0.5}}); // Needs room: the three-entry step goes
+
+    EXPECT_EQ(history.undoSteps(), 2u);
+    ParamHistory::Step step;
+    ASSERT_TRUE(history.undo(step));
+    ASSERT_TRUE(history.undo(step));
+    EXPECT_EQ(pairs(step.changes), (std::vector<std::pair<ParamID, ParamValue>>{{4, 0.0}}));
+    EXPECT_FALSE(history.undo(step));
+}
+
+TEST(ParamHistory, StepLargerThanRingClearsHistory) {
+    ParamHistory history(2);
+    history.record({{1, 0.0, 0.1}});
+    history.record({{1, 0.1, 0.2}, {2, 0.0, 0.2}, {3, 0.0, 0.3}});
+    EXPECT_EQ(history.undoSteps(), 0u);
+    EXPECT_EQ(history.redoSteps(), 0u);
+}
+
+TEST(ParamHistory, RingWrapsAround) {
+    ParamHistory history(3);
+    for (int i = 0; i < 10; ++i)
+        history.record({{static_cast<ParamID>(i), 0.0, 1.0}});
+
+    EXPECT_EQ(history.undoSteps(), 3u);
+    ParamHistory::Step step;
+    for (ParamID expected : {9u, 8u, 7u}) {
+        ASSERT_TRUE(history.undo(step));
+        ASSERT_EQ(step.changes.size(), 1u);
+        EXPECT_EQ(step.changes[0].id, expected);
+    }
+    EXPECT_FALSE(history.undo(step));
+}
+
+TEST(ParamHistory, CheckpointsAreReplacedByNameAndBounded) {
+    ParamHistory history;
+    history.checkpoint("a", {{2, 0.2}, {1, 0.1}});
+    history.checkpoint("a", {{1, 0.7}});
+
+    auto values = history.findCheckpoint("a");
+    ASSERT_TRUE(values);
+    EXPECT_EQ(*values, (ParamSnapshot{{1, 0.7}}));
+    EXPECT_FALSE(history.findCheckpoint("b"));
+
+    for (size_t i = 0; i < ParamHistory::kMaxCheckpoints; ++i)
+        history.checkpoint("cp" + std::to_string(i), {});
+    auto names = history.checkpointNames();
+    EXPECT_EQ(names.size(), ParamHistory::kMaxCheckpoints);
+    EXPECT_FALSE(history.findCheckpoint("a")) << "oldest checkpoint dropped";
+}
+
+TEST(ParamHistory, AutoSnapshotsDueEveryIntervalAndKeptSeparately) {
+    ParamHistory history;
+    history.checkpoint("mine", {});
+    for (size_t i = 0; i + 1 < ParamHistory::kSnapshotInterval; ++i)
+        history.record({{1, 0.0, 1.0}});
+    EXPECT_FALSE(history.autoSnapshotDue());
+    history.record({{1, 0.0, 1.0}});
+    EXPECT_TRUE(history.autoSnapshotDue());
+
+    for (size_t i = 0; i < ParamHistory::kMaxAutoSnapshots + 2; ++i)
+        history.addAutoSnapshot({});
+    EXPECT_FALSE(history.autoSnapshotDue());
+
+    auto names = history.checkpointNames();
+    EXPECT_EQ(names.size(), ParamHistory::kMaxAutoSnapshots + 1);
+    EXPECT_EQ(names.front(), "mine");
+    EXPECT_FALSE(history.findCheckpoint("auto-1"));
+    EXPECT_TRUE(history.findCheckpoint("auto-" + std::to_string(ParamHistory::kMaxAutoSnapshots + 2)));
+}
+
+TEST(ParamHistory, ClearDropsStepsAndCheckpoints) {
+    ParamHistory history;
+    history.record({{1, 0.0, 1.0}});
+    history.checkpoint("a", {{1, 1.0}});
+    history.clear();
+    EXPECT_EQ(history.undoSteps(), 0u);
+    EXPECT_TRUE(history.checkpointNames().empty());
+}
+
+// ============================================================
+// undo / redo / checkpoint / revert_to tools
+// ============================================================
+
+namespace {
+
+class ParamHistoryToolsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // A controller that stores the values it is given
+        EXPECT_CALL(ctrl_, getParameterCount()).WillRepeatedly(Return(3));
+        for (int32 i = 0; i < 3; ++i) {
+            ParameterInfo info = {};
+            info.id = static_cast<ParamID>(10 * (i + 1));
+            fillTChar(info.title, u"Param");
+            values_[info.id] = 0.0;
+            EXPECT_CALL(ctrl_, getParameterInfo(i, _))
+                .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
+        }
+        EXPECT_CALL(ctrl_, getParamNormalized(_)).WillRepeatedly([this](ParamID id) { return values_[id]; });
+        EXPECT_CALL(ctrl_, setParamNormalized(_, _)).WillRepeatedly([this](ParamID id, ParamValue value) {
+            values_[id] = value;
+            return kResultOk;
+        });
+        EXPECT_CALL(ctrl_, getParamStringByValue(_, _, _)).WillRepeatedly(Return(kResultFalse));
+    }
+
+    // Changes queued for the processor since the last call
+    std::vector<ParamChange> drainQueued() {
+        std::vector<ParamChange> drained;
+        instance_.drainParamChanges(drained);
+        return drained;
+    }
+
+    static mcp::json body(const mcp::json& result) {
+        return mcp::json::parse(result["content"][0]["text"].get<std::string>());
+    }
+
+    MockEditController ctrl_;
+    std::map<ParamID, ParamValue> values_;
+    ParameterInfoCache cache_;
+    HostedPluginInstance instance_;
+    ParamHistory history_;
+};
+
+} // namespace
+
+TEST_F(ParamHistoryToolsTest, UndoRevertsSetParametersBatchInOneBatch) {
+    handleSetParameter(&ctrl_, cache_, instance_, 10, 0.5, ParamChangeTiming::Immediate, 0, &history_);
+    handleSetParameters(&ctrl_, cache_, instance_, mcp::json::parse(R"([{"id": 10, "value": 0.8}, {"id": 20, "value": 0.3}])"),
+                        &history_);
+    drainQueued();
+
+    auto result = handleUndoRedo(&ctrl_, cache_, instance_, history_, false, 1);
+    ASSERT_FALSE(result.contains("isError"));
+    EXPECT_DOUBLE_EQ(values_[10], 0.5);
+    EXPECT_DOUBLE_EQ(values_[20], 0.0);
+    auto queued = drainQueued();
+    EXPECT_EQ(queued.size(), 2u);
+
+    auto json = body(result);
+    EXPECT_EQ(json["undone"], 1);
+    EXPECT_EQ(json["undoSteps"], 1);
+    EXPECT_EQ(json["redoSteps"], 1);
+    EXPECT_EQ(json["steps"][0]["changes"], 2);
+}
+
+TEST_F(ParamHistoryToolsTest, MultiStepUndoQueuesOneChangePerParameter) {
+    handleSetParameter(&ctrl_, cache_, instance_, 10, 0.2, ParamChangeTiming::Immediate, 0, &history_);
+    handleSetParameter(&ctrl_, cache_, instance_, 10, 0.4, ParamChangeTiming::Immediate, 0, &history_);
+    handleRampParameter(&ctrl_, cache_, instance_, 10, 0.9, 100.0, "linear", &history_);
+    drainQueued();
+
+    auto json = body(handleUndoRedo(&ctrl_, cache_, instance_, history_, false, 10));
+    EXPECT_EQ(json["undone"], 3);
+    EXPECT_DOUBLE_EQ(values_[10], 0.0);
+    auto queued = drainQueued();
+    ASSERT_EQ(queued.size(), 1u);
+    EXPECT_DOUBLE_EQ(queued[0].value, 0.0);
+
+    json = body(handleUndoRedo(&ctrl_, cache_, instance_, history_, true, 2));
+    EXPECT_EQ(json["redone"], 2);
+    EXPECT_DOUBLE_EQ(values_[10], 0.4);
+}
+
+TEST_F(ParamHistoryToolsTest, NothingToUndoIsAnError) {
+    auto result = handleUndoRedo(&ctrl_, cache_, instance_, history_, false, 1);
+    EXPECT_TRUE(result["isError"].get<bool>());
+    result = handleUndoRedo(&ctrl_, cache_, instance_, history_, true, 1);
+    EXPECT_TRUE(result["isError"].get<bool>());
+    result = handleUndoRedo(nullptr, cache_, instance_, history_, false, 1);
+    EXPECT_TRUE(result["isError"].get<bool>());
+}
+
+TEST_F(ParamHistoryToolsTest, RevertToCheckpointIsUndoable) {
+    handleSetParameter(&ctrl_, cache_, instance_, 10, 0.5, ParamChangeTiming::Immediate, 0, &history_);
+    auto json = body(handleCheckpoint(&ctrl_, cache_, history_, "mix"));
+    EXPECT_EQ(json["checkpoint"], "mix");
+    EXPECT_EQ(json["parameters"], 3);
+
+    handleSetParameters(&ctrl_, cache_, instance_, mcp::json::parse(R"([{"id": 10, "value": 1.0}, {"id": 30, "value": 0.7}])"),
+                        &history_);
+    drainQueued();
+
+    json = body(handleRevertTo(&ctrl_, cache_, instance_, history_, "mix"));
+    EXPECT_EQ(json["changed"], 2);
+    EXPECT_DOUBLE_EQ(values_[10], 0.5);
+    EXPECT_DOUBLE_EQ(values_[30], 0.0);
+    EXPECT_EQ(drainQueued().size(), 2u);
+
+    handleUndoRedo(&ctrl_, cache_, instance_, history_, false, 1);
+    EXPECT_DOUBLE_EQ(values_[10], 1.0);
+    EXPECT_DOUBLE_EQ(values_[30], 0.7);
+}
+
+TEST_F(ParamHistoryToolsTest, RevertToUnknownCheckpointListsAvailable) {
+    handleCheckpoint(&ctrl_, cache_, history_, "");
+    auto result = handleRevertTo(&ctrl_, cache_, instance_, history_, "nope");
+    EXPECT_TRUE(result["isError"].get<bool>());
+    EXPECT_NE(result["content"][0]["text"].get<std::string>().find("checkpoint-1"), std::string::npos);
+}
+
+TEST_F(ParamHistoryToolsTest, CheckpointNameTooLongIsRejected) {
+    auto result = handleCheckpoint(&ctrl_, cache_, history_, std::string(kMaxCheckpointNameLength + 1, 'x'));
+    EXPECT_TRUE(result["isError"].get<bool>());
+    EXPECT_TRUE(history_.checkpointNames().empty());
+}
@@ -0,0 +1,340 @@
+/**
+ * @file test_param_merge_alloc.cpp
+ * @brief Tests for the preallocated parameter merge used by Processor::process().
+ *
+ * Covers PreallocatedParameterChanges / PreallocatedParamValueQueue semantics
+ * and proves that the merge path performs zero heap allocations by replacing
+ * the global operator new with a counting version that is only armed around
+ * the process() call under test.
+ */
+
+#include <gtest/gtest.h>
+
+#include "paramchanges.h"
+#include "processor.h"
+#include "hostedplugin.h"
+#include "helpers/processor_test_access.h"
+#include "mocks/mock_vst3.h"
+
+#include "public.sdk/source/vst/hosting/parameterchanges.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+
+//------------------------------------------------------------------------
+// Counting operator new — only counts on the arming thread while armed
+//------------------------------------------------------------------------
+namespace {
+std::atomic<bool> gCountAllocations{false};
+std::atomic<int> gAllocationCount{0};
+thread_local bool tCountingThread = false;
+
+struct AllocationCounter {
+    AllocationCounter ()
+    {
+        gAllocationCount = 0;
+        tCountingThread = true;
+        gCountAllocations = true;
+    }
+    ~AllocationCounter ()
+    {
+        gCountAllocations = false;
+        tCountingThread = false;
+    }
+    int count () const { return gAllocationCount.load (); }
+};
+} // namespace
+
+void* operator new (std::size_t size)
+{
+    if (gCountAllocations.load (std::memory_order_relaxed) && tCountingThread)
+        gAllocationCount.fetch_add (1, std::memory_order_relaxed);
+    if (void* p = std::malloc (size ? size : 1))
+        return p;
+    throw std::bad_alloc ();
+}
+
+void operator delete (void* p) noexcept { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept { std::free (p); }
+
+namespace {
+
+//------------------------------------------------------------------------
+// Hand-written hosted processor: gmock records calls on the heap, so a
+// plain fake is needed to keep the measured region allocation-free.
+//------------------------------------------------------------------------
+class RecordingAudioProcessor : public IAudioProcessor
+{
+public:
+    uint32 PLUGIN_API addRef () override { return 1; }
+    uint32 PLUGIN_API release () override { return 1; }
+    tresult PLUGIN_API queryInterface (const TUID, void** obj) override
+    {
+        *obj = nullptr;
+        return kNoInterface;
+    }
+
+    tresult PLUGIN_API setBusArrangements (SpeakerArrangement*, int32, SpeakerArrangement*, int32) override
+    {
+        return kResultOk;
+    }
+    tresult PLUGIN_API getBusArrangement (BusDirection, int32, SpeakerArrangement&) override
+    {
+        return kResultFalse;
+    }
+    tresult PLUGIN_API canProcessSampleSize (int32) override { return kResultTrue; }
+    uint32 PLUGIN_API getLatencySamples () override { return 0; }
+    tresult PLUGIN_API setupProcessing (ProcessSetup&) override { return kResultOk; }
+    tresult PLUGIN_API setProcessing (TBool) override { return kResultOk; }
+    uint32 PLUGIN_API getTailSamples () override { return 0; }
+
+    tresult PLUGIN_API process (ProcessData& data) override
+    {
+        ++processCalls;
+        lastParamCount = data.inputParameterChanges
+            ? data.inputParameterChanges->getParameterCount () : 0;
+        return kResultOk;
+    }
+
+    int processCalls = 0;
+    int32 lastParamCount = 0;
+};
+
+} // namespace
+
+//------------------------------------------------------------------------
+// PreallocatedParameterChanges semantics
+//------------------------------------------------------------------------
+TEST (PreallocatedParameterChanges, AddParameterDataReusesQueueForSameId)
+{
+    PreallocatedParameterChanges changes;
+    changes.allocate (4, 4);
+
+    int32 idx0 = -1;
+    int32 idx1 = -1;
+    auto* q0 = changes.addParameterData (7, idx0);
+    auto* q1 = changes.addParameterData (7, idx1);
+
+    ASSERT_NE (q0, nullptr);
+    EXPECT_EQ (q0, q1);
+    EXPECT_EQ (idx0, idx1);
+    EXPECT_EQ (changes.getParameterCount (), 1);
+}
+
+TEST (PreallocatedParameterChanges, ReturnsNullWhenParameterCapacityExhausted)
+{
+    PreallocatedParameterChanges changes;
+    changes.allocate (2, 4);
+
+    int32 idx;
+    EXPECT_NE (changes.addParameterData (1, idx), nullptr);
+    EXPECT_NE (changes.addParameterData (2, idx), nullptr);
+    EXPECT_EQ (changes.addParameterData (3, idx), nullptr);
+    EXPECT_EQ (changes.getParameterCount (), 2);
+}
+
+TEST (PreallocatedParameterChanges, ClearResetsQueuesForReuse)
+{
+    PreallocatedParameterChanges changes;
+    changes.allocate (2, 4);
+
+    int32 idx;
+    int32 pIdx;
+    changes.addParameterData (1, idx)->addPoint (0, 0.5, pIdx);
+    changes.clear ();
+    EXPECT_EQ (changes.getParameterCount (), 0);
+    EXPECT_EQ (changes.getParameterData (0), nullptr);
+
+    auto* q = changes.addParameterData (9, idx);
+    ASSERT_NE (q, nullptr);
+    EXPECT_EQ (q->getParameterId (), 9u);
+    EXPECT_EQ (q->getPointCount (), 0);
+}
+
+TEST (PreallocatedParamValueQueue, PointsSortedAndSameOffsetReplaces)
+{
+    PreallocatedParameterChanges changes;
+    changes.allocate (1, 8);
+
+    int32 idx;
+    auto* q = changes.addParameterData (1, idx);
+    int32 pIdx;
+    q->addPoint (10, 0.1, pIdx);
+    q->addPoint (0, 0.2, pIdx);
+    EXPECT_EQ (pIdx, 0);
+    q->addPoint (10, 0.3, pIdx);
+    EXPECT_EQ (pIdx, 1);
+
+    ASSERT_EQ (q->getPointCount (), 2);
+    int32 offset;
+    ParamValue value;
+    q->getPoint (0, offset, value);
+    EXPECT_EQ (offset, 0);
+    EXPECT_DOUBLE_EQ (value, 0.2);
+    q->getPoint (1, offset, value);
+    EXPECT_EQ (offset, 10);
+    EXPECT_DOUBLE_EQ (value, 0.3);
+}
+
+TEST (PreallocatedParamValueQueue, RejectsPointsBeyondCapacity)
+{
+    PreallocatedParameterChanges changes;
+    changes.allocate (1, 2);
+
+    int32 idx;
+    auto* q = changes.addParameterData (1, idx);
+    int32 pIdx;
+    EXPECT_EQ (q->addPoint (0, 0.1, pIdx), kResultTrue);
+    EXPECT_EQ (q->addPoint (1, 0.2, pIdx), kResultTrue);
+    EXPECT_EQ (q->addPoint (2, 0.3, pIdx), kResultFalse);
+    // Replacing an existing offset is still allowed when full
+    EXPECT_EQ (q->addPoint (1, 0.4, pIdx), kResultTrue);
+    EXPECT_EQ (q->getPointCount (), 2);
+}
+
+TEST (PreallocatedParamValueQueue, AddPointDoesNotAllocate)
+{
+    PreallocatedParameterChanges changes;
+    changes.allocate (8, 16);
+
+    AllocationCounter counter;
+    for (int block = 0; block < 4; ++block) {
+        changes.clear ();
+        for (ParamID id = 0; id < 8; ++id) {
+            int32 idx;
+            auto* q = changes.addParameterData (id, idx);
+            for (int32 p = 0; p < 16; ++p) {
+                int32 pIdx;
+                q->addPoint (15 - p, 0.5, pIdx);
+            }
+        }
+    }
+    EXPECT_EQ (counter.count (), 0);
+}
+
+//------------------------------------------------------------------------
+// Processor::process() merge path
+//------------------------------------------------------------------------
+class ParamMergeAllocTest : public ::testing::Test {
+protected:
+    void SetUp () override
+    {
+        processor_ = new Processor ();
+        ASSERT_EQ (processor_->initialize (nullptr), kResultOk);
+
+        ProcessorTestAccess::setHostedComponent (*processor_, &mockComp_);
+        ProcessorTestAccess::setHostedProcessor (*processor_, &hostedProc_);
+        ProcessorTestAccess::setProcessorReady (*processor_, true);
+        ProcessorTestAccess::setHostedActive (*processor_, true);
+    }
+
+    void TearDown () override
+    {
+        ProcessorTestAccess::setProcessorReady (*processor_, false);
+        ProcessorTestAccess::setHostedActive (*processor_, false);
+        ProcessorTestAccess::setHostedComponent (*processor_, nullptr);
+        ProcessorTestAccess::setHostedProcessor (*processor_, nullptr);
+        processor_->terminate ();
+        processor_->release ();
+    }
+
+    Processor* processor_ = nullptr;
+    MockComponent mockComp_;
+    RecordingAudioProcessor hostedProc_;
+};
+
+TEST_F (ParamMergeAllocTest, MergeWithQueuedAndDawChangesDoesNotAllocate)
+{
+    // DAW automation for two params, one overlapping with the queued changes
+    ParameterChanges dawChanges;
+    int32 idx;
+    int32 pIdx;
+    dawChanges.addParameterData (1, idx)->addPoint (0, 0.1, pIdx);
+    dawChanges.addParameterData (2, idx)->addPoint (8, 0.2, pIdx);
+
+    std::vector<float> in (32, 0.0f);
+    std::vector<float> out (32, 0.0f);
+    float* inPtr = in.data ();
+    float* outPtr = out.data ();
+    AudioBusBuffers inBus{};
+    inBus.numChannels = 1;
+    inBus.channelBuffers32 = &inPtr;
+    AudioBusBuffers outBus{};
+    outBus.numChannels = 1;
+    outBus.channelBuffers32 = &outPtr;
+
+    ProcessData data{};
+    data.numSamples = 32;
+    data.symbolicSampleSize = kSample32;
+    data.numInputs = 1;
+    data.numOutputs = 1;
+    data.inputs = &inBus;
+    data.outputs = &outBus;
+    data.inputParameterChanges = &dawChanges;
+
+    auto& pluginModule = processor_->getHostedInstance ();
+
+    // Several blocks in a row: each block has fresh queued changes
+    for (int block = 0; block < 8; ++block) {
+        for (ParamID id = 2; id < 10; ++id)
+            pluginModule.pushParamChange (id, 0.05 * block);
+
+        AllocationCounter counter;
+        EXPECT_EQ (processor_->process (data), kResultOk);
+        EXPECT_EQ (counter.count (), 0) << "process() allocated in block " << block;
+    }
+
+    EXPECT_EQ (hostedProc_.processCalls, 8);
+    EXPECT_EQ (hostedProc_.lastParamCount, 9);
+    EXPECT_EQ (data.inputParameterChanges, &dawChanges);
+}
+
+TEST_F (ParamMergeAllocTest, RunningRampsDoNotAllocate)
+{
+    std::vector<float> in (256, 0.0f);
+    std::vector<float> out (256, 0.0f);
+    float* inPtr = in.data ();
+    float* outPtr = out.data ();
+    AudioBusBuffers inBus{};
+    inBus.numChannels = 1;
+    inBus.channelBuffers32 = &inPtr;
+    AudioBusBuffers outBus{};
+    outBus.numChannels = 1;
+    outBus.channelBuffers32 = &outPtr;
+
+    ProcessData data{};
+    data.numSamples = 256;
+    data.symbolicSampleSize = kSample32;
+    data.numInputs = 1;
+    data.numOutputs = 1;
+    data.inputs = &inBus;
+    data.outputs = &outBus;
+    ProcessContext context{};
+    context.sampleRate = 48000.0;
+    data.processContext = &context;
+
+    auto& pluginModule = processor_->getHostedInstance ();
+    for (ParamID id = 0; id < 16; ++id) {
+        ParamRamp ramp;
+        ramp.id = id;
+        ramp.targetValue = 1.0;
+        ramp.durationMs = 1000.0;
+        ramp.curve = RampCurve::SCurve;
+        ASSERT_TRUE (pluginModule.pushParamRamp (ramp));
+    }
+
+    for (int block = 0; block < 8; ++block) {
+        AllocationCounter counter;
+        EXPECT_EQ (processor_->process (data), kResultOk);
+        EXPECT_EQ (counter.count (), 0) << "process() allocated in block " << block;
+    }
+
+    EXPECT_EQ (hostedProc_.lastParamCount, 16);
+}
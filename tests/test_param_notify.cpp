@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "paramnotify.h"
+#include "mcp_param_handlers.h"
+#include "helpers/test_helpers.h"
+#include "mocks/mock_vst3.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace testing;
+
+namespace {
+
+using Clock = ParamChangeNotifier::Clock;
+
+// Collects flushed batches per session
+struct Outbox {
+    std::map<std::string, std::vector<std::vector<ParamUpdate>>> batches;
+
+    ParamChangeNotifier::Sender sender() {
+        return [this](const std::string& sessionId, const std::vector<ParamUpdate>& updates) {
+            batches[sessionId].push_back(updates);
+        };
+    }
+};
+
+ParameterInfo makeInfo(ParamID id) {
+    ParameterInfo info = {};
+    info.id = id;
+    fillTChar(info.title, u"P");
+    return info;
+}
+
+} // namespace
+
+// ============================================================
+// ParamChangeNotifier
+// ============================================================
+
+TEST(ParamChangeNotifier, PublishWithoutSubscribersIsDropped) {
+    ParamChangeNotifier notifier;
+    Outbox out;
+    notifier.publish(1, 0.5);
+    EXPECT_EQ(notifier.flush(Clock::now(), out.sender()), Clock::time_point::max());
+    EXPECT_TRUE(out.batches.empty());
+}
+
+TEST(ParamChangeNotifier, CoalescesPerParameterWithinInterval) {
+    ParamChangeNotifier notifier;
+    Outbox out;
+    notifier.subscribe("s", {}, 50);
+
+    for (int i = 0; i <= 100; ++i)
+        notifier.publish(1, i / 100.0);
+    notifier.publish(2, 0.3);
+
+    notifier.flush(Clock::now(), out.sender());
+    ASSERT_EQ(out.batches["s"].size(), 1u);
+    const auto& batch = out.batches["s"][0];
+    ASSERT_EQ(batch.size(), 2u);
+    EXPECT_EQ(batch[0].id, 1u);
+    EXPECT_DOUBLE_EQ(batch[0].value, 1.0);
+    EXPECT_EQ(batch[1].id, 2u);
+}
+
+TEST(ParamChangeNotifier, RateLimitsPerSession) {
+    ParamChangeNotifier notifier;
+    Outbox out;
+    notifier.subscribe("s", {}, 100);
+
+    auto t0 = Clock::now();
+    notifier.publish(1, 0.1);
+    notifier.flush(t0, out.sender());
+    ASSERT_EQ(out.batches["s"].size(), 1u);
+
+    notifier.publish(1, 0.2);
+    auto due = notifier.flush(t0 + std::chrono::milliseconds(20), out.sender());
+    EXPECT_EQ(out.batches["s"].size(), 1u) << "second batch must wait for the interval";
+    EXPECT_EQ(due, t0 + std::chrono::milliseconds(100));
+
+    notifier.flush(due, out.sender());
+    ASSERT_EQ(out.batches["s"].size(), 2u);
+    EXPECT_DOUBLE_EQ(out.batches["s"][1][0].value, 0.2);
+}
+
+TEST(ParamChangeNotifier, OnlySubscribedIdsAreDelivered) {
+    ParamChangeNotifier notifier;
+    Outbox out;
+    notifier.subscribe("a", {1});
+    notifier.subscribe("b", {2});
+
+    notifier.publish(1, 0.1);
+    notifier.publish(2, 0.2);
+    notifier.publish(3, 0.3);
+    notifier.flush(Clock::now(), out.sender());
+
+    ASSERT_EQ(out.batches["a"].size(), 1u);
+    ASSERT_EQ(out.batches["a"][0].size(), 1u);
+    EXPECT_EQ(out.batches["a"][0][0].id, 1u);
+    ASSERT_EQ(out.batches["b"][0].size(), 1u);
+    EXPECT_EQ(out.batches["b"][0][0].id, 2u);
+}
+
+TEST(ParamChangeNotifier, UnsubscribeRemovesIdsThenSession) {
+    ParamChangeNotifier notifier;
+    notifier.subscribe("s", {1, 2});
+    notifier.unsubscribe("s", {1});
+    EXPECT_TRUE(notifier.isSubscribed("s"));
+    notifier.unsubscribe("s", {2});
+    EXPECT_FALSE(notifier.isSubscribed("s"));
+
+    notifier.subscribe("s", {});
+    notifier.unsubscribe("s", {});
+    EXPECT_EQ(notifier.sessionCount(), 0u);
+}
+
+TEST(ParamChangeNotifier, IntervalIsClamped) {
+    ParamChangeNotifier notifier;
+    EXPECT_EQ(notifier.subscribe("s", {}, 0), ParamChangeNotifier::kMinIntervalMs);
+    EXPECT_EQ(notifier.subscribe("s", {}, 1000000), ParamChangeNotifier::kMaxIntervalMs);
+}
+
+TEST(ParamChangeNotifier, EvictsLeastRecentlySubscribedWhenFull) {
+    ParamChangeNotifier notifier;
+    for (size_t i = 0; i < ParamChangeNotifier::kMaxSessions; ++i)
+        notifier.subscribe("s" + std::to_string(i), {});
+    notifier.subscribe("s0", {}); // refresh s0 so s1 is now the oldest
+
+    notifier.subscribe("new", {});
+    EXPECT_EQ(notifier.sessionCount(), ParamChangeNotifier::kMaxSessions);
+    EXPECT_TRUE(notifier.isSubscribed("s0"));
+    EXPECT_FALSE(notifier.isSubscribed("s1"));
+    EXPECT_TRUE(notifier.isSubscribed("new"));
+}
+
+TEST(ParamChangeNotifier, ClearPendingDiscardsUndelivered) {
+    ParamChangeNotifier notifier;
+    Outbox out;
+    notifier.subscribe("s", {});
+    notifier.publish(1, 0.5);
+    notifier.clearPending();
+    notifier.flush(Clock::now(), out.sender());
+    EXPECT_TRUE(out.batches.empty());
+}
+
+TEST(ParamChangeNotifier, BackgroundThreadDelivers) {
+    ParamChangeNotifier notifier;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<ParamUpdate> received;
+
+    notifier.subscribe("s", {}, ParamChangeNotifier::kMinIntervalMs);
+    notifier.start([&](const std::string&, const std::vector<ParamUpdate>& updates) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.insert(received.end(), updates.begin(), updates.end());
+        cv.notify_all();
+    });
+
+    notifier.publish(9, 0.9);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(2), [&] { return !received.empty(); }));
+        EXPECT_EQ(received[0].id, 9u);
+    }
+    notifier.stop();
+    notifier.stop();
+}
+
+// ============================================================
+// subscribe_parameters / unsubscribe_parameters
+// ============================================================
+
+TEST(SubscribeParametersHandler, SubscribesToAllWithoutPlugin) {
+    ParamChangeNotifier notifier;
+    ParameterInfoCache cache;
+    auto result = handleSubscribeParameters(nullptr, cache, notifier, "s", mcp::json(), 25);
+    ASSERT_FALSE(result.contains("isError"));
+
+    auto data = mcp::json::parse(result["content"][0]["text"].get<std::string>());
+    EXPECT_EQ(data["subscribed"].get<std::string>(), "all");
+    EXPECT_EQ(data["intervalMs"].get<int>(), 25);
+    EXPECT_EQ(data["notification"].get<std::string>(), kParamChangedNotification);
+    EXPECT_TRUE(notifier.isSubscribed("s"));
+}
+
+TEST(SubscribeParametersHandler, ValidatesIds) {
+    ParamChangeNotifier notifier;
+    ParameterInfoCache cache;
+    MockEditController ctrl;
+    EXPECT_CALL(ctrl, getParameterCount()).WillRepeatedly(Return(1));
+    EXPECT_CALL(ctrl, getParameterInfo(0, _))
+        .WillRepeatedly(DoAll(SetArgReferee<1>(makeInfo(4)), Return(kResultOk)));
+
+    auto missing = handleSubscribeParameters(&ctrl, cache, notifier, "s", mcp::json::array({4, 5}), 50);
+    EXPECT_TRUE(missing["isError"].get<bool>());
+    EXPECT_FALSE(notifier.isSubscribed("s"));
+
+    auto noPlugin = handleSubscribeParameters(nullptr, cache, notifier, "s", mcp::json::array({4}), 50);
+    EXPECT_TRUE(noPlugin["isError"].get<bool>());
+
+    auto ok = handleSubscribeParameters(&ctrl, cache, notifier, "s", mcp::json::array({4}), 50);
+    ASSERT_FALSE(ok.contains("isError"));
+    auto data = mcp::json::parse(ok["content"][0]["text"].get<std::string>());
+    EXPECT_EQ(data["subscribed"], mcp::json::array({4}));
+}
+
+TEST(SubscribeParametersHandler, UnsubscribeReportsState) {
+    ParamChangeNotifier notifier;
+    notifier.subscribe("s", {1, 2});
+
+    auto partial = handleUnsubscribeParameters(notifier, "s", mcp::json::array({1}));
+    EXPECT_TRUE(mcp::json::parse(partial["content"][0]["text"].get<std::string>())["subscribed"].get<bool>());
+
+    auto all = handleUnsubscribeParameters(notifier, "s", mcp::json());
+    EXPECT_FALSE(mcp::json::parse(all["content"][0]["text"].get<std::string>())["subscribed"].get<bool>());
+}
+
+TEST(SubscribeParametersHandler, NotificationParamsListUpdates) {
+    auto params = paramChangedNotificationParams({{1, 0.25}, {2, 0.5}});
+    ASSERT_EQ(params["parameters"].size(), 2u);
+    EXPECT_EQ(params["parameters"][1]["id"].get<uint32>(), 2u);
+    EXPECT_DOUBLE_EQ(params["parameters"][0]["normalizedValue"].get<double>(), 0.25);
+}
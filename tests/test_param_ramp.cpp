@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "paramramp.h"
+#include "paramchanges.h"
+#include "mcp_param_handlers.h"
+#include "helpers/test_helpers.h"
+#include "mocks/mock_vst3.h"
+#include "hostedplugin.h"
+
+#include <vector>
+
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace testing;
+
+namespace {
+
+struct Point {
+    int32 offset;
+    ParamValue value;
+};
+
+std::vector<Point> pointsFor(PreallocatedParameterChanges& changes, ParamID id) {
+    std::vector<Point> points;
+    for (int32 i = 0; i < changes.getParameterCount(); ++i) {
+        auto* q = changes.getParameterData(i);
+        if (!q || q->getParameterId() != id)
+            continue;
+        for (int32 p = 0; p < q->getPointCount(); ++p) {
+            Point pt{};
+            q->getPoint(p, pt.offset, pt.value);
+            points.push_back(pt);
+        }
+    }
+    return points;
+}
+
+ParamRamp makeRamp(ParamID id, ParamValue start, ParamValue target, double durationMs,
+                   RampCurve curve = RampCurve::Linear) {
+    ParamRamp ramp;
+    ramp.id = id;
+    ramp.startValue = start;
+    ramp.targetValue = target;
+    ramp.durationMs = durationMs;
+    ramp.curve = curve;
+    return ramp;
+}
+
+class ParamRampEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override { changes_.allocate(8, 32); }
+
+    std::vector<Point> renderBlock(ParamID id, int32 numSamples = 64) {
+        changes_.clear();
+        engine_.render(changes_, numSamples);
+        return pointsFor(changes_, id);
+    }
+
+    PreallocatedParameterChanges changes_;
+    ParamRampEngine engine_;
+};
+
+} // namespace
+
+// ============================================================
+// Curves
+// ============================================================
+
+TEST(RampCurve, EndpointsAreFixedForEveryCurve) {
+    for (auto curve : {RampCurve::Linear, RampCurve::EaseIn, RampCurve::EaseOut, RampCurve::SCurve}) {
+        EXPECT_DOUBLE_EQ(applyRampCurve(curve, 0.0), 0.0);
+        EXPECT_DOUBLE_EQ(applyRampCurve(curve, 1.0), 1.0);
+        EXPECT_DOUBLE_EQ(applyRampCurve(curve, 2.0), 1.0);
+    }
+    EXPECT_LT(applyRampCurve(RampCurve::EaseIn, 0.5), 0.5);
+    EXPECT_GT(applyRampCurve(RampCurve::EaseOut, 0.5), 0.5);
+    EXPECT_DOUBLE_EQ(applyRampCurve(RampCurve::SCurve, 0.5), 0.5);
+}
+
+TEST(RampCurve, NamesRoundTrip) {
+    for (auto curve : {RampCurve::Linear, RampCurve::EaseIn, RampCurve::EaseOut, RampCurve::SCurve}) {
+        RampCurve parsed;
+        ASSERT_TRUE(parseRampCurve(rampCurveName(curve), parsed));
+        EXPECT_EQ(parsed, curve);
+    }
+    RampCurve parsed;
+    EXPECT_FALSE(parseRampCurve("bounce", parsed));
+}
+
+// ============================================================
+// ParamRampEngine
+// ============================================================
+
+TEST_F(ParamRampEngineTest, RampSpansBlocksAndEndsExactlyOnTarget) {
+    // 100 ms at 1 kHz = 100 samples: a full block of 64, then 36 more
+    ASSERT_TRUE(engine_.start(makeRamp(1, 0.0, 1.0, 100.0), 1000.0));
+
+    auto first = renderBlock(1);
+    ASSERT_EQ(first.size(), static_cast<size_t>(ParamRampEngine::kPointsPerBlock));
+    EXPECT_EQ(first.front().offset, 0);
+    EXPECT_DOUBLE_EQ(first.front().value, 0.0);
+    EXPECT_EQ(first.back().offset, 63);
+    EXPECT_DOUBLE_EQ(first.back().value, 0.63);
+    for (size_t i = 1; i < first.size(); ++i)
+        EXPECT_GT(first[i].value, first[i - 1].value);
+
+    auto second = renderBlock(1);
+    ASSERT_FALSE(second.empty());
+    EXPECT_DOUBLE_EQ(second.front().value, 0.64);
+    EXPECT_EQ(second.back().offset, 36);
+    EXPECT_DOUBLE_EQ(second.back().value, 1.0);
+    EXPECT_EQ(engine_.activeCount(), 0u);
+
+    EXPECT_TRUE(renderBlock(1).empty());
+}
+
+TEST_F(ParamRampEngineTest, RampEndingOnBlockBoundaryHitsTargetOnLastSample) {
+    ASSERT_TRUE(engine_.start(makeRamp(1, 0.2, 0.8, 64.0), 1000.0));
+
+    auto points = renderBlock(1);
+    ASSERT_FALSE(points.empty());
+    EXPECT_EQ(points.back().offset, 63);
+    EXPECT_DOUBLE_EQ(points.back().value, 0.8);
+    EXPECT_EQ(engine_.activeCount(), 0u);
+}
+
+TEST_F(ParamRampEngineTest, ZeroDurationJumpsToTarget) {
+    ASSERT_TRUE(engine_.start(makeRamp(2, 0.9, 0.1, 0.0), 48000.0));
+
+    auto points = renderBlock(2);
+    ASSERT_EQ(points.size(), 2u);
+    EXPECT_DOUBLE_EQ(points[0].value, 0.9);
+    EXPECT_EQ(points[1].offset, 1);
+    EXPECT_DOUBLE_EQ(points[1].value, 0.1);
+}
+
+TEST_F(ParamRampEngineTest, RestartContinuesFromCurrentValue) {
+    ASSERT_TRUE(engine_.start(makeRamp(3, 0.0, 1.0, 128.0), 1000.0));
+    renderBlock(3);
+
+    // Half-way (0.5) — the new ramp's stale start value is ignored
+    ASSERT_TRUE(engine_.start(makeRamp(3, 1.0, 0.0, 64.0), 1000.0));
+    EXPECT_EQ(engine_.activeCount(), 1u);
+
+    auto points = renderBlock(3);
+    ASSERT_FALSE(points.empty());
+    EXPECT_DOUBLE_EQ(points.front().value, 0.5);
+    EXPECT_DOUBLE_EQ(points.back().value, 0.0);
+}
+
+TEST_F(ParamRampEngineTest, CancelStopsRamp) {
+    engine_.start(makeRamp(4, 0.0, 1.0, 1000.0), 1000.0);
+    engine_.start(makeRamp(5, 0.0, 1.0, 1000.0), 1000.0);
+    engine_.cancel(4);
+
+    EXPECT_EQ(engine_.activeCount(), 1u);
+    EXPECT_TRUE(renderBlock(4).empty());
+    EXPECT_FALSE(renderBlock(5).empty());
+}
+
+TEST_F(ParamRampEngineTest, RejectsRampsBeyondTableCapacity) {
+    for (size_t i = 0; i < ParamRampEngine::kMaxActiveRamps; ++i)
+        EXPECT_TRUE(engine_.start(makeRamp(static_cast<ParamID>(i), 0.0, 1.0, 100.0), 1000.0));
+    EXPECT_FALSE(engine_.start(makeRamp(999, 0.0, 1.0, 100.0), 1000.0));
+    // An already running parameter can still be retargeted
+    EXPECT_TRUE(engine_.start(makeRamp(0, 0.0, 0.5, 100.0), 1000.0));
+}
+
+TEST_F(ParamRampEngineTest, CurveShapesIntermediatePoints) {
+    ASSERT_TRUE(engine_.start(makeRamp(6, 0.0, 1.0, 64.0, RampCurve::EaseIn), 1000.0));
+    auto points = renderBlock(6);
+
+    ASSERT_GE(points.size(), 3u);
+    const auto& mid = points[points.size() / 2];
+    EXPECT_NEAR(mid.value, applyRampCurve(RampCurve::EaseIn, mid.offset / 64.0), 1e-12);
+    EXPECT_LT(mid.value, mid.offset / 64.0);
+}
+
+// ============================================================
+// ramp_parameter handler
+// ============================================================
+
+class MCPRampParameterTest : public ::testing::Test {
+protected:
+    std::vector<ParamRamp> drainRamps() {
+        std::vector<ParamRamp> ramps;
+        ParamRamp ramp;
+        while (instance_.popParamRamp(ramp))
+            ramps.push_back(ramp);
+        return ramps;
+    }
+
+    void expectParam(ParamID id, ParamValue current) {
+        ParameterInfo info = {};
+        info.id = id;
+        EXPECT_CALL(mockCtrl_, getParameterCount()).WillRepeatedly(Return(1));
+        EXPECT_CALL(mockCtrl_, getParameterInfo(0, _))
+            .WillRepeatedly(DoAll(SetArgReferee<1>(info), Return(kResultOk)));
+        EXPECT_CALL(mockCtrl_, getParamNormalized(id)).WillRepeatedly(Return(current));
+    }
+
+    MockEditController mockCtrl_;
+    ParameterInfoCache cache_;
+    HostedPluginInstance instance_;
+};
+
+TEST_F(MCPRampParameterTest, NoPluginLoaded) {
+    auto result = handleRampParameter(nullptr, cache_, instance_, 1, 0.5, 100.0);
+    EXPECT_TRUE(result["isError"].get<bool>());
+}
+
+TEST_F(MCPRampParameterTest, QueuesRampFromCurrentValue) {
+    expectParam(7, 0.2);
+    EXPECT_CALL(mockCtrl_, setParamNormalized(7, 0.9)).WillOnce(Return(kResultOk));
+
+    auto result = handleRampParameter(&mockCtrl_, cache_, instance_, 7, 0.9, 250.0, "s_curve");
+    ASSERT_FALSE(result.contains("isError"));
+    auto data = mcp::json::parse(result["content"][0]["text"].get<std::string>());
+    EXPECT_DOUBLE_EQ(data["startValue"].get<double>(), 0.2);
+    EXPECT_EQ(data["curve"].get<std::string>(), "s_curve");
+
+    auto ramps = drainRamps();
+    ASSERT_EQ(ramps.size(), 1u);
+    EXPECT_EQ(ramps[0].id, 7u);
+    EXPECT_DOUBLE_EQ(ramps[0].startValue, 0.2);
+    EXPECT_DOUBLE_EQ(ramps[0].targetValue, 0.9);
+    EXPECT_DOUBLE_EQ(ramps[0].durationMs, 250.0);
+    EXPECT_EQ(ramps[0].curve, RampCurve::SCurve);
+}
+
+TEST_F(MCPRampParameterTest, RejectsInvalidArguments) {
+    expectParam(7, 0.2);
+    EXPECT_CALL(mockCtrl_, setParamNormalized(_, _)).Times(0);
+
+    EXPECT_TRUE(handleRampParameter(&mockCtrl_, cache_, instance_, 8, 0.5, 100.0)["isError"].get<bool>());
+    EXPECT_TRUE(handleRampParameter(&mockCtrl_, cache_, instance_, 7, std::nan(""), 100.0)["isError"].get<bool>());
+    EXPECT_TRUE(handleRampParameter(&mockCtrl_, cache_, instance_, 7, 0.5, -1.0)["isError"].get<bool>());
+    EXPECT_TRUE(handleRampParameter(&mockCtrl_, cache_, instance_, 7, 0.5, kMaxRampDurationMs + 1)["isError"].get<bool>());
+    EXPECT_TRUE(handleRampParameter(&mockCtrl_, cache_, instance_, 7, 0.5, 100.0, "bounce")["isError"].get<bool>());
+    EXPECT_TRUE(drainRamps().empty());
+}
+
+TEST_F(MCPRampParameterTest, ReportsFullRampQueue) {
+    expectParam(7, 0.2);
+    EXPECT_CALL(mockCtrl_, setParamNormalized(7, _)).WillRepeatedly(Return(kResultOk));
+
+    for (size_t i = 0; i < HostedPluginInstance::kRampQueueCapacity; ++i)
+        ASSERT_FALSE(handleRampParameter(&mockCtrl_, cache_, instance_, 7, 0.5, 10.0).contains("isError"));
+    auto result = handleRampParameter(&mockCtrl_, cache_, instance_, 7, 0.5, 10.0);
+    EXPECT_TRUE(result["isError"].get<bool>());
+}
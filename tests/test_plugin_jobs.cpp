@@ -0,0 +1,285 @@
+/**
+ * @file test_plugin_jobs.cpp
+ * @brief Tests for asynchronous load_plugin/unload_plugin jobs: job state and
+ * phases, cancellation before the swap point, the job queue, and the MCP
+ * handlers for get_job_status and cancel_job.
+ */
+
+#include <gtest/gtest.h>
+
+#include "controller.h"
+#include "hostedplugin.h"
+#include "helpers/controller_test_access.h"
+#include "mcp_plugin_handlers.h"
+#include "pluginjobs.h"
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace VST3MCPWrapper;
+
+namespace {
+
+mcp::json parseText(const mcp::json& result) {
+    return mcp::json::parse(result["content"][0]["text"].get<std::string>());
+}
+
+// Block until the job has finished (the queue runs it on its own thread).
+void waitFinished(const std::shared_ptr<PluginJob>& job) {
+    for (int i = 0; i < 400 && !job->isFinished(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(job->isFinished());
+}
+
+} // namespace
+
+// ============================================================
+// PluginJob
+// ============================================================
+
+TEST(PluginJobTest, ReportsPhasesAndSuccess) {
+    PluginJob job(7, "load", "/plugins/A.vst3");
+    EXPECT_EQ(job.status().state, PluginJobState::Queued);
+
+    EXPECT_TRUE(job.enterPhase(PluginJobPhase::ModuleOpen));
+    EXPECT_EQ(job.status().state, PluginJobState::Running);
+    EXPECT_EQ(job.status().phase, PluginJobPhase::ModuleOpen);
+
+    EXPECT_TRUE(job.beginSwap());
+    EXPECT_TRUE(job.enterPhase(PluginJobPhase::StateSync));
+    job.finish({});
+
+    auto status = job.status();
+    EXPECT_EQ(status.id, 7u);
+    EXPECT_EQ(status.state, PluginJobState::Succeeded);
+    EXPECT_EQ(status.phase, PluginJobPhase::Done);
+    EXPECT_TRUE(job.isFinished());
+
+    job.finish("late error");
+    EXPECT_EQ(job.status().state, PluginJobState::Succeeded) << "first outcome sticks";
+}
+
+TEST(PluginJobTest, FailureKeepsPhaseAndError) {
+    PluginJob job(1, "load", "/plugins/A.vst3");
+    job.enterPhase(PluginJobPhase::ModuleOpen);
+    job.finish("Module not found");
+
+    auto status = job.status();
+    EXPECT_EQ(status.state, PluginJobState::Failed);
+    EXPECT_EQ(status.phase, PluginJobPhase::ModuleOpen);
+    EXPECT_EQ(status.error, "Module not found");
+}
+
+TEST(PluginJobTest, CancelBeforeSwapStopsTheJob) {
+    PluginJob job(1, "load", "/plugins/A.vst3");
+    job.enterPhase(PluginJobPhase::ModuleOpen);
+
+    EXPECT_TRUE(job.requestCancel());
+    EXPECT_TRUE(job.isCancelled());
+    EXPECT_FALSE(job.enterPhase(PluginJobPhase::ComponentInit));
+    EXPECT_FALSE(job.beginSwap());
+
+    job.finish("Load cancelled");
+    EXPECT_EQ(job.status().state, PluginJobState::Cancelled);
+    EXPECT_TRUE(job.status().error.empty());
+}
+
+TEST(PluginJobTest, CancelIsRefusedAfterSwap) {
+    PluginJob job(1, "load", "/plugins/A.vst3");
+    job.enterPhase(PluginJobPhase::ModuleOpen);
+    ASSERT_TRUE(job.beginSwap());
+
+    EXPECT_FALSE(job.requestCancel());
+    EXPECT_FALSE(job.isCancelled());
+    EXPECT_TRUE(job.enterPhase(PluginJobPhase::ControllerSetup));
+    job.finish({});
+    EXPECT_EQ(job.status().state, PluginJobState::Succeeded);
+}
+
+TEST(PluginJobTest, CancelWhileQueuedFinishesImmediately) {
+    PluginJob job(1, "unload", "");
+    EXPECT_TRUE(job.requestCancel());
+    EXPECT_TRUE(job.isFinished());
+    EXPECT_EQ(job.status().state, PluginJobState::Cancelled);
+    EXPECT_FALSE(job.requestCancel()) << "finished jobs can't be cancelled again";
+}
+
+// ============================================================
+// PluginJobQueue
+// ============================================================
+
+TEST(PluginJobQueueTest, RunsJobsInSubmissionOrder) {
+    PluginJobQueue queue;
+    std::vector<uint64_t> order;
+    std::mutex orderMutex;
+    std::vector<std::shared_ptr<PluginJob>> submitted;
+    for (int i = 0; i < 5; ++i) {
+        submitted.push_back(queue.submit("load", "/p" + std::to_string(i), [&](const std::shared_ptr<PluginJob>& job) {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order.push_back(job->id());
+        }));
+    }
+    for (auto& job : submitted)
+        waitFinished(job);
+
+    ASSERT_EQ(order.size(), 5u);
+    for (size_t i = 0; i < order.size(); ++i)
+        EXPECT_EQ(order[i], submitted[i]->id());
+    for (auto& job : submitted)
+        EXPECT_EQ(job->status().state, PluginJobState::Succeeded) << "work() without finish() succeeds";
+}
+
+TEST(PluginJobQueueTest, SubmitReturnsWithoutWaitingForWork) {
+    PluginJobQueue queue;
+    std::promise<void> release;
+    auto gate = release.get_future().share();
+
+    auto start = std::chrono::steady_clock::now();
+    auto slow = queue.submit("load", "/slow", [gate](const std::shared_ptr<PluginJob>& job) {
+        job->enterPhase(PluginJobPhase::ModuleOpen);
+        gate.wait();
+    });
+    auto queued = queue.submit("load", "/next", [](const std::shared_ptr<PluginJob>&) {});
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+
+    for (int i = 0; i < 400 && slow->status().state != PluginJobState::Running; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(slow->status().phase, PluginJobPhase::ModuleOpen);
+    EXPECT_EQ(queued->status().state, PluginJobState::Queued);
+
+    // Cancelling the queued job means it never runs
+    EXPECT_TRUE(queued->requestCancel());
+    release.set_value();
+    waitFinished(slow);
+    EXPECT_EQ(queued->status().state, PluginJobState::Cancelled);
+}
+
+TEST(PluginJobQueueTest, ExceptionsFailTheJob) {
+    PluginJobQueue queue;
+    auto job = queue.submit("load", "/x", [](const std::shared_ptr<PluginJob>&) {
+        throw std::runtime_error("boom");
+    });
+    waitFinished(job);
+    EXPECT_EQ(job->status().state, PluginJobState::Failed);
+    EXPECT_EQ(job->status().error, "boom");
+}
+
+TEST(PluginJobQueueTest, EvictsOldestFinishedJobs) {
+    PluginJobQueue queue;
+    std::vector<std::shared_ptr<PluginJob>> submitted;
+    for (size_t i = 0; i < PluginJobQueue::kMaxFinishedJobs + 3; ++i)
+        submitted.push_back(queue.submit("unload", "", [](const std::shared_ptr<PluginJob>&) {}));
+    waitFinished(submitted.back());
+    // The retire step runs right after finish(); give it a moment
+    for (int i = 0; i < 200 && queue.find(submitted[2]->id()); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    EXPECT_EQ(queue.find(submitted[0]->id()), nullptr);
+    EXPECT_EQ(queue.find(submitted[2]->id()), nullptr);
+    EXPECT_EQ(queue.find(submitted[3]->id()), submitted[3]);
+    EXPECT_EQ(queue.find(submitted.back()->id()), submitted.back());
+}
+
+TEST(PluginJobQueueTest, StopCancelsQueuedJobsAndRejectsNewOnes) {
+    PluginJobQueue queue;
+    std::promise<void> release;
+    auto gate = release.get_future().share();
+    auto running = queue.submit("load", "/a", [&queue, gate](const std::shared_ptr<PluginJob>& job) {
+        job->enterPhase(PluginJobPhase::ModuleOpen);
+        while (gate.wait_for(std::chrono::milliseconds(5)) == std::future_status::timeout) {
+            if (queue.stopping()) {
+                job->finish("Plugin is shutting down");
+                return;
+            }
+        }
+    });
+    auto queued = queue.submit("load", "/b", [](const std::shared_ptr<PluginJob>&) {});
+    for (int i = 0; i < 400 && running->status().state != PluginJobState::Running; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    queue.stop();
+    EXPECT_EQ(running->status().state, PluginJobState::Failed);
+    EXPECT_EQ(queued->status().state, PluginJobState::Cancelled);
+    EXPECT_EQ(queue.submit("load", "/c", [](const std::shared_ptr<PluginJob>&) {}), nullptr);
+}
+
+// ============================================================
+// MCP handlers
+// ============================================================
+
+TEST(PluginJobHandlersTest, StatusJson) {
+    PluginJob job(3, "load", "/plugins/A.vst3");
+    job.enterPhase(PluginJobPhase::ModuleOpen);
+    job.finish("Module not found");
+
+    auto data = parseText(buildJobSubmittedResponse(job.status()));
+    EXPECT_EQ(data["jobId"].get<uint64_t>(), 3u);
+    EXPECT_EQ(data["operation"].get<std::string>(), "load");
+    EXPECT_EQ(data["path"].get<std::string>(), "/plugins/A.vst3");
+    EXPECT_EQ(data["state"].get<std::string>(), "failed");
+    EXPECT_EQ(data["phase"].get<std::string>(), "module_open");
+    EXPECT_EQ(data["error"].get<std::string>(), "Module not found");
+    EXPECT_TRUE(data.contains("elapsedMs"));
+}
+
+TEST(PluginJobHandlersTest, GetJobStatusAndCancel) {
+    PluginJobQueue queue;
+    std::promise<void> release;
+    auto gate = release.get_future().share();
+    auto first = queue.submit("load", "/a", [gate](const std::shared_ptr<PluginJob>&) { gate.wait(); });
+    auto second = queue.submit("load", "/b", [](const std::shared_ptr<PluginJob>&) {});
+
+    auto unknown = handleGetJobStatus(queue, 999);
+    EXPECT_TRUE(unknown["isError"].get<bool>());
+    EXPECT_TRUE(handleCancelJob(queue, 999)["isError"].get<bool>());
+
+    auto cancel = parseText(handleCancelJob(queue, second->id()));
+    EXPECT_TRUE(cancel["cancelled"].get<bool>());
+    EXPECT_EQ(cancel["state"].get<std::string>(), "cancelled");
+
+    release.set_value();
+    waitFinished(first);
+    auto status = parseText(handleGetJobStatus(queue, first->id()));
+    EXPECT_EQ(status["state"].get<std::string>(), "succeeded");
+    EXPECT_EQ(status["phase"].get<std::string>(), "done");
+
+    auto refused = parseText(handleCancelJob(queue, first->id()));
+    EXPECT_FALSE(refused["cancelled"].get<bool>());
+    EXPECT_EQ(refused["state"].get<std::string>(), "succeeded");
+}
+
+// ============================================================
+// Controller integration
+// ============================================================
+
+TEST(PluginJobControllerTest, CancelledJobLeavesCurrentPluginAlone) {
+    auto* controller = new Controller();
+
+    PluginJob job(1, "load", "/nonexistent/Cancelled.vst3");
+    job.enterPhase(PluginJobPhase::ModuleOpen);
+    job.requestCancel();
+
+    EXPECT_EQ(controller->loadPlugin("/nonexistent/Cancelled.vst3", &job), "Load cancelled");
+    EXPECT_FALSE(controller->getHostedInstance()->isLoaded());
+    EXPECT_TRUE(ControllerTestAccess::currentPluginPath(*controller).empty());
+
+    job.finish("Load cancelled");
+    EXPECT_EQ(job.status().state, PluginJobState::Cancelled);
+    controller->release();
+}
+
+TEST(PluginJobControllerTest, FailedLoadReportsErrorAfterSwap) {
+    auto* controller = new Controller();
+
+    PluginJob job(1, "load", "/nonexistent/Missing.vst3");
+    job.enterPhase(PluginJobPhase::ModuleOpen);
+
+    auto error = controller->loadPlugin("/nonexistent/Missing.vst3", &job, nullptr);
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(job.requestCancel()) << "the swap point was passed";
+    job.finish(error);
+    EXPECT_EQ(job.status().state, PluginJobState::Failed);
+    controller->release();
+}
@@ -0,0 +1,193 @@
+/**
+ * @file test_plugin_scan_cache.cpp
+ * @brief Tests for the persistent plugin scan index behind list_available_plugins.
+ *
+ * Bundles are fake directories under a temporary root with hand-written
+ * moduleinfo.json files; the path provider is a lambda over that root, so the
+ * tests never touch the real VST3 search paths.
+ */
+
+#include <gtest/gtest.h>
+
+#include "pluginscan.h"
+#include "mcp_plugin_handlers.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace VST3MCPWrapper;
+
+namespace {
+
+const char* kModuleInfo = R"({
+  // comments are allowed in moduleinfo.json
+  "Name": "Test Synth",
+  "Version": "1.2.3",
+  "Factory Info": { "Vendor": "Acme", "URL": "", "E-Mail": "" },
+  "Classes": [
+    {
+      "CID": "0123456789ABCDEF0123456789ABCDEF",
+      "Category": "Audio Module Class",
+      "Name": "Test Synth",
+      "Vendor": "Acme",
+      "Version": "1.2.3",
+      "Sub Categories": ["Instrument", "Synth"]
+    }
+  ]
+})";
+
+class PluginScanCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = fs::temp_directory_path() / ("vst3mcp_scan_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed())
+                                             + "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        fs::remove_all(root_);
+        fs::create_directories(root_ / "plugins");
+        indexPath_ = (root_ / "cache" / "plugin-index.json").string();
+    }
+
+    void TearDown() override {
+        fs::remove_all(root_);
+    }
+
+    fs::path makeBundle(const std::string& name, const char* moduleInfo = nullptr) {
+        fs::path bundle = root_ / "plugins" / (name + ".vst3");
+        fs::create_directories(bundle / "Contents" / "Resources");
+        if (moduleInfo)
+            std::ofstream(bundle / "Contents" / "Resources" / "moduleinfo.json") << moduleInfo;
+        return bundle;
+    }
+
+    PluginScanCache::PathProvider provider() {
+        return [this]() {
+            ++scans_;
+            std::vector<std::string> paths;
+            for (const auto& entry : fs::directory_iterator(root_ / "plugins"))
+                paths.push_back(entry.path().string());
+            return paths;
+        };
+    }
+
+    fs::path root_;
+    std::string indexPath_;
+    int scans_ = 0;
+};
+
+} // namespace
+
+TEST_F(PluginScanCacheTest, ReadsModuleInfoMetadata) {
+    makeBundle("Synth", kModuleInfo);
+    makeBundle("Bare");
+
+    PluginScanCache cache(indexPath_, provider());
+    auto plugins = cache.plugins();
+    ASSERT_EQ(plugins->size(), 2u);
+
+    const auto& bare = (*plugins)[0];
+    EXPECT_EQ(bare.name, "Bare");
+    EXPECT_FALSE(bare.hasModuleInfo);
+    EXPECT_TRUE(bare.classes.empty());
+
+    const auto& synth = (*plugins)[1];
+    EXPECT_TRUE(synth.hasModuleInfo);
+    EXPECT_EQ(synth.name, "Test Synth");
+    EXPECT_EQ(synth.vendor, "Acme");
+    EXPECT_EQ(synth.version, "1.2.3");
+    ASSERT_EQ(synth.classes.size(), 1u);
+    EXPECT_EQ(synth.classes[0].category, "Audio Module Class");
+    EXPECT_EQ(synth.classes[0].subCategories, (std::vector<std::string>{"Instrument", "Synth"}));
+}
+
+TEST_F(PluginScanCacheTest, AnswersFromMemoryAfterFirstScan) {
+    makeBundle("Synth", kModuleInfo);
+    PluginScanCache cache(indexPath_, provider());
+
+    auto first = cache.plugins();
+    auto second = cache.plugins();
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(scans_, 1);
+}
+
+TEST_F(PluginScanCacheTest, RefreshOnlyRereadsChangedBundles) {
+    makeBundle("A", kModuleInfo);
+    makeBundle("B", kModuleInfo);
+    PluginScanCache cache(indexPath_, provider());
+
+    EXPECT_EQ(cache.refresh(), 2u);
+    EXPECT_EQ(cache.refresh(), 0u) << "unchanged bundles must come from the index";
+
+    // Rewrite B's moduleinfo with a different size
+    std::ofstream(root_ / "plugins" / "B.vst3" / "Contents" / "Resources" / "moduleinfo.json")
+        << R"({"Name": "B v2"})";
+    EXPECT_EQ(cache.refresh(), 1u);
+    EXPECT_EQ((*cache.plugins())[1].name, "B v2");
+
+    fs::remove_all(root_ / "plugins" / "A.vst3");
+    EXPECT_EQ(cache.refresh(), 0u);
+    ASSERT_EQ(cache.plugins()->size(), 1u);
+    EXPECT_EQ((*cache.plugins())[0].name, "B v2");
+}
+
+TEST_F(PluginScanCacheTest, IndexPersistsAcrossInstances) {
+    makeBundle("Synth", kModuleInfo);
+    {
+        PluginScanCache cache(indexPath_, provider());
+        cache.refresh();
+    }
+    ASSERT_TRUE(fs::exists(indexPath_));
+
+    // A new cache answers from the index on disk without scanning
+    PluginScanCache reloaded(indexPath_, provider());
+    int scansBefore = scans_;
+    auto plugins = reloaded.plugins();
+    EXPECT_EQ(scans_, scansBefore);
+    ASSERT_EQ(plugins->size(), 1u);
+    EXPECT_EQ((*plugins)[0].vendor, "Acme");
+
+    // ...and a refresh against the loaded index re-reads nothing
+    EXPECT_EQ(reloaded.refresh(), 0u);
+}
+
+TEST_F(PluginScanCacheTest, CorruptIndexIsIgnored) {
+    fs::create_directories(fs::path(indexPath_).parent_path());
+    std::ofstream(indexPath_) << "{not json";
+    makeBundle("Synth", kModuleInfo);
+
+    PluginScanCache cache(indexPath_, provider());
+    EXPECT_EQ(cache.plugins()->size(), 1u);
+    EXPECT_EQ(scans_, 1);
+}
+
+TEST_F(PluginScanCacheTest, BackgroundRefreshPicksUpNewBundles) {
+    PluginScanCache cache(indexPath_, provider());
+    EXPECT_TRUE(cache.plugins()->empty());
+
+    makeBundle("Late", kModuleInfo);
+    cache.startBackgroundRefresh(std::chrono::milliseconds(5));
+    cache.startBackgroundRefresh(std::chrono::milliseconds(5)); // second user shares the thread
+
+    for (int i = 0; i < 400 && cache.plugins()->empty(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(cache.plugins()->size(), 1u);
+
+    cache.stopBackgroundRefresh();
+    cache.stopBackgroundRefresh();
+    cache.stopBackgroundRefresh(); // unbalanced stop is harmless
+}
+
+TEST_F(PluginScanCacheTest, HandlerListsMetadata) {
+    makeBundle("Synth", kModuleInfo);
+    makeBundle("Bare");
+    PluginScanCache cache(indexPath_, provider());
+
+    auto result = handleListAvailablePlugins(*cache.plugins());
+    auto list = mcp::json::parse(result["content"][0]["text"].get<std::string>());
+    ASSERT_EQ(list.size(), 2u);
+    EXPECT_EQ(list[0]["name"].get<std::string>(), "Bare");
+    EXPECT_FALSE(list[0].contains("classes"));
+    EXPECT_EQ(list[1]["vendor"].get<std::string>(), "Acme");
+    EXPECT_EQ(list[1]["classes"][0]["cid"].get<std::string>(), "0123456789ABCDEF0123456789ABCDEF");
+}
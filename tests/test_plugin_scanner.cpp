@@ -0,0 +1,236 @@
+/**
+ * @file test_plugin_scanner.cpp
+ * @brief Tests for the out-of-process plugin scanner and merging its results
+ * into the scan index.
+ *
+ * Workers are `/bin/sh -c <script> sh <bundle>` processes that imitate what
+ * `vst3mcp-scanner --scan-one` does for well-behaved, failing, crashing and
+ * hanging plugins, so no real plugin binary is loaded.
+ */
+
+#include <gtest/gtest.h>
+
+#include "pluginscan.h"
+#include "pluginscanner.h"
+#include "mcp_plugin_handlers.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace VST3MCPWrapper;
+
+namespace {
+
+OutOfProcessScanner::Options shellWorker(const std::string& script, size_t jobs = 4,
+                                         std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+    OutOfProcessScanner::Options options;
+    options.workerCommand = {"/bin/sh", "-c", script, "sh"};
+    options.jobs = jobs;
+    options.timeout = timeout;
+    return options;
+}
+
+// Echo a minimal successful scan result for the bundle in $1
+const char* kOkWorker =
+    R"(printf '{"path":"%s","name":"Scanned","vendor":"Acme","scanStatus":"ok",)"
+    R"("classes":[{"cid":"00","name":"Scanned","category":"Audio Module Class",)"
+    R"("buses":[{"name":"Out","mediaType":"audio","direction":"output","busType":"main","channelCount":2}]}]}\n' "$1")";
+
+std::map<std::string, ScannedPlugin> byPath(const std::vector<ScannedPlugin>& results) {
+    std::map<std::string, ScannedPlugin> map;
+    for (const auto& result : results)
+        map[result.path] = result;
+    return map;
+}
+
+} // namespace
+
+TEST(OutOfProcessScannerTest, ParsesWorkerResult) {
+    auto results = OutOfProcessScanner(shellWorker(kOkWorker)).run({"/plugins/A.vst3"});
+    ASSERT_EQ(results.size(), 1u);
+    const auto& result = results[0];
+    EXPECT_EQ(result.path, "/plugins/A.vst3");
+    EXPECT_EQ(result.scanStatus, "ok");
+    EXPECT_EQ(result.vendor, "Acme");
+    ASSERT_EQ(result.classes.size(), 1u);
+    ASSERT_EQ(result.classes[0].buses.size(), 1u);
+    EXPECT_EQ(result.classes[0].buses[0].direction, "output");
+    EXPECT_EQ(result.classes[0].buses[0].channelCount, 2);
+}
+
+TEST(OutOfProcessScannerTest, ReportsFailedCrashedAndTimedOutWorkers) {
+    const char* script =
+        R"(case "$1" in )"
+        R"(*fail*) echo '{"error":"Bad module"}'; exit 1;; )"
+        R"(*crash*) kill -SEGV $$;; )"
+        R"(*hang*) exec sleep 5;; )"
+        R"(*garbage*) echo 'not json';; )"
+        R"(esac)";
+    auto results = byPath(OutOfProcessScanner(shellWorker(script, 4, std::chrono::milliseconds(300)))
+                              .run({"fail.vst3", "crash.vst3", "hang.vst3", "garbage.vst3"}));
+    ASSERT_EQ(results.size(), 4u);
+
+    EXPECT_EQ(results["fail.vst3"].scanStatus, "failed");
+    EXPECT_EQ(results["fail.vst3"].scanError, "Bad module");
+    EXPECT_EQ(results["crash.vst3"].scanStatus, "crashed");
+    EXPECT_EQ(results["hang.vst3"].scanStatus, "timeout");
+    EXPECT_EQ(results["garbage.vst3"].scanStatus, "failed");
+}
+
+TEST(OutOfProcessScannerTest, RejectsResultForOtherBundle) {
+    auto results = OutOfProcessScanner(shellWorker(R"(echo '{"path":"/elsewhere.vst3"}')"))
+                       .run({"/plugins/A.vst3"});
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].path, "/plugins/A.vst3");
+    EXPECT_EQ(results[0].scanStatus, "failed");
+}
+
+TEST(OutOfProcessScannerTest, RunsWorkersInParallel) {
+    std::vector<std::string> bundles;
+    for (int i = 0; i < 8; ++i)
+        bundles.push_back("/plugins/" + std::to_string(i) + ".vst3");
+
+    int progressCalls = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto results = OutOfProcessScanner(shellWorker(std::string("sleep 0.3; ") + kOkWorker, 8))
+                       .run(bundles, [&](const ScannedPlugin&) { ++progressCalls; });
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(results.size(), bundles.size());
+    EXPECT_EQ(progressCalls, 8);
+    for (const auto& result : results)
+        EXPECT_EQ(result.scanStatus, "ok") << result.path;
+    // Serially this would take 2.4s
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1500));
+}
+
+TEST(OutOfProcessScannerTest, MissingWorkerExecutableFails) {
+    OutOfProcessScanner::Options options;
+    options.workerCommand = {"/nonexistent/vst3mcp-scanner", "--scan-one"};
+    auto results = OutOfProcessScanner(options).run({"A.vst3"});
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].scanStatus, "failed");
+}
+
+TEST(ScannedPluginJsonTest, RoundTripsBusesAndScanStatus) {
+    ScannedPlugin plugin;
+    plugin.path = "/plugins/A.vst3";
+    plugin.mtime = 42;
+    plugin.size = 7;
+    plugin.name = "A";
+    plugin.scanStatus = "ok";
+    ScannedPluginClass cls;
+    cls.cid = "00";
+    cls.subCategories = {"Fx"};
+    cls.buses.push_back({"Side", "audio", "input", "aux", 1});
+    plugin.classes.push_back(cls);
+
+    ScannedPlugin copy;
+    ASSERT_TRUE(scannedPluginFromJson(scannedPluginToJson(plugin), copy));
+    EXPECT_EQ(copy.mtime, 42);
+    EXPECT_EQ(copy.scanStatus, "ok");
+    ASSERT_EQ(copy.classes.size(), 1u);
+    EXPECT_EQ(copy.classes[0].subCategories, std::vector<std::string>{"Fx"});
+    ASSERT_EQ(copy.classes[0].buses.size(), 1u);
+    EXPECT_EQ(copy.classes[0].buses[0].name, "Side");
+    EXPECT_EQ(copy.classes[0].buses[0].busType, "aux");
+    EXPECT_EQ(copy.classes[0].buses[0].channelCount, 1);
+
+    EXPECT_FALSE(scannedPluginFromJson(mcp::json{{"name", "no path"}}, copy));
+}
+
+class ScanResultMergeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = fs::temp_directory_path() / ("vst3mcp_scanner_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed())
+                                             + "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        fs::remove_all(root_);
+        fs::create_directories(root_ / "plugins");
+        indexPath_ = (root_ / "plugin-index.json").string();
+    }
+
+    void TearDown() override {
+        fs::remove_all(root_);
+    }
+
+    std::string makeBundle(const std::string& name) {
+        fs::path bundle = root_ / "plugins" / (name + ".vst3");
+        fs::create_directories(bundle / "Contents");
+        return bundle.string();
+    }
+
+    PluginScanCache::PathProvider provider() {
+        return [this]() {
+            std::vector<std::string> paths;
+            for (const auto& entry : fs::directory_iterator(root_ / "plugins"))
+                paths.push_back(entry.path().string());
+            return paths;
+        };
+    }
+
+    fs::path root_;
+    std::string indexPath_;
+};
+
+TEST_F(ScanResultMergeTest, OkResultsReplaceMetadataAndFailuresOnlyRecordStatus) {
+    auto a = makeBundle("A");
+    auto b = makeBundle("B");
+    PluginScanCache cache(indexPath_, provider());
+    cache.refresh();
+
+    ScannedPlugin ok;
+    ok.path = a;
+    ok.name = "Plugin A";
+    ok.vendor = "Acme";
+    ok.scanStatus = "ok";
+    ok.classes.push_back({"00", "Plugin A", "Audio Module Class", {}, "Acme", "1.0", {{"Out", "audio", "output", "main", 2}}});
+    ScannedPlugin crashed;
+    crashed.path = b;
+    crashed.scanStatus = "crashed";
+    crashed.scanError = "Worker terminated by signal 11";
+    cache.applyScanResults({ok, crashed});
+
+    auto plugins = cache.plugins();
+    ASSERT_EQ(plugins->size(), 2u);
+    EXPECT_EQ((*plugins)[0].name, "Plugin A");
+    EXPECT_NE((*plugins)[0].mtime, 0) << "stamp from the index is kept";
+    EXPECT_EQ((*plugins)[1].name, "B");
+    EXPECT_EQ((*plugins)[1].scanStatus, "crashed");
+
+    // Unchanged bundles keep their scan results across refreshes
+    EXPECT_EQ(cache.refresh(), 0u);
+    EXPECT_EQ((*cache.plugins())[0].vendor, "Acme");
+
+    auto list = mcp::json::parse(handleListAvailablePlugins(*cache.plugins())["content"][0]["text"].get<std::string>());
+    EXPECT_EQ(list[0]["vendor"].get<std::string>(), "Acme");
+    EXPECT_EQ(list[0]["classes"][0]["buses"][0]["channelCount"].get<int>(), 2);
+    EXPECT_EQ(list[0]["scanStatus"].get<std::string>(), "ok");
+    EXPECT_FALSE(list[1].contains("classes"));
+    EXPECT_EQ(list[1]["scanError"].get<std::string>(), "Worker terminated by signal 11");
+}
+
+TEST_F(ScanResultMergeTest, RefreshPicksUpIndexWrittenByScanner) {
+    auto a = makeBundle("A");
+    PluginScanCache wrapper(indexPath_, provider());
+    wrapper.refresh();
+    EXPECT_TRUE((*wrapper.plugins())[0].scanStatus.empty());
+
+    // The scanner process works on its own cache over the same index file
+    {
+        PluginScanCache scanner(indexPath_, provider());
+        ScannedPlugin ok;
+        ok.path = a;
+        ok.name = "Scanned A";
+        ok.scanStatus = "ok";
+        scanner.applyScanResults({ok});
+    }
+
+    wrapper.refresh();
+    EXPECT_EQ((*wrapper.plugins())[0].name, "Scanned A");
+    EXPECT_EQ((*wrapper.plugins())[0].scanStatus, "ok");
+}
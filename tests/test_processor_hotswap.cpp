@@ -0,0 +1,374 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "crossfade.h"
+#include "processor.h"
+#include "hostedplugin.h"
+#include "messageids.h"
+#include "helpers/processor_test_access.h"
+#include "mocks/mock_vst3.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace {
+
+constexpr int kChannels = 2;
+constexpr int kBlock = 128;
+constexpr double kSampleRate = 48000.0; // 10 ms fade = 480 samples
+
+struct StereoBuffers {
+    std::vector<std::vector<float>> samples;
+    std::vector<float*> ptrs;
+    AudioBusBuffers bus{};
+
+    explicit StereoBuffers (int numSamples, float value = 0.0f)
+        : samples (kChannels, std::vector<float> (numSamples, value)), ptrs (kChannels)
+    {
+        for (int ch = 0; ch < kChannels; ++ch)
+            ptrs[ch] = samples[ch].data ();
+        bus.numChannels = kChannels;
+        bus.channelBuffers32 = ptrs.data ();
+    }
+};
+
+// Hosted processor whose output is a constant, or its input (passthrough).
+void renderConstant (MockAudioProcessor& proc, float value)
+{
+    ON_CALL (proc, process (_)).WillByDefault (Invoke ([value] (ProcessData& data) {
+        for (int ch = 0; ch < data.outputs[0].numChannels; ++ch)
+            for (int s = 0; s < data.numSamples; ++s)
+                data.outputs[0].channelBuffers32[ch][s] = value;
+        return kResultOk;
+    }));
+}
+
+void renderPassthrough (MockAudioProcessor& proc)
+{
+    ON_CALL (proc, process (_)).WillByDefault (Invoke ([] (ProcessData& data) {
+        for (int ch = 0; ch < data.outputs[0].numChannels; ++ch)
+            for (int s = 0; s < data.numSamples; ++s)
+                data.outputs[0].channelBuffers32[ch][s] = data.inputs[0].channelBuffers32[ch][s];
+        return kResultOk;
+    }));
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+// Crossfade gain curve
+//------------------------------------------------------------------------
+TEST (CrossfadeTest, GainsAreEqualPower)
+{
+    double out, in;
+    crossfadeGains (0.0, out, in);
+    EXPECT_DOUBLE_EQ (out, 1.0);
+    EXPECT_NEAR (in, 0.0, 1e-12);
+
+    crossfadeGains (1.0, out, in);
+    EXPECT_NEAR (out, 0.0, 1e-12);
+    EXPECT_DOUBLE_EQ (in, 1.0);
+
+    for (double t = 0.0; t <= 1.0; t += 0.05) {
+        crossfadeGains (t, out, in);
+        EXPECT_NEAR (out * out + in * in, 1.0, 1e-12) << "t=" << t;
+    }
+
+    crossfadeGains (2.0, out, in); // clamped
+    EXPECT_DOUBLE_EQ (in, 1.0);
+}
+
+TEST (CrossfadeTest, RejectsBlocksLargerThanPrepared)
+{
+    Crossfade fade;
+    fade.prepare (kChannels, kBlock, kSample32, 480);
+
+    StereoBuffers buffers (kBlock * 2);
+    ProcessData data{};
+    data.symbolicSampleSize = kSample32;
+    data.numOutputs = 1;
+    data.outputs = &buffers.bus;
+    data.numSamples = kBlock;
+    EXPECT_TRUE (fade.fits (data));
+    data.numSamples = kBlock * 2;
+    EXPECT_FALSE (fade.fits (data));
+    data.numSamples = kBlock;
+    data.symbolicSampleSize = kSample64;
+    EXPECT_FALSE (fade.fits (data));
+}
+
+//------------------------------------------------------------------------
+// Processor hot swap
+//------------------------------------------------------------------------
+class ProcessorHotSwapTest : public ::testing::Test {
+protected:
+    void SetUp () override
+    {
+        processor_ = new Processor ();
+        ASSERT_EQ (processor_->initialize (nullptr), kResultOk);
+
+        ProcessSetup setup{kRealtime, kSample32, kBlock, kSampleRate};
+        processor_->setupProcessing (setup);
+        processor_->setActive (true);
+        processor_->setProcessing (true);
+
+        // Outgoing plugin, playing
+        ProcessorTestAccess::setHostedComponent (*processor_, &oldComponent_);
+        ProcessorTestAccess::setHostedProcessor (*processor_, &oldProcessor_);
+        ProcessorTestAccess::setHostedActive (*processor_, true);
+        ProcessorTestAccess::setHostedProcessing (*processor_, true);
+        ProcessorTestAccess::setProcessorReady (*processor_, true);
+    }
+
+    void TearDown () override
+    {
+        ProcessorTestAccess::setHostedComponent (*processor_, nullptr);
+        ProcessorTestAccess::setHostedProcessor (*processor_, nullptr);
+        // A committed swap hands the incoming component to the module
+        processor_->getHostedInstance ().setHostedComponent (nullptr);
+        processor_->terminate ();
+        processor_->release ();
+    }
+
+    // Run one block of input, returning the output
+    StereoBuffers runBlock (int numSamples = kBlock, float input = 0.25f)
+    {
+        StereoBuffers in (numSamples, input);
+        StereoBuffers out (numSamples);
+        ProcessData data{};
+        data.numSamples = numSamples;
+        data.symbolicSampleSize = kSample32;
+        data.numInputs = 1;
+        data.numOutputs = 1;
+        data.inputs = &in.bus;
+        data.outputs = &out.bus;
+        EXPECT_EQ (processor_->process (data), kResultOk);
+        return out;
+    }
+
+    Processor* processor_ = nullptr;
+    NiceMock<MockComponent> oldComponent_, newComponent_;
+    NiceMock<MockAudioProcessor> oldProcessor_, newProcessor_;
+};
+
+TEST_F (ProcessorHotSwapTest, CrossfadesFromOldToNew)
+{
+    renderConstant (oldProcessor_, 1.0f);
+    renderConstant (newProcessor_, -1.0f);
+    EXPECT_TRUE (ProcessorTestAccess::canHotSwap (*processor_));
+
+    ProcessorTestAccess::beginHotSwap (*processor_, &newComponent_, &newProcessor_);
+    EXPECT_FALSE (ProcessorTestAccess::canHotSwap (*processor_)) << "one swap at a time";
+
+    // 480-sample fade over 128-sample blocks: both plugins run for 4 blocks
+    EXPECT_CALL (oldProcessor_, process (_)).Times (4);
+    EXPECT_CALL (newProcessor_, process (_)).Times (5);
+
+    std::vector<float> rendered;
+    for (int block = 0; block < 4; ++block) {
+        auto out = runBlock ();
+        rendered.insert (rendered.end (), out.samples[0].begin (), out.samples[0].end ());
+    }
+    EXPECT_TRUE (ProcessorTestAccess::swapFinished (*processor_));
+
+    // Starts at the old plugin's level, ends at the new one's, crosses zero
+    // at the midpoint, and never jumps between adjacent samples
+    EXPECT_NEAR (rendered.front (), 1.0f, 5e-3);
+    EXPECT_NEAR (rendered[479], -1.0f, 5e-3);
+    EXPECT_NEAR (rendered[240], 0.0f, 0.01f);
+    for (size_t i = 1; i < rendered.size (); ++i)
+        EXPECT_LT (std::fabs (rendered[i] - rendered[i - 1]), 0.01f) << "at " << i;
+
+    // Before the message thread commits, the audio thread already runs only the new plugin
+    auto after = runBlock ();
+    EXPECT_FLOAT_EQ (after.samples[1][0], -1.0f);
+
+    // Commit: the outgoing instance is retired off the audio thread
+    EXPECT_CALL (oldProcessor_, setProcessing (false)).Times (1);
+    EXPECT_CALL (oldComponent_, setActive (false)).Times (1);
+    EXPECT_CALL (oldComponent_, terminate ()).Times (1);
+    EXPECT_TRUE (ProcessorTestAccess::finishHotSwap (*processor_, std::chrono::milliseconds (0),
+                                                     std::chrono::milliseconds (0)));
+    EXPECT_TRUE (ProcessorTestAccess::swapIdle (*processor_));
+    EXPECT_EQ (ProcessorTestAccess::hostedProcessor (*processor_), &newProcessor_);
+    EXPECT_TRUE (ProcessorTestAccess::hostedActive (*processor_));
+    EXPECT_TRUE (ProcessorTestAccess::processorReady (*processor_));
+}
+
+TEST_F (ProcessorHotSwapTest, IncomingPluginSeesInputEvenWhenProcessingInPlace)
+{
+    renderConstant (oldProcessor_, 0.0f); // Overwrites the shared buffer
+    renderPassthrough (newProcessor_);
+    ProcessorTestAccess::beginHotSwap (*processor_, &newComponent_, &newProcessor_);
+
+    // Host buffer used as both input and output
+    StereoBuffers io (kBlock, 0.5f);
+    ProcessData data{};
+    data.numSamples = kBlock;
+    data.symbolicSampleSize = kSample32;
+    data.numInputs = 1;
+    data.numOutputs = 1;
+    data.inputs = &io.bus;
+    data.outputs = &io.bus;
+    ASSERT_EQ (processor_->process (data), kResultOk);
+
+    double gainOut, gainIn;
+    crossfadeGains ((kBlock - 0.5) / 480.0, gainOut, gainIn);
+    EXPECT_NEAR (io.samples[0][kBlock - 1], 0.5 * gainIn, 1e-5);
+
+    while (!ProcessorTestAccess::swapFinished (*processor_))
+        runBlock ();
+    EXPECT_TRUE (ProcessorTestAccess::finishHotSwap (*processor_, std::chrono::milliseconds (0),
+                                                     std::chrono::milliseconds (0)));
+}
+
+TEST_F (ProcessorHotSwapTest, IncomingPluginGetsNoParameterChangesDuringFade)
+{
+    renderConstant (oldProcessor_, 0.0f);
+    renderConstant (newProcessor_, 0.0f);
+    ProcessorTestAccess::beginHotSwap (*processor_, &newComponent_, &newProcessor_);
+
+    // The change was meant for the outgoing plugin's parameter 42
+    int32 outgoingChanges = 0;
+    ON_CALL (oldProcessor_, process (_)).WillByDefault (Invoke ([&outgoingChanges] (ProcessData& data) {
+        if (data.inputParameterChanges)
+            outgoingChanges += data.inputParameterChanges->getParameterCount ();
+        return kResultOk;
+    }));
+    ON_CALL (newProcessor_, process (_)).WillByDefault (Invoke ([] (ProcessData& data) {
+        EXPECT_TRUE (!data.inputParameterChanges || data.inputParameterChanges->getParameterCount () == 0);
+        return kResultOk;
+    }));
+
+    processor_->getHostedInstance ().pushParamChange (42, 0.75);
+    while (!ProcessorTestAccess::swapFinished (*processor_))
+        runBlock ();
+    EXPECT_EQ (outgoingChanges, 1);
+
+    EXPECT_TRUE (ProcessorTestAccess::finishHotSwap (*processor_, std::chrono::milliseconds (0),
+                                                     std::chrono::milliseconds (0)));
+}
+
+TEST_F (ProcessorHotSwapTest, OversizedBlockSwitchesWithoutFade)
+{
+    renderConstant (oldProcessor_, 1.0f);
+    renderConstant (newProcessor_, -1.0f);
+    ProcessorTestAccess::beginHotSwap (*processor_, &newComponent_, &newProcessor_);
+
+    EXPECT_CALL (oldProcessor_, process (_)).Times (0);
+    auto out = runBlock (kBlock * 2);
+    EXPECT_FLOAT_EQ (out.samples[0][0], -1.0f);
+    EXPECT_TRUE (ProcessorTestAccess::swapFinished (*processor_));
+    EXPECT_TRUE (ProcessorTestAccess::finishHotSwap (*processor_, std::chrono::milliseconds (0),
+                                                     std::chrono::milliseconds (0)));
+}
+
+TEST_F (ProcessorHotSwapTest, SwapWithoutAudioFallsBackToHardSwitch)
+{
+    ProcessorTestAccess::beginHotSwap (*processor_, &newComponent_, &newProcessor_);
+
+    // Nobody calls process(): the swap is withdrawn and done directly
+    EXPECT_CALL (oldComponent_, terminate ()).Times (1);
+    EXPECT_FALSE (ProcessorTestAccess::finishHotSwap (*processor_, std::chrono::milliseconds (5),
+                                                      std::chrono::milliseconds (5)));
+    EXPECT_TRUE (ProcessorTestAccess::swapIdle (*processor_));
+    EXPECT_EQ (ProcessorTestAccess::hostedProcessor (*processor_), &newProcessor_);
+    EXPECT_TRUE (ProcessorTestAccess::processorReady (*processor_));
+
+    // Audio afterwards goes to the new plugin only
+    renderConstant (newProcessor_, -1.0f);
+    EXPECT_CALL (oldProcessor_, process (_)).Times (0);
+    auto out = runBlock ();
+    EXPECT_FLOAT_EQ (out.samples[0][0], -1.0f);
+}
+
+TEST_F (ProcessorHotSwapTest, StalledFadeWaitsForRunningProcessCall)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool entered = false;
+    bool release = false;
+    std::atomic<bool> returned{false};
+
+    // The outgoing plugin hangs inside the first crossfade block
+    ON_CALL (oldProcessor_, process (_)).WillByDefault (Invoke ([&] (ProcessData&) {
+        std::unique_lock<std::mutex> lock (mutex);
+        entered = true;
+        cv.notify_all ();
+        cv.wait (lock, [&] { return release; });
+        return kResultOk;
+    }));
+    EXPECT_CALL (oldComponent_, terminate ()).WillOnce (Invoke ([&] {
+        EXPECT_TRUE (returned.load ()) << "outgoing instance released while in process()";
+        return kResultOk;
+    }));
+
+    ProcessorTestAccess::beginHotSwap (*processor_, &newComponent_, &newProcessor_);
+    std::thread audio ([&] {
+        runBlock ();
+        returned = true;
+    });
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+        cv.wait (lock, [&] { return entered; });
+    }
+
+    std::thread releaser ([&] {
+        std::this_thread::sleep_for (std::chrono::milliseconds (30));
+        std::lock_guard<std::mutex> lock (mutex);
+        release = true;
+        cv.notify_all ();
+    });
+    EXPECT_FALSE (ProcessorTestAccess::finishHotSwap (*processor_, std::chrono::milliseconds (1),
+                                                      std::chrono::milliseconds (5)));
+    audio.join ();
+    releaser.join ();
+    EXPECT_EQ (ProcessorTestAccess::hostedProcessor (*processor_), &newProcessor_);
+    EXPECT_TRUE (ProcessorTestAccess::processorReady (*processor_));
+}
+
+TEST_F (ProcessorHotSwapTest, FailedHotSwapKeepsCurrentPlugin)
+{
+    ProcessorTestAccess::setCurrentPluginPath (*processor_, "/plugins/current.vst3");
+    EXPECT_CALL (oldComponent_, terminate ()).Times (0);
+    EXPECT_CALL (oldComponent_, setActive (false)).Times (0);
+
+    MockMessage msg;
+    MockAttributeList attrs;
+    std::string path = "/nonexistent/next.vst3";
+    const void* data = path.data ();
+    uint32 size = static_cast<uint32> (path.size ());
+    EXPECT_CALL (msg, getMessageID ()).WillRepeatedly (Return (MessageIds::kLoadPlugin));
+    EXPECT_CALL (msg, getAttributes ()).WillRepeatedly (Return (&attrs));
+    EXPECT_CALL (attrs, getBinary (::testing::StrEq ("path"), _, _))
+        .WillOnce (::testing::DoAll (::testing::SetArgReferee<1> (data), ::testing::SetArgReferee<2> (size),
+                                     Return (kResultOk)));
+    EXPECT_EQ (processor_->notify (&msg), kResultOk);
+
+    EXPECT_EQ (ProcessorTestAccess::hostedProcessor (*processor_), &oldProcessor_);
+    EXPECT_EQ (ProcessorTestAccess::currentPluginPath (*processor_), "/plugins/current.vst3");
+    EXPECT_TRUE (ProcessorTestAccess::processorReady (*processor_));
+    EXPECT_TRUE (ProcessorTestAccess::swapIdle (*processor_));
+    EXPECT_EQ (processor_->getHostedInstance ().getHostedComponent (), &oldComponent_);
+    ::testing::Mock::VerifyAndClearExpectations (&oldComponent_);
+}
+
+TEST_F (ProcessorHotSwapTest, ColdLoadWhenNotProcessing)
+{
+    processor_->setProcessing (false);
+    EXPECT_FALSE (ProcessorTestAccess::canHotSwap (*processor_));
+}
@@ -8,6 +8,7 @@
 
 #include "public.sdk/source/vst/hosting/parameterchanges.h"
 
+#include <chrono>
 #include <cstring>
 #include <vector>
 
@@ -57,11 +58,6 @@ protected:
     {
         processor_ = new Processor ();
         ASSERT_EQ (processor_->initialize (nullptr), kResultOk);
-
-        // Drain any leftover param changes from other tests sharing the singleton
-        auto& pluginModule = HostedPluginModule::instance ();
-        std::vector<ParamChange> junk;
-        pluginModule.drainParamChanges (junk);
     }
 
     void TearDown () override
@@ -71,11 +67,6 @@ protected:
         ProcessorTestAccess::setHostedProcessor (*processor_, nullptr);
         processor_->terminate ();
         processor_->release ();
-
-        // Drain any param changes left by the test
-        auto& pluginModule = HostedPluginModule::instance ();
-        std::vector<ParamChange> junk;
-        pluginModule.drainParamChanges (junk);
     }
 
     Processor* processor_ = nullptr;
@@ -278,8 +269,8 @@ TEST_F (ProcessorProcessTest, ParamChangesInjectedIntoProcessData)
     TestAudioBuffers input (numChannels, numSamples, false);
     TestAudioBuffers output (numChannels, numSamples, false);
 
-    // Push parameter changes to the singleton queue
-    auto& pluginModule = HostedPluginModule::instance ();
+    // Push parameter changes to the processor's queue
+    auto& pluginModule = processor_->getHostedInstance ();
     pluginModule.pushParamChange (42, 0.75);
     pluginModule.pushParamChange (99, 0.25);
 
@@ -404,7 +395,7 @@ TEST_F (ProcessorProcessTest, OriginalInputParamChangesRestoredAfterProcess)
     TestAudioBuffers input (numChannels, numSamples, false);
     TestAudioBuffers output (numChannels, numSamples, false);
 
-    auto& pluginModule = HostedPluginModule::instance ();
+    auto& pluginModule = processor_->getHostedInstance ();
     pluginModule.pushParamChange (1, 0.5);
 
     MockAudioProcessor mockProc;
@@ -456,7 +447,7 @@ TEST_F (ProcessorProcessTest, MergesDawAndMcpChangesForDifferentParams)
     TestAudioBuffers output (numChannels, numSamples, false);
 
     // Push MCP parameter change (param 42)
-    auto& pluginModule = HostedPluginModule::instance ();
+    auto& pluginModule = processor_->getHostedInstance ();
     pluginModule.pushParamChange (42, 0.75);
 
     MockAudioProcessor mockProc;
@@ -548,7 +539,7 @@ TEST_F (ProcessorProcessTest, MergesDawAndMcpChangesForSameParam)
     TestAudioBuffers output (numChannels, numSamples, false);
 
     // Push MCP change for param 50
-    auto& pluginModule = HostedPluginModule::instance ();
+    auto& pluginModule = processor_->getHostedInstance ();
     pluginModule.pushParamChange (50, 0.90);
 
     MockAudioProcessor mockProc;
@@ -715,7 +706,7 @@ TEST_F (ProcessorProcessTest, OnlyMcpChangesWhenDawInputParamChangesNull)
     TestAudioBuffers output (numChannels, numSamples, false);
 
     // Push MCP changes
-    auto& pluginModule = HostedPluginModule::instance ();
+    auto& pluginModule = processor_->getHostedInstance ();
     pluginModule.pushParamChange (10, 0.55);
     pluginModule.pushParamChange (20, 0.15);
 
@@ -960,3 +951,301 @@ TEST_F (ProcessorProcessTest, HostedProcessorErrorIsPropagated)
     ProcessorTestAccess::setHostedProcessor (*processor_, nullptr);
     ProcessorTestAccess::setProcessorReady (*processor_, false);
 }
+
+//------------------------------------------------------------------------
+// A sweep queued between two blocks reaches the hosted plugin as one point
+//------------------------------------------------------------------------
+TEST_F (ProcessorProcessTest, CoalescesParameterSweepToOnePointPerBlock)
+{
+    const int numSamples = 64;
+    const int numChannels = 2;
+
+    TestAudioBuffers input (numChannels, numSamples, false);
+    TestAudioBuffers output (numChannels, numSamples, false);
+
+    auto& pluginModule = processor_->getHostedInstance ();
+    ASSERT_EQ (pluginModule.getParamQueueMode (), HostedPluginInstance::ParamQueueMode::Coalesce);
+    for (int i = 0; i <= 500; ++i)
+        pluginModule.pushParamChange (7, i / 500.0);
+    pluginModule.pushParamChange (8, 0.25);
+
+    MockAudioProcessor mockProc;
+    MockComponent mockComp;
+
+    ProcessorTestAccess::setHostedComponent (*processor_, &mockComp);
+    ProcessorTestAccess::setHostedProcessor (*processor_, &mockProc);
+    ProcessorTestAccess::setProcessorReady (*processor_, true);
+    ProcessorTestAccess::setHostedActive (*processor_, true);
+
+    bool verified = false;
+    EXPECT_CALL (mockProc, process (::testing::_))
+        .WillOnce ([&verified] (ProcessData& d) -> tresult {
+            auto* changes = d.inputParameterChanges;
+            EXPECT_NE (changes, nullptr);
+            if (!changes)
+                return kResultOk;
+
+            EXPECT_EQ (changes->getParameterCount (), 2);
+            auto* q0 = changes->getParameterData (0);
+            EXPECT_NE (q0, nullptr);
+            if (q0) {
+                EXPECT_EQ (q0->getParameterId (), 7u);
+                EXPECT_EQ (q0->getPointCount (), 1);
+                int32 sampleOffset;
+                ParamValue value;
+                EXPECT_EQ (q0->getPoint (0, sampleOffset, value), kResultOk);
+                EXPECT_DOUBLE_EQ (value, 1.0);
+            }
+            auto* q1 = changes->getParameterData (1);
+            EXPECT_NE (q1, nullptr);
+            if (q1) {
+                EXPECT_EQ (q1->getParameterId (), 8u);
+            }
+
+            verified = true;
+            return kResultOk;
+        });
+
+    ProcessData data{};
+    data.numSamples = numSamples;
+    data.symbolicSampleSize = kSample32;
+    data.numInputs = 1;
+    data.numOutputs = 1;
+    data.inputs = &input.bus;
+    data.outputs = &output.bus;
+
+    EXPECT_EQ (processor_->process (data), kResultOk);
+    EXPECT_TRUE (verified);
+
+    ProcessorTestAccess::setHostedComponent (*processor_, nullptr);
+    ProcessorTestAccess::setHostedProcessor (*processor_, nullptr);
+    ProcessorTestAccess::setProcessorReady (*processor_, false);
+}
+
+//------------------------------------------------------------------------
+// Timed MCP changes: placed at their sample offset, held until their block
+//------------------------------------------------------------------------
+class ProcessorTimedParamTest : public ProcessorProcessTest {
+protected:
+    struct Point {
+        ParamID id;
+        int32 offset;
+        ParamValue value;
+    };
+
+    void SetUp () override
+    {
+        ProcessorProcessTest::SetUp ();
+        ProcessorTestAccess::setHostedComponent (*processor_, &mockComp_);
+        ProcessorTestAccess::setHostedProcessor (*processor_, &mockProc_);
+        ProcessorTestAccess::setProcessorReady (*processor_, true);
+        ProcessorTestAccess::setHostedActive (*processor_, true);
+
+        EXPECT_CALL (mockProc_, process (::testing::_))
+            .WillRepeatedly ([this] (ProcessData& d) -> tresult {
+                blocks_.emplace_back ();
+                if (!d.inputParameterChanges)
+                    return kResultOk;
+                for (int32 i = 0; i < d.inputParameterChanges->getParameterCount (); ++i) {
+                    auto* q = d.inputParameterChanges->getParameterData (i);
+                    for (int32 p = 0; q && p < q->getPointCount (); ++p) {
+                        int32 offset;
+                        ParamValue value;
+                        q->getPoint (p, offset, value);
+                        blocks_.back ().push_back ({q->getParameterId (), offset, value});
+                    }
+                }
+                return kResultOk;
+            });
+    }
+
+    void TearDown () override
+    {
+        ProcessorTestAccess::setHostedComponent (*processor_, nullptr);
+        ProcessorTestAccess::setHostedProcessor (*processor_, nullptr);
+        ProcessorTestAccess::setProcessorReady (*processor_, false);
+        ProcessorProcessTest::TearDown ();
+    }
+
+    tresult processBlock (int64 projectSample, bool withContext = true,
+                          uint32 state = ProcessContext::kPlaying)
+    {
+        TestAudioBuffers input (2, kBlockSize, false);
+        TestAudioBuffers output (2, kBlockSize, false);
+        ProcessContext context{};
+        context.state = state;
+        context.sampleRate = 48000.0;
+        context.projectTimeSamples = projectSample;
+        // 120 bpm at 48 kHz: one quarter note is 24000 samples
+        context.tempo = 120.0;
+        context.cycleStartMusic = 0.0;
+        context.cycleEndMusic = 1.0;
+
+        ProcessData data{};
+        data.numSamples = kBlockSize;
+        data.symbolicSampleSize = kSample32;
+        data.numInputs = 1;
+        data.numOutputs = 1;
+        data.inputs = &input.bus;
+        data.outputs = &output.bus;
+        data.processContext = withContext ? &context : nullptr;
+        return processor_->process (data);
+    }
+
+    static constexpr int32 kBlockSize = 64;
+    MockAudioProcessor mockProc_;
+    MockComponent mockComp_;
+    std::vector<std::vector<Point>> blocks_;
+};
+
+TEST_F (ProcessorTimedParamTest, ProjectSampleInsideBlockLandsAtOffset)
+{
+    processor_->getHostedInstance ().pushParamChange (
+        ParamChange{5, 0.6, ParamChangeTiming::ProjectSample, 1000 + 37});
+
+    EXPECT_EQ (processBlock (1000), kResultOk);
+
+    ASSERT_EQ (blocks_.size (), 1u);
+    ASSERT_EQ (blocks_[0].size (), 1u);
+    EXPECT_EQ (blocks_[0][0].id, 5u);
+    EXPECT_EQ (blocks_[0][0].offset, 37);
+    EXPECT_DOUBLE_EQ (blocks_[0][0].value, 0.6);
+}
+
+TEST_F (ProcessorTimedParamTest, FutureChangeIsHeldUntilItsBlock)
+{
+    processor_->getHostedInstance ().pushParamChange (
+        ParamChange{6, 0.9, ParamChangeTiming::ProjectSample, 2 * kBlockSize + 3});
+
+    EXPECT_EQ (processBlock (0), kResultOk);
+    EXPECT_EQ (processBlock (kBlockSize), kResultOk);
+    EXPECT_EQ (processBlock (2 * kBlockSize), kResultOk);
+
+    ASSERT_EQ (blocks_.size (), 3u);
+    EXPECT_TRUE (blocks_[0].empty ());
+    EXPECT_TRUE (blocks_[1].empty ());
+    ASSERT_EQ (blocks_[2].size (), 1u);
+    EXPECT_EQ (blocks_[2][0].id, 6u);
+    EXPECT_EQ (blocks_[2][0].offset, 3);
+}
+
+TEST_F (ProcessorTimedParamTest, LateChangeLandsAtOffsetZero)
+{
+    processor_->getHostedInstance ().pushParamChange (
+        ParamChange{7, 0.1, ParamChangeTiming::ProjectSample, 10});
+
+    EXPECT_EQ (processBlock (5000), kResultOk);
+
+    ASSERT_EQ (blocks_[0].size (), 1u);
+    EXPECT_EQ (blocks_[0][0].offset, 0);
+}
+
+TEST_F (ProcessorTimedParamTest, ProjectSampleWithoutContextAppliesImmediately)
+{
+    processor_->getHostedInstance ().pushParamChange (
+        ParamChange{8, 0.2, ParamChangeTiming::ProjectSample, 1 << 30});
+
+    EXPECT_EQ (processBlock (0, false), kResultOk);
+
+    ASSERT_EQ (blocks_[0].size (), 1u);
+    EXPECT_EQ (blocks_[0][0].offset, 0);
+}
+
+TEST_F (ProcessorTimedParamTest, ProjectSampleWithStoppedTransportAppliesImmediately)
+{
+    processor_->getHostedInstance ().pushParamChange (
+        ParamChange{9, 0.4, ParamChangeTiming::ProjectSample, 10 * kBlockSize});
+
+    EXPECT_EQ (processBlock (0, true, 0), kResultOk);
+
+    ASSERT_EQ (blocks_[0].size (), 1u);
+    EXPECT_EQ (blocks_[0][0].id, 9u);
+    EXPECT_EQ (blocks_[0][0].offset, 0);
+    EXPECT_FALSE (processor_->getHostedInstance ().isTransportPlaying ());
+
+    // Nothing stays behind for when playback starts
+    EXPECT_EQ (processBlock (10 * kBlockSize), kResultOk);
+    EXPECT_TRUE (blocks_[1].empty ());
+    EXPECT_TRUE (processor_->getHostedInstance ().isTransportPlaying ());
+}
+
+TEST_F (ProcessorTimedParamTest, ProjectSamplePastTheCycleEndAppliesImmediately)
+{
+    constexpr uint32 kLooping = ProcessContext::kPlaying | ProcessContext::kCycleActive
+        | ProcessContext::kCycleValid | ProcessContext::kTempoValid;
+    auto& instance = processor_->getHostedInstance ();
+    instance.pushParamChange (ParamChange{10, 0.3, ParamChangeTiming::ProjectSample, 30000}); // Past the loop
+    instance.pushParamChange (ParamChange{11, 0.7, ParamChangeTiming::ProjectSample, 2 * kBlockSize});
+
+    EXPECT_EQ (processBlock (0, true, kLooping), kResultOk);
+
+    ASSERT_EQ (blocks_[0].size (), 1u);
+    EXPECT_EQ (blocks_[0][0].id, 10u);
+    EXPECT_EQ (blocks_[0][0].offset, 0);
+
+    // The one inside the loop still waits for its block
+    EXPECT_EQ (processBlock (2 * kBlockSize, true, kLooping), kResultOk);
+    ASSERT_EQ (blocks_[1].size (), 1u);
+    EXPECT_EQ (blocks_[1][0].id, 11u);
+}
+
+TEST_F (ProcessorTimedParamTest, SteadyClockChangeFarAheadIsHeld)
+{
+    auto now = std::chrono::duration_cast<std::chrono::nanoseconds> (
+        std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+    processor_->getHostedInstance ().pushParamChange (
+        ParamChange{9, 0.3, ParamChangeTiming::SteadyClock, now + 60'000'000'000LL});
+    processor_->getHostedInstance ().pushParamChange (
+        ParamChange{10, 0.4, ParamChangeTiming::SteadyClock, now - 1'000'000});
+
+    EXPECT_EQ (processBlock (0), kResultOk);
+
+    // Only the change whose time has passed is delivered
+    ASSERT_EQ (blocks_[0].size (), 1u);
+    EXPECT_EQ (blocks_[0][0].id, 10u);
+    EXPECT_EQ (blocks_[0][0].offset, 0);
+}
+
+//------------------------------------------------------------------------
+// Ramps queued via HostedPluginInstance are rendered across blocks
+//------------------------------------------------------------------------
+TEST_F (ProcessorTimedParamTest, RampRendersAcrossBlocksAndEndsOnTarget)
+{
+    ParamRamp ramp;
+    ramp.id = 11;
+    ramp.startValue = 0.0;
+    ramp.targetValue = 1.0;
+    ramp.durationMs = 2.0; // 96 samples at 48 kHz
+    ASSERT_TRUE (processor_->getHostedInstance ().pushParamRamp (ramp));
+
+    EXPECT_EQ (processBlock (0), kResultOk);
+    EXPECT_EQ (processBlock (kBlockSize), kResultOk);
+    EXPECT_EQ (processBlock (2 * kBlockSize), kResultOk);
+
+    ASSERT_EQ (blocks_.size (), 3u);
+    ASSERT_FALSE (blocks_[0].empty ());
+    EXPECT_DOUBLE_EQ (blocks_[0].front ().value, 0.0);
+    ASSERT_FALSE (blocks_[1].empty ());
+    EXPECT_EQ (blocks_[1].back ().offset, 32);
+    EXPECT_DOUBLE_EQ (blocks_[1].back ().value, 1.0);
+    EXPECT_TRUE (blocks_[2].empty ());
+}
+
+TEST_F (ProcessorTimedParamTest, ExplicitChangeCancelsRunningRamp)
+{
+    ParamRamp ramp;
+    ramp.id = 12;
+    ramp.targetValue = 1.0;
+    ramp.durationMs = 1000.0;
+    ASSERT_TRUE (processor_->getHostedInstance ().pushParamRamp (ramp));
+    EXPECT_EQ (processBlock (0), kResultOk);
+
+    processor_->getHostedInstance ().pushParamChange (12, 0.3);
+    EXPECT_EQ (processBlock (kBlockSize), kResultOk);
+    EXPECT_EQ (processBlock (2 * kBlockSize), kResultOk);
+
+    ASSERT_EQ (blocks_.size (), 3u);
+    ASSERT_EQ (blocks_[1].size (), 1u);
+    EXPECT_DOUBLE_EQ (blocks_[1][0].value, 0.3);
+    EXPECT_TRUE (blocks_[2].empty ());
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include "modulecache.h"
 #include "processor.h"
 #include "stateformat.h"
 #include "helpers/processor_test_access.h"
@@ -55,7 +56,7 @@ TEST_F (ProcessorStateTest, GetStateWritesValidHeader)
 
     uint32 version = 0;
     EXPECT_EQ (stream.read (&version, sizeof (version), &numRead), kResultOk);
-    EXPECT_EQ (version, 1u);
+    EXPECT_EQ (version, kStateVersionV2);
 }
 
 //------------------------------------------------------------------------
@@ -72,9 +73,9 @@ TEST_F (ProcessorStateTest, GetStateIncludesPluginPath)
 
     // Rewind and read back
     stream.seek (0, IBStream::kIBSeekSet, nullptr);
-    std::string readPath;
-    EXPECT_EQ (readStateHeader (&stream, readPath), kResultOk);
-    EXPECT_EQ (readPath, testPath);
+    WrapperState saved;
+    EXPECT_EQ (readWrapperState (&stream, saved), kResultOk);
+    EXPECT_EQ (saved.pluginPath, testPath);
 }
 
 //------------------------------------------------------------------------
@@ -88,9 +89,9 @@ TEST_F (ProcessorStateTest, GetStateWithNoPluginWritesEmptyPath)
     EXPECT_EQ (result, kResultOk);
 
     stream.seek (0, IBStream::kIBSeekSet, nullptr);
-    std::string readPath;
-    EXPECT_EQ (readStateHeader (&stream, readPath), kResultOk);
-    EXPECT_TRUE (readPath.empty ());
+    WrapperState saved;
+    EXPECT_EQ (readWrapperState (&stream, saved), kResultOk);
+    EXPECT_TRUE (saved.pluginPath.empty ());
 }
 
 //------------------------------------------------------------------------
@@ -163,9 +164,9 @@ TEST_F (ProcessorStateTest, SetStateGetStateRoundTripPreservesPath)
 
     // Read back and verify path matches
     readStream.seek (0, IBStream::kIBSeekSet, nullptr);
-    std::string readPath;
-    EXPECT_EQ (readStateHeader (&readStream, readPath), kResultOk);
-    EXPECT_EQ (readPath, testPath);
+    WrapperState saved;
+    EXPECT_EQ (readWrapperState (&readStream, saved), kResultOk);
+    EXPECT_EQ (saved.pluginPath, testPath);
 }
 
 //------------------------------------------------------------------------
@@ -243,3 +244,62 @@ TEST_F (ProcessorStateTest, SetStateWithNonexistentPluginReturnsOkAndPassesThrou
     EXPECT_FALSE (ProcessorTestAccess::processorReady (*processor_));
     EXPECT_TRUE (ProcessorTestAccess::currentPluginPath (*processor_).empty ());
 }
+
+//------------------------------------------------------------------------
+// setState() before activation (opening a project) only prefetches the
+// module; the plugin is loaded once the host needs it
+//------------------------------------------------------------------------
+TEST_F (ProcessorStateTest, SetStateBeforeActivationDefersLoad)
+{
+    const std::string fakePath = "/nonexistent/path/Deferred.vst3";
+    auto prefetches = ModuleCache::shared ().stats ().prefetches;
+
+    ResizableMemoryIBStream stream;
+    EXPECT_EQ (writeStateHeader (&stream, fakePath), kResultOk);
+    stream.seek (0, IBStream::kIBSeekSet, nullptr);
+
+    EXPECT_EQ (processor_->setState (&stream), kResultOk);
+    EXPECT_TRUE (ProcessorTestAccess::hasPendingRestore (*processor_));
+    EXPECT_EQ (ModuleCache::shared ().stats ().prefetches, prefetches + 1);
+
+    // Activation loads it (and the load fails: passthrough)
+    EXPECT_EQ (processor_->setActive (true), kResultOk);
+    EXPECT_FALSE (ProcessorTestAccess::hasPendingRestore (*processor_));
+    EXPECT_FALSE (ProcessorTestAccess::processorReady (*processor_));
+    processor_->setActive (false);
+}
+
+//------------------------------------------------------------------------
+// setState() while active (preset recall, undo) loads right away
+//------------------------------------------------------------------------
+TEST_F (ProcessorStateTest, SetStateWhileActiveLoadsImmediately)
+{
+    ASSERT_EQ (processor_->setActive (true), kResultOk);
+
+    ResizableMemoryIBStream stream;
+    EXPECT_EQ (writeStateHeader (&stream, "/nonexistent/path/Active.vst3"), kResultOk);
+    stream.seek (0, IBStream::kIBSeekSet, nullptr);
+
+    EXPECT_EQ (processor_->setState (&stream), kResultOk);
+    EXPECT_FALSE (ProcessorTestAccess::hasPendingRestore (*processor_));
+    processor_->setActive (false);
+}
+
+//------------------------------------------------------------------------
+// A newer state replaces one still waiting for its plugin
+//------------------------------------------------------------------------
+TEST_F (ProcessorStateTest, NewerStateReplacesPendingRestore)
+{
+    ResizableMemoryIBStream first;
+    EXPECT_EQ (writeStateHeader (&first, "/nonexistent/path/First.vst3"), kResultOk);
+    first.seek (0, IBStream::kIBSeekSet, nullptr);
+    EXPECT_EQ (processor_->setState (&first), kResultOk);
+    ASSERT_TRUE (ProcessorTestAccess::hasPendingRestore (*processor_));
+
+    ResizableMemoryIBStream second;
+    EXPECT_EQ (writeStateHeader (&second, ""), kResultOk);
+    second.seek (0, IBStream::kIBSeekSet, nullptr);
+    EXPECT_EQ (processor_->setState (&second), kResultOk);
+    EXPECT_FALSE (ProcessorTestAccess::hasPendingRestore (*processor_));
+    EXPECT_TRUE (ProcessorTestAccess::currentPluginPath (*processor_).empty ());
+}
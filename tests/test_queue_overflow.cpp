@@ -8,31 +8,25 @@ using namespace Steinberg::Vst;
 using namespace VST3MCPWrapper;
 
 //------------------------------------------------------------------------
-// Test fixture: resets the singleton param queue between tests
+// Test fixture: a fresh instance in FIFO mode per test
 //------------------------------------------------------------------------
 class QueueOverflowTest : public ::testing::Test {
 protected:
     void SetUp () override
     {
-        auto& pm = HostedPluginModule::instance ();
-        std::vector<ParamChange> drain;
-        pm.drainParamChanges (drain);
+        // Overflow only applies to the FIFO ring
+        instance_.setParamQueueMode (HostedPluginInstance::ParamQueueMode::Fifo);
     }
 
-    void TearDown () override
-    {
-        auto& pm = HostedPluginModule::instance ();
-        std::vector<ParamChange> drain;
-        pm.drainParamChanges (drain);
-    }
+    HostedPluginInstance instance_;
 };
 
 //------------------------------------------------------------------------
-// Filling the queue to kMaxParamQueueSize drops further changes
+// Filling the queue to kParamQueueCapacity drops further changes
 //------------------------------------------------------------------------
 TEST_F (QueueOverflowTest, OverflowDropsChanges)
 {
-    auto& pm = HostedPluginModule::instance ();
+    auto& pm = instance_;
 
     // Fill up to the max (10,000)
     for (size_t i = 0; i < 10000; ++i)
@@ -61,7 +55,7 @@ TEST_F (QueueOverflowTest, OverflowDropsChanges)
 //------------------------------------------------------------------------
 TEST_F (QueueOverflowTest, WarnOncePerOverflowEpisode)
 {
-    auto& pm = HostedPluginModule::instance ();
+    auto& pm = instance_;
 
     // Fill queue to max
     for (size_t i = 0; i < 10000; ++i)
@@ -69,7 +63,7 @@ TEST_F (QueueOverflowTest, WarnOncePerOverflowEpisode)
 
     // Push multiple overflow changes — only one warning should be logged.
     // We can't directly check stderr output, but we can verify the queue
-    // stays at exactly kMaxParamQueueSize (no extra changes sneak in).
+    // stays at exactly kParamQueueCapacity (no extra changes sneak in).
     pm.pushParamChange (1, 0.1);
     pm.pushParamChange (2, 0.2);
     pm.pushParamChange (3, 0.3);
@@ -84,7 +78,7 @@ TEST_F (QueueOverflowTest, WarnOncePerOverflowEpisode)
 //------------------------------------------------------------------------
 TEST_F (QueueOverflowTest, ReloadResetsOverflowFlag)
 {
-    auto& pm = HostedPluginModule::instance ();
+    auto& pm = instance_;
 
     // Fill queue to max and trigger overflow
     for (size_t i = 0; i < 10001; ++i)
@@ -110,3 +104,24 @@ TEST_F (QueueOverflowTest, ReloadResetsOverflowFlag)
     EXPECT_EQ (drain[0].id, 42u);
     EXPECT_DOUBLE_EQ (drain[0].value, 0.42);
 }
+
+//------------------------------------------------------------------------
+// Overflow policy is drop-newest: rejected pushes report false and are counted
+//------------------------------------------------------------------------
+TEST_F (QueueOverflowTest, RejectedPushesReturnFalseAndAreCounted)
+{
+    auto& pm = instance_;
+    auto droppedBefore = pm.getDroppedParamChangeCount ();
+
+    for (size_t i = 0; i < HostedPluginInstance::kParamQueueCapacity; ++i)
+        EXPECT_TRUE (pm.pushParamChange (static_cast<ParamID> (i), 0.5));
+
+    EXPECT_FALSE (pm.pushParamChange (1, 0.1));
+    EXPECT_FALSE (pm.pushParamChange (2, 0.2));
+    EXPECT_EQ (pm.getDroppedParamChangeCount (), droppedBefore + 2);
+
+    // Once drained, the queue accepts changes again
+    std::vector<ParamChange> changes;
+    pm.drainParamChanges (changes);
+    EXPECT_TRUE (pm.pushParamChange (3, 0.3));
+}
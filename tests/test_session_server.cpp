@@ -0,0 +1,322 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "controller.h"
+#include "messageids.h"
+#include "processor.h"
+#include "sessionserver.h"
+#include "mocks/mock_vst3.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Return;
+using ::testing::SetArgReferee;
+using ::testing::StrEq;
+
+namespace {
+
+mcp::json textResult(const mcp::json& body)
+{
+    return {{"content", {{{"type", "text"}, {"text", body.dump()}}}}};
+}
+
+mcp::json parseText(const mcp::json& result)
+{
+    return mcp::json::parse(result["content"][0]["text"].get<std::string>());
+}
+
+// A tool table with an "echo" tool that records which calls it saw
+std::shared_ptr<InstanceToolTable> makeEchoTable(std::vector<int>* seen = nullptr, std::mutex* seenMutex = nullptr)
+{
+    auto table = std::make_shared<InstanceToolTable> ();
+    table->add (mcp::tool_builder ("echo").build (),
+        [seen, seenMutex](const mcp::json& params, const std::string&) -> mcp::json {
+            if (seen) {
+                std::lock_guard<std::mutex> lock (*seenMutex);
+                seen->push_back (params.value ("n", -1));
+            }
+            return textResult (params);
+        });
+    return table;
+}
+
+mcp::json call(const std::string& instance, const std::string& tool, const mcp::json& arguments)
+{
+    return {{"instance", instance}, {"tool", tool}, {"arguments", arguments}};
+}
+
+} // namespace
+
+// ============================================================
+// InstanceToolTable
+// ============================================================
+
+TEST (InstanceToolTable, CallsHandlerByName)
+{
+    auto table = makeEchoTable ();
+    auto result = table->call ("echo", {{"n", 1}}, "");
+    EXPECT_FALSE (result.value ("isError", false));
+    EXPECT_EQ (parseText (result)["n"], 1);
+
+    result = table->call ("missing", mcp::json::object (), "");
+    EXPECT_TRUE (result.value ("isError", false));
+}
+
+TEST (InstanceToolTable, CallsFailAfterClose)
+{
+    auto table = makeEchoTable ();
+    table->setDescriber ([] { return mcp::json {{"pluginPath", "/a.vst3"}}; });
+    table->close ();
+
+    EXPECT_TRUE (table->call ("echo", mcp::json::object (), "").value ("isError", false));
+    EXPECT_TRUE (table->describe ().empty ());
+}
+
+TEST (InstanceToolTable, CloseWaitsForRunningCall)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool entered = false;
+    bool release = false;
+    std::atomic<bool> finished {false};
+
+    auto table = std::make_shared<InstanceToolTable> ();
+    table->add (mcp::tool_builder ("slow").build (), [&](const mcp::json&, const std::string&) -> mcp::json {
+        std::unique_lock<std::mutex> lock (mutex);
+        entered = true;
+        cv.notify_all ();
+        cv.wait (lock, [&] { return release; });
+        finished = true;
+        return textResult (mcp::json::object ());
+    });
+
+    std::thread caller ([&] { table->call ("slow", mcp::json::object (), ""); });
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+        cv.wait (lock, [&] { return entered; });
+    }
+    std::thread closer ([&] {
+        table->close ();
+        EXPECT_TRUE (finished.load ());
+    });
+    std::this_thread::sleep_for (std::chrono::milliseconds (20));
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        release = true;
+    }
+    cv.notify_all ();
+    caller.join ();
+    closer.join ();
+}
+
+// ============================================================
+// SessionServer routing
+// ============================================================
+
+TEST (SessionServer, ListInstancesIncludesDescriptionAndTools)
+{
+    SessionServer session;
+    auto table = makeEchoTable ();
+    table->setDescriber ([] { return mcp::json {{"pluginPath", "/a.vst3"}}; });
+    session.attach ("a", table);
+
+    auto instances = parseText (session.handleListInstances ())["instances"];
+    ASSERT_EQ (instances.size (), 1u);
+    EXPECT_EQ (instances[0]["id"], "a");
+    EXPECT_EQ (instances[0]["pluginPath"], "/a.vst3");
+    EXPECT_EQ (instances[0]["tools"], mcp::json::array ({"echo"}));
+}
+
+TEST (SessionServer, CallInstanceRoutesById)
+{
+    SessionServer session;
+    session.attach ("a", makeEchoTable ());
+
+    auto result = session.handleCallInstance ("a", "echo", {{"n", 7}}, "");
+    EXPECT_EQ (parseText (result)["n"], 7);
+
+    result = session.handleCallInstance ("b", "echo", mcp::json::object (), "");
+    EXPECT_TRUE (result.value ("isError", false));
+}
+
+TEST (SessionServer, SubscriptionsAreNotRouted)
+{
+    SessionServer session;
+    auto table = makeEchoTable ();
+    table->add (mcp::tool_builder ("subscribe_parameters").build (),
+        [](const mcp::json&, const std::string&) -> mcp::json { return textResult (mcp::json::object ()); });
+    session.attach ("a", table);
+
+    EXPECT_TRUE (session.handleCallInstance ("a", "subscribe_parameters", mcp::json::object (), "")
+                     .value ("isError", false));
+    EXPECT_EQ (table->names (), std::vector<std::string> {"echo"});
+}
+
+TEST (SessionServer, DetachOnlyRemovesTheGivenTable)
+{
+    SessionServer session;
+    auto first = makeEchoTable ();
+    auto second = makeEchoTable ();
+    session.attach ("a", first);
+    session.attach ("a", second);
+
+    session.detach ("a", first.get ());
+    EXPECT_FALSE (session.handleCallInstance ("a", "echo", mcp::json::object (), "").value ("isError", false));
+
+    session.detach ("a", second.get ());
+    EXPECT_TRUE (session.handleCallInstance ("a", "echo", mcp::json::object (), "").value ("isError", false));
+}
+
+// ============================================================
+// batch
+// ============================================================
+
+TEST (SessionServer, BatchReturnsResultsInCallOrder)
+{
+    SessionServer session;
+    session.attach ("a", makeEchoTable ());
+    session.attach ("b", makeEchoTable ());
+
+    mcp::json calls = mcp::json::array ({
+        call ("a", "echo", {{"n", 0}}),
+        call ("b", "echo", {{"n", 1}}),
+        call ("missing", "echo", {{"n", 2}}),
+        call ("a", "echo", {{"n", 3}}),
+    });
+    auto results = parseText (session.handleBatch (calls, ""))["results"];
+
+    ASSERT_EQ (results.size (), 4u);
+    EXPECT_EQ (results[0]["instance"], "a");
+    EXPECT_EQ (results[0]["result"]["n"], 0);
+    EXPECT_EQ (results[1]["result"]["n"], 1);
+    EXPECT_TRUE (results[2]["isError"].get<bool> ());
+    EXPECT_EQ (results[2]["result"], "Unknown instance: missing");
+    EXPECT_FALSE (results[3]["isError"].get<bool> ());
+    EXPECT_EQ (results[3]["result"]["n"], 3);
+}
+
+TEST (SessionServer, BatchKeepsOrderWithinAnInstance)
+{
+    SessionServer session;
+    std::vector<int> seen;
+    std::mutex seenMutex;
+    session.attach ("a", makeEchoTable (&seen, &seenMutex));
+    session.attach ("b", makeEchoTable ());
+
+    mcp::json calls = mcp::json::array ();
+    for (int i = 0; i < 20; ++i)
+        calls.push_back (call (i % 2 ? "b" : "a", "echo", {{"n", i}}));
+    session.handleBatch (calls, "");
+
+    std::vector<int> expected;
+    for (int i = 0; i < 20; i += 2)
+        expected.push_back (i);
+    EXPECT_EQ (seen, expected);
+}
+
+TEST (SessionServer, BatchRunsInstancesInParallel)
+{
+    // Each call waits until every instance has entered its call, so the
+    // batch only completes if they run at the same time
+    constexpr int kInstances = 4;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int entered = 0;
+
+    SessionServer session;
+    for (int i = 0; i < kInstances; ++i) {
+        auto table = std::make_shared<InstanceToolTable> ();
+        table->add (mcp::tool_builder ("rendezvous").build (), [&](const mcp::json&, const std::string&) -> mcp::json {
+            std::unique_lock<std::mutex> lock (mutex);
+            ++entered;
+            cv.notify_all ();
+            bool all = cv.wait_for (lock, std::chrono::seconds (5), [&] { return entered == kInstances; });
+            return textResult ({{"all", all}});
+        });
+        session.attach ("i" + std::to_string (i), table);
+    }
+
+    mcp::json calls = mcp::json::array ();
+    for (int i = 0; i < kInstances; ++i)
+        calls.push_back (call ("i" + std::to_string (i), "rendezvous", mcp::json::object ()));
+    auto results = parseText (session.handleBatch (calls, ""))["results"];
+
+    ASSERT_EQ (results.size (), static_cast<size_t> (kInstances));
+    for (const auto& result : results)
+        EXPECT_TRUE (result["result"]["all"].get<bool> ());
+}
+
+TEST (SessionServer, BatchRejectsMalformedCallsBeforeRunningAny)
+{
+    SessionServer session;
+    std::vector<int> seen;
+    std::mutex seenMutex;
+    session.attach ("a", makeEchoTable (&seen, &seenMutex));
+
+    mcp::json calls = mcp::json::array ({call ("a", "echo", {{"n", 0}}), {{"instance", "a"}}});
+    auto result = session.handleBatch (calls, "");
+    EXPECT_TRUE (result.value ("isError", false));
+    EXPECT_TRUE (seen.empty ());
+
+    EXPECT_TRUE (session.handleBatch (mcp::json::object (), "").value ("isError", false));
+}
+
+TEST (SessionServer, BatchRejectsTooManyCalls)
+{
+    SessionServer session;
+    mcp::json calls = mcp::json::array ();
+    for (size_t i = 0; i <= SessionServer::kMaxBatchCalls; ++i)
+        calls.push_back (call ("a", "echo", mcp::json::object ()));
+    EXPECT_TRUE (session.handleBatch (calls, "").value ("isError", false));
+}
+
+// ============================================================
+// Controller attachment
+// ============================================================
+
+TEST (SessionServerController, ControllerIsRoutableOnceBound)
+{
+    auto* processor = new Processor ();
+    ASSERT_EQ (processor->initialize (nullptr), kResultOk);
+    auto* controller = new Controller ();
+    ASSERT_EQ (controller->initialize (nullptr), kResultOk);
+    const std::string id = processor->getInstanceId ();
+
+    auto& session = SessionServer::shared ();
+    EXPECT_TRUE (session.handleCallInstance (id, "get_loaded_plugin", mcp::json::object (), "")
+                     .value ("isError", false));
+
+    MockMessage msg;
+    MockAttributeList attrs;
+    const void* data = id.data ();
+    uint32 size = static_cast<uint32> (id.size ());
+    EXPECT_CALL (msg, getMessageID ()).WillRepeatedly (Return (MessageIds::kInstanceId));
+    EXPECT_CALL (msg, getAttributes ()).WillRepeatedly (Return (&attrs));
+    EXPECT_CALL (attrs, getBinary (StrEq ("id"), _, _))
+        .WillOnce (DoAll (SetArgReferee<1> (data), SetArgReferee<2> (size), Return (kResultOk)));
+    EXPECT_EQ (controller->notify (&msg), kResultOk);
+
+    auto result = session.handleCallInstance (id, "get_loaded_plugin", mcp::json::object (), "");
+    EXPECT_FALSE (result.value ("isError", false));
+
+    controller->terminate ();
+    EXPECT_TRUE (session.handleCallInstance (id, "get_loaded_plugin", mcp::json::object (), "")
+                     .value ("isError", false));
+
+    controller->release ();
+    processor->terminate ();
+    processor->release ();
+}
@@ -61,7 +61,9 @@ TEST_F (StateRoundTripTest, GetStateOnA_SetStateOnB_PreservesPath)
     stream.seek (0, IBStream::kIBSeekSet, nullptr);
     // setState will try to loadHostedPlugin if path differs, which will fail
     // (no real plugin at that path), but the path is still parsed correctly.
+    // B isn't active, so the load only happens once the state is needed.
     processorB_->setState (&stream);
+    ProcessorTestAccess::completeRestore (*processorB_);
 
     // The load failed, so currentPluginPath_ on B remains empty.
     // But the stream format was parsed correctly — verified by the fact
@@ -73,9 +75,9 @@ TEST_F (StateRoundTripTest, GetStateOnA_SetStateOnB_PreservesPath)
     EXPECT_EQ (processorB_->getState (&stream2), kResultOk);
 
     stream2.seek (0, IBStream::kIBSeekSet, nullptr);
-    std::string readPath;
-    EXPECT_EQ (readStateHeader (&stream2, readPath), kResultOk);
-    EXPECT_EQ (readPath, testPath);
+    WrapperState saved;
+    EXPECT_EQ (readWrapperState (&stream2, saved), kResultOk);
+    EXPECT_EQ (saved.pluginPath, testPath);
 }
 
 //------------------------------------------------------------------------
@@ -183,3 +185,83 @@ TEST_F (StateRoundTripTest, EmptyStreamReturnsFalse)
     auto result = processorA_->setState (&stream);
     EXPECT_EQ (result, kResultFalse);
 }
+
+//------------------------------------------------------------------------
+// Hosted component state survives a v2 round trip, compressed, and the
+// instance ID travels with it
+//------------------------------------------------------------------------
+TEST_F (StateRoundTripTest, HostedStateAndInstanceIdRoundTrip)
+{
+    // Large and repetitive, like a sampler's state: compressed on save
+    const std::string hostedState = std::string (64 * 1024, 'S') + "end";
+
+    ::testing::NiceMock<MockComponent> componentA;
+    ON_CALL (componentA, getState (::testing::_)).WillByDefault ([&] (IBStream* s) {
+        int32 written = 0;
+        return s->write (const_cast<char*> (hostedState.data ()), static_cast<int32> (hostedState.size ()),
+                         &written);
+    });
+    ProcessorTestAccess::setHostedComponent (*processorA_, &componentA);
+
+    ResizableMemoryIBStream stream;
+    EXPECT_EQ (processorA_->getState (&stream), kResultOk);
+    int64 size = 0;
+    stream.seek (0, IBStream::kIBSeekEnd, &size);
+    EXPECT_LT (size, static_cast<int64> (hostedState.size () / 10));
+
+    // Like reopening the session: A is gone before B restores its ID (a
+    // live instance keeps its ID to itself, see test_instance_registry.cpp)
+    const std::string idA = processorA_->getInstanceId ();
+    ProcessorTestAccess::setHostedComponent (*processorA_, nullptr);
+    processorA_->terminate ();
+
+    std::string restored;
+    ::testing::NiceMock<MockComponent> componentB;
+    ON_CALL (componentB, setState (::testing::_)).WillByDefault ([&] (IBStream* s) {
+        restored.resize (hostedState.size () + 16);
+        int32 read = 0;
+        s->read (restored.data (), static_cast<int32> (restored.size ()), &read);
+        restored.resize (read);
+        return kResultOk;
+    });
+    ProcessorTestAccess::setHostedComponent (*processorB_, &componentB);
+
+    stream.seek (0, IBStream::kIBSeekSet, nullptr);
+    EXPECT_EQ (processorB_->setState (&stream), kResultOk);
+    EXPECT_EQ (restored, hostedState);
+    EXPECT_EQ (processorB_->getInstanceId (), idA);
+
+    ProcessorTestAccess::setHostedComponent (*processorB_, nullptr);
+}
+
+//------------------------------------------------------------------------
+// A v1 stream still restores: the bytes after the header go to the hosted
+// component as they are
+//------------------------------------------------------------------------
+TEST_F (StateRoundTripTest, V1StreamForwardsRemainderToHosted)
+{
+    const std::string hostedState = "V1_HOSTED_STATE";
+    ResizableMemoryIBStream stream;
+    EXPECT_EQ (writeStateHeader (&stream, ""), kResultOk);
+    int32 written = 0;
+    stream.write (const_cast<char*> (hostedState.data ()), static_cast<int32> (hostedState.size ()), &written);
+
+    std::string restored;
+    ::testing::NiceMock<MockComponent> component;
+    ON_CALL (component, setState (::testing::_)).WillByDefault ([&] (IBStream* s) {
+        restored.resize (64);
+        int32 read = 0;
+        s->read (restored.data (), static_cast<int32> (restored.size ()), &read);
+        restored.resize (read);
+        return kResultOk;
+    });
+    ProcessorTestAccess::setHostedComponent (*processorA_, &component);
+
+    const std::string idBefore = processorA_->getInstanceId ();
+    stream.seek (0, IBStream::kIBSeekSet, nullptr);
+    EXPECT_EQ (processorA_->setState (&stream), kResultOk);
+    EXPECT_EQ (restored, hostedState);
+    EXPECT_EQ (processorA_->getInstanceId (), idBefore) << "v1 carries no instance ID";
+
+    ProcessorTestAccess::setHostedComponent (*processorA_, nullptr);
+}
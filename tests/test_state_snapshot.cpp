@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "processor.h"
+#include "hostedplugin.h"
+#include "helpers/processor_test_access.h"
+#include "mocks/mock_vst3.h"
+
+#include "public.sdk/source/vst/hosting/parameterchanges.h"
+#include "public.sdk/source/vst/utility/memoryibstream.h"
+
+#include <string>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace VST3MCPWrapper;
+using namespace VST3MCPWrapper::Testing;
+
+//------------------------------------------------------------------------
+// Test fixture — a processor with a mock hosted component whose getState()
+// calls are counted
+//------------------------------------------------------------------------
+class StateSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp () override
+    {
+        processor_ = new Processor ();
+        ASSERT_EQ (processor_->initialize (nullptr), kResultOk);
+
+        ON_CALL (component_, getState (::testing::_)).WillByDefault ([this] (IBStream* s) {
+            int32 written = 0;
+            return s->write (const_cast<char*> (hostedState_.data ()), static_cast<int32> (hostedState_.size ()),
+                             &written);
+        });
+        ProcessorTestAccess::setHostedComponent (*processor_, &component_);
+    }
+
+    void TearDown () override
+    {
+        ProcessorTestAccess::setHostedComponent (*processor_, nullptr);
+        ProcessorTestAccess::setHostedProcessor (*processor_, nullptr);
+        ProcessorTestAccess::setProcessorReady (*processor_, false);
+        processor_->terminate ();
+        processor_->release ();
+    }
+
+    std::string saveState ()
+    {
+        ResizableMemoryIBStream stream;
+        EXPECT_EQ (processor_->getState (&stream), kResultOk);
+        int64 size = 0;
+        stream.seek (0, IBStream::kIBSeekEnd, &size);
+        stream.seek (0, IBStream::kIBSeekSet, nullptr);
+        std::string bytes (static_cast<size_t> (size), '\0');
+        int32 read = 0;
+        stream.read (bytes.data (), static_cast<int32> (size), &read);
+        return bytes;
+    }
+
+    // Run one block through the mock hosted processor
+    void processBlock (IParameterChanges* dawChanges)
+    {
+        float in[16] = {};
+        float out[16] = {};
+        float* inPtr = in;
+        float* outPtr = out;
+        AudioBusBuffers inBus{};
+        inBus.numChannels = 1;
+        inBus.channelBuffers32 = &inPtr;
+        AudioBusBuffers outBus{};
+        outBus.numChannels = 1;
+        outBus.channelBuffers32 = &outPtr;
+
+        ProcessData data{};
+        data.numSamples = 16;
+        data.symbolicSampleSize = kSample32;
+        data.numInputs = 1;
+        data.numOutputs = 1;
+        data.inputs = &inBus;
+        data.outputs = &outBus;
+        data.inputParameterChanges = dawChanges;
+        processor_->process (data);
+    }
+
+    void attachHostedProcessor ()
+    {
+        ON_CALL (audioProcessor_, process (::testing::_)).WillByDefault (::testing::Return (kResultOk));
+        ProcessorTestAccess::setHostedProcessor (*processor_, &audioProcessor_);
+        ProcessorTestAccess::setProcessorReady (*processor_, true);
+        ProcessorTestAccess::setHostedActive (*processor_, true);
+    }
+
+    Processor* processor_ = nullptr;
+    ::testing::NiceMock<MockComponent> component_;
+    ::testing::NiceMock<MockAudioProcessor> audioProcessor_;
+    std::string hostedState_ = "HOSTED_STATE";
+};
+
+//------------------------------------------------------------------------
+// Repeated getState() without changes serializes the hosted plugin once and
+// writes the same bytes every time
+//------------------------------------------------------------------------
+TEST_F (StateSnapshotTest, RepeatedGetStateServesSnapshot)
+{
+    EXPECT_CALL (component_, getState (::testing::_)).Times (1);
+
+    auto first = saveState ();
+    auto second = saveState ();
+    auto third = saveState ();
+    EXPECT_FALSE (first.empty ());
+    EXPECT_EQ (second, first);
+    EXPECT_EQ (third, first);
+}
+
+//------------------------------------------------------------------------
+// A queued parameter change (MCP tool or performEdit) invalidates the
+// snapshot
+//------------------------------------------------------------------------
+TEST_F (StateSnapshotTest, QueuedParamChangeInvalidatesSnapshot)
+{
+    EXPECT_CALL (component_, getState (::testing::_)).Times (2);
+
+    saveState ();
+    processor_->getHostedInstance ().pushParamChange (7, 0.5);
+    hostedState_ = "CHANGED";
+    auto after = saveState ();
+
+    EXPECT_NE (after.find ("CHANGED"), std::string::npos);
+}
+
+//------------------------------------------------------------------------
+// A state captured between a push and the block that applies it is
+// replaced once the change reaches the hosted plugin
+//------------------------------------------------------------------------
+TEST_F (StateSnapshotTest, ChangeAppliedAfterCaptureInvalidatesSnapshot)
+{
+    attachHostedProcessor ();
+    EXPECT_CALL (component_, getState (::testing::_)).Times (2);
+
+    processor_->getHostedInstance ().pushParamChange (7, 0.5);
+    saveState ();
+    saveState (); // Nothing applied yet: served from the snapshot
+    processBlock (nullptr);
+    saveState ();
+    saveState ();
+}
+
+//------------------------------------------------------------------------
+// DAW automation seen in process() invalidates the snapshot; blocks without
+// parameter changes don't
+//------------------------------------------------------------------------
+TEST_F (StateSnapshotTest, DawAutomationInvalidatesSnapshot)
+{
+    attachHostedProcessor ();
+    EXPECT_CALL (component_, getState (::testing::_)).Times (2);
+
+    saveState ();
+    processBlock (nullptr);
+    saveState ();
+
+    ParameterChanges dawChanges (1);
+    int32 index = 0;
+    auto* queue = dawChanges.addParameterData (3, index);
+    ASSERT_NE (queue, nullptr);
+    queue->addPoint (0, 0.25, index);
+    processBlock (&dawChanges);
+    saveState ();
+}
+
+//------------------------------------------------------------------------
+// setState() invalidates the snapshot, even for a state that restores the
+// same plugin
+//------------------------------------------------------------------------
+TEST_F (StateSnapshotTest, SetStateInvalidatesSnapshot)
+{
+    EXPECT_CALL (component_, getState (::testing::_)).Times (2);
+
+    auto saved = saveState ();
+    ResizableMemoryIBStream stream;
+    stream.write (saved.data (), static_cast<int32> (saved.size ()), nullptr);
+    stream.seek (0, IBStream::kIBSeekSet, nullptr);
+    EXPECT_EQ (processor_->setState (&stream), kResultOk);
+    saveState ();
+}
+
+//------------------------------------------------------------------------
+// With the hosted editor open every getState() serializes the plugin:
+// editors can change state without telling us
+//------------------------------------------------------------------------
+TEST_F (StateSnapshotTest, OpenEditorBypassesSnapshot)
+{
+    EXPECT_CALL (component_, getState (::testing::_)).Times (3);
+
+    processor_->getHostedInstance ().setHostedEditorOpen (true);
+    saveState ();
+    saveState ();
+
+    processor_->getHostedInstance ().setHostedEditorOpen (false);
+    saveState ();
+    saveState ();
+}
+
+//------------------------------------------------------------------------
+// A failed hosted getState() is not cached
+//------------------------------------------------------------------------
+TEST_F (StateSnapshotTest, FailedGetStateIsNotCached)
+{
+    EXPECT_CALL (component_, getState (::testing::_))
+        .WillOnce (::testing::Return (kResultFalse))
+        .WillRepeatedly (::testing::Return (kResultOk));
+
+    ResizableMemoryIBStream stream;
+    EXPECT_EQ (processor_->getState (&stream), kResultFalse);
+    saveState ();
+    saveState ();
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include "statestream.h"
+
+#include "public.sdk/source/vst/utility/memoryibstream.h"
+
+#include <string>
+
+using namespace Steinberg;
+using namespace VST3MCPWrapper;
+
+namespace {
+
+std::string readString(IBStream& stream, int32 count) {
+    std::string out(static_cast<size_t>(count), '\0');
+    int32 numRead = 0;
+    stream.read(out.data(), count, &numRead);
+    out.resize(static_cast<size_t>(numRead));
+    return out;
+}
+
+StateBuffer bufferOf(const std::string& text) {
+    return std::make_shared<const std::vector<char>>(text.begin(), text.end());
+}
+
+} // namespace
+
+TEST(BufferStreamTest, ReadsAndSeeksWithinBuffer) {
+    BufferStream stream(bufferOf("0123456789"));
+
+    EXPECT_EQ(readString(stream, 4), "0123");
+    int64 pos = 0;
+    EXPECT_EQ(stream.seek(-2, IBStream::kIBSeekEnd, &pos), kResultOk);
+    EXPECT_EQ(pos, 8);
+    EXPECT_EQ(readString(stream, 100), "89") << "short read at the end";
+    EXPECT_EQ(readString(stream, 1), "");
+
+    EXPECT_NE(stream.seek(-1, IBStream::kIBSeekSet, nullptr), kResultOk);
+    EXPECT_EQ(stream.seek(3, IBStream::kIBSeekSet, nullptr), kResultOk);
+    EXPECT_EQ(stream.tell(&pos), kResultOk);
+    EXPECT_EQ(pos, 3);
+}
+
+TEST(BufferStreamTest, IsReadOnly) {
+    auto buffer = bufferOf("abc");
+    BufferStream stream(buffer);
+    int32 written = -1;
+    char data[1] = {'x'};
+    EXPECT_NE(stream.write(data, 1, &written), kResultOk);
+    EXPECT_EQ(written, 0);
+    EXPECT_EQ(std::string(buffer->begin(), buffer->end()), "abc");
+}
+
+TEST(CaptureStreamTest, TakeKeepsSeekedBackWrites) {
+    CaptureStream stream;
+    int32 written = 0;
+    stream.write(const_cast<char*>("....payload"), 11, &written);
+    // Plugins often patch a size field after writing the data
+    stream.seek(0, IBStream::kIBSeekSet, nullptr);
+    stream.write(const_cast<char*>("SIZE"), 4, &written);
+
+    int64 pos = 0;
+    stream.tell(&pos);
+    EXPECT_EQ(pos, 4);
+
+    auto buffer = stream.take();
+    ASSERT_TRUE(buffer);
+    EXPECT_EQ(std::string(buffer->begin(), buffer->end()), "SIZEpayload");
+}
+
+TEST(SubRangeStreamTest, SeesOnlyItsRange) {
+    ResizableMemoryIBStream parent;
+    int32 written = 0;
+    parent.write(const_cast<char*>("headerSECTIONtrailer"), 20, &written);
+
+    SubRangeStream stream(&parent, 6, 7);
+    EXPECT_EQ(readString(stream, 3), "SEC");
+
+    // The parent moves elsewhere between reads
+    parent.seek(0, IBStream::kIBSeekSet, nullptr);
+    EXPECT_EQ(readString(stream, 100), "TION");
+
+    int64 pos = 0;
+    EXPECT_EQ(stream.seek(0, IBStream::kIBSeekEnd, &pos), kResultOk);
+    EXPECT_EQ(pos, 7);
+    EXPECT_EQ(stream.seek(1, IBStream::kIBSeekSet, nullptr), kResultOk);
+    EXPECT_EQ(readString(stream, 2), "EC");
+    EXPECT_NE(stream.write(const_cast<char*>("x"), 1, &written), kResultOk);
+}
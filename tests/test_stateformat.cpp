@@ -306,3 +306,280 @@ TEST(StateFormat, WriteSucceedsWithSufficientCapacity) {
     LimitedCapacityStream stream(16);
     EXPECT_EQ(writeStateHeader(&stream, path), kResultOk);
 }
+
+// --- v2 ---
+
+namespace {
+
+WrapperState makeFullState() {
+    WrapperState state;
+    state.instanceId = "0123456789abcdef";
+    state.pluginPath = "/usr/lib/vst3/Sampler.vst3";
+    state.effectClassId.assign(16, '\x11');
+    state.controllerClassId.assign(16, '\x22');
+    state.componentState.buffer = std::make_shared<const std::vector<char>>(100000, 'c');
+    state.controllerState.buffer = std::make_shared<const std::vector<char>>(std::vector<char>{'k', 0, 'k'});
+    state.settings["paramQueueMode"] = "fifo";
+    return state;
+}
+
+// Everything a hosted plugin would read from payload
+std::vector<char> payloadBytes(IBStream* source, const StatePayload& payload) {
+    std::vector<char> bytes;
+    loadPayload(source, payload, [&bytes](IBStream* s) {
+        char chunk[4096];
+        int32 numRead = 0;
+        while (s->read(chunk, sizeof(chunk), &numRead) == kResultOk && numRead > 0)
+            bytes.insert(bytes.end(), chunk, chunk + numRead);
+        return kResultOk;
+    });
+    return bytes;
+}
+
+int64 streamSize(ResizableMemoryIBStream& stream) {
+    int64 size = 0;
+    stream.seek(0, IBStream::kIBSeekEnd, &size);
+    stream.rewind();
+    return size;
+}
+
+} // namespace
+
+TEST(StateFormatV2, RoundTripAllSections) {
+    WrapperState written = makeFullState();
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeWrapperState(&stream, written), kResultOk);
+    stream.rewind();
+
+    WrapperState read;
+    ASSERT_EQ(readWrapperState(&stream, read), kResultOk);
+    EXPECT_EQ(read.version, kStateVersionV2);
+    EXPECT_EQ(read.instanceId, written.instanceId);
+    EXPECT_EQ(read.pluginPath, written.pluginPath);
+    EXPECT_EQ(read.effectClassId, written.effectClassId);
+    EXPECT_EQ(read.controllerClassId, written.controllerClassId);
+    EXPECT_EQ(payloadBytes(&stream, read.componentState), *written.componentState.buffer);
+    EXPECT_EQ(payloadBytes(&stream, read.controllerState), *written.controllerState.buffer);
+    EXPECT_EQ(read.settings, written.settings);
+}
+
+TEST(StateFormatV2, LargeSectionsAreCompressedSmallOnesAreNot) {
+    WrapperState state = makeFullState();
+
+    ResizableMemoryIBStream compressed;
+    ASSERT_EQ(writeWrapperState(&compressed, state), kResultOk);
+    EXPECT_LT(streamSize(compressed), 10000);
+
+    ResizableMemoryIBStream raw;
+    ASSERT_EQ(writeWrapperState(&raw, state, SIZE_MAX), kResultOk);
+    EXPECT_GT(streamSize(raw), 100000);
+}
+
+TEST(StateFormatV2, IncompressibleStateIsStoredRaw) {
+    WrapperState state;
+    std::vector<char> random;
+    uint32 x = 12345;
+    for (int i = 0; i < 8192; ++i) {
+        x = x * 1664525u + 1013904223u;
+        random.push_back(static_cast<char>(x >> 24));
+    }
+    state.componentState.buffer = std::make_shared<const std::vector<char>>(random);
+
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeWrapperState(&stream, state), kResultOk);
+    // magic + version + CSTA header + payload + END header
+    EXPECT_EQ(streamSize(stream), 8 + 28 + 8192 + 28);
+
+    WrapperState read;
+    ASSERT_EQ(readWrapperState(&stream, read), kResultOk);
+    EXPECT_EQ(read.componentState.offset, 8 + 28) << "left in the stream, not copied";
+    EXPECT_FALSE(read.componentState.buffer);
+    EXPECT_EQ(payloadBytes(&stream, read.componentState), random);
+}
+
+TEST(StateFormatV2, EmptyStateRoundTrips) {
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeWrapperState(&stream, WrapperState()), kResultOk);
+    stream.rewind();
+
+    WrapperState read;
+    ASSERT_EQ(readWrapperState(&stream, read), kResultOk);
+    EXPECT_TRUE(read.pluginPath.empty());
+    EXPECT_FALSE(read.componentState.present());
+    EXPECT_FALSE(read.controllerState.present());
+}
+
+TEST(StateFormatV2, CorruptPayloadRejected) {
+    WrapperState state;
+    state.componentState.buffer = std::make_shared<const std::vector<char>>(100, 'c');
+
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeWrapperState(&stream, state, SIZE_MAX), kResultOk);
+    stream.data[8 + 28 + 50] ^= 0x01; // Flip a bit in the raw payload
+    stream.rewind();
+
+    WrapperState read;
+    EXPECT_EQ(readWrapperState(&stream, read), kResultFalse);
+}
+
+TEST(StateFormatV2, CorruptCompressedPayloadRejected) {
+    WrapperState state = makeFullState();
+    state.instanceId.clear();
+    state.pluginPath.clear();
+    state.effectClassId.clear();
+    state.controllerClassId.clear();
+    state.settings.clear();
+
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeWrapperState(&stream, state), kResultOk);
+    stream.data[8 + 28 + 20] ^= 0x40;
+    stream.rewind();
+
+    WrapperState read;
+    EXPECT_EQ(readWrapperState(&stream, read), kResultFalse);
+}
+
+TEST(StateFormatV2, TruncatedStreamRejected) {
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeWrapperState(&stream, makeFullState()), kResultOk);
+    stream.data.resize(stream.data.size() - 1); // Cut into the END section
+    stream.rewind();
+
+    WrapperState read;
+    EXPECT_EQ(readWrapperState(&stream, read), kResultFalse);
+}
+
+TEST(StateFormatV2, UnknownSectionsAreSkipped) {
+    WrapperState state;
+    state.pluginPath = "/p.vst3";
+
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeWrapperState(&stream, state), kResultOk);
+
+    // Insert a section from a future version, with a codec we don't know,
+    // right after the version field
+    std::vector<char> future;
+    auto append = [&future](const void* data, size_t size) {
+        auto* bytes = static_cast<const char*>(data);
+        future.insert(future.end(), bytes, bytes + size);
+    };
+    const char tag[4] = {'N', 'E', 'W', '!'};
+    const uint8 codecAndReserved[4] = {9, 0, 0, 0};
+    const uint64 rawSize = 1000, storedSize = 5;
+    const uint32 crc = 0;
+    append(tag, 4);
+    append(codecAndReserved, 4);
+    append(&rawSize, 8);
+    append(&storedSize, 8);
+    append(&crc, 4);
+    append("xxxxx", 5);
+    stream.data.insert(stream.data.begin() + 8, future.begin(), future.end());
+    stream.rewind();
+
+    WrapperState read;
+    ASSERT_EQ(readWrapperState(&stream, read), kResultOk);
+    EXPECT_EQ(read.pluginPath, "/p.vst3");
+}
+
+TEST(StateFormatV2, ReadsV1HeaderAndStopsAtHostedState) {
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeStateHeader(&stream, "/v1.vst3"), kResultOk);
+    int32 written = 0;
+    stream.write(const_cast<char*>("HOSTED"), 6, &written);
+    stream.rewind();
+
+    WrapperState read;
+    ASSERT_EQ(readWrapperState(&stream, read), kResultOk);
+    EXPECT_EQ(read.version, kStateVersion);
+    EXPECT_EQ(read.pluginPath, "/v1.vst3");
+    EXPECT_FALSE(read.componentState.present());
+
+    char rest[6] = {};
+    int32 numRead = 0;
+    ASSERT_EQ(stream.read(rest, sizeof(rest), &numRead), kResultOk);
+    EXPECT_EQ(std::string(rest, numRead), "HOSTED");
+}
+
+TEST(StateFormatV2, V1ReaderRejectsV2Stream) {
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeWrapperState(&stream, makeFullState()), kResultOk);
+    stream.rewind();
+
+    std::string readPath;
+    EXPECT_EQ(readStateHeader(&stream, readPath), kResultFalse);
+}
+
+TEST(StateFormatV2, UnsupportedVersionRejected) {
+    ResizableMemoryIBStream stream;
+    int32 written = 0;
+    stream.write(const_cast<char*>(kStateMagic), sizeof(kStateMagic), &written);
+    uint32 version = 3;
+    stream.write(&version, sizeof(version), &written);
+    stream.rewind();
+
+    WrapperState read;
+    EXPECT_EQ(readWrapperState(&stream, read), kResultFalse);
+}
+
+TEST(StateFormatV2, ShortWriteDetected) {
+    LimitedCapacityStream stream(64);
+    EXPECT_EQ(writeWrapperState(&stream, makeFullState()), kResultFalse);
+}
+
+TEST(StateFormatV2, KnownBufferIsSharedInsteadOfRead) {
+    WrapperState state = makeFullState();
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeWrapperState(&stream, state), kResultOk);
+
+    // Same content, different buffer: matched by size and CRC
+    auto known = std::make_shared<const std::vector<char>>(*state.componentState.buffer);
+    stream.rewind();
+    WrapperState read;
+    ASSERT_EQ(readWrapperState(&stream, read, known), kResultOk);
+    EXPECT_EQ(read.componentState.buffer, known);
+    EXPECT_NE(read.controllerState.buffer, known);
+    EXPECT_EQ(read.pluginPath, state.pluginPath) << "sections after the skipped one still read";
+
+    auto other = std::make_shared<const std::vector<char>>(100000, 'x');
+    stream.rewind();
+    ASSERT_EQ(readWrapperState(&stream, read, other), kResultOk);
+    EXPECT_NE(read.componentState.buffer, other);
+    EXPECT_EQ(*read.componentState.buffer, *state.componentState.buffer);
+}
+
+TEST(StateFormatV2, DetachCopiesPayloadsLeftInTheStream) {
+    WrapperState state = makeFullState();
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeWrapperState(&stream, state, SIZE_MAX), kResultOk);
+    stream.rewind();
+
+    WrapperState read;
+    ASSERT_EQ(readWrapperState(&stream, read), kResultOk);
+    ASSERT_GE(read.componentState.offset, 0);
+    ASSERT_EQ(detachWrapperState(&stream, read), kResultOk);
+    EXPECT_EQ(read.componentState.offset, -1);
+    ASSERT_TRUE(read.componentState.buffer);
+    EXPECT_EQ(*read.componentState.buffer, *state.componentState.buffer);
+    EXPECT_EQ(payloadBytes(nullptr, read.controllerState), *state.controllerState.buffer);
+}
+
+TEST(StateFormatV2, DetachTurnsV1RemainderIntoComponentState) {
+    ResizableMemoryIBStream stream;
+    ASSERT_EQ(writeStateHeader(&stream, "/v1.vst3"), kResultOk);
+    int32 written = 0;
+    stream.write(const_cast<char*>("HOSTED"), 6, &written);
+    stream.rewind();
+
+    WrapperState read;
+    ASSERT_EQ(readWrapperState(&stream, read), kResultOk);
+    ASSERT_EQ(detachWrapperState(&stream, read), kResultOk);
+    EXPECT_EQ(read.version, kStateVersionV2);
+    EXPECT_EQ(read.pluginPath, "/v1.vst3");
+    EXPECT_EQ(payloadBytes(nullptr, read.componentState), std::vector<char>({'H', 'O', 'S', 'T', 'E', 'D'}));
+
+    // Left at the hosted state for a caller that applies it from the stream
+    char rest[6] = {};
+    int32 numRead = 0;
+    ASSERT_EQ(stream.read(rest, sizeof(rest), &numRead), kResultOk);
+    EXPECT_EQ(std::string(rest, numRead), "HOSTED");
+}